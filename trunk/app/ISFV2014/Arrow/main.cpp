@@ -1,6 +1,7 @@
 #include <kvs/glut/Application>
 #include <kvs/glut/Screen>
 #include <kvs/GrADS>
+#include <kvs/Message>
 #include <kvs/Bounds>
 #include <kvs/ArrowGlyph>
 #include <kvs/TransferFunction>
@@ -30,6 +31,14 @@ int main( int argc, char** argv )
     std::cout << kvs::Indent(4) << wdata->data(tindex).filename() << std::endl;
 
     kvs::StructuredVolumeObject* volume = ISFV2014::Import( udata, vdata, wdata, tindex, vindex );
+    if ( !volume )
+    {
+        kvsMessageError("Cannot import the datasets.");
+        delete udata;
+        delete vdata;
+        delete wdata;
+        return 1;
+    }
     volume->print( std::cout << std::endl << "IMPORTED VOLUME" << std::endl, kvs::Indent(4) );
 
     delete udata;
@@ -38,20 +47,19 @@ int main( int argc, char** argv )
 
     const kvs::Vec3 min_range( 141, 35, -1000 ); // in (deg, deg, meter)
     const kvs::Vec3 max_range( 147, 43, 0 ); // in (deg, deg, meter)
-    kvs::StructuredVolumeObject* cropped_volume = ISFV2014::Crop( volume, min_range, max_range );
+    // The cropped and rescaled volume is given as the view of the imported
+    // volume, and only the downsized volume is copied from it.
+    util::VolumeView cropped_view = ISFV2014::Crop( util::VolumeView( volume ), min_range, max_range );
+    delete volume;
 
     const kvs::Vec3 coord_scale( 1, 1, 200 );
     const kvs::Vec3 value_scale( 1, 1, 1 );
-    ISFV2014::Rescale::Coords( cropped_volume, coord_scale );
-    ISFV2014::Rescale::Values( cropped_volume, value_scale );
-
-    cropped_volume->print( std::cout << std::endl << "CROPPED VOLUME" << std::endl, kvs::Indent(4) );
-    delete volume;
+    cropped_view = ISFV2014::Rescale::Coords( cropped_view, coord_scale );
+    cropped_view = ISFV2014::Rescale::Values( cropped_view, value_scale );
 
     const kvs::Vec3ui stride( 3, 3, 3 );
-    kvs::StructuredVolumeObject* downsized_volume = ISFV2014::Downsize( cropped_volume, stride );
+    kvs::StructuredVolumeObject* downsized_volume = ISFV2014::Downsize( cropped_view, stride );
     downsized_volume->print( std::cout << std::endl << "DOWNSIZED VOLUME" << std::endl, kvs::Indent(4) );
-    delete cropped_volume;
 
     ISFV2014::ArrowGlyph* arrow = new ISFV2014::ArrowGlyph();
     const kvs::TransferFunction transfer_function( kvs::RGBFormulae::Jet( 256 ) );
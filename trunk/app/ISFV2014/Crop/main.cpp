@@ -21,12 +21,12 @@ int main( int argc, char** argv )
     std::cout << "IMPORT FILE" << std::endl;
     std::cout << kvs::Indent(4) << data->data(tindex).filename() << std::endl;
 
-    kvs::StructuredVolumeObject* volume = ISFV2014::Import( data, tindex, vindex );
-    volume->print( std::cout << std::endl << "ORIGINAL VOLUME" << std::endl, kvs::Indent(4) );
-    delete data;
-
     const kvs::Vec3 min_range( 141, 33, -1000 ); // in (deg, deg, meter)
     const kvs::Vec3 max_range( 147, 43, 0 ); // in (deg, deg, meter)
+    kvs::StructuredVolumeObject* volume = ISFV2014::Import( data, tindex, vindex, min_range, max_range );
+    volume->print( std::cout << std::endl << "IMPORTED REGION" << std::endl, kvs::Indent(4) );
+    delete data;
+
     kvs::StructuredVolumeObject* cropped_volume = ISFV2014::Crop( volume, min_range, max_range );
     cropped_volume->print( std::cout << std::endl << "CROPPED VOLUME (deg)" << std::endl, kvs::Indent(4) );
     delete volume;
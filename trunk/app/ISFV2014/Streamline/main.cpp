@@ -1,6 +1,7 @@
 #include <kvs/glut/Application>
 #include <kvs/glut/Screen>
 #include <kvs/GrADS>
+#include <kvs/Message>
 #include <kvs/Bounds>
 #include <kvs/ArrowGlyph>
 #include <kvs/SphereGlyph>
@@ -240,10 +241,27 @@ int main( int argc, char** argv )
     std::cout << kvs::Indent(4) << wdata->data(tindex).filename() << std::endl;
     std::cout << kvs::Indent(4) << tdata->data(tindex).filename() << std::endl;
 
-    kvs::StructuredVolumeObject* volume = ISFV2014::Import( udata, vdata, wdata, tindex, vindex );
+    // The velocity components and the temperature are imported concurrently.
+    std::vector<const kvs::GrADS*> data;
+    data.push_back( udata );
+    data.push_back( vdata );
+    data.push_back( wdata );
+    data.push_back( tdata );
+    std::vector<kvs::StructuredVolumeObject*> volumes = ISFV2014::Import( data, tindex, vindex );
+    if ( !volumes[0] )
+    {
+        kvsMessageError("Cannot import the datasets.");
+        delete udata;
+        delete vdata;
+        delete wdata;
+        delete tdata;
+        return 1;
+    }
+
+    kvs::StructuredVolumeObject* volume = ISFV2014::Combine( volumes[0], volumes[1], volumes[2] );
     volume->print( std::cout << std::endl << "IMPORTED VOLUME (velocity)" << std::endl, kvs::Indent(4) );
 
-    kvs::StructuredVolumeObject* tvolume = ISFV2014::Import( tdata, tindex, vindex );
+    kvs::StructuredVolumeObject* tvolume = volumes[3];
     tvolume->print( std::cout << std::endl << "IMPORTED VOLUME (temperature)" << std::endl, kvs::Indent(4) );
 
     delete udata;
@@ -257,19 +275,23 @@ int main( int argc, char** argv )
 //    const kvs::Vec3 min_range( 160, 50, -1000 ); // in (deg, deg, meter)
 //    const kvs::Vec3 max_range( 180, 60, 0 ); // in (deg, deg, meter)
 
-    kvs::StructuredVolumeObject* cropped_volume = ISFV2014::Crop( volume, min_range, max_range );
-    kvs::StructuredVolumeObject* cropped_tvolume = ISFV2014::Crop( tvolume, min_range, max_range );
+    // The cropped and rescaled volumes are given as the views of the imported
+    // volumes, and they are materialized once for the streamlines and slice.
+    util::VolumeView cropped_view = ISFV2014::Crop( util::VolumeView( volume ), min_range, max_range );
+    util::VolumeView cropped_tview = ISFV2014::Crop( util::VolumeView( tvolume ), min_range, max_range );
+    delete volume;
+    delete tvolume;
 
     const kvs::Vec3 coord_scale( 1, 1, 400 );
     const kvs::Vec3 value_scale( 1, 1, 400 );
-    ISFV2014::Rescale::Coords( cropped_volume, coord_scale );
-    ISFV2014::Rescale::Values( cropped_volume, value_scale, true );
-    ISFV2014::Rescale::Coords( cropped_tvolume, coord_scale );
+    cropped_view = ISFV2014::Rescale::Coords( cropped_view, coord_scale );
+    cropped_view = ISFV2014::Rescale::Values( cropped_view, value_scale, true );
+    cropped_tview = ISFV2014::Rescale::Coords( cropped_tview, coord_scale );
 
+    kvs::StructuredVolumeObject* cropped_volume = cropped_view.materialize();
+    kvs::StructuredVolumeObject* cropped_tvolume = cropped_tview.materialize();
     cropped_volume->print( std::cout << std::endl << "CROPPED VOLUME (velocity)" << std::endl, kvs::Indent(4) );
     cropped_tvolume->print( std::cout << std::endl << "CROPPED VOLUME (temperature)" << std::endl, kvs::Indent(4) );
-    delete volume;
-    delete tvolume;
 
 
     const float p = kvs::Math::Mix( cropped_tvolume->minObjectCoord().z(), cropped_tvolume->maxObjectCoord().z(), 0.2f );
@@ -284,13 +306,13 @@ int main( int argc, char** argv )
 
 
 
-    kvs::PointObject* vortex_points = ISFV2014::Vortex( cropped_volume, ignore_value );
+    kvs::PointObject* vortex_points = ISFV2014::Vortex( cropped_view, ignore_value );
     vortex_points->setName( "VortexPoints" );
     vortex_points->setColor( kvs::RGBColor( 128, 128, 128 ) );
     vortex_points->print( std::cout << std::endl << "VORTEX POINTS" << std::endl, kvs::Indent(4) );
 
     const kvs::Vec3ui stride( 3, 3, 3 );
-    kvs::StructuredVolumeObject* downsized_volume = ISFV2014::Downsize( cropped_volume, stride );
+    kvs::StructuredVolumeObject* downsized_volume = ISFV2014::Downsize( cropped_view, stride );
     downsized_volume->setName( "ArrowGlyph" );
     downsized_volume->print( std::cout << std::endl << "DOWNSIZED VOLUME" << std::endl, kvs::Indent(4) );
 
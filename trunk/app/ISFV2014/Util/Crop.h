@@ -4,6 +4,7 @@
 #include <kvs/StructuredVolumeObject>
 #include <util/CropVolume.h>
 #include <util/DegreeToDistance.h>
+#include <util/VolumeView.h>
 
 using namespace kvsoceanvis;
 
@@ -22,4 +23,14 @@ kvs::StructuredVolumeObject* Crop(
     return object;
 };
 
+util::VolumeView Crop(
+    const util::VolumeView& view,
+    const kvs::Vec3 min_range,
+    const kvs::Vec3 max_range )
+{
+    // Same scales as util::DegreeToDistance (deg to kilo-meter, meter to kilo-meter).
+    const kvs::Vec3 scale( 91.0f, 111.0f, 0.001f );
+    return view.crop( min_range, max_range ).scaleCoords( scale );
+};
+
 } // end of namespace ISFV2014
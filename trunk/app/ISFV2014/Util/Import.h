@@ -1,9 +1,12 @@
 #pragma once
 
+#include <vector>
 #include <kvs/Math>
 #include <kvs/GrADS>
+#include <kvs/Vector3>
 #include <kvs/StructuredVolumeObject>
 #include <util/StructuredVolumeImporter.h>
+#include <util/ParallelVolumeImporter.h>
 #include <util/CombineVectors.h>
 
 using namespace kvsoceanvis;
@@ -118,22 +121,58 @@ kvs::StructuredVolumeObject* Import(
 }
 
 kvs::StructuredVolumeObject* Import(
-    const kvs::GrADS* udata,
-    const kvs::GrADS* vdata,
-    const kvs::GrADS* wdata,
+    const kvs::GrADS* data,
     const size_t tindex,
     const size_t vindex,
-    const bool zflip = true,
-    const bool wadjust = true )
+    const kvs::Vec3& min_range,
+    const kvs::Vec3& max_range,
+    const bool zflip = true )
 {
     typedef kvs::StructuredVolumeObject Object;
     typedef util::StructuredVolumeImporter Importer;
 
+    // Only the values in the region are read from the memory-mapped file.
+    const Object::GridType grid_type = Object::Rectilinear;
+    Object* object = new Importer( data, min_range, max_range, vindex, tindex, zflip, grid_type );
+
+    return object;
+}
+
+std::vector<kvs::StructuredVolumeObject*> Import(
+    const std::vector<const kvs::GrADS*>& data,
+    const size_t tindex,
+    const size_t vindex,
+    const bool zflip = true )
+{
+    typedef kvs::StructuredVolumeObject Object;
+
+    // The datasets are imported concurrently within the default memory budget
+    // (half of the physical memory).
     const Object::GridType grid_type = Object::Rectilinear;
-    Object* uvolume = new Importer( udata, vindex, tindex, zflip, grid_type );
-    Object* vvolume = new Importer( vdata, vindex, tindex, zflip, grid_type );
-    Object* wvolume = new Importer( wdata, vindex, tindex, zflip, grid_type );
+    util::ParallelVolumeImporter importer;
+    for ( size_t i = 0; i < data.size(); i++ )
+    {
+        importer.append( data[i], vindex, tindex, zflip, grid_type );
+    }
 
+    // All the volumes are NULL if any of the datasets cannot be imported.
+    std::vector<Object*> volumes( data.size(), NULL );
+    const bool success = importer.import();
+    for ( size_t i = 0; i < data.size(); i++ )
+    {
+        if ( success ) { volumes[i] = importer.volume(i); }
+        else { delete importer.volume(i); }
+    }
+
+    return volumes;
+}
+
+kvs::StructuredVolumeObject* Combine(
+    kvs::StructuredVolumeObject* uvolume,
+    kvs::StructuredVolumeObject* vvolume,
+    kvs::StructuredVolumeObject* wvolume,
+    const bool wadjust = true )
+{
     if ( wadjust )
     {
         wvolume->setCoords( uvolume->coords() );
@@ -149,4 +188,24 @@ kvs::StructuredVolumeObject* Import(
     return object;
 }
 
+kvs::StructuredVolumeObject* Import(
+    const kvs::GrADS* udata,
+    const kvs::GrADS* vdata,
+    const kvs::GrADS* wdata,
+    const size_t tindex,
+    const size_t vindex,
+    const bool zflip = true,
+    const bool wadjust = true )
+{
+    std::vector<const kvs::GrADS*> data;
+    data.push_back( udata );
+    data.push_back( vdata );
+    data.push_back( wdata );
+
+    const std::vector<kvs::StructuredVolumeObject*> volumes = Import( data, tindex, vindex, zflip );
+    if ( !volumes[0] ) return NULL;
+
+    return Combine( volumes[0], volumes[1], volumes[2], wadjust );
+}
+
 } // end of namespace ISFV2014
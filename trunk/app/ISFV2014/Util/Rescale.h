@@ -3,6 +3,9 @@
 #include <kvs/Assert>
 #include <kvs/Vector3>
 #include <kvs/StructuredVolumeObject>
+#include <util/VolumeView.h>
+
+using namespace kvsoceanvis;
 
 
 namespace ISFV2014
@@ -93,6 +96,21 @@ void Values( kvs::StructuredVolumeObject* volume, kvs::Vec3 scale, bool update_b
     }
 };
 
+util::VolumeView Coords( const util::VolumeView& view, kvs::Vec3 scale )
+{
+    KVS_ASSERT( view.gridType() == kvs::StructuredVolumeObject::Rectilinear );
+    return view.rescaleCoords( scale );
+};
+
+util::VolumeView Values( const util::VolumeView& view, kvs::Vec3 scale, bool update_by_horizontal = false )
+{
+    KVS_ASSERT( view.veclen() == 3 );
+
+    util::VolumeView scaled = view.scaleValues( scale );
+    scaled.updateMinMaxValues( update_by_horizontal );
+    return scaled;
+};
+
 } // end of namespace Rescale
 
 } // end of namespace ISFV2014
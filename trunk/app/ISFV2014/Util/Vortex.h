@@ -20,4 +20,15 @@ kvs::PointObject* Vortex(
     return point;
 }
 
+kvs::PointObject* Vortex(
+    const util::VolumeView& view,
+    const float ignore_value )
+{
+    kvs::UnstructuredVolumeObject* tensor = new util::VortexPointVolume( view, ignore_value );
+    kvs::PointObject* point = new util::VortexPoint( tensor );
+    delete tensor;
+
+    return point;
+}
+
 } // end of namespace ISFV2014
@@ -1,6 +1,7 @@
 #include <kvs/glut/Application>
 #include <kvs/glut/Screen>
 #include <kvs/GrADS>
+#include <kvs/Message>
 #include <kvs/Bounds>
 #include <kvs/ArrowGlyph>
 #include <kvs/SphereGlyph>
@@ -32,6 +33,14 @@ int main( int argc, char** argv )
     std::cout << kvs::Indent(4) << wdata->data(tindex).filename() << std::endl;
 
     kvs::StructuredVolumeObject* volume = ISFV2014::Import( udata, vdata, wdata, tindex, vindex );
+    if ( !volume )
+    {
+        kvsMessageError("Cannot import the datasets.");
+        delete udata;
+        delete vdata;
+        delete wdata;
+        return 1;
+    }
     volume->print( std::cout << std::endl << "IMPORTED VOLUME" << std::endl, kvs::Indent(4) );
 
     delete udata;
@@ -41,17 +50,17 @@ int main( int argc, char** argv )
     //const kvs::Vec3 min_range( 141, 35, -1000 ); // in (deg, deg, meter)
     const kvs::Vec3 min_range( 141, 33, -1000 ); // in (deg, deg, meter)
     const kvs::Vec3 max_range( 147, 43, 0 ); // in (deg, deg, meter)
-    kvs::StructuredVolumeObject* cropped_volume = ISFV2014::Crop( volume, min_range, max_range );
+    // The cropped and rescaled volume is given as the view of the imported
+    // volume, so the vortex points are extracted without copying the values.
+    util::VolumeView cropped_view = ISFV2014::Crop( util::VolumeView( volume ), min_range, max_range );
+    delete volume;
 
     const kvs::Vec3 coord_scale( 1, 1, 200 );
     const kvs::Vec3 value_scale( 1, 1, 200 );
-    ISFV2014::Rescale::Coords( cropped_volume, coord_scale );
-    ISFV2014::Rescale::Values( cropped_volume, value_scale, true );
-
-    cropped_volume->print( std::cout << std::endl << "CROPPED VOLUME" << std::endl, kvs::Indent(4) );
-    delete volume;
+    cropped_view = ISFV2014::Rescale::Coords( cropped_view, coord_scale );
+    cropped_view = ISFV2014::Rescale::Values( cropped_view, value_scale, true );
 
-    kvs::PointObject* vortex_points = ISFV2014::Vortex( cropped_volume, ignore_value );
+    kvs::PointObject* vortex_points = ISFV2014::Vortex( cropped_view, ignore_value );
     vortex_points->setColor( kvs::RGBColor( 128, 128, 128 ) );
     vortex_points->print( std::cout << std::endl << "VORTEX POINTS" << std::endl, kvs::Indent(4) );
 
@@ -61,9 +70,8 @@ int main( int argc, char** argv )
     sphere->setScale( 40 );
 
     const kvs::Vec3ui stride( 3, 3, 3 );
-    kvs::StructuredVolumeObject* downsized_volume = ISFV2014::Downsize( cropped_volume, stride );
+    kvs::StructuredVolumeObject* downsized_volume = ISFV2014::Downsize( cropped_view, stride );
     downsized_volume->print( std::cout << std::endl << "DOWNSIZED VOLUME" << std::endl, kvs::Indent(4) );
-    delete cropped_volume;
 
     ISFV2014::ArrowGlyph* arrow = new ISFV2014::ArrowGlyph();
     const kvs::TransferFunction transfer_function( kvs::RGBFormulae::Jet( 256 ) );
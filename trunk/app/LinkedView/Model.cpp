@@ -22,6 +22,7 @@
 #include <kvs/Version>
 #include <kvs/File>
 #include <kvs/Vector3>
+#include <kvs/Math>
 #include <kvs/TableImporter>
 #include <kvs/ParallelCoordinatesRenderer>
 #include <kvs/ExternalFaces>
@@ -33,12 +34,16 @@
 #include <kvs/glut/ParallelAxis>
 #include <util/CsvReader.h>
 #include <util/CropVolume.h>
-#include <util/StructuredVolumeImporter.h>
+#include <util/VolumeView.h>
+#include <util/MaskedStatistics.h>
 
 using namespace kvsoceanvis;
 
 
 Model::Model():
+    m_cache( &m_data_base ),
+    m_tindex( size_t(-1) ),
+    m_backward( false ),
     m_volume_object( 0 ),
     m_table_object( 0 )
 {
@@ -46,6 +51,10 @@ Model::Model():
 
 void Model::read( const std::string& filename )
 {
+    // The cached volumes are deleted before the data base is modified.
+    m_cache.clear();
+    m_tindex = size_t(-1);
+
     DataBase::Data data( filename );
     m_data_base.insert( data );
 }
@@ -72,8 +81,19 @@ bool Model::importVolumeObject( const std::string& varname, const size_t tindex
         {
             const size_t vindex = static_cast<size_t>( index );
             const bool zflip = true;
-            const kvs::StructuredVolumeObject::GridType grid_type = kvs::StructuredVolumeObject::Uniform;
-            m_volume_object = new util::StructuredVolumeImporter( &data, vindex, tindex, zflip, grid_type );
+            VolumeObject* volume = m_cache.fetch( TimeStepCache::Key( i, vindex, tindex, zflip ) );
+            if ( !volume ) return false;
+            m_volume_object = volume;
+
+            // The neighboring time steps are imported in the background.
+            this->update_time_index( tindex );
+            const std::vector<size_t> tindices = this->prefetched_time_indices( data.dataList().size() );
+            std::vector<TimeStepCache::Key> keys;
+            for ( size_t j = 0; j < tindices.size(); j++ )
+            {
+                keys.push_back( TimeStepCache::Key( i, vindex, tindices[j], zflip ) );
+            }
+            m_cache.prefetch( keys, tindex );
             return true;
         }
     }
@@ -85,15 +105,14 @@ bool Model::importTableObject( const size_t tindex )
 {
     if ( m_data_base.size() == 0 ) return false;
 
-    const size_t dimx = m_data_base.data(0).dataDescriptor().xdef().num;
-    const size_t dimy = m_data_base.data(0).dataDescriptor().ydef().num;
-    const size_t dimz = m_data_base.data(0).dataDescriptor().zdef().num;
-    const kvs::Vector3ui dim( dimx, dimy, dimz );
-
-    kvs::ValueTable<kvs::Real32> table;
+    // The variables in the datasets are imported concurrently unless they
+    // are cached.
+    // NOTE: The min/max values of the imported volumes are calculated in
+    // disregard for the undefined value and the values not greater than -999,
+    // which is a condition for the 'w' column.
+    std::vector<TimeStepCache::Key> keys;
     TableObject::Labels labels;
-    std::vector<kvs::Real32> min_values;
-    std::vector<kvs::Real32> max_values;
+    size_t ntimes = 0;
     for ( size_t i = 0; i < m_data_base.size(); i++ )
     {
         typedef std::list<kvs::grads::Vars::Var> VarList;
@@ -101,40 +120,48 @@ bool Model::importTableObject( const size_t tindex )
         VarList::const_iterator var = data.dataDescriptor().vars().values.begin();
         VarList::const_iterator end = data.dataDescriptor().vars().values.end();
         size_t vindex = 0;
-        const kvs::Real32 ignore_value = data.dataDescriptor().undef().value;
         while ( var != end )
         {
-            data.data( tindex ).load();
-            kvs::ValueArray<kvs::Real32> column = data.data( tindex ).values( vindex, dim );
-            data.data( tindex ).free();
-
-            kvs::Real32 min_value = kvs::Value<kvs::Real32>::Max();
-            kvs::Real32 max_value = kvs::Value<kvs::Real32>::Min();
-            for ( size_t j = 0; j < column.size(); j++ )
-            {
-                // NOTE: "column[j] > -999" is a condition for the 'w' column.
-                // "!kvs::Math::Equal( column[j], ignore_value )" is valid condition,
-                // but this condition dosen't work well for the w column. I don't
-                // why it is like that.
-                //
-                // if ( !kvs::Math::Equal( column[j], ignore_value ) )
-                if ( !kvs::Math::Equal( column[j], ignore_value ) && column[j] > -999 )
-                {
-                    min_value = kvs::Math::Min( column[j], min_value );
-                    max_value = kvs::Math::Max( column[j], max_value );
-                }
-            }
-
-            table.pushBackColumn( column );
+            const bool zflip = false;
+            keys.push_back( TimeStepCache::Key( i, vindex, tindex, zflip ) );
             labels.push_back( var->varname );
-            min_values.push_back( min_value );
-            max_values.push_back( max_value );
 
             var++;
             vindex++;
         }
+        ntimes = i == 0 ? data.dataList().size() : kvs::Math::Min( ntimes, data.dataList().size() );
     }
 
+    std::vector<VolumeObject*> volumes;
+    if ( !m_cache.fetch( keys, &volumes ) ) return false;
+
+    kvs::ValueTable<kvs::Real32> table;
+    std::vector<kvs::Real32> min_values;
+    std::vector<kvs::Real32> max_values;
+    for ( size_t i = 0; i < volumes.size(); i++ )
+    {
+        VolumeObject* volume = volumes[i];
+        table.pushBackColumn( volume->values().asValueArray<kvs::Real32>() );
+        min_values.push_back( static_cast<kvs::Real32>( volume->minValue() ) );
+        max_values.push_back( static_cast<kvs::Real32>( volume->maxValue() ) );
+        delete volume;
+    }
+
+    // The variables of the neighboring time steps are imported in the background.
+    this->update_time_index( tindex );
+    const std::vector<size_t> tindices = this->prefetched_time_indices( ntimes );
+    std::vector<TimeStepCache::Key> prefetched_keys;
+    for ( size_t j = 0; j < tindices.size(); j++ )
+    {
+        for ( size_t i = 0; i < keys.size(); i++ )
+        {
+            TimeStepCache::Key key = keys[i];
+            key.tindex = tindices[j];
+            prefetched_keys.push_back( key );
+        }
+    }
+    m_cache.prefetch( prefetched_keys, tindex );
+
     if ( table.columnSize() > 0 )
     {
         m_table_object = new TableObject();
@@ -173,22 +200,17 @@ Model::TableObject* Model::croppedTableObject( const kvs::Vec3 min_range, const
         volume->shallowCopy( *m_volume_object );
         volume->setValues( m_table_object->column(i) );
 
-        VolumeObject* cropped_volume = new util::CropVolume( volume, min_range, max_range );
-        table->addColumn( cropped_volume->values(), m_table_object->label(i) );
-
+        // The values in the range are copied and the min/max values are
+        // calculated in one pass.
         const DataBase::Data& data = m_data_base.data(i);
         const kvs::Real32 ignore_value = data.dataDescriptor().undef().value;
-        kvs::Real32 min_value = kvs::Value<kvs::Real32>::Max();
-        kvs::Real32 max_value = kvs::Value<kvs::Real32>::Min();
-        const kvs::ValueArray<kvs::Real32> values = cropped_volume->values().asValueArray<kvs::Real32>();
-        for ( size_t j = 0; j < values.size(); j++ )
-        {
-            if ( !kvs::Math::Equal( values[j], ignore_value ) && values[j] > -999 )
-            {
-                min_value = kvs::Math::Min( values[j], min_value );
-                max_value = kvs::Math::Max( values[j], max_value );
-            }
-        }
+        util::MaskedStatistics statistics( ignore_value, -999.0f );
+        VolumeObject* cropped_volume = new VolumeObject();
+        util::VolumeView( volume ).crop( min_range, max_range ).copyTo( cropped_volume, &statistics );
+        table->addColumn( cropped_volume->values(), m_table_object->label(i) );
+
+        const kvs::Real32 min_value = statistics.minValue();
+        const kvs::Real32 max_value = statistics.maxValue();
 
         table->setMinRange( i, min_value );
         table->setMaxRange( i, max_value );
@@ -201,3 +223,41 @@ Model::TableObject* Model::croppedTableObject( const kvs::Vec3 min_range, const
 
     return table;
 }
+
+/*===========================================================================*/
+/**
+ *  @brief  Updates the time index being viewed and the moving direction.
+ *  @param  tindex [in] time index
+ */
+/*===========================================================================*/
+void Model::update_time_index( const size_t tindex )
+{
+    if ( m_tindex != size_t(-1) && tindex != m_tindex ) m_backward = tindex < m_tindex;
+    m_tindex = tindex;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the time indices to be prefetched.
+ *  @param  ntimes [in] number of time steps
+ *  @return time indices next to the viewed one (in the moving direction first)
+ */
+/*===========================================================================*/
+std::vector<size_t> Model::prefetched_time_indices( const size_t ntimes ) const
+{
+    std::vector<size_t> tindices;
+    const bool has_next = m_tindex + 1 < ntimes;
+    const bool has_prev = m_tindex > 0 && m_tindex < ntimes;
+    if ( m_backward )
+    {
+        if ( has_prev ) tindices.push_back( m_tindex - 1 );
+        if ( has_next ) tindices.push_back( m_tindex + 1 );
+    }
+    else
+    {
+        if ( has_next ) tindices.push_back( m_tindex + 1 );
+        if ( has_prev ) tindices.push_back( m_tindex - 1 );
+    }
+
+    return tindices;
+}
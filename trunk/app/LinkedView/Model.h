@@ -16,9 +16,11 @@
 #define MODEL_H_INCLUDE
 
 #include <string>
+#include <vector>
 #include <kvs/StructuredVolumeObject>
 #include <kvs/TableObject>
 #include "DataBase.h"
+#include "TimeStepCache.h"
 
 namespace kvs { class GrADS; }
 namespace kvs { class ColorMap; }
@@ -39,6 +41,9 @@ public:
 private:
 
     DataBase m_data_base; ///< data base in which GrADS datasets are stored
+    TimeStepCache m_cache; ///< cache of the volumes imported from the data base
+    size_t m_tindex; ///< time index being viewed
+    bool m_backward; ///< true if the time steps are moved backward
     VolumeObject* m_volume_object; ///< pointer to the rendered volume object
     TableObject* m_table_object; ///< pointer to the rendered table object
 
@@ -47,6 +52,7 @@ public:
     Model();
 
     DataBase& dataBase() { return m_data_base; }
+    TimeStepCache& cache() { return m_cache; }
     void read( const std::string& filename );
 
     VolumeObject* volumeObject();
@@ -55,6 +61,11 @@ public:
     bool importTableObject( const size_t tindex );
     VolumeObject* croppedVolumeObject( const kvs::Vec3 min_range, const kvs::Vec3 max_range );
     TableObject* croppedTableObject( const kvs::Vec3 min_range, const kvs::Vec3 max_range );
+
+private:
+
+    void update_time_index( const size_t tindex );
+    std::vector<size_t> prefetched_time_indices( const size_t ntimes ) const;
 };
 
 #endif // MODEL_H_INCLUDE
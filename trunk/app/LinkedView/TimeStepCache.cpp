@@ -0,0 +1,362 @@
+/*****************************************************************************/
+/**
+ *  @file   TimeStepCache.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "TimeStepCache.h"
+#include <algorithm>
+#include <QMutexLocker>
+#include <util/ParallelVolumeImporter.h>
+
+using namespace kvsoceanvis;
+
+
+namespace
+{
+
+const size_t DefaultMemoryBudget = size_t( 1024 ) * 1024 * 1024; // 1 GB
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the number of bytes of the volume.
+ *  @param  volume [in] pointer to the volume object
+ *  @return number of bytes
+ */
+/*===========================================================================*/
+size_t VolumeBytes( const kvs::StructuredVolumeObject* volume )
+{
+    return volume->values().byteSize() + volume->coords().byteSize();
+}
+
+} // end of namespace
+
+
+bool TimeStepCache::Key::operator < ( const Key& rhs ) const
+{
+    if ( dindex != rhs.dindex ) return dindex < rhs.dindex;
+    if ( vindex != rhs.vindex ) return vindex < rhs.vindex;
+    if ( tindex != rhs.tindex ) return tindex < rhs.tindex;
+    return zflip < rhs.zflip;
+}
+
+bool TimeStepCache::Key::operator == ( const Key& rhs ) const
+{
+    return dindex == rhs.dindex && vindex == rhs.vindex && tindex == rhs.tindex && zflip == rhs.zflip;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new TimeStepCache class.
+ *  @param  data_base [in] pointer to the data base
+ */
+/*===========================================================================*/
+TimeStepCache::TimeStepCache( DataBase* data_base ):
+    m_data_base( data_base ),
+    m_memory_budget( ::DefaultMemoryBudget ),
+    m_memory_usage( 0 ),
+    m_prefetch_tindex( size_t(-1) ),
+    m_generation( 0 ),
+    m_stop( false ),
+    m_prefetcher( this )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Destroys the TimeStepCache class.
+ */
+/*===========================================================================*/
+TimeStepCache::~TimeStepCache()
+{
+    {
+        QMutexLocker locker( &m_mutex );
+        m_stop = true;
+        m_queue.clear();
+        m_condition.wakeAll();
+    }
+    m_prefetcher.wait();
+
+    this->clear();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a memory budget for the cached volumes.
+ *  @param  memory_budget [in] memory budget in bytes (0: unlimited)
+ */
+/*===========================================================================*/
+void TimeStepCache::setMemoryBudget( const size_t memory_budget )
+{
+    QMutexLocker locker( &m_mutex );
+    m_memory_budget = memory_budget;
+    this->evict();
+}
+
+size_t TimeStepCache::memoryBudget() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_memory_budget;
+}
+
+size_t TimeStepCache::memoryUsage() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_memory_usage;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Deletes the cached volumes and the keys to be prefetched.
+ *
+ *  This method waits for the volumes being prefetched, so that the datasets
+ *  in the data base can be modified after calling it.
+ */
+/*===========================================================================*/
+void TimeStepCache::clear()
+{
+    QMutexLocker load_locker( &m_load_mutex );
+    QMutexLocker locker( &m_mutex );
+
+    std::map<Key,Entry>::iterator entry = m_entries.begin();
+    while ( entry != m_entries.end() )
+    {
+        delete entry->second.volume;
+        entry++;
+    }
+
+    m_entries.clear();
+    m_lru.clear();
+    m_queue.clear();
+    m_memory_usage = 0;
+    m_prefetch_tindex = size_t(-1);
+    m_generation++;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the volumes, which are imported if they are not cached.
+ *  @param  keys [in] keys of the volumes
+ *  @param  volumes [out] shallow copies of the volumes (owned by the caller)
+ *  @return true if all the volumes are returned
+ */
+/*===========================================================================*/
+bool TimeStepCache::fetch( const std::vector<Key>& keys, std::vector<VolumeObject*>* volumes )
+{
+    // The cached volumes are returned without waiting for the prefetcher.
+    {
+        QMutexLocker locker( &m_mutex );
+        if ( this->find_volumes( keys, volumes ) ) return true;
+    }
+
+    // The missing volumes are imported after the volumes being prefetched,
+    // which can be the requested ones.
+    QMutexLocker load_locker( &m_load_mutex );
+    if ( !this->import( keys ) ) return false;
+
+    QMutexLocker locker( &m_mutex );
+    return this->find_volumes( keys, volumes );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the volume, which is imported if it is not cached.
+ *  @param  key [in] key of the volume
+ *  @return shallow copy of the volume (owned by the caller, NULL if failed)
+ */
+/*===========================================================================*/
+TimeStepCache::VolumeObject* TimeStepCache::fetch( const Key& key )
+{
+    std::vector<VolumeObject*> volumes;
+    if ( !this->fetch( std::vector<Key>( 1, key ), &volumes ) ) return NULL;
+    return volumes.front();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Requests the volumes to be imported in the background.
+ *
+ *  The keys requested around another time index are discarded from the
+ *  queue, and the keys are prefetched in the requested order.
+ *
+ *  @param  keys [in] keys of the volumes
+ *  @param  tindex [in] time index being viewed
+ */
+/*===========================================================================*/
+void TimeStepCache::prefetch( const std::vector<Key>& keys, const size_t tindex )
+{
+    QMutexLocker locker( &m_mutex );
+    if ( m_stop ) return;
+
+    if ( tindex != m_prefetch_tindex )
+    {
+        m_queue.clear();
+        m_prefetch_tindex = tindex;
+    }
+
+    for ( size_t i = 0; i < keys.size(); i++ )
+    {
+        const Key& key = keys[i];
+        if ( m_entries.find( key ) != m_entries.end() ) continue;
+        if ( std::find( m_queue.begin(), m_queue.end(), key ) != m_queue.end() ) continue;
+        m_queue.push_back( key );
+    }
+
+    if ( !m_prefetcher.isRunning() ) m_prefetcher.start( QThread::LowPriority );
+    m_condition.wakeOne();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Imports the volumes that are not cached.
+ *  @param  keys [in] keys of the volumes
+ *  @return true if the volumes are imported successfully
+ */
+/*===========================================================================*/
+bool TimeStepCache::import( const std::vector<Key>& keys )
+{
+    // NOTE: The caller should lock m_load_mutex, since the data file of the
+    // time step is loaded into and freed from the GrADS object by the importer.
+    std::vector<Key> misses;
+    size_t memory_budget = 0;
+    {
+        QMutexLocker locker( &m_mutex );
+        memory_budget = m_memory_budget;
+        for ( size_t i = 0; i < keys.size(); i++ )
+        {
+            const Key& key = keys[i];
+            if ( m_entries.find( key ) != m_entries.end() ) continue;
+            if ( std::find( misses.begin(), misses.end(), key ) != misses.end() ) continue;
+            if ( key.dindex >= m_data_base->size() ) return false;
+            misses.push_back( key );
+        }
+    }
+    if ( misses.empty() ) return true;
+
+    // The data files loaded concurrently are bounded by the cache budget.
+    util::ParallelVolumeImporter importer;
+    if ( memory_budget > 0 ) importer.setMemoryBudget( memory_budget );
+    for ( size_t i = 0; i < misses.size(); i++ )
+    {
+        const Key& key = misses[i];
+        importer.append( &m_data_base->data( key.dindex ), key.vindex, key.tindex, key.zflip );
+    }
+    if ( !importer.import() )
+    {
+        for ( size_t i = 0; i < misses.size(); i++ ) { delete importer.volume(i); }
+        return false;
+    }
+
+    QMutexLocker locker( &m_mutex );
+    for ( size_t i = 0; i < misses.size(); i++ )
+    {
+        Entry entry;
+        entry.volume = importer.volume(i);
+        entry.bytes = ::VolumeBytes( entry.volume );
+        entry.position = m_lru.insert( m_lru.begin(), misses[i] );
+        m_entries.insert( std::make_pair( misses[i], entry ) );
+        m_memory_usage += entry.bytes;
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the cached volumes.
+ *  @param  keys [in] keys of the volumes
+ *  @param  volumes [out] shallow copies of the volumes (owned by the caller)
+ *  @return true if all the volumes are cached
+ */
+/*===========================================================================*/
+bool TimeStepCache::find_volumes( const std::vector<Key>& keys, std::vector<VolumeObject*>* volumes )
+{
+    // NOTE: The caller should lock m_mutex.
+    for ( size_t i = 0; i < keys.size(); i++ )
+    {
+        if ( m_entries.find( keys[i] ) == m_entries.end() ) return false;
+    }
+
+    for ( size_t i = 0; i < keys.size(); i++ )
+    {
+        Entry& entry = m_entries.find( keys[i] )->second;
+        m_lru.splice( m_lru.begin(), m_lru, entry.position );
+
+        VolumeObject* volume = new VolumeObject();
+        volume->shallowCopy( *entry.volume );
+        volumes->push_back( volume );
+    }
+
+    // The returned volumes share the value arrays with the evicted volumes.
+    this->evict();
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Deletes the least recently used volumes exceeding the budget.
+ */
+/*===========================================================================*/
+void TimeStepCache::evict()
+{
+    // NOTE: The caller should lock m_mutex.
+    while ( m_memory_budget > 0 && m_memory_usage > m_memory_budget && !m_lru.empty() )
+    {
+        std::map<Key,Entry>::iterator entry = m_entries.find( m_lru.back() );
+        m_memory_usage -= entry->second.bytes;
+        delete entry->second.volume;
+        m_entries.erase( entry );
+        m_lru.pop_back();
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Imports the requested volumes in the background thread.
+ */
+/*===========================================================================*/
+void TimeStepCache::prefetch_loop()
+{
+    for ( ; ; )
+    {
+        // The keys of the same time step are imported concurrently.
+        std::vector<Key> keys;
+        size_t generation = 0;
+        {
+            QMutexLocker locker( &m_mutex );
+            while ( !m_stop && m_queue.empty() ) m_condition.wait( &m_mutex );
+            if ( m_stop ) return;
+
+            const size_t tindex = m_queue.front().tindex;
+            std::list<Key>::iterator key = m_queue.begin();
+            while ( key != m_queue.end() )
+            {
+                if ( key->tindex == tindex ) { keys.push_back( *key ); key = m_queue.erase( key ); }
+                else key++;
+            }
+            generation = m_generation;
+        }
+
+        QMutexLocker load_locker( &m_load_mutex );
+        {
+            // The keys requested before clear() are discarded, since the data
+            // base can have been modified.
+            QMutexLocker locker( &m_mutex );
+            if ( m_stop ) return;
+            if ( generation != m_generation ) continue;
+        }
+        this->import( keys );
+
+        QMutexLocker locker( &m_mutex );
+        this->evict();
+    }
+}
@@ -0,0 +1,113 @@
+/*****************************************************************************/
+/**
+ *  @file   TimeStepCache.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef TIME_STEP_CACHE_H_INCLUDE
+#define TIME_STEP_CACHE_H_INCLUDE
+
+#include <list>
+#include <map>
+#include <vector>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <kvs/StructuredVolumeObject>
+#include "DataBase.h"
+
+
+/*===========================================================================*/
+/**
+ *  @brief  Cache of the volumes imported from the GrADS datasets.
+ *
+ *  The imported volumes are retained in LRU order within the memory budget,
+ *  and the volumes of the neighboring time steps can be imported in advance
+ *  by the background thread (prefetcher) while the current time step is
+ *  viewed. The volumes are returned as shallow copies of the cached volumes,
+ *  which are owned by the caller.
+ */
+/*===========================================================================*/
+class TimeStepCache
+{
+public:
+
+    typedef kvs::StructuredVolumeObject VolumeObject;
+
+    struct Key
+    {
+        size_t dindex; ///< index of the dataset in the data base
+        size_t vindex; ///< value (variable) index
+        size_t tindex; ///< time index
+        bool zflip; ///< flip data along the z-axis if true
+
+        Key( const size_t d = 0, const size_t v = 0, const size_t t = 0, const bool z = false ):
+            dindex( d ), vindex( v ), tindex( t ), zflip( z ) {}
+
+        bool operator < ( const Key& rhs ) const;
+        bool operator == ( const Key& rhs ) const;
+    };
+
+private:
+
+    struct Entry
+    {
+        VolumeObject* volume; ///< cached volume
+        size_t bytes; ///< memory usage of the volume in bytes
+        std::list<Key>::iterator position; ///< position in the LRU list
+    };
+
+    class Prefetcher : public QThread
+    {
+        TimeStepCache* m_cache; ///< pointer to the cache
+    public:
+        Prefetcher( TimeStepCache* cache ): m_cache( cache ) {}
+    protected:
+        void run() { m_cache->prefetch_loop(); }
+    };
+
+    DataBase* m_data_base; ///< pointer to the data base
+    std::map<Key,Entry> m_entries; ///< cached volumes
+    std::list<Key> m_lru; ///< keys in LRU order (most recently used at front)
+    size_t m_memory_budget; ///< memory budget in bytes (0: unlimited)
+    size_t m_memory_usage; ///< memory usage in bytes
+    std::list<Key> m_queue; ///< keys to be prefetched
+    size_t m_prefetch_tindex; ///< time index around which the keys are prefetched
+    size_t m_generation; ///< number of times the cache has been cleared
+    bool m_stop; ///< true if the prefetcher is stopped
+    mutable QMutex m_mutex; ///< mutex for the entries and the queue
+    QMutex m_load_mutex; ///< mutex for importing from the datasets
+    QWaitCondition m_condition; ///< condition for waking up the prefetcher
+    Prefetcher m_prefetcher; ///< background prefetcher
+
+public:
+
+    TimeStepCache( DataBase* data_base );
+    ~TimeStepCache();
+
+    void setMemoryBudget( const size_t memory_budget );
+    size_t memoryBudget() const;
+    size_t memoryUsage() const;
+
+    void clear();
+    bool fetch( const std::vector<Key>& keys, std::vector<VolumeObject*>* volumes );
+    VolumeObject* fetch( const Key& key );
+    void prefetch( const std::vector<Key>& keys, const size_t tindex );
+
+private:
+
+    bool import( const std::vector<Key>& keys );
+    bool find_volumes( const std::vector<Key>& keys, std::vector<VolumeObject*>* volumes );
+    void evict();
+    void prefetch_loop();
+};
+
+#endif // TIME_STEP_CACHE_H_INCLUDE
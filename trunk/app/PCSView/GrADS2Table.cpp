@@ -20,6 +20,7 @@
 #include <kvs/Value>
 #include <kvs/CommandLine>
 #include <kvs/ValueArray>
+#include <util/MaskedStatistics.h>
 
 
 namespace
@@ -51,22 +52,19 @@ kvs::ValueArray<float> GetValues(
     float* pvalues = values.pointer();
 
     const float ignore_value = grads.dataDescriptor().undef().value;
+    kvsoceanvis::util::MaskedStatistics statistics( ignore_value );
+    statistics.disableLowerBound();
     grads.dataList().at(tindex).load();
     {
+        // Copy the values and calculate the min/max values in one pass.
         const float* src = grads.dataList().at(tindex).values().pointer() + size * vindex;
-        for ( size_t i = 0; i < size; i++ )
-        {
-            pvalues[i] = src[i];
-
-            if ( !kvs::Math::Equal( src[i], ignore_value ) )
-            {
-                *min_value = kvs::Math::Min( src[i], *min_value );
-                *max_value = kvs::Math::Max( src[i], *max_value );
-            }
-        }
+        statistics.copy( src, size, pvalues );
     }
     grads.dataList().at(tindex).free();
 
+    *min_value = kvs::Math::Min( statistics.minValue(), *min_value );
+    *max_value = kvs::Math::Max( statistics.maxValue(), *max_value );
+
     return( values );
 }
 
@@ -14,7 +14,9 @@
 /*****************************************************************************/
 #include "AdaptiveKMeansClustering.h"
 #include "FastKMeansClustering.h"
-#include <kvs/Matrix>
+#include "ClusteringUtility.h"
+#include <vector>
+#include <algorithm>
 #include <cmath>
 
 
@@ -23,50 +25,200 @@ namespace
 
 /*===========================================================================*/
 /**
- *  @brief  Returns Mahalanobis distance.
- *  @param  x [in] multivariant vector
- *  @param  u [in] mean values
- *  @return Mahalanobis distance
+ *  @brief  Decomposes the symmetric positive definite matrix with Cholesky decomposition.
+ *  @param  A [in/out] n x n matrix in row-major order (replaced by the lower triangular L)
+ *  @param  n [in] matrix size
+ *  @return true if the matrix is positive definite
  */
 /*===========================================================================*/
-kvs::Real32 GetMahalanobisDistance(
-    const kvs::ValueArray<kvs::Real32>& x,
-    const kvs::ValueArray<kvs::Real32>& u )
+bool CholeskyDecomposition( std::vector<kvs::Real64>& A, const size_t n )
 {
-    const size_t dim = x.size();
-    kvs::Matrix<kvs::Real32> d( dim, 1 );
-    kvs::Matrix<kvs::Real32> dt( 1, dim );
-    for ( size_t i = 0; i < dim; i++ ) { d[i][0] = dt[0][i] = x[i] - u[i]; }
+    for ( size_t j = 0; j < n; j++ )
+    {
+        kvs::Real64 d = A[ j * n + j ];
+        for ( size_t k = 0; k < j; k++ ) { d -= A[ j * n + k ] * A[ j * n + k ]; }
+        if ( !( d > 0.0 ) ) return false;
 
-    // Covariance matrix (identity matrix)
-    kvs::Matrix<kvs::Real32> S( dim, dim );
-    S.identity();
+        const kvs::Real64 ljj = std::sqrt( d );
+        A[ j * n + j ] = ljj;
+        for ( size_t i = j + 1; i < n; i++ )
+        {
+            kvs::Real64 v = A[ i * n + j ];
+            for ( size_t k = 0; k < j; k++ ) { v -= A[ i * n + k ] * A[ j * n + k ]; }
+            A[ i * n + j ] = v / ljj;
+        }
 
-    // In this function, the Mahalanobis distance reduces to the Euclidean
-    // distance since the covariance matrix is the identity matrix.
-    return ( dt * S * d )[0][0];
+        for ( size_t i = 0; i < j; i++ ) { A[ i * n + j ] = 0.0; }
+    }
+
+    return true;
 }
 
 /*===========================================================================*/
 /**
- *  @brief  Returns row array.
- *  @param  table [in] table object
- *  @param  row_index [in] index of the row
- *  @return row array
+ *  @brief  Transforms the points with the inverse of the lower triangular matrix.
+ *  @param  L [in] n x n lower triangular matrix in row-major order
+ *  @param  n [in] number of dimensions
+ *  @param  npoints [in] number of points
+ *  @param  x [in/out] points packed in row-major order
+ *
+ *  Since the Mahalanobis distance with the covariance matrix S = L L^T is
+ *  given by (x-u)^T S^-1 (x-u) = |L^-1 x - L^-1 u|^2, the distances can be
+ *  calculated as the Euclidean distances after this transformation.
  */
 /*===========================================================================*/
-kvs::ValueArray<kvs::Real32> GetRowArray(
-    const kvs::TableObject* table,
-    const size_t row_index )
+void Whiten(
+    const std::vector<kvs::Real64>& L,
+    const size_t n,
+    const size_t npoints,
+    kvs::Real32* x )
 {
-    const size_t ncolumns = table->numberOfColumns();
-    kvs::ValueArray<kvs::Real32> row( ncolumns );
-    for ( size_t i = 0; i < ncolumns; i++ )
+    const kvs::Int64 m = static_cast<kvs::Int64>( npoints );
+    #pragma omp parallel
+    {
+        std::vector<kvs::Real64> y( n );
+
+        #pragma omp for schedule(static)
+        for ( kvs::Int64 i = 0; i < m; i++ )
+        {
+            kvs::Real32* xi = x + i * n;
+            for ( size_t j = 0; j < n; j++ )
+            {
+                kvs::Real64 v = xi[j];
+                for ( size_t k = 0; k < j; k++ ) { v -= L[ j * n + k ] * y[k]; }
+                y[j] = v / L[ j * n + j ];
+            }
+            for ( size_t j = 0; j < n; j++ ) { xi[j] = static_cast<kvs::Real32>( y[j] ); }
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the lower triangular factor of the covariance matrix.
+ *  @param  x [in] points packed in row-major order
+ *  @param  w [in] weights of the points
+ *  @param  npoints [in] number of points
+ *  @param  n [in] number of dimensions
+ *  @param  L [out] n x n lower triangular matrix in row-major order
+ *  @return true if the covariance matrix is positive definite
+ */
+/*===========================================================================*/
+bool CalculateCovarianceFactor(
+    const kvs::Real32* x,
+    const kvs::Real32* w,
+    const size_t npoints,
+    const size_t n,
+    std::vector<kvs::Real64>& L )
+{
+    kvs::Real64 W = 0.0;
+    std::vector<kvs::Real64> mean( n, 0.0 );
+    for ( size_t i = 0; i < npoints; i++ )
+    {
+        for ( size_t j = 0; j < n; j++ ) { mean[j] += w[i] * x[ i * n + j ]; }
+        W += w[i];
+    }
+    if ( !( W > 0.0 ) ) return false;
+    for ( size_t j = 0; j < n; j++ ) { mean[j] /= W; }
+
+    L.assign( n * n, 0.0 );
+    const kvs::Int64 m = static_cast<kvs::Int64>( npoints );
+    #pragma omp parallel
+    {
+        std::vector<kvs::Real64> local( n * n, 0.0 );
+        std::vector<kvs::Real64> d( n );
+
+        #pragma omp for schedule(static)
+        for ( kvs::Int64 i = 0; i < m; i++ )
+        {
+            for ( size_t j = 0; j < n; j++ ) { d[j] = x[ i * n + j ] - mean[j]; }
+            for ( size_t j = 0; j < n; j++ )
+            {
+                for ( size_t k = 0; k <= j; k++ ) { local[ j * n + k ] += w[i] * d[j] * d[k]; }
+            }
+        }
+
+        #pragma omp critical
+        {
+            for ( size_t j = 0; j < n * n; j++ ) { L[j] += local[j]; }
+        }
+    }
+
+    for ( size_t j = 0; j < n; j++ )
     {
-        row[i] = table->column(i).at<kvs::Real32>( row_index );
+        for ( size_t k = 0; k <= j; k++ ) { L[ j * n + k ] /= W; L[ k * n + j ] = L[ j * n + k ]; }
     }
 
-    return row;
+    return ::CholeskyDecomposition( L, n );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the distortion of the clustering.
+ *  @param  y [in] (transformed) points packed in row-major order
+ *  @param  w [in] weights of the points
+ *  @param  npoints [in] number of points
+ *  @param  n [in] number of dimensions
+ *  @param  c [in] (transformed) centers packed in row-major order
+ *  @param  k [in] number of centers
+ *  @param  worst [out] index of the point farthest from its center in the cluster with the largest distortion
+ *  @return weighted sum of the distance to the nearest center
+ */
+/*===========================================================================*/
+kvs::Real64 CalculateDistortion(
+    const kvs::Real32* y,
+    const kvs::Real32* w,
+    const size_t npoints,
+    const size_t n,
+    const kvs::Real32* c,
+    const size_t k,
+    size_t* worst )
+{
+    kvs::Real64 distortion = 0.0;
+    std::vector<kvs::Real64> distortions( k, 0.0 ); // distortion of each cluster
+    std::vector<kvs::Real32> farthest_distances( k, -1.0f ); // distance of the farthest point in each cluster
+    std::vector<size_t> farthest_indices( k, 0 ); // index of the farthest point in each cluster
+
+    const kvs::Int64 m = static_cast<kvs::Int64>( npoints );
+    #pragma omp parallel
+    {
+        std::vector<kvs::Real64> local_distortions( k, 0.0 );
+        std::vector<kvs::Real32> local_distances( k, -1.0f );
+        std::vector<size_t> local_indices( k, 0 );
+
+        #pragma omp for schedule(static)
+        for ( kvs::Int64 i = 0; i < m; i++ )
+        {
+            kvs::Real32 d = 0.0f;
+            const size_t id = kvsoceanvis::pcs::ClusteringUtility::NearestCenter( y + i * n, c, k, n, &d );
+            local_distortions[id] += w[i] * d;
+            if ( d > local_distances[id] ) { local_distances[id] = d; local_indices[id] = static_cast<size_t>(i); }
+        }
+
+        #pragma omp critical
+        {
+            for ( size_t j = 0; j < k; j++ )
+            {
+                distortions[j] += local_distortions[j];
+                if ( local_distances[j] > farthest_distances[j] ||
+                     ( local_distances[j] == farthest_distances[j] && local_indices[j] < farthest_indices[j] ) )
+                {
+                    farthest_distances[j] = local_distances[j];
+                    farthest_indices[j] = local_indices[j];
+                }
+            }
+        }
+    }
+
+    size_t worst_cluster = 0;
+    for ( size_t j = 0; j < k; j++ )
+    {
+        distortion += distortions[j];
+        if ( distortions[j] > distortions[ worst_cluster ] ) { worst_cluster = j; }
+    }
+    if ( worst ) *worst = farthest_indices[ worst_cluster ];
+
+    return distortion;
 }
 
 }
@@ -81,7 +233,9 @@ AdaptiveKMeansClustering::AdaptiveKMeansClustering():
     m_nclusters( 0 ),
     m_max_iterations( 100 ),
     m_tolerance( 1.e-6 ),
-    m_max_nclusters( 10 )
+    m_max_nclusters( 10 ),
+    m_enable_weight( false ),
+    m_enable_mahalanobis_distance( false )
 {
 }
 
@@ -89,7 +243,9 @@ AdaptiveKMeansClustering::AdaptiveKMeansClustering( const kvs::ObjectBase* objec
     m_nclusters( 0 ),
     m_max_iterations( 100 ),
     m_tolerance( 1.e-6 ),
-    m_max_nclusters( 10 )
+    m_max_nclusters( 10 ),
+    m_enable_weight( false ),
+    m_enable_mahalanobis_distance( false )
 {
     this->exec( object );
 }
@@ -101,7 +257,9 @@ AdaptiveKMeansClustering::AdaptiveKMeansClustering(
     m_nclusters( 0 ),
     m_max_iterations( max_iterations ),
     m_tolerance( torelance ),
-    m_max_nclusters( 10 )
+    m_max_nclusters( 10 ),
+    m_enable_weight( false ),
+    m_enable_mahalanobis_distance( false )
 {
     this->exec( object );
 }
@@ -110,7 +268,9 @@ AdaptiveKMeansClustering::AdaptiveKMeansClustering( const kvs::ObjectBase* objec
     m_nclusters( 0 ),
     m_max_iterations( 100 ),
     m_tolerance( 1.e-6 ),
-    m_max_nclusters( max_nclusters )
+    m_max_nclusters( max_nclusters ),
+    m_enable_weight( false ),
+    m_enable_mahalanobis_distance( false )
 {
     this->exec( object );
 }
@@ -123,7 +283,9 @@ AdaptiveKMeansClustering::AdaptiveKMeansClustering(
     m_nclusters( 0 ),
     m_max_iterations( max_iterations ),
     m_tolerance( torelance ),
-    m_max_nclusters( max_nclusters )
+    m_max_nclusters( max_nclusters ),
+    m_enable_weight( false ),
+    m_enable_mahalanobis_distance( false )
 {
     this->exec( object );
 }
@@ -142,38 +304,84 @@ AdaptiveKMeansClustering::SuperClass* AdaptiveKMeansClustering::exec( const kvs:
     const size_t ncolumns = table->numberOfColumns();
 
     const size_t K = m_max_nclusters; // number of clusters
-    const size_t p = ncolumns; // p-dimension
+    const size_t p = ncolumns - ( m_enable_weight ? 1 : 0 ); // p-dimension
     const kvs::Real32 Y = p * 0.5f; // transformation power
+    if ( nrows == 0 || p == 0 || K == 0 )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input table or maximum number of clusters is empty.");
+        return NULL;
+    }
+
+    // Weights of the rows.
+    kvs::ValueArray<kvs::Real32> w( nrows );
+    kvs::Real64 W = static_cast<kvs::Real64>( nrows );
+    if ( m_enable_weight )
+    {
+        W = 0.0;
+        const kvs::AnyValueArray& weights = table->column( p );
+        for ( size_t i = 0; i < nrows; i++ ) { w[i] = weights.at<kvs::Real32>(i); W += w[i]; }
+    }
+    else
+    {
+        for ( size_t i = 0; i < nrows; i++ ) { w[i] = 1.0f; }
+    }
+
+    // Rows packed in row-major order (x), and the rows transformed with the
+    // Cholesky factor of the covariance matrix (y) for the Mahalanobis distance.
+    const kvs::ValueArray<kvs::Real32> x = pcs::ClusteringUtility::PackTable( table, p );
+    kvs::ValueArray<kvs::Real32> y = x;
+    std::vector<kvs::Real64> L;
+    bool whitened = false;
+    if ( m_enable_mahalanobis_distance )
+    {
+        if ( ::CalculateCovarianceFactor( x.data(), w.data(), nrows, p, L ) )
+        {
+            y = x.clone();
+            ::Whiten( L, p, nrows, y.data() );
+            whitened = true;
+        }
+        else
+        {
+            kvsMessageWarning("Covariance matrix is not positive definite. Euclidean distance is used.");
+        }
+    }
 
     size_t nclusters = 1; // number of clusters (best k)
     kvs::Real32 Jmax = 0.0f; // maximum jump
     kvs::ValueArray<kvs::UInt32> IDs; // cluster IDs with the best k
     kvs::ValueArray<kvs::Real32> d( K + 1 ); d[0] = 0.0f; // distortion
+    kvs::ValueArray<kvs::Real32> initial_centers; // warm-start centers for the next k
     for ( size_t k = 1; k < K + 1; k++ )
     {
-        // k-means clustering.
+        // k-means clustering warm-started from the result of k-1 clusters.
         kvsoceanvis::pcs::FastKMeansClustering* clustered_table = new kvsoceanvis::pcs::FastKMeansClustering();
         clustered_table->setSeedingMethod( kvsoceanvis::pcs::FastKMeansClustering::SmartSeeding );
         clustered_table->setNumberOfClusters( k );
         clustered_table->setMaxIterations( m_max_iterations );
         clustered_table->setTolerance( m_tolerance );
+        clustered_table->setInitialCenters( initial_centers );
+        if ( m_enable_weight ) clustered_table->enableWeight();
         clustered_table->exec( table );
 
-        // Calculate the distortions (averaged Mahalanobis distance per dimension).
-        d[k] = 0.0f;
-        for ( size_t i = 0; i < nrows; i++ )
+        kvs::ValueArray<kvs::Real32> centers( k * p );
+        for ( size_t j = 0; j < k; j++ )
         {
-            kvs::ValueArray<kvs::Real32> cx = clustered_table->center(0);
-            kvs::ValueArray<kvs::Real32> x = ::GetRowArray( table, i );
-            kvs::Real32 distance = ::GetMahalanobisDistance( x, cx );
-            for ( size_t j = 1; j < k; j++ )
-            {
-                cx = clustered_table->center(j);
-                distance = kvs::Math::Min( distance, ::GetMahalanobisDistance( x, cx ) );
-            }
-            d[k] += distance;
+            const kvs::ValueArray<kvs::Real32>& c = clustered_table->center(j);
+            std::copy( c.begin(), c.end(), centers.data() + j * p );
         }
-        d[k] = ( 1.0f / p ) * ( ( 1.0f / nrows ) * d[k] );
+
+        kvs::ValueArray<kvs::Real32> transformed_centers = centers;
+        if ( whitened )
+        {
+            transformed_centers = centers.clone();
+            ::Whiten( L, p, k, transformed_centers.data() );
+        }
+
+        // Calculate the distortions (averaged Mahalanobis distance per dimension).
+        size_t worst = 0;
+        const kvs::Real64 distortion = ::CalculateDistortion( y.data(), w.data(), nrows, p, transformed_centers.data(), k, &worst );
+        d[k] = static_cast<kvs::Real32>( ( 1.0 / p ) * ( distortion / W ) );
 
         // Calculate jump in transformed distortion.
         kvs::Real32 Jk = std::pow( d[k], -Y ) - std::pow( d[k-1], -Y );
@@ -183,10 +391,15 @@ AdaptiveKMeansClustering::SuperClass* AdaptiveKMeansClustering::exec( const kvs:
             // Finally, the number of clusters can be calculated as the largest jump (argmax J[k]).
             nclusters = k;
             Jmax = Jk;
-            IDs = clustered_table->column( p ).asValueArray<kvs::UInt32>();
+            IDs = clustered_table->column( ncolumns ).asValueArray<kvs::UInt32>();
         }
 
         delete clustered_table;
+
+        // The worst cluster is split by adding its farthest row as a new center.
+        initial_centers.allocate( ( k + 1 ) * p );
+        std::copy( centers.begin(), centers.end(), initial_centers.begin() );
+        std::copy( x.data() + worst * p, x.data() + ( worst + 1 ) * p, initial_centers.data() + k * p );
     }
 
     m_nclusters = nclusters;
@@ -219,6 +432,54 @@ void AdaptiveKMeansClustering::setTolerance( const float tolerance )
     m_tolerance = tolerance;
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Enables the weighted clustering.
+ *
+ *  The last column of the input table is used as the weights of the rows,
+ *  and the distortions are averaged with the weights.
+ */
+/*===========================================================================*/
+void AdaptiveKMeansClustering::enableWeight()
+{
+    m_enable_weight = true;
+}
+
+void AdaptiveKMeansClustering::disableWeight()
+{
+    m_enable_weight = false;
+}
+
+bool AdaptiveKMeansClustering::isEnabledWeight() const
+{
+    return m_enable_weight;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Enables the Mahalanobis distance for the distortions.
+ *
+ *  The covariance matrix of the rows is calculated and factorized with
+ *  Cholesky decomposition once, and the distortions are calculated with the
+ *  Mahalanobis distance. Otherwise, the covariance matrix is assumed to be
+ *  the identity matrix (Euclidean distance).
+ */
+/*===========================================================================*/
+void AdaptiveKMeansClustering::enableMahalanobisDistance()
+{
+    m_enable_mahalanobis_distance = true;
+}
+
+void AdaptiveKMeansClustering::disableMahalanobisDistance()
+{
+    m_enable_mahalanobis_distance = false;
+}
+
+bool AdaptiveKMeansClustering::isEnabledMahalanobisDistance() const
+{
+    return m_enable_mahalanobis_distance;
+}
+
 size_t AdaptiveKMeansClustering::numberOfClusters() const
 {
     return m_nclusters;
@@ -239,7 +500,7 @@ kvs::ValueArray<kvs::Real32> AdaptiveKMeansClustering::jumps() const
     if ( m_distortions.size() != m_max_nclusters + 1 ) return kvs::ValueArray<kvs::Real32>();
 
     const kvs::ValueArray<kvs::Real32>& d = m_distortions;
-    const size_t p = SuperClass::numberOfColumns() - 1;
+    const size_t p = SuperClass::numberOfColumns() - ( m_enable_weight ? 2 : 1 );
     const kvs::Real32 Y = p * 0.5f;
     kvs::ValueArray<kvs::Real32> J( m_max_nclusters + 1 ); J[0] = 0.0f;
     for ( size_t k = 1; k < m_max_nclusters + 1; k++ )
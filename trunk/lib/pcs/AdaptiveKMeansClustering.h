@@ -52,6 +52,8 @@ private:
     size_t m_max_iterations; ///< maximum number of interations
     float m_tolerance; ///< tolerance of distance
     size_t m_max_nclusters; ///< maximum number of clusters for finding the best k
+    bool m_enable_weight; ///< use the last column as the weights of the rows
+    bool m_enable_mahalanobis_distance; ///< use the covariance matrix of the rows for the distortions
     kvs::ValueArray<kvs::Real32> m_distortions; ///< distortions for finding the best k
 
 public:
@@ -71,7 +73,13 @@ public:
     void setMaxNumberOfClusters( const size_t max_nclusters );
     void setMaxIterations( const size_t max_iterations );
     void setTolerance( const float tolerance );
+    void enableWeight();
+    void disableWeight();
+    void enableMahalanobisDistance();
+    void disableMahalanobisDistance();
 
+    bool isEnabledWeight() const;
+    bool isEnabledMahalanobisDistance() const;
     size_t numberOfClusters() const;
     size_t maxNumberOfClusters() const;
     const kvs::ValueArray<kvs::Real32>& distortions() const;
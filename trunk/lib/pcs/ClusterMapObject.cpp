@@ -180,6 +180,11 @@ void ClusterMapObject::Cluster::setMaxValues( const kvs::ValueArray<kvs::Real64>
     m_max_values = max_values;
 }
 
+size_t ClusterMapObject::Cluster::id() const
+{
+    return m_id;
+}
+
 size_t ClusterMapObject::Cluster::counter() const
 {
     return m_counter;
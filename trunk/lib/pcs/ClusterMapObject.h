@@ -106,6 +106,7 @@ public:
     void setMinValues( const kvs::ValueArray<kvs::Real64>& min_values );
     void setMaxValues( const kvs::ValueArray<kvs::Real64>& max_values );
 
+    size_t id() const;
     size_t counter() const;
     kvs::Real64 minValue( const size_t index ) const;
     kvs::Real64 maxValue( const size_t index ) const;
@@ -0,0 +1,615 @@
+/*****************************************************************************/
+/**
+ *  @file   ClusteringUtility.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "ClusteringUtility.h"
+#include <vector>
+#include <algorithm>
+#include <kvs/AnyValueArray>
+#include <kvs/Message>
+#include <kvs/Value>
+#if defined( _OPENMP )
+#include <omp.h>
+#endif
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Copies the column values into the row-major matrix.
+ *  @param  values [in] pointer to the column values
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  column_index [in] column index
+ *  @param  rows [in] pointer to the selected row indices (NULL: all the rows)
+ *  @param  data [out] pointer to the row-major matrix
+ */
+/*===========================================================================*/
+template <typename T>
+void PackColumn(
+    const T* values,
+    const size_t nrows,
+    const size_t ncolumns,
+    const size_t column_index,
+    const kvs::UInt32* rows,
+    kvs::Real32* data )
+{
+    kvs::Real32* row = data + column_index;
+    if ( rows )
+    {
+        for ( size_t i = 0; i < nrows; i++, row += ncolumns )
+        {
+            *row = static_cast<kvs::Real32>( values[ rows[i] ] );
+        }
+    }
+    else
+    {
+        for ( size_t i = 0; i < nrows; i++, row += ncolumns )
+        {
+            *row = static_cast<kvs::Real32>( values[i] );
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the values of the selected rows.
+ *  @param  values [in] pointer to the column values
+ *  @param  rows [in] selected row indices
+ *  @return values of the selected rows
+ */
+/*===========================================================================*/
+template <typename T>
+kvs::AnyValueArray SelectValues( const T* values, const kvs::ValueArray<kvs::UInt32>& rows )
+{
+    const size_t nrows = rows.size();
+    kvs::ValueArray<T> selected( nrows );
+    for ( size_t i = 0; i < nrows; i++ ) { selected[i] = values[ rows[i] ]; }
+
+    return kvs::AnyValueArray( selected );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns a uniform random number in [0,1) for the given row.
+ *  @param  seed [in] seed of the sampling round
+ *  @param  index [in] row index
+ *  @return random number
+ *
+ *  The number depends only on the seed and the row index (SplitMix64), so
+ *  the rows can be sampled in parallel with a reproducible result.
+ */
+/*===========================================================================*/
+inline kvs::Real64 HashedUniform( const kvs::UInt64 seed, const kvs::UInt64 index )
+{
+    kvs::UInt64 z = seed + ( index + 1 ) * 0x9E3779B97F4A7C15ULL;
+    z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+    z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+    z = z ^ ( z >> 31 );
+    return static_cast<kvs::Real64>( z >> 11 ) / 9007199254740992.0; // 2^53
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns a random row index.
+ *  @param  random [in] random number generator
+ *  @param  nrows [in] number of rows
+ *  @return row index
+ */
+/*===========================================================================*/
+inline size_t RandomIndex( kvs::MersenneTwister& random, const size_t nrows )
+{
+    return kvs::Math::Min( static_cast<size_t>( nrows * random.rand() ), nrows - 1 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns a random 64-bit seed.
+ *  @param  random [in] random number generator
+ *  @return seed composed of two random 32-bit words
+ */
+/*===========================================================================*/
+inline kvs::UInt64 RandomSeed( kvs::MersenneTwister& random )
+{
+    // rand() returns a number in [0,1], so each word is in [0,2^32-1].
+    const kvs::UInt64 hi = static_cast<kvs::UInt32>( random.rand() * 4294967295.0 );
+    const kvs::UInt64 lo = static_cast<kvs::UInt32>( random.rand() * 4294967295.0 );
+    return ( hi << 32 ) | lo;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Fills the remaining centers with the rows different from the chosen ones.
+ *  @param  data [in] pointer to the table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  random [in] random number generator
+ *  @param  centers [in/out] pointer to the centers packed in row-major order
+ *  @param  nchosen [in] number of the centers already chosen
+ *  @param  ncenters [in] number of centers
+ *
+ *  The rows are scanned from a random row, and the rows that coincide with
+ *  none of the chosen centers are taken. If the table has fewer distinct
+ *  rows than the centers, the rest is filled with the random rows.
+ */
+/*===========================================================================*/
+void FillDistinctRows(
+    const kvs::Real32* data,
+    const size_t nrows,
+    const size_t ncolumns,
+    kvs::MersenneTwister& random,
+    kvs::Real32* centers,
+    size_t nchosen,
+    const size_t ncenters )
+{
+    const size_t start = ::RandomIndex( random, nrows );
+    for ( size_t k = 0; k < nrows && nchosen < ncenters; k++ )
+    {
+        const kvs::Real32* x = data + ( ( start + k ) % nrows ) * ncolumns;
+        bool distinct = true;
+        for ( size_t j = 0; j < nchosen && distinct; j++ )
+        {
+            distinct = kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( x, centers + j * ncolumns, ncolumns ) > 0.0f;
+        }
+
+        if ( distinct )
+        {
+            std::copy( x, x + ncolumns, centers + nchosen * ncolumns );
+            nchosen++;
+        }
+    }
+
+    for ( ; nchosen < ncenters; nchosen++ )
+    {
+        const size_t row = ::RandomIndex( random, nrows );
+        std::copy( data + row * ncolumns, data + ( row + 1 ) * ncolumns, centers + nchosen * ncolumns );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Updates the distances from the rows to the nearest candidate.
+ *  @param  data [in] pointer to the table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  candidates [in] candidates packed in row-major order
+ *  @param  begin [in] index of the first candidate to be tested
+ *  @param  weights [in] pointer to the weights of the rows (NULL: unweighted)
+ *  @param  distances [in/out] squared distance to the nearest candidate
+ *  @return weighted sum of the squared distances
+ */
+/*===========================================================================*/
+kvs::Real64 UpdateDistances(
+    const kvs::Real32* data,
+    const size_t nrows,
+    const size_t ncolumns,
+    const std::vector<kvs::Real32>& candidates,
+    const size_t begin,
+    const kvs::Real32* weights,
+    std::vector<kvs::Real32>& distances )
+{
+    const size_t end = candidates.size() / ncolumns;
+    const kvs::Int64 n = static_cast<kvs::Int64>( nrows );
+
+    kvs::Real64 phi = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:phi)
+    for ( kvs::Int64 i = 0; i < n; i++ )
+    {
+        const kvs::Real32* x = data + i * ncolumns;
+        kvs::Real32 dmin = distances[i];
+        for ( size_t j = begin; j < end; j++ )
+        {
+            const kvs::Real32 d = kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( x, &candidates[ j * ncolumns ], ncolumns );
+            if ( d < dmin ) { dmin = d; }
+        }
+        distances[i] = dmin;
+        phi += weights ? weights[i] * dmin : dmin;
+    }
+
+    return phi;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Packs the rows of the table into a contiguous row-major float matrix.
+ *  @param  table [in] pointer to the table object
+ *  @param  ncolumns [in] number of the columns to be packed
+ *  @param  nrows [in] number of the rows to be packed
+ *  @param  selection [in] selected row indices (NULL: the first nrows rows)
+ *  @return matrix of nrows x ncolumns values
+ */
+/*===========================================================================*/
+kvs::ValueArray<kvs::Real32> PackRows(
+    const kvs::TableObject* table,
+    const size_t ncolumns,
+    const size_t nrows,
+    const kvs::UInt32* selection )
+{
+    kvs::ValueArray<kvs::Real32> data( nrows * ncolumns );
+    for ( size_t j = 0; j < ncolumns; j++ )
+    {
+        const kvs::AnyValueArray& column = table->column(j);
+        const void* values = column.data();
+        const std::type_info& type = column.typeInfo()->type();
+        if ( type == typeid( kvs::Int8 ) ) ::PackColumn( static_cast<const kvs::Int8*>( values ), nrows, ncolumns, j, selection, data.data() );
+        else if ( type == typeid( kvs::Int16 ) ) ::PackColumn( static_cast<const kvs::Int16*>( values ), nrows, ncolumns, j, selection, data.data() );
+        else if ( type == typeid( kvs::Int32 ) ) ::PackColumn( static_cast<const kvs::Int32*>( values ), nrows, ncolumns, j, selection, data.data() );
+        else if ( type == typeid( kvs::Int64 ) ) ::PackColumn( static_cast<const kvs::Int64*>( values ), nrows, ncolumns, j, selection, data.data() );
+        else if ( type == typeid( kvs::UInt8 ) ) ::PackColumn( static_cast<const kvs::UInt8*>( values ), nrows, ncolumns, j, selection, data.data() );
+        else if ( type == typeid( kvs::UInt16 ) ) ::PackColumn( static_cast<const kvs::UInt16*>( values ), nrows, ncolumns, j, selection, data.data() );
+        else if ( type == typeid( kvs::UInt32 ) ) ::PackColumn( static_cast<const kvs::UInt32*>( values ), nrows, ncolumns, j, selection, data.data() );
+        else if ( type == typeid( kvs::UInt64 ) ) ::PackColumn( static_cast<const kvs::UInt64*>( values ), nrows, ncolumns, j, selection, data.data() );
+        else if ( type == typeid( kvs::Real32 ) ) ::PackColumn( static_cast<const kvs::Real32*>( values ), nrows, ncolumns, j, selection, data.data() );
+        else if ( type == typeid( kvs::Real64 ) ) ::PackColumn( static_cast<const kvs::Real64*>( values ), nrows, ncolumns, j, selection, data.data() );
+        else
+        {
+            kvsMessageError("Unsupported data type.");
+            return kvs::ValueArray<kvs::Real32>();
+        }
+    }
+
+    return data;
+}
+
+} // end of namespace
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+namespace ClusteringUtility
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Packs the table into a contiguous row-major float matrix.
+ *  @param  table [in] pointer to the table object
+ *  @return matrix of nrows x ncolumns values
+ */
+/*===========================================================================*/
+kvs::ValueArray<kvs::Real32> PackTable( const kvs::TableObject* table )
+{
+    return PackTable( table, table->numberOfColumns() );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Packs the first columns of the table into a contiguous row-major float matrix.
+ *  @param  table [in] pointer to the table object
+ *  @param  ncolumns [in] number of the columns to be packed
+ *  @return matrix of nrows x ncolumns values
+ */
+/*===========================================================================*/
+kvs::ValueArray<kvs::Real32> PackTable( const kvs::TableObject* table, const size_t ncolumns )
+{
+    return ::PackRows( table, ncolumns, table->numberOfRows(), NULL );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Packs the selected rows of the table into a contiguous row-major float matrix.
+ *  @param  table [in] pointer to the table object
+ *  @param  ncolumns [in] number of the columns to be packed
+ *  @param  rows [in] selected row indices (empty: no rows)
+ *  @return matrix of nselected x ncolumns values
+ *
+ *  Only the selected rows are read from the columns, so a subset of the
+ *  table can be clustered without constructing a new table.
+ */
+/*===========================================================================*/
+kvs::ValueArray<kvs::Real32> PackTable( const kvs::TableObject* table, const size_t ncolumns, const kvs::ValueArray<kvs::UInt32>& rows )
+{
+    return ::PackRows( table, ncolumns, rows.size(), rows.data() );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the values of the selected rows of the column.
+ *  @param  column [in] column of the table
+ *  @param  rows [in] selected row indices
+ *  @return values of the selected rows (in the type of the column)
+ */
+/*===========================================================================*/
+kvs::AnyValueArray SelectRows( const kvs::AnyValueArray& column, const kvs::ValueArray<kvs::UInt32>& rows )
+{
+    const void* values = column.data();
+    const std::type_info& type = column.typeInfo()->type();
+    if ( type == typeid( kvs::Int8 ) ) return ::SelectValues( static_cast<const kvs::Int8*>( values ), rows );
+    else if ( type == typeid( kvs::Int16 ) ) return ::SelectValues( static_cast<const kvs::Int16*>( values ), rows );
+    else if ( type == typeid( kvs::Int32 ) ) return ::SelectValues( static_cast<const kvs::Int32*>( values ), rows );
+    else if ( type == typeid( kvs::Int64 ) ) return ::SelectValues( static_cast<const kvs::Int64*>( values ), rows );
+    else if ( type == typeid( kvs::UInt8 ) ) return ::SelectValues( static_cast<const kvs::UInt8*>( values ), rows );
+    else if ( type == typeid( kvs::UInt16 ) ) return ::SelectValues( static_cast<const kvs::UInt16*>( values ), rows );
+    else if ( type == typeid( kvs::UInt32 ) ) return ::SelectValues( static_cast<const kvs::UInt32*>( values ), rows );
+    else if ( type == typeid( kvs::UInt64 ) ) return ::SelectValues( static_cast<const kvs::UInt64*>( values ), rows );
+    else if ( type == typeid( kvs::Real32 ) ) return ::SelectValues( static_cast<const kvs::Real32*>( values ), rows );
+    else if ( type == typeid( kvs::Real64 ) ) return ::SelectValues( static_cast<const kvs::Real64*>( values ), rows );
+
+    kvsMessageError("Unsupported data type.");
+    return kvs::AnyValueArray();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the indices of the rows selected by the mask.
+ *  @param  mask [in] selection mask (non-zero: selected) for each row
+ *  @return selected row indices
+ */
+/*===========================================================================*/
+kvs::ValueArray<kvs::UInt32> SelectedRows( const kvs::ValueArray<kvs::UInt8>& mask )
+{
+    std::vector<kvs::UInt32> rows;
+    for ( size_t i = 0; i < mask.size(); i++ )
+    {
+        if ( mask[i] ) rows.push_back( static_cast<kvs::UInt32>( i ) );
+    }
+
+    return kvs::ValueArray<kvs::UInt32>( rows );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the indices of the rows inside the ranges of the table.
+ *  @param  table [in] pointer to the table object
+ *  @return selected row indices
+ *
+ *  The rows brushed in the linked views (i.e. the rows inside the min/max
+ *  ranges of all the columns) are selected.
+ */
+/*===========================================================================*/
+kvs::ValueArray<kvs::UInt32> SelectedRows( const kvs::TableObject* table )
+{
+    std::vector<kvs::UInt32> rows;
+    const size_t nrows = table->numberOfRows();
+    for ( size_t i = 0; i < nrows; i++ )
+    {
+        if ( table->insideRange(i) ) rows.push_back( static_cast<kvs::UInt32>( i ) );
+    }
+
+    return kvs::ValueArray<kvs::UInt32>( rows );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Restricts the given centers to the rows.
+ *  @param  data [in] pointer to the table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  ncenters [in] number of centers
+ *  @param  centers [in/out] pointer to the centers packed in row-major order
+ *  @return number of the moved centers
+ *
+ *  This is used for warm-starting the clustering of a subset of the rows
+ *  with the centers of the whole rows. The centers closest to some rows are
+ *  kept, and each of the other centers is moved to the row farthest from
+ *  the current centers, so every center has the rows of the subset.
+ */
+/*===========================================================================*/
+size_t RestrictCenters(
+    const kvs::Real32* data,
+    const size_t nrows,
+    const size_t ncolumns,
+    const size_t ncenters,
+    kvs::Real32* centers )
+{
+    if ( nrows == 0 || ncenters == 0 ) return 0;
+
+    std::vector<kvs::Real32> distances( nrows );
+    std::vector<size_t> counts( ncenters, 0 );
+    const kvs::Int64 n = static_cast<kvs::Int64>( nrows );
+    #pragma omp parallel
+    {
+        std::vector<size_t> local_counts( ncenters, 0 );
+
+        #pragma omp for schedule(static)
+        for ( kvs::Int64 i = 0; i < n; i++ )
+        {
+            const size_t j = NearestCenter( data + i * ncolumns, centers, ncenters, ncolumns, &distances[i] );
+            local_counts[j]++;
+        }
+
+        #pragma omp critical
+        {
+            for ( size_t j = 0; j < ncenters; j++ ) { counts[j] += local_counts[j]; }
+        }
+    }
+
+    size_t nmoved = 0;
+    for ( size_t j = 0; j < ncenters; j++ )
+    {
+        if ( counts[j] > 0 ) continue;
+
+        const size_t index = std::max_element( distances.begin(), distances.end() ) - distances.begin();
+        if ( !( distances[ index ] > 0.0f ) ) break; // all the rows are on the centers
+
+        kvs::Real32* center = centers + j * ncolumns;
+        std::copy( data + index * ncolumns, data + ( index + 1 ) * ncolumns, center );
+        nmoved++;
+
+        #pragma omp parallel for schedule(static)
+        for ( kvs::Int64 i = 0; i < n; i++ )
+        {
+            const kvs::Real32 d = SquaredDistance( data + i * ncolumns, center, ncolumns );
+            if ( d < distances[i] ) { distances[i] = d; }
+        }
+    }
+
+    return nmoved;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the number of threads used in the parallel regions.
+ *  @return number of threads (1 if OpenMP is not available)
+ */
+/*===========================================================================*/
+size_t NumberOfThreads()
+{
+#if defined( _OPENMP )
+    return static_cast<size_t>( omp_get_max_threads() );
+#else
+    return 1;
+#endif
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Selects the initial centers with the k-means|| seeding.
+ *  @param  data [in] pointer to the table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  ncenters [in] number of centers
+ *  @param  random [in] random number generator
+ *  @param  centers [out] pointer to the centers packed in row-major order
+ *  @param  weights [in] pointer to the weights of the rows (NULL: unweighted)
+ *
+ *  Instead of the k passes of k-means++, the candidates are oversampled
+ *  with the factor of 2k in a few rounds over the rows, and then the
+ *  centers are chosen from the candidates weighted by the number of rows
+ *  closest to them with k-means++ [B. Bahmani et al., Scalable K-Means++,
+ *  VLDB 2012]. The work buffers are allocated on the heap.
+ */
+/*===========================================================================*/
+void ScalableSeeding(
+    const kvs::Real32* data,
+    const size_t nrows,
+    const size_t ncolumns,
+    const size_t ncenters,
+    kvs::MersenneTwister& random,
+    kvs::Real32* centers,
+    const kvs::Real32* weights )
+{
+    if ( nrows == 0 || ncenters == 0 ) return;
+
+    const size_t nrounds = 5;
+    const kvs::Real64 oversampling = 2.0 * ncenters;
+
+    // Candidates packed in row-major order.
+    std::vector<kvs::Real32> candidates;
+    candidates.reserve( ( 1 + nrounds * 2 * ncenters ) * ncolumns );
+
+    // The first candidate is chosen uniformly at random.
+    const size_t first = ::RandomIndex( random, nrows );
+    candidates.insert( candidates.end(), data + first * ncolumns, data + ( first + 1 ) * ncolumns );
+
+    // Squared distance from each row to the nearest candidate.
+    std::vector<kvs::Real32> distances( nrows, kvs::Value<kvs::Real32>::Max() );
+    kvs::Real64 phi = ::UpdateDistances( data, nrows, ncolumns, candidates, 0, weights, distances );
+
+    // Oversampling rounds.
+    const kvs::Int64 n = static_cast<kvs::Int64>( nrows );
+    for ( size_t round = 0; round < nrounds && phi > 0.0; round++ )
+    {
+        const size_t begin = candidates.size() / ncolumns;
+        const kvs::UInt64 seed = ::RandomSeed( random );
+
+        // The sampled rows are sorted so that the result does not depend
+        // on the number of threads.
+        std::vector<size_t> sampled;
+        #pragma omp parallel
+        {
+            std::vector<size_t> local;
+
+            #pragma omp for schedule(static)
+            for ( kvs::Int64 i = 0; i < n; i++ )
+            {
+                const kvs::Real64 w = weights ? weights[i] : 1.0;
+                const kvs::Real64 probability = oversampling * w * distances[i] / phi;
+                if ( ::HashedUniform( seed, static_cast<kvs::UInt64>(i) ) < probability )
+                {
+                    local.push_back( static_cast<size_t>(i) );
+                }
+            }
+
+            #pragma omp critical
+            {
+                sampled.insert( sampled.end(), local.begin(), local.end() );
+            }
+        }
+
+        std::sort( sampled.begin(), sampled.end() );
+        for ( size_t j = 0; j < sampled.size(); j++ )
+        {
+            const kvs::Real32* x = data + sampled[j] * ncolumns;
+            candidates.insert( candidates.end(), x, x + ncolumns );
+        }
+
+        phi = ::UpdateDistances( data, nrows, ncolumns, candidates, begin, weights, distances );
+    }
+
+    // Weight of each candidate given by the (weighted) number of rows closest to it.
+    const size_t ncandidates = candidates.size() / ncolumns;
+    std::vector<kvs::Real64> candidate_weights( ncandidates, 0.0 );
+    #pragma omp parallel
+    {
+        std::vector<kvs::Real64> local( ncandidates, 0.0 );
+
+        #pragma omp for schedule(static)
+        for ( kvs::Int64 i = 0; i < n; i++ )
+        {
+            local[ NearestCenter( data + i * ncolumns, &candidates[0], ncandidates, ncolumns, NULL ) ] += weights ? weights[i] : 1.0;
+        }
+
+        #pragma omp critical
+        {
+            for ( size_t j = 0; j < ncandidates; j++ ) { candidate_weights[j] += local[j]; }
+        }
+    }
+
+    // Weighted k-means++ on the candidates.
+    std::vector<kvs::Real32> D( ncandidates, kvs::Value<kvs::Real32>::Max() );
+    size_t index = kvs::Math::Min( static_cast<size_t>( ncandidates * random.rand() ), ncandidates - 1 );
+    size_t nchosen = 0;
+    while ( nchosen < ncenters && nchosen < ncandidates )
+    {
+        kvs::Real32* center = centers + nchosen * ncolumns;
+        std::copy( &candidates[ index * ncolumns ], &candidates[ index * ncolumns ] + ncolumns, center );
+        nchosen++;
+
+        kvs::Real64 S = 0.0;
+        for ( size_t j = 0; j < ncandidates; j++ )
+        {
+            D[j] = kvs::Math::Min( D[j], SquaredDistance( &candidates[ j * ncolumns ], center, ncolumns ) );
+            S += candidate_weights[j] * D[j];
+        }
+
+        // All the candidates coincide with the chosen centers.
+        if ( !( S > 0.0 ) ) { break; }
+
+        const kvs::Real64 threshold = S * random.rand();
+        kvs::Real64 P = 0.0;
+        for ( size_t j = 0; j < ncandidates; j++ )
+        {
+            if ( D[j] > 0.0f ) { index = j; }
+            P += candidate_weights[j] * D[j];
+            if ( P > threshold && D[j] > 0.0f ) { break; }
+        }
+    }
+
+    // Fewer distinct candidates than centers (e.g. many duplicated rows).
+    if ( nchosen < ncenters )
+    {
+        ::FillDistinctRows( data, nrows, ncolumns, random, centers, nchosen, ncenters );
+    }
+}
+
+} // end of namespace ClusteringUtility
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
@@ -0,0 +1,137 @@
+/*****************************************************************************/
+/**
+ *  @file   ClusteringUtility.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__PCS__CLUSTERING_UTILITY_H_INCLUDE
+#define KVSOCEANVIS__PCS__CLUSTERING_UTILITY_H_INCLUDE
+
+#include <kvs/Type>
+#include <kvs/ValueArray>
+#include <kvs/AnyValueArray>
+#include <kvs/TableObject>
+#include <kvs/MersenneTwister>
+#if defined( __SSE__ ) || defined( _M_X64 )
+#include <xmmintrin.h>
+#define KVSOCEANVIS__PCS__CLUSTERING_UTILITY_ENABLE_SSE
+#endif
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+namespace ClusteringUtility
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the squared Euclidean distance between the given points.
+ *  @param  x0 [in] pointer to the point 0
+ *  @param  x1 [in] pointer to the point 1
+ *  @param  dim [in] number of dimensions
+ *  @return squared distance
+ */
+/*===========================================================================*/
+inline kvs::Real32 SquaredDistance( const kvs::Real32* x0, const kvs::Real32* x1, const size_t dim )
+{
+    size_t i = 0;
+    kvs::Real32 distance = 0.0f;
+
+#if defined( KVSOCEANVIS__PCS__CLUSTERING_UTILITY_ENABLE_SSE )
+    if ( dim >= 4 )
+    {
+        __m128 sum = _mm_setzero_ps();
+        for ( ; i + 4 <= dim; i += 4 )
+        {
+            const __m128 diff = _mm_sub_ps( _mm_loadu_ps( x1 + i ), _mm_loadu_ps( x0 + i ) );
+            sum = _mm_add_ps( sum, _mm_mul_ps( diff, diff ) );
+        }
+
+        kvs::Real32 s[4];
+        _mm_storeu_ps( s, sum );
+        distance = ( s[0] + s[1] ) + ( s[2] + s[3] );
+    }
+#endif
+
+    for ( ; i < dim; i++ )
+    {
+        const kvs::Real32 diff = x1[i] - x0[i];
+        distance += diff * diff;
+    }
+
+    return distance;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the index of the nearest center.
+ *  @param  x [in] pointer to the point
+ *  @param  centers [in] pointer to the centers packed in row-major order
+ *  @param  ncenters [in] number of centers
+ *  @param  dim [in] number of dimensions
+ *  @param  distance [out] squared distance to the nearest center
+ *  @return index of the nearest center
+ */
+/*===========================================================================*/
+inline size_t NearestCenter(
+    const kvs::Real32* x,
+    const kvs::Real32* centers,
+    const size_t ncenters,
+    const size_t dim,
+    kvs::Real32* distance )
+{
+    size_t index = 0;
+    kvs::Real32 dmin = SquaredDistance( x, centers, dim );
+    for ( size_t j = 1; j < ncenters; j++ )
+    {
+        const kvs::Real32 d = SquaredDistance( x, centers + j * dim, dim );
+        if ( d < dmin ) { dmin = d; index = j; }
+    }
+
+    if ( distance ) *distance = dmin;
+    return index;
+}
+
+kvs::ValueArray<kvs::Real32> PackTable( const kvs::TableObject* table );
+kvs::ValueArray<kvs::Real32> PackTable( const kvs::TableObject* table, const size_t ncolumns );
+kvs::ValueArray<kvs::Real32> PackTable( const kvs::TableObject* table, const size_t ncolumns, const kvs::ValueArray<kvs::UInt32>& rows );
+kvs::AnyValueArray SelectRows( const kvs::AnyValueArray& column, const kvs::ValueArray<kvs::UInt32>& rows );
+kvs::ValueArray<kvs::UInt32> SelectedRows( const kvs::ValueArray<kvs::UInt8>& mask );
+kvs::ValueArray<kvs::UInt32> SelectedRows( const kvs::TableObject* table );
+size_t NumberOfThreads();
+
+void ScalableSeeding(
+    const kvs::Real32* data,
+    const size_t nrows,
+    const size_t ncolumns,
+    const size_t ncenters,
+    kvs::MersenneTwister& random,
+    kvs::Real32* centers,
+    const kvs::Real32* weights = NULL );
+
+size_t RestrictCenters(
+    const kvs::Real32* data,
+    const size_t nrows,
+    const size_t ncolumns,
+    const size_t ncenters,
+    kvs::Real32* centers );
+
+} // end of namespace ClusteringUtility
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__PCS__CLUSTERING_UTILITY_H_INCLUDE
@@ -0,0 +1,298 @@
+/*****************************************************************************/
+/**
+ *  @file   CoresetSampling.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "CoresetSampling.h"
+#include <vector>
+#include <algorithm>
+#include <kvs/ValueArray>
+#include <kvs/AnyValueArray>
+#include "OutOfCoreTableObject.h"
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Weighted point set.
+ */
+/*===========================================================================*/
+struct PointSet
+{
+    std::vector<kvs::Real32> points; ///< points packed in row-major order
+    std::vector<kvs::Real32> weights; ///< weights of the points
+
+    size_t size() const { return weights.size(); }
+    bool empty() const { return weights.empty(); }
+    void clear() { points.clear(); weights.clear(); }
+    void append( const PointSet& other )
+    {
+        points.insert( points.end(), other.points.begin(), other.points.end() );
+        weights.insert( weights.end(), other.weights.begin(), other.weights.end() );
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Reduces the weighted points to the lightweight coreset.
+ *  @param  input [in] weighted points
+ *  @param  ncolumns [in] number of columns
+ *  @param  size [in] number of the points in the coreset
+ *  @param  random [in] random number generator
+ *  @param  output [out] coreset
+ *
+ *  The points are sampled with the probability of the mixture of the uniform
+ *  distribution and the distribution proportional to the squared distance
+ *  to the mean, and each sampled point is weighted by the inverse of the
+ *  probability. The duplicated samples are merged into one point.
+ */
+/*===========================================================================*/
+void Reduce(
+    const PointSet& input,
+    const size_t ncolumns,
+    const size_t size,
+    kvs::MersenneTwister& random,
+    PointSet& output )
+{
+    const size_t npoints = input.size();
+    if ( npoints <= size ) { output = input; return; }
+
+    // Weighted mean.
+    kvs::Real64 W = 0.0;
+    std::vector<kvs::Real64> mean( ncolumns, 0.0 );
+    for ( size_t i = 0; i < npoints; i++ )
+    {
+        const kvs::Real32* x = &input.points[ i * ncolumns ];
+        const kvs::Real64 w = input.weights[i];
+        for ( size_t k = 0; k < ncolumns; k++ ) { mean[k] += w * x[k]; }
+        W += w;
+    }
+    if ( !( W > 0.0 ) ) { output.clear(); return; }
+    for ( size_t k = 0; k < ncolumns; k++ ) { mean[k] /= W; }
+
+    // Weighted squared distances to the mean.
+    kvs::Real64 D = 0.0;
+    std::vector<kvs::Real64> d( npoints );
+    for ( size_t i = 0; i < npoints; i++ )
+    {
+        const kvs::Real32* x = &input.points[ i * ncolumns ];
+        kvs::Real64 distance = 0.0;
+        for ( size_t k = 0; k < ncolumns; k++ ) { distance += ( x[k] - mean[k] ) * ( x[k] - mean[k] ); }
+        d[i] = input.weights[i] * distance;
+        D += d[i];
+    }
+
+    // Cumulative sampling distribution.
+    std::vector<kvs::Real64> q( npoints );
+    std::vector<kvs::Real64> cdf( npoints );
+    kvs::Real64 sum = 0.0;
+    for ( size_t i = 0; i < npoints; i++ )
+    {
+        const kvs::Real64 uniform = input.weights[i] / W;
+        q[i] = ( D > 0.0 ) ? 0.5 * uniform + 0.5 * d[i] / D : uniform;
+        sum += q[i];
+        cdf[i] = sum;
+    }
+
+    // Sampling with replacement.
+    std::vector<size_t> indices( size );
+    for ( size_t j = 0; j < size; j++ )
+    {
+        const kvs::Real64 r = sum * random.rand();
+        const size_t i = std::upper_bound( cdf.begin(), cdf.end(), r ) - cdf.begin();
+        indices[j] = kvs::Math::Min( i, npoints - 1 );
+    }
+    std::sort( indices.begin(), indices.end() );
+
+    output.clear();
+    for ( size_t j = 0; j < size; )
+    {
+        const size_t i = indices[j];
+        size_t count = 0;
+        while ( j < size && indices[j] == i ) { count++; j++; }
+
+        const kvs::Real32* x = &input.points[ i * ncolumns ];
+        output.points.insert( output.points.end(), x, x + ncolumns );
+        output.weights.push_back( static_cast<kvs::Real32>( count * input.weights[i] / ( size * q[i] / sum ) ) );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Inserts the coreset to the bucket with merge-and-reduce.
+ *  @param  coreset [in] coreset of a block
+ *  @param  ncolumns [in] number of columns
+ *  @param  size [in] number of the points in the coreset
+ *  @param  random [in] random number generator
+ *  @param  buckets [in/out] buckets of the coresets
+ *
+ *  The buckets work as a binary counter. The coreset in the level i
+ *  summarizes 2^i blocks, and two coresets in the same level are merged
+ *  and reduced into the next level, so that only O(log n) coresets are
+ *  kept in memory.
+ */
+/*===========================================================================*/
+void Insert(
+    const PointSet& coreset,
+    const size_t ncolumns,
+    const size_t size,
+    kvs::MersenneTwister& random,
+    std::vector<PointSet>& buckets )
+{
+    PointSet carry = coreset;
+    for ( size_t level = 0; ; level++ )
+    {
+        if ( level == buckets.size() ) { buckets.push_back( PointSet() ); }
+        if ( buckets[level].empty() ) { buckets[level] = carry; return; }
+
+        PointSet merged = buckets[level];
+        merged.append( carry );
+        buckets[level].clear();
+        ::Reduce( merged, ncolumns, size, random, carry );
+    }
+}
+
+} // end of namespace
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new CoresetSampling class.
+ */
+/*===========================================================================*/
+CoresetSampling::CoresetSampling():
+    m_coreset_size( 10000 ),
+    m_block_size( 262144 )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new CoresetSampling class.
+ *  @param  object [in] pointer to the out-of-core table object
+ *  @param  coreset_size [in] number of the rows in the coreset
+ */
+/*===========================================================================*/
+CoresetSampling::CoresetSampling( const kvs::ObjectBase* object, const size_t coreset_size ):
+    m_coreset_size( coreset_size ),
+    m_block_size( 262144 )
+{
+    this->exec( object );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Executes the coreset sampling.
+ *  @param  object [in] pointer to the out-of-core table object
+ *  @return pointer to the table object of the weighted rows
+ */
+/*===========================================================================*/
+CoresetSampling::SuperClass* CoresetSampling::exec( const kvs::ObjectBase* object )
+{
+    if ( !object )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input object is NULL.");
+        return NULL;
+    }
+
+    const pcs::OutOfCoreTableObject* table = reinterpret_cast<const pcs::OutOfCoreTableObject*>( object );
+    const size_t nrows = table->numberOfRows();
+    const size_t ncolumns = table->numberOfColumns();
+    if ( nrows == 0 || ncolumns == 0 || m_coreset_size == 0 )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input table or coreset size is empty.");
+        return NULL;
+    }
+
+    // Each block is reduced to the coreset and inserted to the buckets.
+    const bool opened = table->hasOpenedColumnFiles();
+    if ( !opened ) table->openColumnFiles();
+
+    const size_t block_size = kvs::Math::Min( m_block_size, nrows );
+    std::vector<PointSet> buckets;
+    ::PointSet block;
+    for ( size_t begin = 0; begin < nrows; begin += block_size )
+    {
+        const size_t n = kvs::Math::Min( block_size, nrows - begin );
+        block.points.resize( n * ncolumns );
+        block.weights.assign( n, 1.0f );
+        if ( !table->readRows( begin, n, &block.points[0] ) )
+        {
+            if ( !opened ) table->closeColumnFiles();
+            BaseClass::setSuccess( false );
+            kvsMessageError("Cannot read the input table.");
+            return NULL;
+        }
+
+        ::PointSet coreset;
+        ::Reduce( block, ncolumns, m_coreset_size, m_random, coreset );
+        ::Insert( coreset, ncolumns, m_coreset_size, m_random, buckets );
+    }
+
+    if ( !opened ) table->closeColumnFiles();
+
+    // The coresets in all the levels are merged into the final coreset.
+    ::PointSet merged;
+    for ( size_t i = 0; i < buckets.size(); i++ ) { merged.append( buckets[i] ); }
+
+    ::PointSet coreset;
+    ::Reduce( merged, ncolumns, m_coreset_size, m_random, coreset );
+
+    // Set the results to the output table object.
+    const size_t npoints = coreset.size();
+    for ( size_t i = 0; i < ncolumns; i++ )
+    {
+        kvs::ValueArray<kvs::Real32> column( npoints );
+        for ( size_t j = 0; j < npoints; j++ ) { column[j] = coreset.points[ j * ncolumns + i ]; }
+        SuperClass::addColumn( kvs::AnyValueArray( column ), table->label(i) );
+    }
+
+    kvs::ValueArray<kvs::Real32> weights( npoints );
+    std::copy( coreset.weights.begin(), coreset.weights.end(), weights.begin() );
+    SuperClass::addColumn( kvs::AnyValueArray( weights ), "Weight" );
+
+    return this;
+}
+
+void CoresetSampling::setSeed( const size_t seed )
+{
+    m_random.setSeed( seed );
+}
+
+void CoresetSampling::setCoresetSize( const size_t coreset_size )
+{
+    m_coreset_size = coreset_size;
+}
+
+void CoresetSampling::setBlockSize( const size_t block_size )
+{
+    m_block_size = kvs::Math::Max( block_size, size_t(1) );
+}
+
+size_t CoresetSampling::coresetSize() const
+{
+    return m_coreset_size;
+}
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
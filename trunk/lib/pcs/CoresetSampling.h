@@ -0,0 +1,86 @@
+/*****************************************************************************/
+/**
+ *  @file   CoresetSampling.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*----------------------------------------------------------------------------
+ *
+ * References:
+ * [1] O. Bachem, M. Lucic and A. Krause, Scalable k-Means Clustering via
+ *     Lightweight Coresets, In Proceedings of the 24th ACM SIGKDD
+ *     International Conference on Knowledge Discovery & Data Mining, 2018.
+ * [2] S. Har-Peled and S. Mazumdar, On Coresets for k-Means and k-Median
+ *     Clustering, In Proceedings of the 36th Annual ACM Symposium on Theory
+ *     of Computing, 2004.
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__PCS__CORESET_SAMPLING_H_INCLUDE
+#define KVSOCEANVIS__PCS__CORESET_SAMPLING_H_INCLUDE
+
+#include <kvs/Module>
+#include <kvs/FilterBase>
+#include <kvs/TableObject>
+#include <kvs/MersenneTwister>
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Coreset sampling class.
+ *
+ *  The out-of-core table is summarized into a small set of the weighted rows
+ *  in one sequential pass. The output table has the columns of the input
+ *  table and the "Weight" column as the last column, which can be clustered
+ *  with FastKMeansClustering::enableWeight() and
+ *  AdaptiveKMeansClustering::enableWeight().
+ */
+/*===========================================================================*/
+class CoresetSampling : public kvs::FilterBase, public kvs::TableObject
+{
+    kvsModuleName( kvsoceanvis::pcs::CoresetSampling );
+    kvsModuleCategory( Filter );
+    kvsModuleBaseClass( kvs::FilterBase );
+    kvsModuleSuperClass( kvs::TableObject );
+
+private:
+
+    kvs::MersenneTwister m_random; ///< random number generator
+    size_t m_coreset_size; ///< number of the rows in the coreset
+    size_t m_block_size; ///< number of rows read from the files at once
+
+public:
+
+    CoresetSampling();
+    CoresetSampling( const kvs::ObjectBase* object, const size_t coreset_size );
+
+public:
+
+    SuperClass* exec( const kvs::ObjectBase* object );
+
+public:
+
+    void setSeed( const size_t seed );
+    void setCoresetSize( const size_t coreset_size );
+    void setBlockSize( const size_t block_size );
+
+    size_t coresetSize() const;
+};
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__PCS__CORESET_SAMPLING_H_INCLUDE
@@ -0,0 +1,368 @@
+/*****************************************************************************/
+/**
+ *  @file   DistanceMatrix.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "DistanceMatrix.h"
+#include "ClusteringUtility.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <new>
+#include <kvs/Message>
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the distances between the rows in the pair of tiles.
+ *  @param  x [in] table data packed in row-major order
+ *  @param  norms [in] squared norms of the rows
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  i0 [in] first row of the tile I
+ *  @param  i1 [in] last row + 1 of the tile I
+ *  @param  j0 [in] first row of the tile J
+ *  @param  j1 [in] last row + 1 of the tile J
+ *  @param  squared [in] store the squared distances
+ *  @param  tile [in] buffer for the transposed tile J (ncolumns x tile size)
+ *  @param  dots [in] buffer for the dot products of a row (tile size)
+ *  @param  output [out] packed upper triangle of the distance matrix
+ *
+ *  The tile J is transposed so that the dot products between a row of the
+ *  tile I and all the rows of the tile J are accumulated column by column
+ *  with the SIMD operations.
+ */
+/*===========================================================================*/
+void ComputeTile(
+    const kvs::Real32* x,
+    const kvs::Real32* norms,
+    const size_t nrows,
+    const size_t ncolumns,
+    const size_t i0,
+    const size_t i1,
+    const size_t j0,
+    const size_t j1,
+    const bool squared,
+    kvs::Real32* tile,
+    kvs::Real32* dots,
+    kvs::Real32* output )
+{
+    const size_t nj = j1 - j0;
+    for ( size_t j = j0; j < j1; j++ )
+    {
+        for ( size_t k = 0; k < ncolumns; k++ ) { tile[ k * nj + ( j - j0 ) ] = x[ j * ncolumns + k ]; }
+    }
+
+    for ( size_t i = i0; i < i1; i++ )
+    {
+        const size_t begin = kvs::Math::Max( i, j0 );
+        if ( begin >= j1 ) continue;
+
+        // Dot products between the row i and the rows in the tile J.
+        std::fill( dots, dots + nj, 0.0f );
+        for ( size_t k = 0; k < ncolumns; k++ )
+        {
+            const kvs::Real32 xik = x[ i * ncolumns + k ];
+            const kvs::Real32* tk = tile + k * nj;
+            size_t j = 0;
+#if defined( KVSOCEANVIS__PCS__CLUSTERING_UTILITY_ENABLE_SSE )
+            const __m128 xk = _mm_set1_ps( xik );
+            for ( ; j + 4 <= nj; j += 4 )
+            {
+                const __m128 sum = _mm_add_ps( _mm_loadu_ps( dots + j ), _mm_mul_ps( xk, _mm_loadu_ps( tk + j ) ) );
+                _mm_storeu_ps( dots + j, sum );
+            }
+#endif
+            for ( ; j < nj; j++ ) { dots[j] += xik * tk[j]; }
+        }
+
+        // Distances stored in the row i of the upper triangle.
+        kvs::Real32* out = output + kvsoceanvis::pcs::DistanceMatrix::PackedIndex( nrows, i, begin );
+        for ( size_t j = begin; j < j1; j++ )
+        {
+            kvs::Real32 d = norms[i] + norms[j] - 2.0f * dots[ j - j0 ];
+            if ( j == i || d < 0.0f ) d = 0.0f;
+            out[ j - begin ] = squared ? d : std::sqrt( d );
+        }
+    }
+}
+
+} // end of namespace
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new DistanceMatrix class.
+ */
+/*===========================================================================*/
+DistanceMatrix::DistanceMatrix():
+    m_nrows( 0 ),
+    m_tile_size( 256 ),
+    m_enable_squared_distance( false ),
+    m_storage( MemoryStorage )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the distance matrix of the table rows.
+ *  @param  table [in] pointer to the table object
+ *  @return true if the calculation is done successfully
+ */
+/*===========================================================================*/
+bool DistanceMatrix::compute( const kvs::TableObject* table )
+{
+    if ( !table )
+    {
+        kvsMessageError("Input table is NULL.");
+        return false;
+    }
+
+    const kvs::ValueArray<kvs::Real32> data = pcs::ClusteringUtility::PackTable( table );
+    return this->compute( data.data(), table->numberOfRows(), table->numberOfColumns() );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the distance matrix of the rows.
+ *  @param  data [in] table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @return true if the calculation is done successfully
+ */
+/*===========================================================================*/
+bool DistanceMatrix::compute( const kvs::Real32* data, const size_t nrows, const size_t ncolumns )
+{
+    if ( nrows == 0 || ncolumns == 0 )
+    {
+        this->release();
+        kvsMessageError("Input data is empty.");
+        return false;
+    }
+
+    if ( !this->allocate( nrows ) ) return false;
+
+    // Rows centered by the column means and their squared norms.
+    /* NOTE: The distances are invariant to the translation, and the centering
+     * reduces the cancellation error of |x|^2 + |y|^2 - 2 x.y.
+     */
+    std::vector<kvs::Real64> means( ncolumns, 0.0 );
+    for ( size_t i = 0; i < nrows; i++ )
+    {
+        for ( size_t k = 0; k < ncolumns; k++ ) { means[k] += data[ i * ncolumns + k ]; }
+    }
+    for ( size_t k = 0; k < ncolumns; k++ ) { means[k] /= nrows; }
+
+    std::vector<kvs::Real32> x( nrows * ncolumns );
+    std::vector<kvs::Real32> norms( nrows, 0.0f );
+    for ( size_t i = 0; i < nrows; i++ )
+    {
+        for ( size_t k = 0; k < ncolumns; k++ )
+        {
+            const kvs::Real32 v = static_cast<kvs::Real32>( data[ i * ncolumns + k ] - means[k] );
+            x[ i * ncolumns + k ] = v;
+            norms[i] += v * v;
+        }
+    }
+
+    // Pairs of the tiles in the upper triangle.
+    const size_t tile_size = kvs::Math::Max( m_tile_size, size_t(1) );
+    const size_t ntiles = ( nrows + tile_size - 1 ) / tile_size;
+    std::vector<size_t> tasks;
+    tasks.reserve( ntiles * ( ntiles + 1 ) );
+    for ( size_t I = 0; I < ntiles; I++ )
+    {
+        for ( size_t J = I; J < ntiles; J++ ) { tasks.push_back( I ); tasks.push_back( J ); }
+    }
+
+    kvs::Real32* output = this->data();
+    const bool squared = m_enable_squared_distance;
+    const kvs::Int64 ntasks = static_cast<kvs::Int64>( tasks.size() / 2 );
+    #pragma omp parallel
+    {
+        std::vector<kvs::Real32> tile( tile_size * ncolumns );
+        std::vector<kvs::Real32> dots( tile_size );
+
+        #pragma omp for schedule(dynamic)
+        for ( kvs::Int64 t = 0; t < ntasks; t++ )
+        {
+            const size_t i0 = tasks[ 2 * t + 0 ] * tile_size;
+            const size_t j0 = tasks[ 2 * t + 1 ] * tile_size;
+            const size_t i1 = kvs::Math::Min( i0 + tile_size, nrows );
+            const size_t j1 = kvs::Math::Min( j0 + tile_size, nrows );
+            ::ComputeTile( &x[0], &norms[0], nrows, ncolumns, i0, i1, j0, j1, squared, &tile[0], &dots[0], output );
+        }
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Allocates the packed upper triangle of the matrix.
+ *  @param  nrows [in] number of rows (matrix size)
+ *  @return true if the matrix is allocated successfully
+ *
+ *  False is returned when the size of the matrix overflows, the memory
+ *  cannot be allocated or the mapped file cannot be created.
+ *  The elements are not initialized, so the matrix given by the other
+ *  method can be stored in the memory or in the mapped file.
+ */
+/*===========================================================================*/
+bool DistanceMatrix::allocate( const size_t nrows )
+{
+    this->release();
+
+    // The number of the elements n(n+1)/2 and its bytes must not overflow.
+    const size_t max_size = std::numeric_limits<size_t>::max();
+    const size_t n = nrows % 2 == 0 ? nrows / 2 : nrows;
+    const size_t m = nrows % 2 == 0 ? nrows + 1 : ( nrows + 1 ) / 2;
+    if ( n > 0 && m > max_size / sizeof( kvs::Real32 ) / n )
+    {
+        kvsMessageError("Distance matrix is too large (%lu rows).", static_cast<unsigned long>( nrows ) );
+        return false;
+    }
+
+    const size_t nelements = n * m;
+    if ( m_storage == FileStorage )
+    {
+        const size_t size = nelements * sizeof( kvs::Real32 );
+        const bool created = m_filename.empty() ? m_file.createTemporary( size ) : m_file.create( m_filename, size );
+        if ( !created )
+        {
+            kvsMessageError("Cannot create the mapped file for the distance matrix.");
+            return false;
+        }
+    }
+    else
+    {
+        try
+        {
+            m_values.allocate( nelements );
+        }
+        catch ( const std::bad_alloc& )
+        {
+            kvsMessageError("Cannot allocate memory for the distance matrix (%lu rows).", static_cast<unsigned long>( nrows ) );
+            return false;
+        }
+    }
+    m_nrows = nrows;
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Releases the distance matrix.
+ */
+/*===========================================================================*/
+void DistanceMatrix::release()
+{
+    m_values.release();
+    m_file.close();
+    m_nrows = 0;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a number of rows in a tile.
+ *  @param  tile_size [in] number of rows in a tile
+ */
+/*===========================================================================*/
+void DistanceMatrix::setTileSize( const size_t tile_size )
+{
+    m_tile_size = tile_size;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a storage of the matrix.
+ *  @param  storage [in] storage (FileStorage: memory-mapped file for the large matrix)
+ */
+/*===========================================================================*/
+void DistanceMatrix::setStorage( const Storage storage )
+{
+    m_storage = storage;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a filename of the memory-mapped file.
+ *  @param  filename [in] filename (empty: temporary file removed when released)
+ */
+/*===========================================================================*/
+void DistanceMatrix::setFilename( const std::string& filename )
+{
+    m_filename = filename;
+}
+
+void DistanceMatrix::enableSquaredDistance()
+{
+    m_enable_squared_distance = true;
+}
+
+void DistanceMatrix::disableSquaredDistance()
+{
+    m_enable_squared_distance = false;
+}
+
+bool DistanceMatrix::isEnabledSquaredDistance() const
+{
+    return m_enable_squared_distance;
+}
+
+size_t DistanceMatrix::size() const
+{
+    return m_nrows;
+}
+
+size_t DistanceMatrix::numberOfElements() const
+{
+    return m_nrows * ( m_nrows + 1 ) / 2;
+}
+
+kvs::Real32* DistanceMatrix::data()
+{
+    return m_file.isOpen() ? static_cast<kvs::Real32*>( m_file.data() ) : m_values.data();
+}
+
+const kvs::Real32* DistanceMatrix::data() const
+{
+    return m_file.isOpen() ? static_cast<const kvs::Real32*>( m_file.data() ) : m_values.data();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the distance between the rows.
+ *  @param  i [in] row index
+ *  @param  j [in] row index
+ *  @return distance (squared distance if enabled)
+ */
+/*===========================================================================*/
+kvs::Real32 DistanceMatrix::at( const size_t i, const size_t j ) const
+{
+    return i <= j ? this->data()[ PackedIndex( m_nrows, i, j ) ] : this->data()[ PackedIndex( m_nrows, j, i ) ];
+}
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
@@ -0,0 +1,112 @@
+/*****************************************************************************/
+/**
+ *  @file   DistanceMatrix.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__PCS__DISTANCE_MATRIX_H_INCLUDE
+#define KVSOCEANVIS__PCS__DISTANCE_MATRIX_H_INCLUDE
+
+#include <string>
+#include <kvs/Type>
+#include <kvs/ValueArray>
+#include <kvs/TableObject>
+#include "../util/MappedFile.h"
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Pairwise Euclidean distance matrix class.
+ *
+ *  The distances between the rows are calculated tile by tile in parallel,
+ *  where the dot products of the rows in a pair of tiles are calculated as a
+ *  small matrix product and the distances are given by |x|^2 + |y|^2 - 2 x.y.
+ *  The upper triangle of the matrix (including the diagonal) is stored by
+ *  rows in the memory or in the memory-mapped file.
+ */
+/*===========================================================================*/
+class DistanceMatrix
+{
+public:
+
+    enum Storage
+    {
+        MemoryStorage,
+        FileStorage
+    };
+
+private:
+
+    size_t m_nrows; ///< number of rows (matrix size)
+    size_t m_tile_size; ///< number of rows in a tile
+    bool m_enable_squared_distance; ///< store the squared distances
+    Storage m_storage; ///< storage of the matrix
+    std::string m_filename; ///< filename of the mapped file (empty: temporary file)
+    kvs::ValueArray<kvs::Real32> m_values; ///< packed upper triangle in the memory
+    util::MappedFile m_file; ///< packed upper triangle in the mapped file
+
+public:
+
+    DistanceMatrix();
+
+public:
+
+    bool compute( const kvs::TableObject* table );
+    bool compute( const kvs::Real32* data, const size_t nrows, const size_t ncolumns );
+    bool allocate( const size_t nrows );
+    void release();
+
+    void setTileSize( const size_t tile_size );
+    void setStorage( const Storage storage );
+    void setFilename( const std::string& filename );
+    void enableSquaredDistance();
+    void disableSquaredDistance();
+
+    bool isEnabledSquaredDistance() const;
+    size_t size() const;
+    size_t numberOfElements() const;
+    kvs::Real32* data();
+    const kvs::Real32* data() const;
+    kvs::Real32 at( const size_t i, const size_t j ) const;
+
+    static size_t PackedIndex( const size_t n, const size_t i, const size_t j );
+
+private:
+
+    DistanceMatrix( const DistanceMatrix& );
+    DistanceMatrix& operator =( const DistanceMatrix& );
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the index of the element in the packed upper triangle.
+ *  @param  n [in] matrix size
+ *  @param  i [in] row index
+ *  @param  j [in] column index (j >= i)
+ *  @return index of the element (i,j)
+ */
+/*===========================================================================*/
+inline size_t DistanceMatrix::PackedIndex( const size_t n, const size_t i, const size_t j )
+{
+    return i * ( 2 * n - i + 1 ) / 2 + ( j - i );
+}
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__PCS__DISTANCE_MATRIX_H_INCLUDE
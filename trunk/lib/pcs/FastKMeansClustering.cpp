@@ -13,6 +13,10 @@
  */
 /*****************************************************************************/
 #include "FastKMeansClustering.h"
+#include "ClusteringUtility.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
 #include <kvs/Value>
 
 
@@ -21,128 +25,49 @@ namespace
 
 /*===========================================================================*/
 /**
- *  @brief  Returns the row array of the table data specified by the given index.
- *  @param  table [in] pointer to the table data
- *  @param  i [in] row index
- */
-/*===========================================================================*/
-kvs::ValueArray<kvs::Real32> GetRowArray(
-    const kvs::TableObject* table,
-    const size_t i )
-{
-    kvs::ValueArray<kvs::Real32> row( table->numberOfColumns() );
-    const size_t ncolumns = table->numberOfColumns();
-    for ( size_t j = 0; j < ncolumns; j++ )
-    {
-        row[j] = table->column(j).at<kvs::Real32>(i);
-    }
-
-    return row;
-}
-
-/*===========================================================================*/
-/**
- *  @brief  Returns the distance between the given points.
- *  @param  x0 [in] point 0
- *  @param  x1 [in] point 1
- *  @return distance
+ *  @brief  Initializes the centers with rows selected randomly.
+ *  @param  x [in] pointer to the table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  nclusters [in] number of clusters
+ *  @param  random [in] random number generator
+ *  @param  c [out] pointer to the centers packed in row-major order
  */
 /*===========================================================================*/
-kvs::Real32 GetEuclideanDistance(
-    const kvs::ValueArray<kvs::Real32>& x0,
-    const kvs::ValueArray<kvs::Real32>& x1 )
-{
-    kvs::Real32 distance = 0.0f;
-    const size_t nrows = x0.size();
-    for ( size_t i = 0; i < nrows; i++ )
-    {
-        const kvs::Real32 diff = x1[i] - x0[i];
-        distance += diff * diff;
-    }
-
-    return distance;
-}
-
 void InitializeCenterWithRandomSeeding(
-    const kvs::TableObject* table,
+    const kvs::Real32* x,
+    const size_t nrows,
+    const size_t ncolumns,
     const size_t nclusters,
     kvs::MersenneTwister& random,
-    kvs::ValueArray<kvs::Real32>* center )
+    kvs::Real32* c )
 {
-    const size_t nrows = table->numberOfRows();
     for ( size_t i = 0; i < nclusters; i++ )
     {
-        const kvs::UInt32 index = nrows * random.rand();
-        center[i] = GetRowArray( table, index );
-    }
-}
-
-void InitializeCenterWithSmartSeeding(
-    const kvs::TableObject* table,
-    const size_t nclusters,
-    kvs::MersenneTwister& random,
-    kvs::ValueArray<kvs::Real32>* center )
-{
-    const size_t nrows = table->numberOfRows();
-    const size_t ncolumns = table->numberOfColumns();
-    const kvs::UInt32 index = nrows * random.rand();
-    center[0] = GetRowArray( table, index );
-
-    for ( size_t i = 1; i < nclusters; i++ )
-    {
-        kvs::Real32 S = 0.0;
-        kvs::Real32 D[ nrows ];
-        for ( size_t j = 0; j < nrows; j++ )
-        {
-            kvs::Real32 distance = kvs::Value<kvs::Real32>::Max();
-            for ( size_t k = 0; k < nclusters; k++ )
-            {
-                const kvs::Real32 d = ::GetEuclideanDistance( GetRowArray( table, j ), center[k] );
-                if ( d < distance ) { distance = d; }
-            }
-            D[j] = distance;
-            S += distance * distance;
-        }
-
-        size_t index = 0;
-        kvs::Real32 P = 0.0;
-        for ( size_t j = 0; j < nrows; j++ )
-        {
-            const kvs::Real32 DD = D[j] * D[j];
-            if ( P < kvs::Math::Max( P, DD / S ) )
-            {
-                P = DD / S;
-                index = j;
-            }
-        }
-
-        for ( size_t j = 0; j < ncolumns; j++ )
-        {
-            center[i].at(j) = table->column(j).at<kvs::Real32>(index);
-        }
+        const size_t index = kvs::Math::Min( size_t( nrows * random.rand() ), nrows - 1 );
+        std::copy( x + index * ncolumns, x + ( index + 1 ) * ncolumns, c + i * ncolumns );
     }
 }
 
-}
-
-namespace
-{
-
 /*===========================================================================*/
 /**
  *  @brief  Updates upper and lower bounds and index of the center over all centers.
  *  @param  nclusters [in] number of clusters
+ *  @param  ncolumns [in] number of columns
  *  @param  xi [in] data point at i-th row in the table data
- *  @param  c [in] set of centers
+ *  @param  c [in] pointer to the centers packed in row-major order
  *  @param  ai [out] index of the centers for xi
  *  @param  ui [out] upper bound for xi
  *  @param  li [out] lower bound for xi
+ *
+ *  The closest and the second closest centers are found in a single pass.
  */
 /*===========================================================================*/
 void PointAllCtrs(
     const size_t nclusters,
-    const kvs::ValueArray<kvs::Real32>& xi,
-    const kvs::ValueArray<kvs::Real32>* c,
+    const size_t ncolumns,
+    const kvs::Real32* xi,
+    const kvs::Real32* c,
     kvs::UInt32& ai,
     kvs::Real32& ui,
     kvs::Real32& li )
@@ -150,40 +75,39 @@ void PointAllCtrs(
     // Algorithm 3: POINT-ALL-CTRS( x(i), c, a(i), u(i), l(i) )
 
     kvs::UInt32 index = 0;
-    kvs::Real32 dmin = kvs::Value<kvs::Real32>::Max();
+    kvs::Real32 dmin1 = kvs::Value<kvs::Real32>::Max();
+    kvs::Real32 dmin2 = kvs::Value<kvs::Real32>::Max();
     for ( size_t j = 0; j < nclusters; j++ )
     {
-        const kvs::Real32 d = ::GetEuclideanDistance( xi, c[j] );
-        if ( d < dmin )
+        const kvs::Real32 d = kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( xi, c + j * ncolumns, ncolumns );
+        if ( d < dmin1 )
         {
-            dmin = d;
+            dmin2 = dmin1;
+            dmin1 = d;
             index = static_cast<kvs::UInt32>(j);
         }
-    }
-    ai = index;
-
-    ui = ::GetEuclideanDistance( xi, c[ai] );
-
-    dmin = kvs::Value<kvs::Real32>::Max();
-    for ( size_t j = 0; j < nclusters; j++ )
-    {
-        if ( j != ai )
+        else if ( d < dmin2 )
         {
-            const kvs::Real32 d = ::GetEuclideanDistance( xi, c[j] );
-            dmin = kvs::Math::Min( dmin, d );
+            dmin2 = d;
         }
     }
-    li = dmin;
+
+    ai = index;
+    ui = std::sqrt( dmin1 );
+    li = ( nclusters > 1 ) ? std::sqrt( dmin2 ) : kvs::Value<kvs::Real32>::Max();
 }
 
 /*===========================================================================*/
 /**
  *  @brief  Initializes the upper and lower bounds and the assignments.
  *  @param  nclusters [in] number of clusters
- *  @param  table [in] pointer to the table data
- *  @param  c [in] set of cluster centers
- *  @param  q [out] number of points
- *  @param  cp [out] vector sum of all points
+ *  @param  x [in] pointer to the table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  w [in] pointer to the weights of the points (NULL: unweighted)
+ *  @param  c [in] pointer to the centers packed in row-major order
+ *  @param  q [out] (weighted) number of points
+ *  @param  cp [out] (weighted) vector sum of all points
  *  @param  u [out] upper bound
  *  @param  l [out] lower bound
  *  @param  a [out] index of the center
@@ -191,33 +115,36 @@ void PointAllCtrs(
 /*===========================================================================*/
 void Initialize(
     const size_t nclusters,
-    const kvs::TableObject* table,
-    const kvs::ValueArray<kvs::Real32>* c,
-    kvs::ValueArray<kvs::UInt32>& q,
-    kvs::ValueArray<kvs::Real32>* cp,
+    const kvs::Real32* x,
+    const size_t nrows,
+    const size_t ncolumns,
+    const kvs::Real32* w,
+    const kvs::Real32* c,
+    kvs::ValueArray<kvs::Real64>& q,
+    kvs::ValueArray<kvs::Real64>& cp,
     kvs::ValueArray<kvs::Real32>& u,
     kvs::ValueArray<kvs::Real32>& l,
     kvs::ValueArray<kvs::UInt32>& a )
 {
     // Algorithm 2: INITIALIZE( c, x, q, c', u, l, a )
 
-    for ( size_t j = 0; j < nclusters; j++ )
+    q.fill( 0x00 );
+    cp.fill( 0x00 );
+
+    const kvs::Int64 n = static_cast<kvs::Int64>( nrows );
+    #pragma omp parallel for schedule(static)
+    for ( kvs::Int64 i = 0; i < n; i++ )
     {
-        q[j] = 0;
-        cp[j].fill( 0x00 );
+        ::PointAllCtrs( nclusters, ncolumns, x + i * ncolumns, c, a[i], u[i], l[i] );
     }
 
-    const size_t nrows = table->numberOfRows();
-    const size_t ncolumns = table->numberOfColumns();
     for ( size_t i = 0; i < nrows; i++ )
     {
-        const kvs::ValueArray<kvs::Real32> xi = ::GetRowArray( table, i );
-        PointAllCtrs( nclusters, xi, c, a[i], u[i], l[i] );
-        q[a[i]] += 1;
-        for ( size_t k = 0; k < ncolumns; k++ )
-        {
-            cp[a[i]][k] += xi[k];
-        }
+        const kvs::Real32* xi = x + i * ncolumns;
+        const kvs::Real64 wi = w ? w[i] : 1.0;
+        kvs::Real64* cpi = cp.data() + a[i] * ncolumns;
+        for ( size_t k = 0; k < ncolumns; k++ ) { cpi[k] += wi * xi[k]; }
+        q[a[i]] += wi;
     }
 }
 
@@ -226,32 +153,36 @@ void Initialize(
  *  @brief  Updates the center locations.
  *  @param  cp [in] set of the vector sum of all points
  *  @param  q [in] array of the number of points
+ *  @param  ncolumns [in] number of columns
  *  @param  c [out] updated cluster centers
  *  @param  p [out] array of the distance that the cluster center moved
  */
 /*===========================================================================*/
 void MoveCenters(
-    const kvs::ValueArray<kvs::Real32>* cp,
-    const kvs::ValueArray<kvs::UInt32>& q,
-    kvs::ValueArray<kvs::Real32>* c,
+    const kvs::ValueArray<kvs::Real64>& cp,
+    const kvs::ValueArray<kvs::Real64>& q,
+    const size_t ncolumns,
+    kvs::ValueArray<kvs::Real32>& c,
     kvs::ValueArray<kvs::Real32>& p )
 {
     // Algorithm 4: MOVE-CENTERS( c', q, c, p )
 
+    std::vector<kvs::Real32> cs( ncolumns );
     const size_t nclusters = q.size();
     for ( size_t j = 0; j < nclusters; j++ )
     {
-//        kvs::ValueArray<kvs::Real32> cs;
-//        cs.deepCopy( c[j] );
-        kvs::ValueArray<kvs::Real32> cs = c[j].clone();
+        // The center of the empty cluster is kept in the current position.
+        if ( !( q[j] > 0.0 ) ) { p[j] = 0.0f; continue; }
+
+        kvs::Real32* cj = c.data() + j * ncolumns;
+        std::copy( cj, cj + ncolumns, cs.begin() );
 
-        const size_t nrows = cp[j].size();
-        const kvs::Real32 qj = static_cast<kvs::Real32>( q[j] );
-        for ( size_t k = 0; k < nrows; k++ )
+        const kvs::Real64 qj = q[j];
+        for ( size_t k = 0; k < ncolumns; k++ )
         {
-            c[j][k] = cp[j][k] / qj;
+            cj[k] = static_cast<kvs::Real32>( cp[ j * ncolumns + k ] / qj );
         }
-        p[j] = ::GetEuclideanDistance( cs, c[j] );
+        p[j] = std::sqrt( kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( &cs[0], cj, ncolumns ) );
     }
 }
 
@@ -272,35 +203,20 @@ void UpdateBounds(
 {
     // Algorithm 5: UPDATE-BOUNDS( p, a, u, l )
 
-    kvs::Real32 r = 0.0f;
-    kvs::Real32 rp = 0.0f;
-
-    kvs::Real32 pmax = kvs::Value<kvs::Real32>::Min();
+    // r: index of the center that moved the most
+    // rp: index of the center that moved the second most
+    size_t r = 0;
+    size_t rp = 0;
     const size_t nclusters = p.size();
-    for ( size_t j = 0; j < nclusters; j++ )
+    for ( size_t j = 1; j < nclusters; j++ )
     {
-        if ( p[j] > pmax )
-        {
-            pmax = p[j];
-            r = j;
-        }
+        if ( p[j] > p[r] ) { rp = r; r = j; }
+        else if ( rp == r || p[j] > p[rp] ) { rp = j; }
     }
 
-    pmax = kvs::Value<kvs::Real32>::Min();
-    for ( size_t j = 0; j < nclusters; j++ )
-    {
-        if ( j != r )
-        {
-            if ( p[j] > pmax )
-            {
-                pmax = p[j];
-                rp = j;
-            }
-        }
-    }
-
-    const size_t nrows = u.size();
-    for ( size_t i = 0; i < nrows; i++ )
+    const kvs::Int64 nrows = static_cast<kvs::Int64>( u.size() );
+    #pragma omp parallel for schedule(static)
+    for ( kvs::Int64 i = 0; i < nrows; i++ )
     {
         u[i] += p[a[i]];
         l[i] -= ( r == a[i] ) ? p[rp] : p[r];
@@ -309,53 +225,117 @@ void UpdateBounds(
 
 /*===========================================================================*/
 /**
- *  @brief  Updates the number of points specified by the given index.
- *  @param  m [in] index of the center
- *  @param  a [in] array of index of the center
- *  @param  q [in/out] updated the array of the number of points
+ *  @brief  Calculates the half of the distance from each center to its closest other center.
+ *  @param  c [in] pointer to the centers packed in row-major order
+ *  @param  nclusters [in] number of clusters
+ *  @param  ncolumns [in] number of columns
+ *  @param  s [out] half of the distance to the closest other center
  */
 /*===========================================================================*/
-void Update(
-    const size_t m,
-    const kvs::ValueArray<kvs::UInt32>& a,
-    kvs::ValueArray<kvs::UInt32>& q )
+void UpdateHalfDistances(
+    const kvs::Real32* c,
+    const size_t nclusters,
+    const size_t ncolumns,
+    kvs::ValueArray<kvs::Real32>& s )
 {
-    size_t counter = 0;
-    const size_t nrows = a.size();
-    for ( size_t i = 0; i < nrows; i++ )
+    for ( size_t j = 0; j < nclusters; j++ ) { s[j] = kvs::Value<kvs::Real32>::Max(); }
+
+    for ( size_t j = 0; j < nclusters; j++ )
     {
-        if ( a[i] == m ) counter++;
+        for ( size_t jp = j + 1; jp < nclusters; jp++ )
+        {
+            const kvs::Real32 d = kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( c + j * ncolumns, c + jp * ncolumns, ncolumns );
+            s[j] = kvs::Math::Min( s[j], d );
+            s[jp] = kvs::Math::Min( s[jp], d );
+        }
     }
 
-    q[m] = counter;
+    for ( size_t j = 0; j < nclusters; j++ )
+    {
+        if ( s[j] < kvs::Value<kvs::Real32>::Max() ) { s[j] = 0.5f * std::sqrt( s[j] ); }
+    }
 }
 
 /*===========================================================================*/
 /**
- *  @brief  Updates the vector sum of all points specified by the given index.
- *  @param  m [in] index of the center
- *  @param  table [in] pointer to the table data
- *  @param  a [in] array of index of the center
- *  @param  cp [out] set of the vector sum of all points
+ *  @brief  Reassigns the points whose bounds do not hold.
+ *  @param  nclusters [in] number of clusters
+ *  @param  x [in] pointer to the table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  w [in] pointer to the weights of the points (NULL: unweighted)
+ *  @param  c [in] pointer to the centers packed in row-major order
+ *  @param  s [in] half of the distance to the closest other center
+ *  @param  q [in/out] number of points
+ *  @param  cp [in/out] vector sum of all points
+ *  @param  u [in/out] upper bound
+ *  @param  l [in/out] lower bound
+ *  @param  a [in/out] index of the center
+ *
+ *  The rows are split across the threads. When a point changes its cluster,
+ *  the point is subtracted from the sum of the old cluster and added to the
+ *  sum of the new one in the per-thread buffers, which are merged into cp
+ *  and q at the end of the pass.
  */
 /*===========================================================================*/
-void Update(
-    const size_t m,
-    const kvs::TableObject* table,
-    const kvs::ValueArray<kvs::UInt32>& a,
-    kvs::ValueArray<kvs::Real32>* cp )
+void AssignPoints(
+    const size_t nclusters,
+    const kvs::Real32* x,
+    const size_t nrows,
+    const size_t ncolumns,
+    const kvs::Real32* w,
+    const kvs::Real32* c,
+    const kvs::ValueArray<kvs::Real32>& s,
+    kvs::ValueArray<kvs::Real64>& q,
+    kvs::ValueArray<kvs::Real64>& cp,
+    kvs::ValueArray<kvs::Real32>& u,
+    kvs::ValueArray<kvs::Real32>& l,
+    kvs::ValueArray<kvs::UInt32>& a )
 {
-    const size_t nrows = a.size();
-    const size_t ncolumns = table->numberOfColumns();
-
-    cp[m].fill( 0x00 );
-    for ( size_t i = 0; i < nrows; i++ )
+    const kvs::Int64 n = static_cast<kvs::Int64>( nrows );
+    #pragma omp parallel
     {
-        if ( a[i] == m )
+        std::vector<kvs::Real64> dcp( nclusters * ncolumns, 0.0 );
+        std::vector<kvs::Real64> dq( nclusters, 0.0 );
+        bool changed = false;
+
+        #pragma omp for schedule(static)
+        for ( kvs::Int64 i = 0; i < n; i++ )
         {
-            for ( size_t k = 0; k < ncolumns; k++ )
+            const kvs::Real32 m = kvs::Math::Max( s[a[i]], l[i] );
+            if ( u[i] > m ) // First bound test.
             {
-                cp[m][k] += table->column(k).at<kvs::Real32>(i);
+                // Tighten upper bound.
+                const kvs::Real32* xi = x + i * ncolumns;
+                u[i] = std::sqrt( kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( xi, c + a[i] * ncolumns, ncolumns ) );
+                if ( u[i] > m ) // Second bound test.
+                {
+                    const kvs::UInt32 ap = a[i];
+                    ::PointAllCtrs( nclusters, ncolumns, xi, c, a[i], u[i], l[i] );
+                    if ( ap != a[i] )
+                    {
+                        const kvs::Real64 wi = w ? w[i] : 1.0;
+                        kvs::Real64* dcp_old = &dcp[ ap * ncolumns ];
+                        kvs::Real64* dcp_new = &dcp[ a[i] * ncolumns ];
+                        for ( size_t k = 0; k < ncolumns; k++ )
+                        {
+                            dcp_old[k] -= wi * xi[k];
+                            dcp_new[k] += wi * xi[k];
+                        }
+                        dq[ap] -= wi;
+                        dq[a[i]] += wi;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        if ( changed )
+        {
+            #pragma omp critical
+            {
+                for ( size_t j = 0; j < nclusters * ncolumns; j++ ) { cp[j] += dcp[j]; }
+                for ( size_t j = 0; j < nclusters; j++ ) { q[j] += dq[j]; }
             }
         }
     }
@@ -380,6 +360,9 @@ FastKMeansClustering::FastKMeansClustering():
     m_nclusters( 10 ),
     m_max_iterations( 100 ),
     m_tolerance( 1.e-6 ),
+    m_enable_weight( false ),
+    m_enable_selection( false ),
+    m_enable_warm_start( false ),
     m_centers( NULL )
 {
 }
@@ -396,6 +379,9 @@ FastKMeansClustering::FastKMeansClustering( const kvs::ObjectBase* object, const
     m_nclusters( nclusters ),
     m_max_iterations( 100 ),
     m_tolerance( 1.e-6 ),
+    m_enable_weight( false ),
+    m_enable_selection( false ),
+    m_enable_warm_start( false ),
     m_centers( NULL )
 {
     this->exec( object );
@@ -415,6 +401,9 @@ FastKMeansClustering::FastKMeansClustering( const kvs::ObjectBase* object, const
     m_nclusters( nclusters ),
     m_max_iterations( max_iterations ),
     m_tolerance( tolerance ),
+    m_enable_weight( false ),
+    m_enable_selection( false ),
+    m_enable_warm_start( false ),
     m_centers( NULL )
 {
     this->exec( object );
@@ -443,29 +432,62 @@ FastKMeansClustering::SuperClass* FastKMeansClustering::exec( const kvs::ObjectB
 
     // Input table object.
     const kvs::TableObject* table = static_cast<const kvs::TableObject*>( object );
-    const size_t nrows = table->numberOfRows();
-    const size_t ncolumns = table->numberOfColumns();
+    const bool selected = m_enable_selection;
+    const size_t nrows = selected ? m_selected_rows.size() : table->numberOfRows();
+    if ( selected && nrows == 0 )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("No rows are selected.");
+        return NULL;
+    }
+
+    const size_t ncolumns = table->numberOfColumns() - ( m_enable_weight ? 1 : 0 );
     const size_t nclusters = m_nclusters;
+    if ( nrows == 0 || nclusters == 0 || table->numberOfColumns() == 0 || ncolumns == 0 )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input table or number of clusters is empty.");
+        return NULL;
+    }
+
+    if ( selected && *std::max_element( m_selected_rows.begin(), m_selected_rows.end() ) >= table->numberOfRows() )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Selected row index is out of range.");
+        return NULL;
+    }
+
+    // Table data (only the selected rows) packed in row-major order, and the
+    // weights of the rows.
+    const kvs::ValueArray<kvs::Real32> x = pcs::ClusteringUtility::PackTable( table, ncolumns, m_selected_rows );
+    kvs::ValueArray<kvs::Real32> w;
+    if ( m_enable_weight )
+    {
+        const kvs::AnyValueArray& weights = table->column( ncolumns );
+        w.allocate( nrows );
+        for ( size_t i = 0; i < nrows; i++ ) { w[i] = weights.at<kvs::Real32>( selected ? m_selected_rows[i] : i ); }
+    }
+    const kvs::Real32* pw = m_enable_weight ? w.data() : NULL;
+    if ( x.size() != nrows * ncolumns )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Cannot pack the input table.");
+        return NULL;
+    }
 
     // Parameters that relate to cluster centers.
-    /*   c:  cluster center
-     *   cp: vector sum of all points in the cluster
-     *   q:  number of points assigned to the cluster
+    /*   c:  cluster center (packed in row-major order)
+     *   cp: (weighted) vector sum of all points in the cluster
+     *   q:  (weighted) number of points assigned to the cluster
      *   p:  distance that c last moved
-     *   s:  distance from c to its closest other center
+     *   s:  half of the distance from c to its closest other center
      */
-    kvs::ValueArray<kvs::Real32>* c = new kvs::ValueArray<kvs::Real32> [ nclusters ];
-    kvs::ValueArray<kvs::Real32>* cp = new kvs::ValueArray<kvs::Real32> [ nclusters ];
-    kvs::ValueArray<kvs::UInt32> q( nclusters );
+    kvs::ValueArray<kvs::Real32> c( nclusters * ncolumns );
+    kvs::ValueArray<kvs::Real64> cp( nclusters * ncolumns );
+    kvs::ValueArray<kvs::Real64> q( nclusters );
     kvs::ValueArray<kvs::Real32> p( nclusters );
     kvs::ValueArray<kvs::Real32> s( nclusters );
 
-    for ( size_t j = 0; j < nclusters; j++ )
-    {
-        c[j].allocate( ncolumns );
-        cp[j].allocate( ncolumns );
-    }
-
     // Parameters that relate to data points.
     /*   a:  index of the center to which the data point x is assigned
      *   u:  upper bound on the distance between the data point x and
@@ -479,95 +501,73 @@ FastKMeansClustering::SuperClass* FastKMeansClustering::exec( const kvs::ObjectB
     kvs::ValueArray<kvs::Real32> l( nrows );
 
     // Assign initial centers.
-    switch ( m_seeding_method )
+    /* NOTE: The given centers or the centers of the last execution are used
+     * as the initial centers if available. For the selected rows, the centers
+     * are restricted to the selection so that every cluster has the rows.
+     */
+    if ( m_initial_centers.size() == c.size() || ( m_enable_warm_start && m_packed_centers.size() == c.size() ) )
+    {
+        const kvs::ValueArray<kvs::Real32>& centers = ( m_initial_centers.size() == c.size() ) ? m_initial_centers : m_packed_centers;
+        std::copy( centers.begin(), centers.end(), c.begin() );
+        if ( selected ) { pcs::ClusteringUtility::RestrictCenters( x.data(), nrows, ncolumns, nclusters, c.data() ); }
+    }
+    else switch ( m_seeding_method )
     {
     case RandomSeeding:
-        ::InitializeCenterWithRandomSeeding( table, nclusters, m_random, c );
+        ::InitializeCenterWithRandomSeeding( x.data(), nrows, ncolumns, nclusters, m_random, c.data() );
         break;
     case SmartSeeding:
-        ::InitializeCenterWithSmartSeeding( table, nclusters, m_random, c );
+        pcs::ClusteringUtility::ScalableSeeding( x.data(), nrows, ncolumns, nclusters, m_random, c.data(), pw );
         break;
     default:
-        ::InitializeCenterWithRandomSeeding( table, nclusters, m_random, c );
+        ::InitializeCenterWithRandomSeeding( x.data(), nrows, ncolumns, nclusters, m_random, c.data() );
         break;
     }
 
     // Initialize.
-    ::Initialize( nclusters, table, c, q, cp, u, l, a );
-
-    // Cluster IDs.
-    kvs::ValueArray<kvs::UInt32> IDs;
+    ::Initialize( nclusters, x.data(), nrows, ncolumns, pw, c.data(), q, cp, u, l, a );
 
     // Clustering.
     bool converged = false;
     size_t counter = 0;
     while ( !converged )
     {
-        // Update s.
-        for ( size_t j = 0; j < nclusters; j++ )
-        {
-            kvs::Real32 dmin = kvs::Value<kvs::Real32>::Max();
-            for ( size_t jp = 0; jp < nclusters; jp++ )
-            {
-                if ( jp != j )
-                {
-                    const kvs::Real32 d = ::GetEuclideanDistance( c[jp], c[j] );
-                    dmin = kvs::Math::Min( dmin, d );
-                }
-            }
-            s[j] = dmin;
-        }
-
-        for ( size_t i = 0; i < nrows; i++ )
-        {
-            const kvs::Real32 m = kvs::Math::Max( s[a[i]] * 0.5f, l[i] );
-            if ( u[i] > m ) // First bound test.
-            {
-                // Tighten upper bound.
-                const kvs::ValueArray<kvs::Real32> xi = ::GetRowArray( table, i );
-                u[i] = ::GetEuclideanDistance( xi, c[a[i]] );
-                if ( u[i] > m ) // Second bound test.
-                {
-                    const kvs::UInt32 ap = a[i];
-                    ::PointAllCtrs( nclusters, xi, c, a[i], u[i], l[i] );
-                    if ( ap != a[i] )
-                    {
-                        ::Update( ap, a, q );
-                        ::Update( a[i], a, q );
-                        ::Update( ap, table, a, cp );
-                        ::Update( a[i], table, a, cp );
-                    }
-                }
-            }
-        }
-
-        ::MoveCenters( cp, q, c, p );
+        ::UpdateHalfDistances( c.data(), nclusters, ncolumns, s );
+        ::AssignPoints( nclusters, x.data(), nrows, ncolumns, pw, c.data(), s, q, cp, u, l, a );
+        ::MoveCenters( cp, q, ncolumns, c, p );
         ::UpdateBounds( p, a, u, l );
 
-        // Update cluster IDs.
-        IDs = a;
-
-        // Convergence test.
+        // Convergence test (the tolerance is given for the squared distance).
         converged = true;
         for ( size_t j = 0; j < nclusters; j++ )
         {
-            if ( !( p[j] < m_tolerance ) ) { converged = false; break; }
+            if ( !( p[j] * p[j] < m_tolerance ) ) { converged = false; break; }
         }
 
         if ( counter++ > m_max_iterations ) break;
     }
 
+    m_packed_centers = c;
     if ( m_centers ) delete [] m_centers;
-    m_centers = c;
+    m_centers = new kvs::ValueArray<kvs::Real32> [ nclusters ];
+    for ( size_t j = 0; j < nclusters; j++ )
+    {
+        m_centers[j].allocate( ncolumns );
+        std::copy( c.data() + j * ncolumns, c.data() + ( j + 1 ) * ncolumns, m_centers[j].begin() );
+    }
 
-    delete [] cp;
+    // Cluster IDs.
+    const kvs::ValueArray<kvs::UInt32>& IDs = a;
 
-    // Set the results to the output table object.
-    for ( size_t i = 0; i < ncolumns; i++ )
+    // Set the results to the output table object (only the selected rows).
+    // The columns of the last execution are cleared for the re-clustering.
+    SuperClass::setTableObject( kvs::TableObject() );
+    for ( size_t i = 0; i < table->numberOfColumns(); i++ )
     {
         const std::string label = table->label(i);
         const kvs::AnyValueArray& column = table->column(i);
-        SuperClass::addColumn( column, label );
+        if ( selected ) { SuperClass::addColumn( pcs::ClusteringUtility::SelectRows( column, m_selected_rows ), label ); }
+        else { SuperClass::addColumn( column, label ); }
     }
     SuperClass::addColumn( kvs::AnyValueArray( IDs ), "Cluster ID" );
 
@@ -617,6 +617,118 @@ void FastKMeansClustering::setTolerance( const float tolerance )
     m_tolerance = tolerance;
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Sets the initial centers instead of the seeding.
+ *  @param  centers [in] initial centers packed in row-major order
+ *
+ *  The given centers are used when the array has the centers for the number
+ *  of clusters, e.g. for warm-starting from the result of the other k.
+ */
+/*===========================================================================*/
+void FastKMeansClustering::setInitialCenters( const kvs::ValueArray<kvs::Real32>& centers )
+{
+    m_initial_centers = centers;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets the rows to be clustered.
+ *  @param  rows [in] indices of the selected rows
+ *
+ *  Only the selected rows are clustered without copying the input table,
+ *  e.g. for the rows brushed in the linked views. The output table has the
+ *  selected rows in the given order. The execution fails when no rows are
+ *  selected; call resetSelection() to cluster all the rows.
+ */
+/*===========================================================================*/
+void FastKMeansClustering::setSelectedRows( const kvs::ValueArray<kvs::UInt32>& rows )
+{
+    m_enable_selection = true;
+    m_selected_rows = rows;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets the rows to be clustered by the selection mask.
+ *  @param  mask [in] selection mask (non-zero: selected) for each row
+ */
+/*===========================================================================*/
+void FastKMeansClustering::setSelectionMask( const kvs::ValueArray<kvs::UInt8>& mask )
+{
+    m_enable_selection = true;
+    m_selected_rows = pcs::ClusteringUtility::SelectedRows( mask );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Resets the selection so that all the rows are clustered.
+ */
+/*===========================================================================*/
+void FastKMeansClustering::resetSelection()
+{
+    m_enable_selection = false;
+    m_selected_rows.release();
+}
+
+bool FastKMeansClustering::isEnabledSelection() const
+{
+    return m_enable_selection;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Enables the weighted clustering.
+ *
+ *  The last column of the input table is used as the weights of the rows
+ *  (e.g. the weighted points given by CoresetSampling) and is not included
+ *  in the dimensions of the clustering.
+ */
+/*===========================================================================*/
+void FastKMeansClustering::enableWeight()
+{
+    m_enable_weight = true;
+}
+
+void FastKMeansClustering::disableWeight()
+{
+    m_enable_weight = false;
+}
+
+bool FastKMeansClustering::isEnabledWeight() const
+{
+    return m_enable_weight;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Enables the warm start from the centers of the last execution.
+ *
+ *  The re-clustering of the selected rows converges in a few iterations by
+ *  starting from the centers of the whole rows, which are restricted to the
+ *  selection.
+ */
+/*===========================================================================*/
+void FastKMeansClustering::enableWarmStart()
+{
+    m_enable_warm_start = true;
+}
+
+void FastKMeansClustering::disableWarmStart()
+{
+    m_enable_warm_start = false;
+}
+
+bool FastKMeansClustering::isEnabledWarmStart() const
+{
+    return m_enable_warm_start;
+}
+
+const kvs::ValueArray<kvs::UInt32>& FastKMeansClustering::selectedRows() const
+{
+    return m_selected_rows;
+}
+
 size_t FastKMeansClustering::numberOfClusters() const
 {
     return m_nclusters;
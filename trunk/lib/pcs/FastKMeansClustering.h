@@ -19,6 +19,9 @@
  * [2] D. Arthur and S. Vassilvitskii, k-means++ : The Advantages of Careful
  *     Seeding, in Proceedings of the eighteenth annual ACM-SIAM symposium on
  *     Discrete algorithms, 2007, pp. 1027-1035.
+ * [3] B. Bahmani, B. Moseley, A. Vattani, R. Kumar and S. Vassilvitskii,
+ *     Scalable K-Means++, Proceedings of the VLDB Endowment, Vol. 5, No. 7,
+ *     2012, pp. 622-633.
  */
 /*****************************************************************************/
 #ifndef KVSOCEANVIS__PCS__FAST_K_MEANS_CLUSTERING_H_INCLUDE
@@ -39,6 +42,11 @@ namespace pcs
 /*===========================================================================*/
 /**
  *  @brief  Fast K-means clustering class.
+ *
+ *  Only this class can cluster a selection of the rows of the input table
+ *  (setSelectedRows or setSelectionMask). KMeansClustering,
+ *  FilteringKMeansClustering and YinyangKMeansClustering always cluster all
+ *  the rows.
  */
 /*===========================================================================*/
 class FastKMeansClustering : public kvs::FilterBase, public kvs::TableObject
@@ -63,6 +71,12 @@ protected:
     size_t m_nclusters; ///< number of clusters
     size_t m_max_iterations; ///< maximum number of interations
     float m_tolerance; ///< tolerance of distance
+    bool m_enable_weight; ///< use the last column as the weights of the rows
+    kvs::ValueArray<kvs::Real32> m_initial_centers; ///< given initial centers (packed in row-major order)
+    bool m_enable_selection; ///< cluster only the selected rows
+    kvs::ValueArray<kvs::UInt32> m_selected_rows; ///< indices of the rows to be clustered
+    bool m_enable_warm_start; ///< start from the centers of the last execution
+    kvs::ValueArray<kvs::Real32> m_packed_centers; ///< cluster centers of the last execution (packed in row-major order)
     kvs::ValueArray<kvs::Real32>* m_centers; ///< cluster centers
 
 public:
@@ -83,7 +97,19 @@ public:
     void setNumberOfClusters( const size_t nclusters );
     void setMaxIterations( const size_t max_iterations );
     void setTolerance( const float tolerance );
-
+    void setInitialCenters( const kvs::ValueArray<kvs::Real32>& centers );
+    void setSelectedRows( const kvs::ValueArray<kvs::UInt32>& rows );
+    void setSelectionMask( const kvs::ValueArray<kvs::UInt8>& mask );
+    void resetSelection();
+    void enableWeight();
+    void disableWeight();
+    void enableWarmStart();
+    void disableWarmStart();
+
+    bool isEnabledWeight() const;
+    bool isEnabledWarmStart() const;
+    bool isEnabledSelection() const;
+    const kvs::ValueArray<kvs::UInt32>& selectedRows() const;
     size_t numberOfClusters() const;
     const kvs::ValueArray<kvs::Real32>& center( const size_t index ) const;
 };
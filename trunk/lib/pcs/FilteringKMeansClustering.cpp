@@ -0,0 +1,754 @@
+/*****************************************************************************/
+/**
+ *  @file   FilteringKMeansClustering.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "FilteringKMeansClustering.h"
+#include "ClusteringUtility.h"
+#include <vector>
+#include <algorithm>
+#include <kvs/Value>
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Node of the kd-tree.
+ */
+/*===========================================================================*/
+struct Node
+{
+    size_t begin; ///< first row of the node (in the order of the tree)
+    size_t end; ///< last row + 1 of the node (in the order of the tree)
+    kvs::Int64 left; ///< index of the left child node (-1: leaf node)
+    kvs::Int64 right; ///< index of the right child node (-1: leaf node)
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  kd-tree over the rows packed in row-major order.
+ *
+ *  The rows are reordered so that the rows of each node are contiguous, and
+ *  each node has the bounding box and the vector sum of its rows.
+ */
+/*===========================================================================*/
+class KdTree
+{
+public:
+
+    size_t ncolumns; ///< number of columns
+    size_t depth; ///< depth of the tree
+    std::vector<Node> nodes; ///< nodes (the root node is nodes[0])
+    std::vector<kvs::Real32> bounds; ///< min. and max. corners of the bounding box of each node
+    std::vector<kvs::Real64> sums; ///< vector sum of the rows of each node
+    std::vector<size_t> indices; ///< row indices of the original table in the order of the tree
+    kvs::ValueArray<kvs::Real32> data; ///< rows in the order of the tree
+
+public:
+
+    const kvs::Real32* min( const size_t node ) const { return &bounds[ node * 2 * ncolumns ]; }
+    const kvs::Real32* max( const size_t node ) const { return &bounds[ node * 2 * ncolumns + ncolumns ]; }
+    const kvs::Real64* sum( const size_t node ) const { return &sums[ node * ncolumns ]; }
+    const kvs::Real32* row( const size_t index ) const { return data.data() + index * ncolumns; }
+
+    void build( const kvs::Real32* x, const size_t nrows, const size_t ncolumns, const size_t leaf_size );
+
+private:
+
+    size_t build_node( const kvs::Real32* x, const size_t begin, const size_t end, const size_t leaf_size, const size_t level );
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Comparison of the rows by the value of the given column.
+ */
+/*===========================================================================*/
+struct LessInColumn
+{
+    const kvs::Real32* x;
+    size_t ncolumns;
+    size_t column;
+
+    LessInColumn( const kvs::Real32* x, const size_t ncolumns, const size_t column ):
+        x( x ), ncolumns( ncolumns ), column( column ) {}
+
+    bool operator () ( const size_t i, const size_t j ) const
+    {
+        return x[ i * ncolumns + column ] < x[ j * ncolumns + column ];
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Builds the kd-tree.
+ *  @param  x [in] pointer to the table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  leaf_size [in] maximum number of rows in a leaf node
+ */
+/*===========================================================================*/
+void KdTree::build( const kvs::Real32* x, const size_t nrows, const size_t ncolumns, const size_t leaf_size )
+{
+    this->ncolumns = ncolumns;
+    this->depth = 0;
+    nodes.clear();
+    bounds.clear();
+    sums.clear();
+
+    indices.resize( nrows );
+    for ( size_t i = 0; i < nrows; i++ ) { indices[i] = i; }
+
+    this->build_node( x, 0, nrows, kvs::Math::Max( leaf_size, size_t(1) ), 1 );
+
+    // Reorder the rows so that the rows of each node are contiguous.
+    data.allocate( nrows * ncolumns );
+    const kvs::Int64 n = static_cast<kvs::Int64>( nrows );
+    #pragma omp parallel for schedule(static)
+    for ( kvs::Int64 i = 0; i < n; i++ )
+    {
+        const kvs::Real32* src = x + indices[i] * ncolumns;
+        std::copy( src, src + ncolumns, data.data() + i * ncolumns );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Builds the node for the given range of the rows recursively.
+ *  @param  x [in] pointer to the table data packed in row-major order
+ *  @param  begin [in] first row of the node
+ *  @param  end [in] last row + 1 of the node
+ *  @param  leaf_size [in] maximum number of rows in a leaf node
+ *  @param  level [in] level of the node (the root node is 1)
+ *  @return index of the node
+ *
+ *  The rows are split at the median of the widest column of the box.
+ */
+/*===========================================================================*/
+size_t KdTree::build_node( const kvs::Real32* x, const size_t begin, const size_t end, const size_t leaf_size, const size_t level )
+{
+    const size_t index = nodes.size();
+    depth = kvs::Math::Max( depth, level );
+    Node node = { begin, end, -1, -1 };
+    nodes.push_back( node );
+    bounds.resize( bounds.size() + 2 * ncolumns );
+    sums.resize( sums.size() + ncolumns, 0.0 );
+
+    kvs::Real32* bmin = &bounds[ index * 2 * ncolumns ];
+    kvs::Real32* bmax = bmin + ncolumns;
+    kvs::Real64* sum = &sums[ index * ncolumns ];
+    std::copy( x + indices[ begin ] * ncolumns, x + ( indices[ begin ] + 1 ) * ncolumns, bmin );
+    std::copy( bmin, bmin + ncolumns, bmax );
+    for ( size_t i = begin; i < end; i++ )
+    {
+        const kvs::Real32* xi = x + indices[i] * ncolumns;
+        for ( size_t k = 0; k < ncolumns; k++ )
+        {
+            bmin[k] = kvs::Math::Min( bmin[k], xi[k] );
+            bmax[k] = kvs::Math::Max( bmax[k], xi[k] );
+            sum[k] += xi[k];
+        }
+    }
+
+    if ( end - begin <= leaf_size ) return index;
+
+    size_t column = 0;
+    for ( size_t k = 1; k < ncolumns; k++ )
+    {
+        if ( bmax[k] - bmin[k] > bmax[column] - bmin[column] ) column = k;
+    }
+
+    // All the rows in the node are at the same position.
+    if ( !( bmax[column] > bmin[column] ) ) return index;
+
+    const size_t middle = begin + ( end - begin ) / 2;
+    std::nth_element(
+        indices.begin() + begin,
+        indices.begin() + middle,
+        indices.begin() + end,
+        ::LessInColumn( x, ncolumns, column ) );
+
+    // NOTE: 'nodes' may be reallocated in the recursion.
+    const kvs::Int64 left = static_cast<kvs::Int64>( this->build_node( x, begin, middle, leaf_size, level + 1 ) );
+    const kvs::Int64 right = static_cast<kvs::Int64>( this->build_node( x, middle, end, leaf_size, level + 1 ) );
+    nodes[ index ].left = left;
+    nodes[ index ].right = right;
+
+    return index;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the center z is farther than z* from every point in the box.
+ *  @param  z [in] pointer to the center z
+ *  @param  zstar [in] pointer to the center z*
+ *  @param  bmin [in] min. corner of the box
+ *  @param  bmax [in] max. corner of the box
+ *  @param  ncolumns [in] number of columns
+ *  @return true if z can be pruned
+ *
+ *  It is enough to test the vertex of the box that is extreme in the direction
+ *  from z* to z.
+ */
+/*===========================================================================*/
+inline bool IsFarther(
+    const kvs::Real32* z,
+    const kvs::Real32* zstar,
+    const kvs::Real32* bmin,
+    const kvs::Real32* bmax,
+    const size_t ncolumns )
+{
+    kvs::Real32 dz = 0.0f;
+    kvs::Real32 dzstar = 0.0f;
+    for ( size_t k = 0; k < ncolumns; k++ )
+    {
+        const kvs::Real32 v = ( z[k] > zstar[k] ) ? bmax[k] : bmin[k];
+        const kvs::Real32 d0 = z[k] - v;
+        const kvs::Real32 d1 = zstar[k] - v;
+        dz += d0 * d0;
+        dzstar += d1 * d1;
+    }
+
+    return dz >= dzstar;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Filtering pass over the kd-tree.
+ *
+ *  The sums and the counts are accumulated for each thread. The cluster IDs
+ *  are written (in the order of the tree) only when the ID array is given.
+ */
+/*===========================================================================*/
+class Filter
+{
+private:
+
+    const KdTree& m_tree; ///< kd-tree
+    const kvs::Real32* m_centers; ///< centers packed in row-major order
+    const size_t m_nclusters; ///< number of clusters
+    kvs::Real64* m_sums; ///< vector sum of the rows for each cluster
+    kvs::Real64* m_counts; ///< number of the rows for each cluster
+    kvs::UInt32* m_ids; ///< cluster IDs (NULL: not written)
+    std::vector<kvs::UInt32> m_candidates; ///< candidate centers for each level of the tree
+    std::vector<kvs::Real32> m_midpoint; ///< midpoint of the box
+
+public:
+
+    Filter(
+        const KdTree& tree,
+        const kvs::Real32* centers,
+        const size_t nclusters,
+        kvs::Real64* sums,
+        kvs::Real64* counts,
+        kvs::UInt32* ids ):
+        m_tree( tree ),
+        m_centers( centers ),
+        m_nclusters( nclusters ),
+        m_sums( sums ),
+        m_counts( counts ),
+        m_ids( ids ),
+        m_midpoint( tree.ncolumns )
+    {
+    }
+
+    void run( const size_t node );
+
+private:
+
+    void filter( const size_t node, const kvs::UInt32* candidates, const size_t ncandidates, const size_t level );
+    void assign( const size_t begin, const size_t end, const kvs::UInt32* candidates, const size_t ncandidates );
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Runs the filtering for the subtree with all the centers as the candidates.
+ *  @param  node [in] index of the root node of the subtree
+ */
+/*===========================================================================*/
+void Filter::run( const size_t node )
+{
+    // The candidates for each level of the tree are stored in a single buffer.
+    if ( m_candidates.empty() ) { m_candidates.resize( ( m_tree.depth + 1 ) * m_nclusters ); }
+    for ( size_t j = 0; j < m_nclusters; j++ ) { m_candidates[j] = static_cast<kvs::UInt32>( j ); }
+    this->filter( node, &m_candidates[0], m_nclusters, 1 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Prunes the candidates for the node and recurses to the children.
+ *  @param  node [in] index of the node
+ *  @param  candidates [in] candidate centers of the node
+ *  @param  ncandidates [in] number of the candidates
+ *  @param  level [in] level in the candidate buffer for the children
+ */
+/*===========================================================================*/
+void Filter::filter( const size_t node, const kvs::UInt32* candidates, const size_t ncandidates, const size_t level )
+{
+    const Node& n = m_tree.nodes[ node ];
+    if ( n.left < 0 )
+    {
+        this->assign( n.begin, n.end, candidates, ncandidates );
+        return;
+    }
+
+    // Candidate closest to the midpoint of the box.
+    const size_t ncolumns = m_tree.ncolumns;
+    const kvs::Real32* bmin = m_tree.min( node );
+    const kvs::Real32* bmax = m_tree.max( node );
+    for ( size_t k = 0; k < ncolumns; k++ ) { m_midpoint[k] = 0.5f * ( bmin[k] + bmax[k] ); }
+
+    kvs::UInt32 zstar = candidates[0];
+    kvs::Real32 dmin = kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( &m_midpoint[0], m_centers + zstar * ncolumns, ncolumns );
+    for ( size_t j = 1; j < ncandidates; j++ )
+    {
+        const kvs::Real32 d = kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( &m_midpoint[0], m_centers + candidates[j] * ncolumns, ncolumns );
+        if ( d < dmin ) { dmin = d; zstar = candidates[j]; }
+    }
+
+    // Prune the candidates that are farther than z* from the whole box.
+    kvs::UInt32* next = &m_candidates[ level * m_nclusters ];
+    size_t nnext = 0;
+    const kvs::Real32* cstar = m_centers + zstar * ncolumns;
+    for ( size_t j = 0; j < ncandidates; j++ )
+    {
+        const kvs::UInt32 z = candidates[j];
+        if ( z == zstar || !::IsFarther( m_centers + z * ncolumns, cstar, bmin, bmax, ncolumns ) )
+        {
+            next[ nnext++ ] = z;
+        }
+    }
+
+    // All the rows in the node are assigned to z*.
+    if ( nnext == 1 )
+    {
+        const kvs::Real64* sum = m_tree.sum( node );
+        kvs::Real64* s = m_sums + zstar * ncolumns;
+        for ( size_t k = 0; k < ncolumns; k++ ) { s[k] += sum[k]; }
+        m_counts[ zstar ] += static_cast<kvs::Real64>( n.end - n.begin );
+        if ( m_ids ) { std::fill( m_ids + n.begin, m_ids + n.end, zstar ); }
+        return;
+    }
+
+    this->filter( size_t( n.left ), next, nnext, level + 1 );
+    this->filter( size_t( n.right ), next, nnext, level + 1 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Assigns the rows in the leaf node to the nearest candidates.
+ *  @param  begin [in] first row
+ *  @param  end [in] last row + 1
+ *  @param  candidates [in] candidate centers
+ *  @param  ncandidates [in] number of the candidates
+ */
+/*===========================================================================*/
+void Filter::assign( const size_t begin, const size_t end, const kvs::UInt32* candidates, const size_t ncandidates )
+{
+    const size_t ncolumns = m_tree.ncolumns;
+    for ( size_t i = begin; i < end; i++ )
+    {
+        const kvs::Real32* xi = m_tree.row(i);
+        kvs::UInt32 index = candidates[0];
+        kvs::Real32 dmin = kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( xi, m_centers + index * ncolumns, ncolumns );
+        for ( size_t j = 1; j < ncandidates; j++ )
+        {
+            const kvs::Real32 d = kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( xi, m_centers + candidates[j] * ncolumns, ncolumns );
+            if ( d < dmin ) { dmin = d; index = candidates[j]; }
+        }
+
+        kvs::Real64* s = m_sums + index * ncolumns;
+        for ( size_t k = 0; k < ncolumns; k++ ) { s[k] += xi[k]; }
+        m_counts[ index ] += 1.0;
+        if ( m_ids ) { m_ids[i] = index; }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the subtrees that are processed by the threads.
+ *  @param  tree [in] kd-tree
+ *  @param  nsubtrees [in] number of subtrees at least
+ *  @return indices of the root nodes of the subtrees
+ */
+/*===========================================================================*/
+std::vector<size_t> Subtrees( const KdTree& tree, const size_t nsubtrees )
+{
+    std::vector<size_t> subtrees( 1, 0 );
+    bool split = true;
+    while ( subtrees.size() < nsubtrees && split )
+    {
+        split = false;
+        std::vector<size_t> next;
+        for ( size_t i = 0; i < subtrees.size(); i++ )
+        {
+            const Node& n = tree.nodes[ subtrees[i] ];
+            if ( n.left < 0 ) { next.push_back( subtrees[i] ); continue; }
+            next.push_back( size_t( n.left ) );
+            next.push_back( size_t( n.right ) );
+            split = true;
+        }
+        subtrees.swap( next );
+    }
+
+    return subtrees;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Assigns the rows to the nearest centers and accumulates the rows.
+ *  @param  tree [in] kd-tree
+ *  @param  subtrees [in] subtrees processed by the threads
+ *  @param  centers [in] pointer to the centers packed in row-major order
+ *  @param  nclusters [in] number of clusters
+ *  @param  sums [out] vector sum of the rows for each cluster
+ *  @param  counts [out] number of the rows for each cluster
+ *  @param  ids [out] cluster IDs in the order of the tree (NULL: not written)
+ */
+/*===========================================================================*/
+void AssignAndAccumulate(
+    const KdTree& tree,
+    const std::vector<size_t>& subtrees,
+    const kvs::Real32* centers,
+    const size_t nclusters,
+    kvs::Real64* sums,
+    kvs::Real64* counts,
+    kvs::UInt32* ids )
+{
+    const size_t ncolumns = tree.ncolumns;
+    std::fill( sums, sums + nclusters * ncolumns, 0.0 );
+    std::fill( counts, counts + nclusters, 0.0 );
+
+    const kvs::Int64 n = static_cast<kvs::Int64>( subtrees.size() );
+    #pragma omp parallel
+    {
+        std::vector<kvs::Real64> local_sums( nclusters * ncolumns, 0.0 );
+        std::vector<kvs::Real64> local_counts( nclusters, 0.0 );
+        ::Filter filter( tree, centers, nclusters, &local_sums[0], &local_counts[0], ids );
+
+        #pragma omp for schedule(dynamic)
+        for ( kvs::Int64 i = 0; i < n; i++ )
+        {
+            filter.run( subtrees[i] );
+        }
+
+        #pragma omp critical
+        {
+            for ( size_t j = 0; j < nclusters * ncolumns; j++ ) { sums[j] += local_sums[j]; }
+            for ( size_t j = 0; j < nclusters; j++ ) { counts[j] += local_counts[j]; }
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Moves the centers to the means of the accumulated rows.
+ *  @param  sums [in] vector sum of the rows for each cluster
+ *  @param  counts [in] number of the rows for each cluster
+ *  @param  nclusters [in] number of clusters
+ *  @param  ncolumns [in] number of columns
+ *  @param  tolerance [in] tolerance for the convergence test
+ *  @param  centers [in/out] pointer to the centers packed in row-major order
+ *  @return true if all the centers moved less than the tolerance
+ */
+/*===========================================================================*/
+bool MoveCenters(
+    const kvs::Real64* sums,
+    const kvs::Real64* counts,
+    const size_t nclusters,
+    const size_t ncolumns,
+    const kvs::Real32 tolerance,
+    kvs::Real32* centers )
+{
+    bool converged = true;
+    std::vector<kvs::Real32> center_new( ncolumns );
+    for ( size_t i = 0; i < nclusters; i++ )
+    {
+        // The center of the empty cluster is kept in the current position.
+        if ( !( counts[i] > 0.0 ) ) continue;
+
+        kvs::Real32* center = centers + i * ncolumns;
+        for ( size_t k = 0; k < ncolumns; k++ )
+        {
+            center_new[k] = static_cast<kvs::Real32>( sums[ i * ncolumns + k ] / counts[i] );
+        }
+
+        const kvs::Real32 distance = kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( center, &center_new[0], ncolumns );
+        if ( !( distance < tolerance ) ) { converged = false; }
+
+        std::copy( center_new.begin(), center_new.end(), center );
+    }
+
+    return converged;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Initializes the centers with rows selected randomly.
+ *  @param  x [in] pointer to the table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  nclusters [in] number of clusters
+ *  @param  random [in] random number generator
+ *  @param  c [out] pointer to the centers packed in row-major order
+ */
+/*===========================================================================*/
+void InitializeCenterWithRandomSeeding(
+    const kvs::Real32* x,
+    const size_t nrows,
+    const size_t ncolumns,
+    const size_t nclusters,
+    kvs::MersenneTwister& random,
+    kvs::Real32* c )
+{
+    for ( size_t i = 0; i < nclusters; i++ )
+    {
+        const size_t index = kvs::Math::Min( size_t( nrows * random.rand() ), nrows - 1 );
+        std::copy( x + index * ncolumns, x + ( index + 1 ) * ncolumns, c + i * ncolumns );
+    }
+}
+
+}
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new FilteringKMeansClustering class.
+ */
+/*===========================================================================*/
+FilteringKMeansClustering::FilteringKMeansClustering():
+    m_seeding_method( FilteringKMeansClustering::RandomSeeding ),
+    m_nclusters( 10 ),
+    m_max_iterations( 100 ),
+    m_tolerance( 1.e-6 ),
+    m_leaf_size( 16 ),
+    m_centers( NULL )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new FilteringKMeansClustering class.
+ *  @param  object [in] pointer to the table object
+ *  @param  nclusters [in] number of clusters
+ */
+/*===========================================================================*/
+FilteringKMeansClustering::FilteringKMeansClustering( const kvs::ObjectBase* object, const size_t nclusters ):
+    m_seeding_method( FilteringKMeansClustering::RandomSeeding ),
+    m_nclusters( nclusters ),
+    m_max_iterations( 100 ),
+    m_tolerance( 1.e-6 ),
+    m_leaf_size( 16 ),
+    m_centers( NULL )
+{
+    this->exec( object );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new FilteringKMeansClustering class.
+ *  @param  object [in] pointer to the table object
+ *  @param  nclusters [in] number of clusters
+ *  @param  max_iterations [in] maximum number of iterations
+ *  @param  tolerance [in] tolerance for the convergence test
+ */
+/*===========================================================================*/
+FilteringKMeansClustering::FilteringKMeansClustering( const kvs::ObjectBase* object, const size_t nclusters, const size_t max_iterations, const float tolerance ):
+    m_seeding_method( FilteringKMeansClustering::RandomSeeding ),
+    m_nclusters( nclusters ),
+    m_max_iterations( max_iterations ),
+    m_tolerance( tolerance ),
+    m_leaf_size( 16 ),
+    m_centers( NULL )
+{
+    this->exec( object );
+}
+
+FilteringKMeansClustering::~FilteringKMeansClustering()
+{
+    if ( m_centers ) delete [] m_centers;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Executes the k-means clustering with the filtering algorithm.
+ *  @param  object [in] pointer to the table object
+ *  @return pointer to the clustered table object
+ */
+/*===========================================================================*/
+FilteringKMeansClustering::SuperClass* FilteringKMeansClustering::exec( const kvs::ObjectBase* object )
+{
+    if ( !object )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input object is NULL.");
+        return NULL;
+    }
+
+    // Input table object.
+    const kvs::TableObject* table = static_cast<const kvs::TableObject*>( object );
+    const size_t nrows = table->numberOfRows();
+    const size_t ncolumns = table->numberOfColumns();
+    const size_t nclusters = m_nclusters;
+    if ( nrows == 0 || nclusters == 0 || ncolumns == 0 )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input table or number of clusters is empty.");
+        return NULL;
+    }
+
+    // Table data packed in row-major order.
+    const kvs::ValueArray<kvs::Real32> x = pcs::ClusteringUtility::PackTable( table );
+    if ( x.size() != nrows * ncolumns )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Cannot pack the input table.");
+        return NULL;
+    }
+
+    // Assign initial centers.
+    kvs::ValueArray<kvs::Real32> c( nclusters * ncolumns );
+    switch ( m_seeding_method )
+    {
+    case RandomSeeding:
+        ::InitializeCenterWithRandomSeeding( x.data(), nrows, ncolumns, nclusters, m_random, c.data() );
+        break;
+    case SmartSeeding:
+        pcs::ClusteringUtility::ScalableSeeding( x.data(), nrows, ncolumns, nclusters, m_random, c.data() );
+        break;
+    default:
+        ::InitializeCenterWithRandomSeeding( x.data(), nrows, ncolumns, nclusters, m_random, c.data() );
+        break;
+    }
+
+    // Build the kd-tree once. The subtrees are distributed over the threads
+    // in each pass (several subtrees per thread for the load balancing).
+    ::KdTree tree;
+    tree.build( x.data(), nrows, ncolumns, m_leaf_size );
+    const std::vector<size_t> subtrees = ::Subtrees( tree, 8 * pcs::ClusteringUtility::NumberOfThreads() );
+
+    // Vector sums and numbers of the rows for each cluster.
+    std::vector<kvs::Real64> sums( nclusters * ncolumns );
+    std::vector<kvs::Real64> counts( nclusters );
+
+    // Clustering.
+    bool converged = false;
+    size_t counter = 0;
+    while ( !converged )
+    {
+        ::AssignAndAccumulate( tree, subtrees, c.data(), nclusters, &sums[0], &counts[0], NULL );
+        converged = ::MoveCenters( &sums[0], &counts[0], nclusters, ncolumns, m_tolerance, c.data() );
+
+        if ( counter++ > m_max_iterations ) break;
+    }
+
+    // Cluster IDs for the final centers.
+    kvs::ValueArray<kvs::UInt32> a( nrows );
+    ::AssignAndAccumulate( tree, subtrees, c.data(), nclusters, &sums[0], &counts[0], a.data() );
+
+    kvs::ValueArray<kvs::UInt32> IDs( nrows );
+    for ( size_t i = 0; i < nrows; i++ ) { IDs[ tree.indices[i] ] = a[i]; }
+
+    if ( m_centers ) delete [] m_centers;
+    m_centers = new kvs::ValueArray<kvs::Real32> [ nclusters ];
+    for ( size_t j = 0; j < nclusters; j++ )
+    {
+        m_centers[j].allocate( ncolumns );
+        std::copy( c.data() + j * ncolumns, c.data() + ( j + 1 ) * ncolumns, m_centers[j].begin() );
+    }
+
+    // Set the results to the output table object.
+    for ( size_t i = 0; i < ncolumns; i++ )
+    {
+        const std::string label = table->label(i);
+        const kvs::AnyValueArray& column = table->column(i);
+        SuperClass::addColumn( column, label );
+    }
+    SuperClass::addColumn( kvs::AnyValueArray( IDs ), "Cluster ID" );
+
+    return this;
+}
+
+void FilteringKMeansClustering::setSeedingMethod( SeedingMethod seeding_method )
+{
+    m_seeding_method = seeding_method;
+}
+
+void FilteringKMeansClustering::setSeed( const size_t seed )
+{
+    m_random.setSeed( seed );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a number of clusters.
+ *  @param  nclusters [in] number of clusters
+ */
+/*===========================================================================*/
+void FilteringKMeansClustering::setNumberOfClusters( const size_t nclusters )
+{
+    m_nclusters = nclusters;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a maximum number of interations.
+ *  @param  max_iterations [in] maximum number of iterations
+ */
+/*===========================================================================*/
+void FilteringKMeansClustering::setMaxIterations( const size_t max_iterations )
+{
+    m_max_iterations = max_iterations;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a tolerance for the convergence test.
+ *  @param  tolerance [in] tolerance which can be assumed zero
+ */
+/*===========================================================================*/
+void FilteringKMeansClustering::setTolerance( const float tolerance )
+{
+    m_tolerance = tolerance;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a maximum number of rows in a leaf node of the kd-tree.
+ *  @param  leaf_size [in] maximum number of rows in a leaf node
+ */
+/*===========================================================================*/
+void FilteringKMeansClustering::setLeafSize( const size_t leaf_size )
+{
+    m_leaf_size = leaf_size;
+}
+
+size_t FilteringKMeansClustering::numberOfClusters() const
+{
+    return m_nclusters;
+}
+
+const kvs::ValueArray<kvs::Real32>& FilteringKMeansClustering::center( const size_t index ) const
+{
+    return m_centers[ index ];
+}
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
@@ -0,0 +1,100 @@
+/*****************************************************************************/
+/**
+ *  @file   FilteringKMeansClustering.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*----------------------------------------------------------------------------
+ *
+ * References:
+ * [1] T. Kanungo, D. M. Mount, N. S. Netanyahu, C. D. Piatko, R. Silverman
+ *     and A. Y. Wu, An Efficient k-Means Clustering Algorithm: Analysis and
+ *     Implementation, IEEE Transactions on Pattern Analysis and Machine
+ *     Intelligence, Vol. 24, No. 7, pp. 881-892, 2002.
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__PCS__FILTERING_K_MEANS_CLUSTERING_H_INCLUDE
+#define KVSOCEANVIS__PCS__FILTERING_K_MEANS_CLUSTERING_H_INCLUDE
+
+#include <kvs/Module>
+#include <kvs/FilterBase>
+#include <kvs/TableObject>
+#include <kvs/MersenneTwister>
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  K-means clustering class with the kd-tree filtering algorithm.
+ *
+ *  The kd-tree is built over the rows once, and the candidate centers are
+ *  pruned for each node of the tree. This is efficient for the tables with
+ *  a small number of columns (up to about 8).
+ */
+/*===========================================================================*/
+class FilteringKMeansClustering : public kvs::FilterBase, public kvs::TableObject
+{
+    kvsModuleName( kvsoceanvis::pcs::FilteringKMeansClustering );
+    kvsModuleCategory( Filter );
+    kvsModuleBaseClass( kvs::FilterBase );
+    kvsModuleSuperClass( kvs::TableObject );
+
+public:
+
+    enum SeedingMethod
+    {
+        RandomSeeding,
+        SmartSeeding
+    };
+
+protected:
+
+    kvs::MersenneTwister m_random; ///< random number generator
+    SeedingMethod m_seeding_method; ///< seeding method
+    size_t m_nclusters; ///< number of clusters
+    size_t m_max_iterations; ///< maximum number of interations
+    float m_tolerance; ///< tolerance of distance
+    size_t m_leaf_size; ///< maximum number of rows in a leaf node of the kd-tree
+    kvs::ValueArray<kvs::Real32>* m_centers; ///< cluster centers
+
+public:
+
+    FilteringKMeansClustering();
+    FilteringKMeansClustering( const kvs::ObjectBase* object, const size_t nclusters );
+    FilteringKMeansClustering( const kvs::ObjectBase* object, const size_t nclusters, const size_t max_iterations, const float torelance );
+    virtual ~FilteringKMeansClustering();
+
+public:
+
+    SuperClass* exec( const kvs::ObjectBase* object );
+
+public:
+
+    void setSeedingMethod( SeedingMethod seeding_method );
+    void setSeed( const size_t seed );
+    void setNumberOfClusters( const size_t nclusters );
+    void setMaxIterations( const size_t max_iterations );
+    void setTolerance( const float tolerance );
+    void setLeafSize( const size_t leaf_size );
+
+    size_t numberOfClusters() const;
+    const kvs::ValueArray<kvs::Real32>& center( const size_t index ) const;
+};
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__PCS__FILTERING_K_MEANS_CLUSTERING_H_INCLUDE
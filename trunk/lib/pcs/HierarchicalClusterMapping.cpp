@@ -0,0 +1,527 @@
+/*****************************************************************************/
+/**
+ *  @file   HierarchicalClusterMapping.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "HierarchicalClusterMapping.h"
+#include "FastKMeansClustering.h"
+#include <vector>
+#include <algorithm>
+#include <kvs/Value>
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the root of the set in the disjoint-set forest.
+ *  @param  parents [in/out] parent indices (compressed by path halving)
+ *  @param  index [in] element index
+ *  @return root index
+ */
+/*===========================================================================*/
+size_t Root( std::vector<size_t>& parents, size_t index )
+{
+    while ( parents[ index ] != index )
+    {
+        parents[ index ] = parents[ parents[ index ] ];
+        index = parents[ index ];
+    }
+
+    return index;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the Ward's distance between the clusters.
+ *  @param  c0 [in] center of the cluster 0
+ *  @param  w0 [in] weight of the cluster 0
+ *  @param  c1 [in] center of the cluster 1
+ *  @param  w1 [in] weight of the cluster 1
+ *  @param  ncolumns [in] number of columns
+ *  @return increase of the sum of squared errors by merging the clusters
+ */
+/*===========================================================================*/
+kvs::Real64 WardDistance(
+    const kvs::Real64* c0,
+    const kvs::Real64 w0,
+    const kvs::Real64* c1,
+    const kvs::Real64 w1,
+    const size_t ncolumns )
+{
+    const kvs::Real64 w = w0 + w1;
+    if ( !( w > 0.0 ) ) return 0.0;
+
+    kvs::Real64 distance = 0.0;
+    for ( size_t k = 0; k < ncolumns; k++ )
+    {
+        const kvs::Real64 d = c0[k] - c1[k];
+        distance += d * d;
+    }
+
+    return w0 * w1 / w * distance;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Merges the clusters with the nearest-neighbor chain algorithm.
+ *  @param  centers [in/out] centers of the clusters (overwritten by the merged centers)
+ *  @param  weights [in/out] weights of the clusters (overwritten by the merged weights)
+ *  @param  nclusters [in] number of clusters
+ *  @param  ncolumns [in] number of columns
+ *  @param  pairs [out] pairs of the merged clusters (nclusters - 1 pairs)
+ *  @param  heights [out] Ward's distances of the merged clusters
+ *
+ *  The merged cluster is stored in the place of the first cluster of the
+ *  pair. Since the Ward's linkage is reducible, the pairs sorted by the
+ *  distances are the same dendrogram as the one by the greedy merging.
+ *  The distances are computed from the centers on demand, so no distance
+ *  matrix is stored.
+ */
+/*===========================================================================*/
+void NearestNeighborChain(
+    std::vector<kvs::Real64>& centers,
+    std::vector<kvs::Real64>& weights,
+    const size_t nclusters,
+    const size_t ncolumns,
+    std::vector<size_t>& pairs,
+    std::vector<kvs::Real64>& heights )
+{
+    pairs.assign( 2 * ( nclusters - 1 ), 0 );
+    heights.assign( nclusters - 1, 0.0 );
+
+    std::vector<bool> active( nclusters, true );
+    std::vector<size_t> chain;
+    chain.reserve( nclusters );
+
+    size_t first = 0;
+    size_t nmerges = 0;
+    while ( nmerges + 1 < nclusters )
+    {
+        if ( chain.empty() )
+        {
+            while ( !active[ first ] ) first++;
+            chain.push_back( first );
+        }
+
+        // Nearest neighbor of the tail of the chain. The previous cluster
+        // in the chain is preferred for the ties to avoid the cycles.
+        const size_t a = chain.back();
+        const kvs::Real64* ca = &centers[ a * ncolumns ];
+        size_t b = nclusters;
+        kvs::Real64 dmin = kvs::Value<kvs::Real64>::Max();
+        if ( chain.size() > 1 )
+        {
+            b = chain[ chain.size() - 2 ];
+            dmin = ::WardDistance( ca, weights[a], &centers[ b * ncolumns ], weights[b], ncolumns );
+        }
+
+        for ( size_t j = 0; j < nclusters; j++ )
+        {
+            if ( !active[j] || j == a ) continue;
+
+            const kvs::Real64 d = ::WardDistance( ca, weights[a], &centers[ j * ncolumns ], weights[j], ncolumns );
+            if ( d < dmin ) { dmin = d; b = j; }
+        }
+
+        if ( chain.size() < 2 || b != chain[ chain.size() - 2 ] )
+        {
+            chain.push_back( b );
+            continue;
+        }
+
+        // Reciprocal nearest neighbors are merged.
+        chain.pop_back();
+        chain.pop_back();
+
+        const kvs::Real64 wa = weights[a];
+        const kvs::Real64 wb = weights[b];
+        const kvs::Real64 w = wa + wb;
+        kvs::Real64* c0 = &centers[ a * ncolumns ];
+        const kvs::Real64* c1 = &centers[ b * ncolumns ];
+        for ( size_t k = 0; k < ncolumns; k++ )
+        {
+            c0[k] = ( w > 0.0 ) ? ( wa * c0[k] + wb * c1[k] ) / w : 0.5 * ( c0[k] + c1[k] );
+        }
+        weights[a] = w;
+        active[b] = false;
+
+        pairs[ 2 * nmerges + 0 ] = a;
+        pairs[ 2 * nmerges + 1 ] = b;
+        heights[ nmerges ] = dmin;
+        nmerges++;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Comparison of the merges by the heights.
+ */
+/*===========================================================================*/
+struct HeightLess
+{
+    const std::vector<kvs::Real64>& heights;
+    HeightLess( const std::vector<kvs::Real64>& h ): heights( h ) {}
+    bool operator () ( const size_t i, const size_t j ) const { return heights[i] < heights[j]; }
+};
+
+} // end of namespace
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new HierarchicalClusterMapping class.
+ */
+/*===========================================================================*/
+HierarchicalClusterMapping::HierarchicalClusterMapping():
+    m_ngroups( 0 )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new HierarchicalClusterMapping class.
+ *  @param  object [in] pointer to the cluster map object
+ *  @param  ngroups [in] number of groups
+ */
+/*===========================================================================*/
+HierarchicalClusterMapping::HierarchicalClusterMapping( const kvs::ObjectBase* object, const size_t ngroups ):
+    m_ngroups( ngroups )
+{
+    this->exec( object );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Executes the hierarchical cluster mapping.
+ *  @param  object [in] pointer to the cluster map object
+ *  @return pointer to the cluster map object
+ *
+ *  The cluster IDs of the input clusters must be sequential integers from
+ *  zero, which correspond to the indices of the given centers. If the centers
+ *  are not given, the centers of the min/max values are used instead.
+ */
+/*===========================================================================*/
+HierarchicalClusterMapping::SuperClass* HierarchicalClusterMapping::exec( const kvs::ObjectBase* object )
+{
+    if ( !object )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input object is NULL.");
+        return NULL;
+    }
+
+    const pcs::ClusterMapObject* cluster_map = static_cast<const pcs::ClusterMapObject*>( object );
+    const pcs::ClusterMapObject::ClusterList& cluster_list = cluster_map->clusterList();
+    const size_t naxes = cluster_map->naxes();
+    const size_t nleaves = cluster_list.size();
+    if ( nleaves == 0 || naxes == 0 )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input clusters are empty.");
+        return NULL;
+    }
+
+    // Input clusters indexed by the cluster IDs.
+    m_leaves.assign( nleaves, SuperClass::Cluster() );
+    std::vector<bool> found( nleaves, false );
+    pcs::ClusterMapObject::ClusterList::const_iterator cluster = cluster_list.begin();
+    pcs::ClusterMapObject::ClusterList::const_iterator last = cluster_list.end();
+    while ( cluster != last )
+    {
+        const size_t id = cluster->id();
+        if ( id >= nleaves || found[ id ] )
+        {
+            m_leaves.clear();
+            BaseClass::setSuccess( false );
+            kvsMessageError("Cluster IDs are not sequential.");
+            return NULL;
+        }
+
+        m_leaves[ id ] = *cluster;
+        found[ id ] = true;
+        cluster++;
+    }
+
+    // Centers and weights of the input clusters.
+    if ( m_centers.size() > 0 && m_centers.size() != nleaves * naxes )
+    {
+        m_leaves.clear();
+        BaseClass::setSuccess( false );
+        kvsMessageError("Number of the centers is not equal to the number of clusters.");
+        return NULL;
+    }
+
+    std::vector<kvs::Real64> centers( nleaves * naxes );
+    std::vector<kvs::Real64> weights( nleaves );
+    for ( size_t i = 0; i < nleaves; i++ )
+    {
+        for ( size_t j = 0; j < naxes; j++ )
+        {
+            centers[ i * naxes + j ] = ( m_centers.size() > 0 ) ?
+                static_cast<kvs::Real64>( m_centers[ i * naxes + j ] ) :
+                0.5 * ( m_leaves[i].minValue(j) + m_leaves[i].maxValue(j) );
+        }
+        weights[i] = static_cast<kvs::Real64>( m_leaves[i].counter() );
+    }
+
+    // Dendrogram.
+    /* NOTE: The merges are sorted by the heights, and the merged nodes are
+     * numbered from nleaves in the sorted order as well as the linkage matrix
+     * of SciPy, i.e. the node nleaves + i is created by the i-th merge.
+     */
+    m_merged_nodes.allocate( 2 * ( nleaves - 1 ) );
+    m_merge_heights.allocate( nleaves - 1 );
+    if ( nleaves > 1 )
+    {
+        std::vector<size_t> pairs;
+        std::vector<kvs::Real64> heights;
+        ::NearestNeighborChain( centers, weights, nleaves, naxes, pairs, heights );
+
+        std::vector<size_t> order( nleaves - 1 );
+        for ( size_t i = 0; i < order.size(); i++ ) { order[i] = i; }
+        std::stable_sort( order.begin(), order.end(), ::HeightLess( heights ) );
+
+        std::vector<size_t> parents( nleaves );
+        std::vector<size_t> nodes( nleaves );
+        for ( size_t i = 0; i < nleaves; i++ ) { parents[i] = i; nodes[i] = i; }
+        for ( size_t i = 0; i < order.size(); i++ )
+        {
+            const size_t r0 = ::Root( parents, pairs[ 2 * order[i] + 0 ] );
+            const size_t r1 = ::Root( parents, pairs[ 2 * order[i] + 1 ] );
+            m_merged_nodes[ 2 * i + 0 ] = static_cast<kvs::UInt32>( kvs::Math::Min( nodes[ r0 ], nodes[ r1 ] ) );
+            m_merged_nodes[ 2 * i + 1 ] = static_cast<kvs::UInt32>( kvs::Math::Max( nodes[ r0 ], nodes[ r1 ] ) );
+            m_merge_heights[i] = heights[ order[i] ];
+
+            parents[ r1 ] = r0;
+            nodes[ r0 ] = nleaves + i;
+        }
+    }
+
+    // Number of axes.
+    SuperClass::m_naxes = naxes;
+    SuperClass::setNumberOfColumns( naxes );
+
+    // Number of points.
+    SuperClass::m_npoints = cluster_map->npoints();
+    SuperClass::setNumberOfRows( cluster_map->numberOfRows() );
+
+    // Min/Max value.
+    SuperClass::setMinValues( cluster_map->minValues() );
+    SuperClass::setMaxValues( cluster_map->maxValues() );
+    SuperClass::setLabels( cluster_map->labels() );
+
+    // Min/Max range.
+    SuperClass::setMinRanges( cluster_map->minValues() );
+    SuperClass::setMaxRanges( cluster_map->maxValues() );
+
+    // Clusters of the groups.
+    this->cut( m_ngroups );
+
+    return this;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets the centers of the input clusters.
+ *  @param  centers [in] centers packed in row-major order
+ */
+/*===========================================================================*/
+void HierarchicalClusterMapping::setCenters( const kvs::ValueArray<kvs::Real32>& centers )
+{
+    m_centers = centers;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets the centers of the input clusters by the k-means clustering.
+ *  @param  clustering [in] pointer to the executed k-means clustering
+ */
+/*===========================================================================*/
+void HierarchicalClusterMapping::setCenters( const pcs::FastKMeansClustering* clustering )
+{
+    const size_t nclusters = clustering->numberOfClusters();
+    const size_t ncolumns = nclusters > 0 ? clustering->center(0).size() : 0;
+
+    m_centers.allocate( nclusters * ncolumns );
+    for ( size_t i = 0; i < nclusters; i++ )
+    {
+        const kvs::ValueArray<kvs::Real32>& center = clustering->center(i);
+        std::copy( center.begin(), center.end(), m_centers.begin() + i * ncolumns );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a number of groups.
+ *  @param  ngroups [in] number of groups (0: no merging)
+ */
+/*===========================================================================*/
+void HierarchicalClusterMapping::setNumberOfGroups( const size_t ngroups )
+{
+    m_ngroups = ngroups;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Cuts the dendrogram at the number of groups.
+ *  @param  ngroups [in] number of groups (0: no merging)
+ *
+ *  The output clusters are regrouped from the input clusters without
+ *  re-clustering, so the number of groups can be changed interactively.
+ */
+/*===========================================================================*/
+void HierarchicalClusterMapping::cut( const size_t ngroups )
+{
+    m_ngroups = ngroups;
+
+    const size_t nleaves = m_leaves.size();
+    if ( nleaves == 0 ) return;
+
+    const size_t n = ( ngroups == 0 ) ? nleaves : kvs::Math::Min( ngroups, nleaves );
+    const size_t nmerges = nleaves - n;
+
+    // Merges the leaves up to the number of groups, where a node of the
+    // dendrogram is represented by one of its leaves.
+    std::vector<size_t> leaves( 2 * nleaves - 1 );
+    std::vector<size_t> parents( nleaves );
+    for ( size_t i = 0; i < nleaves; i++ ) { leaves[i] = i; parents[i] = i; }
+    for ( size_t i = 0; i < nmerges; i++ )
+    {
+        const size_t l0 = leaves[ m_merged_nodes[ 2 * i + 0 ] ];
+        const size_t l1 = leaves[ m_merged_nodes[ 2 * i + 1 ] ];
+        parents[ ::Root( parents, l1 ) ] = ::Root( parents, l0 );
+        leaves[ nleaves + i ] = l0;
+    }
+
+    // Group IDs in the order of the input cluster IDs.
+    const kvs::UInt32 none = kvs::Value<kvs::UInt32>::Max();
+    std::vector<kvs::UInt32> root_ids( nleaves, none );
+    m_group_ids.allocate( nleaves );
+    kvs::UInt32 ngroup_ids = 0;
+    for ( size_t i = 0; i < nleaves; i++ )
+    {
+        const size_t root = ::Root( parents, i );
+        if ( root_ids[ root ] == none ) { root_ids[ root ] = ngroup_ids++; }
+        m_group_ids[i] = root_ids[ root ];
+    }
+
+    // Cluster parameters.
+    const size_t naxes = SuperClass::m_naxes;
+    std::vector<size_t> counter( n, 0 );
+    std::vector< kvs::ValueArray<kvs::Real64> > min_values( n );
+    std::vector< kvs::ValueArray<kvs::Real64> > max_values( n );
+    for ( size_t i = 0; i < n; i++ )
+    {
+        min_values[i].allocate( naxes );
+        max_values[i].allocate( naxes );
+        for ( size_t j = 0; j < naxes; j++ )
+        {
+            min_values[i][j] = kvs::Value<kvs::Real64>::Max();
+            max_values[i][j] = kvs::Value<kvs::Real64>::Min();
+        }
+    }
+
+    // Merging the min/max values and the counters of the input clusters.
+    for ( size_t i = 0; i < nleaves; i++ )
+    {
+        const size_t id = m_group_ids[i];
+        for ( size_t j = 0; j < naxes; j++ )
+        {
+            min_values[id][j] = kvs::Math::Min( min_values[id][j], m_leaves[i].minValue(j) );
+            max_values[id][j] = kvs::Math::Max( max_values[id][j], m_leaves[i].maxValue(j) );
+        }
+        counter[id] += m_leaves[i].counter();
+    }
+
+    // Set the clusters.
+    SuperClass::m_cluster_list.clear();
+    for ( size_t i = 0; i < n; i++ )
+    {
+        SuperClass::Cluster cluster;
+        cluster.setID( i );
+        cluster.setCounter( counter[i] );
+        cluster.setMinValues( min_values[i] );
+        cluster.setMaxValues( max_values[i] );
+
+        SuperClass::m_cluster_list.push_back( cluster );
+    }
+
+    // Sorting.
+    SuperClass::m_cluster_list.sort();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Cuts the dendrogram at the height.
+ *  @param  height [in] height (the merges up to the height are applied)
+ */
+/*===========================================================================*/
+void HierarchicalClusterMapping::cutAtHeight( const kvs::Real64 height )
+{
+    const size_t nmerges = std::upper_bound( m_merge_heights.begin(), m_merge_heights.end(), height ) - m_merge_heights.begin();
+    this->cut( m_leaves.size() - nmerges );
+}
+
+size_t HierarchicalClusterMapping::numberOfLeaves() const
+{
+    return m_leaves.size();
+}
+
+size_t HierarchicalClusterMapping::numberOfGroups() const
+{
+    return SuperClass::m_cluster_list.size();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the pairs of the merged nodes.
+ *  @return pairs of the node IDs, where the node nleaves + i is the i-th merge
+ */
+/*===========================================================================*/
+const kvs::ValueArray<kvs::UInt32>& HierarchicalClusterMapping::mergedNodes() const
+{
+    return m_merged_nodes;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the heights of the merges.
+ *  @return increases of the sum of squared errors in ascending order
+ */
+/*===========================================================================*/
+const kvs::ValueArray<kvs::Real64>& HierarchicalClusterMapping::mergeHeights() const
+{
+    return m_merge_heights;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the group IDs of the input clusters.
+ *  @return group ID of each input cluster (indexed by the input cluster ID)
+ */
+/*===========================================================================*/
+const kvs::ValueArray<kvs::UInt32>& HierarchicalClusterMapping::groupIDs() const
+{
+    return m_group_ids;
+}
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
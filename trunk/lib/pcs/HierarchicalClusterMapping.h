@@ -0,0 +1,99 @@
+/*****************************************************************************/
+/**
+ *  @file   HierarchicalClusterMapping.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*----------------------------------------------------------------------------
+ *
+ * References:
+ * [1] J. H. Ward, Hierarchical Grouping to Optimize an Objective Function,
+ *     Journal of the American Statistical Association, Vol. 58, No. 301,
+ *     1963, pp. 236-244.
+ * [2] D. Mullner, Modern hierarchical, agglomerative clustering algorithms,
+ *     arXiv:1109.2378, 2011.
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__PCS__HIERARCHICAL_CLUSTER_MAPPING_H_INCLUDE
+#define KVSOCEANVIS__PCS__HIERARCHICAL_CLUSTER_MAPPING_H_INCLUDE
+
+#include <vector>
+#include <kvs/Module>
+#include <kvs/FilterBase>
+#include <kvs/ValueArray>
+#include "ClusterMapObject.h"
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+class FastKMeansClustering;
+
+/*===========================================================================*/
+/**
+ *  @brief  Hierarchical cluster mapping class.
+ *
+ *  The clusters of the input cluster map object (e.g. the k-means clusters
+ *  mapped by ClusterMapping) are merged into a dendrogram with Ward's
+ *  linkage, where the centers and the counters of the clusters are used as
+ *  the weighted points. The dendrogram can be cut at any number of groups
+ *  without re-clustering the rows, and the output clusters are regrouped by
+ *  merging the min/max values and the counters of the input clusters.
+ */
+/*===========================================================================*/
+class HierarchicalClusterMapping : public kvs::FilterBase, public pcs::ClusterMapObject
+{
+    kvsModuleName( kvsoceanvis::pcs::HierarchicalClusterMapping );
+    kvsModuleCategory( Filter );
+    kvsModuleBaseClass( kvs::FilterBase );
+    kvsModuleSuperClass( pcs::ClusterMapObject );
+
+protected:
+
+    kvs::ValueArray<kvs::Real32> m_centers; ///< given centers of the input clusters (packed in row-major order)
+    size_t m_ngroups; ///< number of groups (0: no merging)
+    std::vector<SuperClass::Cluster> m_leaves; ///< input clusters indexed by the cluster ID
+    kvs::ValueArray<kvs::UInt32> m_merged_nodes; ///< pairs of the merged nodes (leaves: [0,n), merged nodes: [n,2n-1))
+    kvs::ValueArray<kvs::Real64> m_merge_heights; ///< increases of the sum of squared errors in ascending order
+    kvs::ValueArray<kvs::UInt32> m_group_ids; ///< group ID of each input cluster
+
+public:
+
+    HierarchicalClusterMapping();
+    HierarchicalClusterMapping( const kvs::ObjectBase* object, const size_t ngroups );
+
+public:
+
+    SuperClass* exec( const kvs::ObjectBase* object );
+
+public:
+
+    void setCenters( const kvs::ValueArray<kvs::Real32>& centers );
+    void setCenters( const pcs::FastKMeansClustering* clustering );
+    void setNumberOfGroups( const size_t ngroups );
+
+    void cut( const size_t ngroups );
+    void cutAtHeight( const kvs::Real64 height );
+
+    size_t numberOfLeaves() const;
+    size_t numberOfGroups() const;
+    const kvs::ValueArray<kvs::UInt32>& mergedNodes() const;
+    const kvs::ValueArray<kvs::Real64>& mergeHeights() const;
+    const kvs::ValueArray<kvs::UInt32>& groupIDs() const;
+};
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__PCS__HIERARCHICAL_CLUSTER_MAPPING_H_INCLUDE
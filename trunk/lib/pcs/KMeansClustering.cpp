@@ -13,153 +13,150 @@
  */
 /*****************************************************************************/
 #include "KMeansClustering.h"
+#include "ClusteringUtility.h"
+#include <vector>
+#include <algorithm>
 #include <kvs/Value>
 
 
 namespace
 {
 
-kvs::Real32 GetEuclideanDistance(
-    const kvs::TableObject* table,
-    const kvs::UInt16 row_index,
-    const kvs::ValueArray<kvs::Real32>& center )
-{
-    kvs::Real32 distance = 0.0;
-    for ( size_t i = 0; i < table->numberOfColumns(); i++ )
-    {
-        const kvs::Real32 x0 = center[i];
-        const kvs::Real32 x1 = table->column(i).at<kvs::Real32>( row_index );
-        distance += ( x1 - x0 ) * ( x1 - x0 );
-    }
-
-    return distance;
-}
-
-kvs::Real32 GetEuclideanDistance(
-    const kvs::TableObject* table,
-    const kvs::ValueArray<kvs::Real32>& center_old,
-    const kvs::ValueArray<kvs::Real32>& center_new )
-{
-    kvs::Real32 distance = 0.0;
-    for ( size_t i = 0; i < table->numberOfColumns(); i++ )
-    {
-        const kvs::Real32 x0 = center_old[i];
-        const kvs::Real32 x1 = center_new[i];
-        distance += ( x1 - x0 ) * ( x1 - x0 );
-    }
-
-    return distance;
-}
-}
-
-namespace
-{
 /*===========================================================================*/
 /**
- *  @brief  Calculates the cluster centroid.
- *  @param  table [in] table object
- *  @param  cluster_id [in] target cluster ID
- *  @param  ids [in] cluster ID array
- *  @param  center [out] cluster centroid
+ *  @brief  Initialize centers of clusters with random seeding method.
+ *  @param  data [in] pointer to the table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  nclusters [in] number of clusters
+ *  @param  ids [in] randomly assigned cluster IDs
+ *  @param  centers [out] pointer to the centers packed in row-major order
  */
 /*===========================================================================*/
-void CalculateCenter(
-    const kvs::TableObject* table,
-    const kvs::UInt16 cluster_id,
+void InitializeCentersWithRandomSeeding(
+    const kvs::Real32* data,
+    const size_t nrows,
+    const size_t ncolumns,
+    const size_t nclusters,
     const kvs::ValueArray<kvs::UInt16>& ids,
-    kvs::ValueArray<kvs::Real32>* center )
+    kvs::Real32* centers )
 {
-    for ( size_t j = 0; j < table->numberOfColumns(); j++ ) { center->at(j) = 0.0; }
+    std::vector<kvs::Real64> sums( nclusters * ncolumns, 0.0 );
+    std::vector<size_t> counts( nclusters, 0 );
+    for ( size_t i = 0; i < nrows; i++ )
+    {
+        const kvs::Real32* x = data + i * ncolumns;
+        kvs::Real64* sum = &sums[ ids[i] * ncolumns ];
+        for ( size_t k = 0; k < ncolumns; k++ ) { sum[k] += x[k]; }
+        counts[ ids[i] ]++;
+    }
 
-    size_t counter = 0;
-    for ( size_t j = 0; j < table->numberOfRows(); j++ )
+    for ( size_t i = 0; i < nclusters; i++ )
     {
-        if ( ids[j] == cluster_id )
+        const kvs::Real64 count = static_cast<kvs::Real64>( kvs::Math::Max( counts[i], size_t(1) ) );
+        for ( size_t k = 0; k < ncolumns; k++ )
         {
-            for ( size_t k = 0; k < table->numberOfColumns(); k++ )
-            {
-                center->at(k) += table->column(k).at<kvs::Real32>(j);
-            }
-            counter++;
+            centers[ i * ncolumns + k ] = static_cast<kvs::Real32>( sums[ i * ncolumns + k ] / count );
         }
     }
-    if ( counter != 0 )
-    {
-        for ( size_t k = 0; k < table->numberOfColumns(); k++ ) { center->at(k) /= counter; }
-    }
 }
 
 /*===========================================================================*/
 /**
- *  @brief  Initialize centers of clusters with random seeding method.
- *  @param  table [in] pointer to table
+ *  @brief  Assigns each row to the nearest center and accumulates the rows.
+ *  @param  data [in] pointer to the table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  centers [in] pointer to the centers packed in row-major order
  *  @param  nclusters [in] number of clusters
- *  @param  ids [i]
- *  @param  centers [in/out] pointer to center array
+ *  @param  ids [out] cluster ID array
+ *  @param  sums [out] vector sum of the rows for each cluster
+ *  @param  counts [out] number of the rows for each cluster
+ *
+ *  The assignment and the accumulation are done in a single pass over the
+ *  rows. The rows are split across the threads, and each thread accumulates
+ *  its own partial sums which are reduced at the end of the pass.
  */
 /*===========================================================================*/
-void InitializeCentersWithRandomSeeding(
-    const kvs::TableObject* table,
+void AssignAndAccumulate(
+    const kvs::Real32* data,
+    const size_t nrows,
+    const size_t ncolumns,
+    const kvs::Real32* centers,
     const size_t nclusters,
-    const kvs::ValueArray<kvs::UInt16>& ids,
-    kvs::ValueArray<kvs::Real32>* centers )
+    kvs::UInt16* ids,
+    kvs::Real64* sums,
+    size_t* counts )
 {
-    for ( size_t i = 0; i < nclusters; i++ )
+    std::fill( sums, sums + nclusters * ncolumns, 0.0 );
+    std::fill( counts, counts + nclusters, size_t(0) );
+
+    const kvs::Int64 n = static_cast<kvs::Int64>( nrows );
+    #pragma omp parallel
     {
-        CalculateCenter( table, i, ids, &centers[i] );
+        std::vector<kvs::Real64> local_sums( nclusters * ncolumns, 0.0 );
+        std::vector<size_t> local_counts( nclusters, 0 );
+
+        #pragma omp for schedule(static)
+        for ( kvs::Int64 i = 0; i < n; i++ )
+        {
+            const kvs::Real32* x = data + i * ncolumns;
+            const size_t id = kvsoceanvis::pcs::ClusteringUtility::NearestCenter( x, centers, nclusters, ncolumns, NULL );
+            ids[i] = static_cast<kvs::UInt16>( id );
+
+            kvs::Real64* sum = &local_sums[ id * ncolumns ];
+            for ( size_t k = 0; k < ncolumns; k++ ) { sum[k] += x[k]; }
+            local_counts[id]++;
+        }
+
+        #pragma omp critical
+        {
+            for ( size_t j = 0; j < nclusters * ncolumns; j++ ) { sums[j] += local_sums[j]; }
+            for ( size_t j = 0; j < nclusters; j++ ) { counts[j] += local_counts[j]; }
+        }
     }
 }
 
 /*===========================================================================*/
 /**
- *  @brief  Initialize centers of clusters with k-means++.
- *  @param  table [in] pointer to table
+ *  @brief  Moves the centers to the means of the accumulated rows.
+ *  @param  sums [in] vector sum of the rows for each cluster
+ *  @param  counts [in] number of the rows for each cluster
  *  @param  nclusters [in] number of clusters
- *  @param  ids [i]
- *  @param  centers [in/out] pointer to center array
+ *  @param  ncolumns [in] number of columns
+ *  @param  tolerance [in] tolerance for the convergence test
+ *  @param  centers [in/out] pointer to the centers packed in row-major order
+ *  @return true if all the centers moved less than the tolerance
  */
 /*===========================================================================*/
-void InitializeCentersWithSmartSeeding(
-    const kvs::TableObject* table,
+bool MoveCenters(
+    const kvs::Real64* sums,
+    const size_t* counts,
     const size_t nclusters,
-    const kvs::ValueArray<kvs::UInt16>& ids,
-    kvs::ValueArray<kvs::Real32>* centers )
+    const size_t ncolumns,
+    const kvs::Real32 tolerance,
+    kvs::Real32* centers )
 {
-    CalculateCenter( table, 0, ids, &(centers[0]) );
-
-    for ( size_t i = 1; i < nclusters; i++ )
+    bool converged = true;
+    std::vector<kvs::Real32> center_new( ncolumns );
+    for ( size_t i = 0; i < nclusters; i++ )
     {
-        kvs::Real32 S = 0.0;
-        kvs::Real32 D[ table->numberOfRows() ];
-        for ( size_t j = 0; j < table->numberOfRows(); j++ )
-        {
-            kvs::Real32 distance = kvs::Value<kvs::Real32>::Max();
-            for ( size_t k = 0; k < nclusters; k++ )
-            {
-                const kvs::Real32 d = ::GetEuclideanDistance( table, j, centers[k] );
-                if ( d < distance ) { distance = d; }
-            }
-            D[j] = distance;
-            S += distance * distance;
-        }
+        // The center of the empty cluster is kept in the current position.
+        if ( counts[i] == 0 ) continue;
 
-        size_t index = 0;
-        kvs::Real32 P = 0.0;
-        for ( size_t j = 0; j < table->numberOfRows(); j++ )
+        kvs::Real32* center = centers + i * ncolumns;
+        for ( size_t k = 0; k < ncolumns; k++ )
         {
-            const kvs::Real32 DD = D[j] * D[j];
-            if ( P < kvs::Math::Max( P, DD / S ) )
-            {
-                P = DD / S;
-                index = j;
-            }
+            center_new[k] = static_cast<kvs::Real32>( sums[ i * ncolumns + k ] / counts[i] );
         }
 
-        for ( size_t j = 0; j < table->numberOfColumns(); j++ )
-        {
-            centers[i].at(j) = table->column(j).at<kvs::Real32>(index);
-        }
+        const kvs::Real32 distance = kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( center, &center_new[0], ncolumns );
+        if ( !( distance < tolerance ) ) { converged = false; }
+
+        std::copy( center_new.begin(), center_new.end(), center );
     }
+
+    return converged;
 }
 
 }
@@ -215,79 +212,67 @@ KMeansClustering::SuperClass* KMeansClustering::exec( const kvs::ObjectBase* obj
     }
 
     const kvs::TableObject* table = static_cast<const kvs::TableObject*>( object );
+    const size_t nrows = table->numberOfRows();
+    const size_t ncolumns = table->numberOfColumns();
+    const size_t nclusters = m_nclusters;
 
-    // Allocate memory for the cluster center.
-    m_centers = new kvs::ValueArray<kvs::Real32> [ m_nclusters ];
-    for ( size_t i = 0; i < m_nclusters; i++ ) { m_centers[i].allocate( table->numberOfColumns() ); }
+    // Pack the table into a contiguous row-major matrix.
+    const kvs::ValueArray<kvs::Real32> data = pcs::ClusteringUtility::PackTable( table );
+    if ( data.size() != nrows * ncolumns )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Cannot pack the input table.");
+        return NULL;
+    }
 
     // Assign initial cluster IDs to each row of the input table randomly.
-    kvs::ValueArray<kvs::UInt16> IDs( table->numberOfRows() );
-    for ( size_t i = 0; i < table->numberOfRows(); i++ ) IDs[i] = kvs::UInt16( m_nclusters * m_random() );
+    kvs::ValueArray<kvs::UInt16> IDs( nrows );
+    for ( size_t i = 0; i < nrows; i++ ) IDs[i] = kvs::UInt16( nclusters * m_random() );
 
-    // Calculate the center of cluster.
+    // Calculate the center of cluster (packed in row-major order).
+    kvs::ValueArray<kvs::Real32> centers( nclusters * ncolumns );
     switch ( m_seeding_method )
     {
     case RandomSeeding:
-        ::InitializeCentersWithRandomSeeding( table, m_nclusters, IDs, m_centers );
+        ::InitializeCentersWithRandomSeeding( data.data(), nrows, ncolumns, nclusters, IDs, centers.data() );
         break;
     case SmartSeeding:
-        ::InitializeCentersWithSmartSeeding( table, m_nclusters, IDs, m_centers );
+        pcs::ClusteringUtility::ScalableSeeding( data.data(), nrows, ncolumns, nclusters, m_random, centers.data() );
         break;
     default:
-        ::InitializeCentersWithRandomSeeding( table, m_nclusters, IDs, m_centers );
+        ::InitializeCentersWithRandomSeeding( data.data(), nrows, ncolumns, nclusters, IDs, centers.data() );
         break;
     }
 
-    // Cluster center used for convergence test.
-    kvs::ValueArray<kvs::Real32> center_new( table->numberOfColumns() );
+    // Vector sums and numbers of the rows for each cluster.
+    std::vector<kvs::Real64> sums( nclusters * ncolumns );
+    std::vector<size_t> counts( nclusters );
 
     // Clustering.
+    /* NOTE: The assignment of the rows and the accumulation for the new
+     * centers are done in the same pass, and the convergence test is done
+     * with the accumulated sums, so each iteration reads the data once.
+     */
     bool converged = false;
     size_t counter = 0;
     while ( !converged )
     {
-        // Calculate euclidean distance between the center of cluster and the point, and update the IDs.
-        for ( size_t i = 0; i < table->numberOfRows(); i++ )
-        {
-            size_t id = 0;
-            kvs::Real32 distance = kvs::Value<kvs::Real32>::Max();
-            for ( size_t j = 0; j < m_nclusters; j++ )
-            {
-                const kvs::Real32 d = ::GetEuclideanDistance( table, i, m_centers[j] );
-                if ( d < distance ) { distance = d; id = j; }
-            }
-            IDs[i] = id;
-        }
-
-        // Convergence test.
-        converged = true;
-        for ( size_t i = 0; i < m_nclusters; i++ )
-        {
-            ::CalculateCenter( table, i, IDs, &center_new );
-
-            const kvs::Real32 distance = ::GetEuclideanDistance( table, m_centers[i], center_new );
-            if ( !( distance < m_tolerance ) )
-            {
-                converged = false;
-                break;
-            }
-        }
+        ::AssignAndAccumulate( data.data(), nrows, ncolumns, centers.data(), nclusters, IDs.data(), &sums[0], &counts[0] );
+        converged = ::MoveCenters( &sums[0], &counts[0], nclusters, ncolumns, m_tolerance, centers.data() );
 
         if ( counter++ > m_max_iterations ) break;
+    }
 
-        // Calculate the center of cluster.
-        if ( !converged )
-        {
-            for ( size_t i = 0; i < m_nclusters; i++ )
-            {
-                ::CalculateCenter( table, i, IDs, &(m_centers[i]) );
-            }
-        }
-
-    } // end of while
+    // Allocate memory for the cluster center.
+    if ( m_centers ) delete [] m_centers;
+    m_centers = new kvs::ValueArray<kvs::Real32> [ nclusters ];
+    for ( size_t i = 0; i < nclusters; i++ )
+    {
+        m_centers[i].allocate( ncolumns );
+        std::copy( centers.data() + i * ncolumns, centers.data() + ( i + 1 ) * ncolumns, m_centers[i].begin() );
+    }
 
     // Set the results to the output table object.
-    const size_t ncolumns = table->numberOfColumns();
     for ( size_t i = 0; i < ncolumns; i++ )
     {
         const std::string label = table->label(i);
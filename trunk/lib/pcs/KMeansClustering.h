@@ -17,6 +17,9 @@
  * [1] D. Arthur and S. Vassilvitskii, k-means++ : The Advantages of Careful
  *     Seeding, in Proceedings of the eighteenth annual ACM-SIAM symposium on
  *     Discrete algorithms, 2007, pp. 1027-1035.
+ * [2] B. Bahmani, B. Moseley, A. Vattani, R. Kumar and S. Vassilvitskii,
+ *     Scalable K-Means++, Proceedings of the VLDB Endowment, Vol. 5, No. 7,
+ *     2012, pp. 622-633.
  */
 /*****************************************************************************/
 #ifndef KVSOCEANVIS__PCS__K_MEANS_CLUSTERING_H_INCLUDE
@@ -0,0 +1,362 @@
+/*****************************************************************************/
+/**
+ *  @file   MultiBinDensityClusterMapping.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "MultiBinDensityClusterMapping.h"
+#include "MultiBinMapObject.h"
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <kvs/Value>
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Hash table from the bin indices to the bin number.
+ *
+ *  The bin indices of all the axes are packed into a 64-bit hash key, and
+ *  the collisions are resolved by the linear probing with the comparison of
+ *  the indices. The table is read-only after the insertion, so it can be
+ *  looked up from the threads concurrently.
+ */
+/*===========================================================================*/
+class BinTable
+{
+private:
+
+    size_t m_naxes; ///< number of axes
+    size_t m_mask; ///< number of slots - 1
+    std::vector<kvs::UInt32> m_slots; ///< bin number + 1 (0: empty slot)
+    std::vector<const kvs::UInt16*> m_indices; ///< bin indices of each bin
+
+public:
+
+    BinTable( const size_t naxes, const size_t nbins ):
+        m_naxes( naxes )
+    {
+        size_t nslots = 16;
+        while ( nslots < 2 * nbins ) { nslots <<= 1; }
+        m_mask = nslots - 1;
+        m_slots.assign( nslots, 0 );
+        m_indices.reserve( nbins );
+    }
+
+    static kvs::UInt64 Key( const kvs::UInt16* indices, const size_t naxes )
+    {
+        // FNV-1a over the 16-bit indices with the SplitMix64 finalizer.
+        kvs::UInt64 key = 14695981039346656037ULL;
+        for ( size_t i = 0; i < naxes; i++ )
+        {
+            key ^= indices[i];
+            key *= 1099511628211ULL;
+        }
+        key ^= key >> 30; key *= 0xbf58476d1ce4e5b9ULL;
+        key ^= key >> 27; key *= 0x94d049bb133111ebULL;
+        key ^= key >> 31;
+        return key;
+    }
+
+    void insert( const kvs::UInt16* indices )
+    {
+        const kvs::UInt32 number = static_cast<kvs::UInt32>( m_indices.size() );
+        m_indices.push_back( indices );
+
+        size_t slot = static_cast<size_t>( Key( indices, m_naxes ) ) & m_mask;
+        while ( m_slots[ slot ] != 0 ) { slot = ( slot + 1 ) & m_mask; }
+        m_slots[ slot ] = number + 1;
+    }
+
+    kvs::Int64 find( const kvs::UInt16* indices ) const
+    {
+        size_t slot = static_cast<size_t>( Key( indices, m_naxes ) ) & m_mask;
+        while ( m_slots[ slot ] != 0 )
+        {
+            const kvs::UInt32 number = m_slots[ slot ] - 1;
+            if ( std::equal( indices, indices + m_naxes, m_indices[ number ] ) ) return number;
+            slot = ( slot + 1 ) & m_mask;
+        }
+
+        return -1;
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Union-find (disjoint set) with the union by size and the path halving.
+ */
+/*===========================================================================*/
+class DisjointSet
+{
+private:
+
+    std::vector<kvs::UInt32> m_parents; ///< parent of each element
+    std::vector<kvs::UInt32> m_sizes; ///< size of the set for each root
+
+public:
+
+    DisjointSet( const size_t size ):
+        m_parents( size ),
+        m_sizes( size, 1 )
+    {
+        for ( size_t i = 0; i < size; i++ ) { m_parents[i] = static_cast<kvs::UInt32>( i ); }
+    }
+
+    kvs::UInt32 find( kvs::UInt32 x )
+    {
+        while ( m_parents[x] != x )
+        {
+            m_parents[x] = m_parents[ m_parents[x] ];
+            x = m_parents[x];
+        }
+        return x;
+    }
+
+    void unite( const kvs::UInt32 x, const kvs::UInt32 y )
+    {
+        kvs::UInt32 rx = this->find( x );
+        kvs::UInt32 ry = this->find( y );
+        if ( rx == ry ) return;
+
+        if ( m_sizes[ rx ] < m_sizes[ ry ] ) std::swap( rx, ry );
+        m_parents[ ry ] = rx;
+        m_sizes[ rx ] += m_sizes[ ry ];
+    }
+};
+
+}
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new MultiBinDensityClusterMapping class.
+ */
+/*===========================================================================*/
+MultiBinDensityClusterMapping::MultiBinDensityClusterMapping():
+    m_density_threshold( 1 )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new MultiBinDensityClusterMapping class.
+ *  @param  object [in] pointer to the multiple binned map object
+ *  @param  density_threshold [in] min. number of rows in a dense bin
+ */
+/*===========================================================================*/
+MultiBinDensityClusterMapping::MultiBinDensityClusterMapping( const kvs::ObjectBase* object, const size_t density_threshold ):
+    m_density_threshold( density_threshold )
+{
+    this->exec( object );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Executes the density cluster mapping for the occupied bins.
+ *  @param  object [in] pointer to the multiple binned map object
+ *  @return pointer to the cluster map object
+ */
+/*===========================================================================*/
+MultiBinDensityClusterMapping::SuperClass* MultiBinDensityClusterMapping::exec( const kvs::ObjectBase* object )
+{
+    if ( !object )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input object is NULL.");
+        return NULL;
+    }
+
+    const pcs::MultiBinMapObject* bin_map = reinterpret_cast<const pcs::MultiBinMapObject*>( object );
+    const pcs::MultiBinMapObject::BinList& bin_list = bin_map->binList();
+    const kvs::ValueArray<kvs::UInt32>& nbins = bin_map->nbins();
+    const size_t naxes = bin_map->naxes();
+    const size_t noccupied_bins = bin_list.size();
+    if ( noccupied_bins == 0 || naxes == 0 )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input bins are empty.");
+        return NULL;
+    }
+
+    // Dense bins.
+    std::vector<const pcs::MultiBinMapObject::Bin*> bins;
+    bins.reserve( noccupied_bins );
+    std::vector<size_t> dense_bins; // bin numbers of the dense bins in the list
+    {
+        pcs::MultiBinMapObject::BinList::const_iterator bin = bin_list.begin();
+        pcs::MultiBinMapObject::BinList::const_iterator last = bin_list.end();
+        while ( bin != last )
+        {
+            if ( bin->counter() >= m_density_threshold ) dense_bins.push_back( bins.size() );
+            bins.push_back( &*bin );
+            bin++;
+        }
+    }
+
+    const size_t ndense_bins = dense_bins.size();
+    ::BinTable table( naxes, ndense_bins );
+    for ( size_t i = 0; i < ndense_bins; i++ ) { table.insert( bins[ dense_bins[i] ]->indices().data() ); }
+
+    // Adjacent pairs of the dense bins.
+    /* NOTE: Each dense bin looks up the neighbors in the positive direction of
+     * each axis, so every adjacent pair is found once. The look-ups are split
+     * across the threads, and the pairs are united after the look-ups.
+     */
+    ::DisjointSet components( ndense_bins );
+    const kvs::Int64 n = static_cast<kvs::Int64>( ndense_bins );
+    #pragma omp parallel
+    {
+        std::vector< std::pair<kvs::UInt32,kvs::UInt32> > pairs;
+        std::vector<kvs::UInt16> neighbor( naxes );
+
+        #pragma omp for schedule(dynamic, 1024)
+        for ( kvs::Int64 i = 0; i < n; i++ )
+        {
+            const kvs::ValueArray<kvs::UInt16>& indices = bins[ dense_bins[i] ]->indices();
+            std::copy( indices.begin(), indices.end(), neighbor.begin() );
+            for ( size_t j = 0; j < naxes; j++ )
+            {
+                if ( size_t( indices[j] ) + 1 >= nbins[j] ) continue;
+
+                neighbor[j] = indices[j] + 1;
+                const kvs::Int64 k = table.find( &neighbor[0] );
+                if ( k >= 0 ) pairs.push_back( std::make_pair( kvs::UInt32( i ), kvs::UInt32( k ) ) );
+                neighbor[j] = indices[j];
+            }
+        }
+
+        #pragma omp critical
+        {
+            for ( size_t i = 0; i < pairs.size(); i++ ) { components.unite( pairs[i].first, pairs[i].second ); }
+        }
+    }
+
+    // Cluster IDs of the bins (sequential numbers in the order of the list).
+    m_bin_cluster_ids.allocate( noccupied_bins );
+    m_bin_cluster_ids.fill( -1 );
+    std::vector<kvs::Int32> root_ids( ndense_bins, -1 );
+    size_t nclusters = 0;
+    for ( size_t i = 0; i < ndense_bins; i++ )
+    {
+        const kvs::UInt32 root = components.find( kvs::UInt32( i ) );
+        if ( root_ids[ root ] < 0 ) root_ids[ root ] = static_cast<kvs::Int32>( nclusters++ );
+        m_bin_cluster_ids[ dense_bins[i] ] = root_ids[ root ];
+    }
+
+    // Cluster parameters.
+    std::vector<size_t> counter( nclusters, 0 );
+    kvs::ValueArray<kvs::Real64>* min_values = new kvs::ValueArray<kvs::Real64> [ nclusters ];
+    kvs::ValueArray<kvs::Real64>* max_values = new kvs::ValueArray<kvs::Real64> [ nclusters ];
+
+    // Initialize the parameters.
+    for ( size_t i = 0; i < nclusters; i++ )
+    {
+        min_values[i].allocate( naxes );
+        max_values[i].allocate( naxes );
+        for ( size_t j = 0; j < naxes; j++ )
+        {
+            min_values[i][j] = kvs::Value<kvs::Real64>::Max();
+            max_values[i][j] = kvs::Value<kvs::Real64>::Min();
+        }
+    }
+
+    // Cluster mapping (the min/max values are derived from the bin edges).
+    for ( size_t i = 0; i < ndense_bins; i++ )
+    {
+        const pcs::MultiBinMapObject::Bin* bin = bins[ dense_bins[i] ];
+        const size_t id = m_bin_cluster_ids[ dense_bins[i] ];
+        const kvs::ValueArray<kvs::UInt16>& indices = bin->indices();
+        for ( size_t j = 0; j < naxes; j++ )
+        {
+            min_values[id][j] = kvs::Math::Min( min_values[id][j], bin_map->binMinValue( j, indices[j] ) );
+            max_values[id][j] = kvs::Math::Max( max_values[id][j], bin_map->binMaxValue( j, indices[j] ) );
+        }
+        counter[id] += bin->counter();
+    }
+
+    // Set the clusters.
+    for ( size_t i = 0; i < nclusters; i++ )
+    {
+        SuperClass::Cluster cluster;
+        cluster.setID( i );
+        cluster.setCounter( counter[i] );
+        cluster.setMinValues( min_values[i] );
+        cluster.setMaxValues( max_values[i] );
+
+        SuperClass::m_cluster_list.push_back( cluster );
+    }
+
+    delete [] min_values;
+    delete [] max_values;
+
+    // Sorting.
+    SuperClass::m_cluster_list.sort();
+
+    // Number of axes.
+    SuperClass::m_naxes = naxes;
+    SuperClass::setNumberOfColumns( naxes );
+
+    // Number of points.
+    SuperClass::m_npoints = bin_map->npoints();
+    SuperClass::setNumberOfRows( bin_map->numberOfRows() );
+
+    // Min/Max value.
+    SuperClass::setMinValues( bin_map->minValues() );
+    SuperClass::setMaxValues( bin_map->maxValues() );
+    SuperClass::setLabels( bin_map->labels() );
+
+    // Min/Max range.
+    SuperClass::setMinRanges( bin_map->minValues() );
+    SuperClass::setMaxRanges( bin_map->maxValues() );
+
+    return this;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a density threshold.
+ *  @param  density_threshold [in] min. number of rows in a dense bin
+ */
+/*===========================================================================*/
+void MultiBinDensityClusterMapping::setDensityThreshold( const size_t density_threshold )
+{
+    m_density_threshold = density_threshold;
+}
+
+size_t MultiBinDensityClusterMapping::densityThreshold() const
+{
+    return m_density_threshold;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the cluster IDs of the bins.
+ *  @return cluster ID of each bin in the order of the bin list (-1: noise)
+ */
+/*===========================================================================*/
+const kvs::ValueArray<kvs::Int32>& MultiBinDensityClusterMapping::binClusterIDs() const
+{
+    return m_bin_cluster_ids;
+}
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
@@ -0,0 +1,74 @@
+/*****************************************************************************/
+/**
+ *  @file   MultiBinDensityClusterMapping.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__PCS__MULTI_BIN_DENSITY_CLUSTER_MAPPING_H_INCLUDE
+#define KVSOCEANVIS__PCS__MULTI_BIN_DENSITY_CLUSTER_MAPPING_H_INCLUDE
+
+#include <kvs/Module>
+#include <kvs/FilterBase>
+#include <kvs/ValueArray>
+#include "ClusterMapObject.h"
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Grid-based density cluster mapping class for the multiple binned map object.
+ *
+ *  The occupied bins whose counter is not less than the density threshold are
+ *  the dense bins, and the connected components of the dense bins (adjacent
+ *  on one of the axes) are the clusters. The other bins are the noise and do
+ *  not belong to any cluster. The cost depends on the number of the occupied
+ *  bins instead of the number of rows.
+ */
+/*===========================================================================*/
+class MultiBinDensityClusterMapping : public kvs::FilterBase, public pcs::ClusterMapObject
+{
+    kvsModuleName( kvsoceanvis::pcs::MultiBinDensityClusterMapping );
+    kvsModuleCategory( Filter );
+    kvsModuleBaseClass( kvs::FilterBase );
+    kvsModuleSuperClass( pcs::ClusterMapObject );
+
+protected:
+
+    size_t m_density_threshold; ///< min. number of rows in a dense bin
+    kvs::ValueArray<kvs::Int32> m_bin_cluster_ids; ///< cluster ID of each bin (-1: noise)
+
+public:
+
+    MultiBinDensityClusterMapping();
+    MultiBinDensityClusterMapping( const kvs::ObjectBase* object, const size_t density_threshold );
+
+public:
+
+    SuperClass* exec( const kvs::ObjectBase* object );
+
+public:
+
+    void setDensityThreshold( const size_t density_threshold );
+
+    size_t densityThreshold() const;
+    const kvs::ValueArray<kvs::Int32>& binClusterIDs() const;
+};
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__PCS__MULTI_BIN_DENSITY_CLUSTER_MAPPING_H_INCLUDE
@@ -0,0 +1,252 @@
+/*****************************************************************************/
+/**
+ *  @file   MultiBinKMeansClusterMapping.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "MultiBinKMeansClusterMapping.h"
+#include "MultiBinMapObject.h"
+#include "FastKMeansClustering.h"
+#include <vector>
+#include <kvs/TableObject>
+#include <kvs/ValueArray>
+#include <kvs/Value>
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new MultiBinKMeansClusterMapping class.
+ */
+/*===========================================================================*/
+MultiBinKMeansClusterMapping::MultiBinKMeansClusterMapping():
+    m_seed( 0 ),
+    m_nclusters( 10 ),
+    m_max_iterations( 100 ),
+    m_tolerance( 1.e-6 )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new MultiBinKMeansClusterMapping class.
+ *  @param  object [in] pointer to the multiple binned map object
+ *  @param  nclusters [in] number of clusters
+ */
+/*===========================================================================*/
+MultiBinKMeansClusterMapping::MultiBinKMeansClusterMapping( const kvs::ObjectBase* object, const size_t nclusters ):
+    m_seed( 0 ),
+    m_nclusters( nclusters ),
+    m_max_iterations( 100 ),
+    m_tolerance( 1.e-6 )
+{
+    this->exec( object );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Executes the k-means cluster mapping for the occupied bins.
+ *  @param  object [in] pointer to the multiple binned map object
+ *  @return pointer to the cluster map object
+ */
+/*===========================================================================*/
+MultiBinKMeansClusterMapping::SuperClass* MultiBinKMeansClusterMapping::exec( const kvs::ObjectBase* object )
+{
+    if ( !object )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input object is NULL.");
+        return NULL;
+    }
+
+    const pcs::MultiBinMapObject* bin_map = reinterpret_cast<const pcs::MultiBinMapObject*>( object );
+    const pcs::MultiBinMapObject::BinList& bin_list = bin_map->binList();
+    const size_t naxes = bin_map->naxes();
+    const size_t noccupied_bins = bin_list.size();
+    if ( noccupied_bins == 0 || naxes == 0 || m_nclusters == 0 )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input bins or number of clusters is empty.");
+        return NULL;
+    }
+
+    // The number of clusters cannot exceed the number of occupied bins.
+    const size_t nclusters = kvs::Math::Min( m_nclusters, noccupied_bins );
+
+    // Table of the bin centers with the weights (number of rows in the bin)
+    // as the last column.
+    kvs::TableObject points;
+    {
+        std::vector< kvs::ValueArray<kvs::Real32> > columns( naxes + 1 );
+        for ( size_t j = 0; j <= naxes; j++ ) { columns[j].allocate( noccupied_bins ); }
+
+        size_t index = 0;
+        pcs::MultiBinMapObject::BinList::const_iterator bin = bin_list.begin();
+        pcs::MultiBinMapObject::BinList::const_iterator last = bin_list.end();
+        while ( bin != last )
+        {
+            const kvs::ValueArray<kvs::UInt16>& indices = bin->indices();
+            for ( size_t j = 0; j < naxes; j++ )
+            {
+                columns[j][ index ] = static_cast<kvs::Real32>( bin_map->binCenter( j, indices[j] ) );
+            }
+            columns[ naxes ][ index ] = static_cast<kvs::Real32>( bin->counter() );
+
+            index++;
+            bin++;
+        }
+
+        for ( size_t j = 0; j < naxes; j++ ) { points.addColumn( kvs::AnyValueArray( columns[j] ), bin_map->label(j) ); }
+        points.addColumn( kvs::AnyValueArray( columns[ naxes ] ), "Weight" );
+    }
+
+    // Weighted k-means clustering of the bin centers.
+    pcs::FastKMeansClustering clustering;
+    clustering.setSeed( m_seed );
+    clustering.setSeedingMethod( pcs::FastKMeansClustering::SmartSeeding );
+    clustering.setNumberOfClusters( nclusters );
+    clustering.setMaxIterations( m_max_iterations );
+    clustering.setTolerance( m_tolerance );
+    clustering.enableWeight();
+    if ( !clustering.exec( &points ) )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Cannot cluster the occupied bins.");
+        return NULL;
+    }
+
+    // Cluster parameters.
+    std::vector<size_t> counter( nclusters, 0 );
+    kvs::ValueArray<kvs::Real64>* min_values = new kvs::ValueArray<kvs::Real64> [ nclusters ];
+    kvs::ValueArray<kvs::Real64>* max_values = new kvs::ValueArray<kvs::Real64> [ nclusters ];
+
+    // Initialize the parameters.
+    for ( size_t i = 0; i < nclusters; i++ )
+    {
+        min_values[i].allocate( naxes );
+        max_values[i].allocate( naxes );
+        for ( size_t j = 0; j < naxes; j++ )
+        {
+            min_values[i][j] = kvs::Value<kvs::Real64>::Max();
+            max_values[i][j] = kvs::Value<kvs::Real64>::Min();
+        }
+    }
+
+    // Cluster mapping.
+    /* NOTE: The min/max values of the cluster are derived from the edges of
+     * the bins in the cluster, so that the cluster envelope covers all the
+     * rows counted in the bins.
+     */
+    const kvs::AnyValueArray& IDs = clustering.column( naxes + 1 );
+    size_t index = 0;
+    pcs::MultiBinMapObject::BinList::const_iterator bin = bin_list.begin();
+    pcs::MultiBinMapObject::BinList::const_iterator last = bin_list.end();
+    while ( bin != last )
+    {
+        const size_t id = IDs.at<kvs::UInt32>( index );
+        const kvs::ValueArray<kvs::UInt16>& indices = bin->indices();
+        for ( size_t j = 0; j < naxes; j++ )
+        {
+            min_values[id][j] = kvs::Math::Min( min_values[id][j], bin_map->binMinValue( j, indices[j] ) );
+            max_values[id][j] = kvs::Math::Max( max_values[id][j], bin_map->binMaxValue( j, indices[j] ) );
+        }
+        counter[id] += bin->counter();
+
+        index++;
+        bin++;
+    }
+
+    // Set the clusters.
+    for ( size_t i = 0; i < nclusters; i++ )
+    {
+        SuperClass::Cluster cluster;
+        cluster.setID( i );
+        cluster.setCounter( counter[i] );
+        cluster.setMinValues( min_values[i] );
+        cluster.setMaxValues( max_values[i] );
+
+        SuperClass::m_cluster_list.push_back( cluster );
+    }
+
+    delete [] min_values;
+    delete [] max_values;
+
+    // Sorting.
+    SuperClass::m_cluster_list.sort();
+
+    // Number of axes.
+    SuperClass::m_naxes = naxes;
+    SuperClass::setNumberOfColumns( naxes );
+
+    // Number of points.
+    SuperClass::m_npoints = bin_map->npoints();
+    SuperClass::setNumberOfRows( bin_map->numberOfRows() );
+
+    // Min/Max value.
+    SuperClass::setMinValues( bin_map->minValues() );
+    SuperClass::setMaxValues( bin_map->maxValues() );
+    SuperClass::setLabels( bin_map->labels() );
+
+    // Min/Max range.
+    SuperClass::setMinRanges( bin_map->minValues() );
+    SuperClass::setMaxRanges( bin_map->maxValues() );
+
+    return this;
+}
+
+void MultiBinKMeansClusterMapping::setSeed( const size_t seed )
+{
+    m_seed = seed;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a number of clusters.
+ *  @param  nclusters [in] number of clusters
+ *
+ *  The number of clusters is limited to the number of occupied bins.
+ */
+/*===========================================================================*/
+void MultiBinKMeansClusterMapping::setNumberOfClusters( const size_t nclusters )
+{
+    m_nclusters = nclusters;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a maximum number of interations.
+ *  @param  max_iterations [in] maximum number of iterations
+ */
+/*===========================================================================*/
+void MultiBinKMeansClusterMapping::setMaxIterations( const size_t max_iterations )
+{
+    m_max_iterations = max_iterations;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a tolerance for the convergence test.
+ *  @param  tolerance [in] tolerance which can be assumed zero
+ */
+/*===========================================================================*/
+void MultiBinKMeansClusterMapping::setTolerance( const float tolerance )
+{
+    m_tolerance = tolerance;
+}
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
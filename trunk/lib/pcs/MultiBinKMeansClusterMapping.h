@@ -0,0 +1,73 @@
+/*****************************************************************************/
+/**
+ *  @file   MultiBinKMeansClusterMapping.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__PCS__MULTI_BIN_K_MEANS_CLUSTER_MAPPING_H_INCLUDE
+#define KVSOCEANVIS__PCS__MULTI_BIN_K_MEANS_CLUSTER_MAPPING_H_INCLUDE
+
+#include <kvs/Module>
+#include <kvs/FilterBase>
+#include "ClusterMapObject.h"
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  K-means cluster mapping class for the multiple binned map object.
+ *
+ *  The centers of the occupied bins are clustered as the points weighted by
+ *  the number of rows in the bins, so the cost of the clustering depends on
+ *  the number of the occupied bins instead of the number of rows.
+ */
+/*===========================================================================*/
+class MultiBinKMeansClusterMapping : public kvs::FilterBase, public pcs::ClusterMapObject
+{
+    kvsModuleName( kvsoceanvis::pcs::MultiBinKMeansClusterMapping );
+    kvsModuleCategory( Filter );
+    kvsModuleBaseClass( kvs::FilterBase );
+    kvsModuleSuperClass( pcs::ClusterMapObject );
+
+protected:
+
+    size_t m_seed; ///< seed of the random number generator
+    size_t m_nclusters; ///< number of clusters
+    size_t m_max_iterations; ///< maximum number of interations
+    float m_tolerance; ///< tolerance of distance
+
+public:
+
+    MultiBinKMeansClusterMapping();
+    MultiBinKMeansClusterMapping( const kvs::ObjectBase* object, const size_t nclusters );
+
+public:
+
+    SuperClass* exec( const kvs::ObjectBase* object );
+
+public:
+
+    void setSeed( const size_t seed );
+    void setNumberOfClusters( const size_t nclusters );
+    void setMaxIterations( const size_t max_iterations );
+    void setTolerance( const float tolerance );
+};
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__PCS__MULTI_BIN_K_MEANS_CLUSTER_MAPPING_H_INCLUDE
@@ -50,6 +50,66 @@ size_t MultiBinMapObject::naxes() const
     return m_nbins.size();
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Returns the center value of the bin on the axis.
+ *  @param  column_index [in] column (axis) index
+ *  @param  bin_index [in] bin index on the axis
+ *  @return center value of the bin
+ *
+ *  The bin index of the value v is given by round( ( n - 1 ) * ( v - min ) /
+ *  ( max - min ) ) in MultiBinMapping, so the bin i is centered at min + i * w
+ *  with the bin width w = ( max - min ) / ( n - 1 ).
+ */
+/*===========================================================================*/
+kvs::Real64 MultiBinMapObject::binCenter( const size_t column_index, const size_t bin_index ) const
+{
+    const size_t nbins = m_nbins[ column_index ];
+    const kvs::Real64 min_value = this->minValue( column_index );
+    const kvs::Real64 max_value = this->maxValue( column_index );
+    if ( nbins <= 1 ) return 0.5 * ( min_value + max_value );
+
+    return min_value + bin_index * ( max_value - min_value ) / ( nbins - 1 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the lower edge of the bin on the axis.
+ *  @param  column_index [in] column (axis) index
+ *  @param  bin_index [in] bin index on the axis
+ *  @return lower edge of the bin (clamped to the min. value)
+ */
+/*===========================================================================*/
+kvs::Real64 MultiBinMapObject::binMinValue( const size_t column_index, const size_t bin_index ) const
+{
+    const size_t nbins = m_nbins[ column_index ];
+    const kvs::Real64 min_value = this->minValue( column_index );
+    const kvs::Real64 max_value = this->maxValue( column_index );
+    if ( nbins <= 1 ) return min_value;
+
+    const kvs::Real64 half_width = 0.5 * ( max_value - min_value ) / ( nbins - 1 );
+    return kvs::Math::Max( this->binCenter( column_index, bin_index ) - half_width, min_value );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the upper edge of the bin on the axis.
+ *  @param  column_index [in] column (axis) index
+ *  @param  bin_index [in] bin index on the axis
+ *  @return upper edge of the bin (clamped to the max. value)
+ */
+/*===========================================================================*/
+kvs::Real64 MultiBinMapObject::binMaxValue( const size_t column_index, const size_t bin_index ) const
+{
+    const size_t nbins = m_nbins[ column_index ];
+    const kvs::Real64 min_value = this->minValue( column_index );
+    const kvs::Real64 max_value = this->maxValue( column_index );
+    if ( nbins <= 1 ) return max_value;
+
+    const kvs::Real64 half_width = 0.5 * ( max_value - min_value ) / ( nbins - 1 );
+    return kvs::Math::Min( this->binCenter( column_index, bin_index ) + half_width, max_value );
+}
+
 void MultiBinMapObject::setMinRange( const size_t column_index, const kvs::Real64 range )
 {
     const kvs::Real64 min_value = this->minValue( column_index );
@@ -62,6 +62,9 @@ public:
     const BinList& binList() const;
     const kvs::ValueArray<kvs::UInt32>& nbins() const;
     size_t naxes() const;
+    kvs::Real64 binCenter( const size_t column_index, const size_t bin_index ) const;
+    kvs::Real64 binMinValue( const size_t column_index, const size_t bin_index ) const;
+    kvs::Real64 binMaxValue( const size_t column_index, const size_t bin_index ) const;
 
     void setMinRange( const size_t column_index, const kvs::Real64 range );
     void setMaxRange( const size_t column_index, const kvs::Real64 range );
@@ -19,6 +19,8 @@
 #include <kvs/ObjectBase>
 #include <kvs/AnyValueArray>
 #include <kvs/Math>
+#include <map>
+#include <cmath>
 #include "MultiBinMapObject.h"
 
 
@@ -48,6 +50,107 @@ void EndDraw()
     glPopAttrib();
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the vertices of the bin on the screen.
+ *  @param  object [in] pointer to the bin map object
+ *  @param  indices [in] bin indices
+ *  @param  x0 [in] x position of the first axis
+ *  @param  stride [in] interval between the axes
+ *  @param  y0 [in] top position of the axes
+ *  @param  y1 [in] bottom position of the axes
+ *  @param  vertex [out] vertices (x, ya, x, yb for each axis)
+ *  @return false if the bin is out of the selected ranges
+ */
+/*===========================================================================*/
+bool CalculateBinVertices(
+    const kvsoceanvis::pcs::MultiBinMapObject* object,
+    const kvs::ValueArray<kvs::UInt16>& indices,
+    const int x0,
+    const float stride,
+    const int y0,
+    const int y1,
+    GLfloat* vertex )
+{
+    const size_t naxes = object->naxes();
+    for ( size_t i = 0; i < naxes; i++ )
+    {
+        const size_t nbins = object->nbins().at(i);
+        const size_t index = indices[i];
+
+        const kvs::Real64 y_min_value = object->minValue(i);
+        const kvs::Real64 y_max_value = object->maxValue(i);
+        const kvs::Real64 y_min_range = object->minRange(i);
+        const kvs::Real64 y_max_range = object->maxRange(i);
+        const kvs::Real64 bin_width = ( y_max_value - y_min_value ) / nbins;
+        if ( y_max_range < y_min_value + bin_width * ( index + 1 ) ||
+             y_min_range > y_min_value + bin_width * ( index + 0 ) )
+        {
+            return false;
+        }
+
+        const float x = x0 + stride * i;
+        const float width = float( y1 - y0 ) / nbins;
+        const float ya = y1 - width * indices[i];
+        const float yb = ya - width;
+        vertex[ 4 * i + 0 ] = x;
+        vertex[ 4 * i + 1 ] = ya;
+        vertex[ 4 * i + 2 ] = x;
+        vertex[ 4 * i + 3 ] = yb;
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Draws the bin as a quad strip.
+ *  @param  vertex [in] vertices (x, ya, x, yb for each axis)
+ *  @param  naxes [in] number of axes
+ *  @param  r [in] red component
+ *  @param  g [in] green component
+ *  @param  b [in] blue component
+ *  @param  a [in] opacity
+ *  @param  edge_width [in] bin edge width (not drawn if zero)
+ */
+/*===========================================================================*/
+void DrawBin(
+    const GLfloat* vertex,
+    const size_t naxes,
+    const GLubyte r,
+    const GLubyte g,
+    const GLubyte b,
+    const GLubyte a,
+    const kvs::Real32 edge_width )
+{
+    glBegin( GL_QUAD_STRIP );
+    glColor4ub( r, g, b, a );
+    for ( size_t i = 0; i < naxes; i++ )
+    {
+        glVertex2fv( vertex + 4 * i );
+        glVertex2fv( vertex + 4 * i + 2 );
+    }
+    glEnd();
+
+    if ( edge_width > 0.0f )
+    {
+        glLineWidth( edge_width );
+        const GLubyte er = r * 0.8 + 0.5;
+        const GLubyte eg = g * 0.8 + 0.5;
+        const GLubyte eb = b * 0.8 + 0.5;
+        for ( size_t i = 0; i < naxes - 1; i++ )
+        {
+            glBegin( GL_LINE_LOOP );
+            glColor4ub( er, eg, eb, a );
+            glVertex2f( vertex[4*i+0], vertex[4*i+1] );
+            glVertex2f( vertex[4*i+2], vertex[4*i+3] );
+            glVertex2f( vertex[4*i+6], vertex[4*i+7] );
+            glVertex2f( vertex[4*i+4], vertex[4*i+5] );
+            glEnd();
+        }
+    }
+}
+
 } // end of namespace
 
 
@@ -72,7 +175,10 @@ MultiBinMappedParallelCoordinatesRenderer::MultiBinMappedParallelCoordinatesRend
     m_active_axis( 0 ),
     m_bin_opacity( 255 ),
     m_bin_edge_width( 0.0f ),
-    m_color_map( 256 )
+    m_color_map( 256 ),
+    m_enable_lod( false ),
+    m_lod_opacity_threshold( 0.0f ),
+    m_lod_object( NULL )
 {
     m_color_map.create();
 }
@@ -175,6 +281,9 @@ void MultiBinMappedParallelCoordinatesRenderer::setBinEdgeWidth( const kvs::Real
 void MultiBinMappedParallelCoordinatesRenderer::setColorMap( const kvs::ColorMap& color_map )
 {
     m_color_map = color_map;
+
+    // The colors of the LOD bins are recalculated at the next drawing.
+    m_lod_parameters.clear();
 }
 
 /*===========================================================================*/
@@ -188,6 +297,47 @@ void MultiBinMappedParallelCoordinatesRenderer::selectAxis( const size_t index )
     m_active_axis = index;
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Enables level-of-detail (LOD) rendering.
+ *  @param  opacity_threshold [in] opacity threshold in [0,1] for dropping merged bins
+ *
+ *  In LOD rendering, bins whose screen-space footprints coincide on all axes
+ *  are merged into one quad strip, and the merged bins whose accumulated
+ *  opacity is below the threshold are not drawn.
+ */
+/*===========================================================================*/
+void MultiBinMappedParallelCoordinatesRenderer::enableLOD( const kvs::Real32 opacity_threshold )
+{
+    m_enable_lod = true;
+    m_lod_opacity_threshold = opacity_threshold;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Disables level-of-detail (LOD) rendering.
+ */
+/*===========================================================================*/
+void MultiBinMappedParallelCoordinatesRenderer::disableLOD()
+{
+    m_enable_lod = false;
+    m_lod_object = NULL;
+    m_lod_parameters.clear();
+    m_lod_vertices.clear();
+    m_lod_colors.clear();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets opacity threshold for dropping merged bins in LOD rendering.
+ *  @param  opacity_threshold [in] opacity threshold in [0,1]
+ */
+/*===========================================================================*/
+void MultiBinMappedParallelCoordinatesRenderer::setLODOpacityThreshold( const kvs::Real32 opacity_threshold )
+{
+    m_lod_opacity_threshold = opacity_threshold;
+}
+
 /*===========================================================================*/
 /**
  *  @brief  Returns top margin.
@@ -265,6 +415,39 @@ kvs::Real32 MultiBinMappedParallelCoordinatesRenderer::binEdgeWidth() const
     return m_bin_edge_width;
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if level-of-detail (LOD) rendering is enabled.
+ *  @return true if LOD rendering is enabled
+ */
+/*===========================================================================*/
+bool MultiBinMappedParallelCoordinatesRenderer::isEnabledLOD() const
+{
+    return m_enable_lod;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns opacity threshold for dropping merged bins in LOD rendering.
+ *  @return opacity threshold
+ */
+/*===========================================================================*/
+kvs::Real32 MultiBinMappedParallelCoordinatesRenderer::lodOpacityThreshold() const
+{
+    return m_lod_opacity_threshold;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns number of bins drawn in the last LOD rendering.
+ *  @return number of merged bins
+ */
+/*===========================================================================*/
+size_t MultiBinMappedParallelCoordinatesRenderer::numberOfLODBins() const
+{
+    return m_lod_colors.size() / 4;
+}
+
 /*===========================================================================*/
 /**
  *  @brief  Render multi bin mapped parallel coordinates.
@@ -318,85 +501,162 @@ void MultiBinMappedParallelCoordinatesRenderer::exec( kvs::ObjectBase* object, k
     const size_t naxes = bin_map_object->naxes();
     const float stride = float( x1 - x0 ) / ( naxes - 1 );
 
-    GLfloat* vertex = new GLfloat [ naxes * 4 ];
+    if ( m_enable_lod )
+    {
+        this->update_lod( object, camera->windowWidth(), camera->windowHeight() );
+
+        const size_t nbins = m_lod_colors.size() / 4;
+        for ( size_t i = 0; i < nbins; i++ )
+        {
+            const GLfloat* vertex = &m_lod_vertices[ naxes * 4 * i ];
+            const GLubyte* color = &m_lod_colors[ 4 * i ];
+            ::DrawBin( vertex, naxes, color[0], color[1], color[2], color[3], m_bin_edge_width );
+        }
+    }
+    else
+    {
+        GLfloat* vertex = new GLfloat [ naxes * 4 ];
+        pcs::MultiBinMapObject::BinList::const_iterator bin = bin_map_object->binList().begin();
+        pcs::MultiBinMapObject::BinList::const_iterator last = bin_map_object->binList().end();
+        while ( bin != last )
+        {
+            const kvs::ValueArray<kvs::UInt16>& indices = bin->indices();
+            if ( ::CalculateBinVertices( bin_map_object, indices, x0, stride, y0, y1, vertex ) )
+            {
+                const kvs::RGBColor color = m_color_map.at( indices[m_active_axis] );
+                ::DrawBin( vertex, naxes, color.r(), color.g(), color.b(), m_bin_opacity, m_bin_edge_width );
+            }
+
+            bin++;
+        }
+        delete [] vertex;
+    }
+
+    ::EndDraw();
+
+    glPopAttrib();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Updates the merged bins for level-of-detail (LOD) rendering.
+ *  @param  object [in] pointer to the bin map object
+ *  @param  width [in] window width
+ *  @param  height [in] window height
+ *
+ *  The bins are merged when the pixel rows covered by the bins coincide on
+ *  all the axes. The merged bin has the summed counter and the color blended
+ *  by the counters, and its opacity is accumulated as 1-(1-a)^n for n merged
+ *  bins, which is the opacity obtained by drawing the n bins one over another.
+ *  The merged bins are cached and rebuilt only when the window size, the
+ *  selected ranges or the rendering parameters are changed.
+ */
+/*===========================================================================*/
+void MultiBinMappedParallelCoordinatesRenderer::update_lod( const kvs::ObjectBase* object, const int width, const int height )
+{
+    const pcs::MultiBinMapObject* bin_map_object = reinterpret_cast<const pcs::MultiBinMapObject*>( object );
+    const size_t naxes = bin_map_object->naxes();
+
+    std::vector<kvs::Real64> parameters;
+    parameters.push_back( width );
+    parameters.push_back( height );
+    parameters.push_back( m_top_margin );
+    parameters.push_back( m_bottom_margin );
+    parameters.push_back( m_left_margin );
+    parameters.push_back( m_right_margin );
+    parameters.push_back( m_active_axis );
+    parameters.push_back( m_bin_opacity );
+    parameters.push_back( m_lod_opacity_threshold );
+    parameters.push_back( bin_map_object->binList().size() );
+    for ( size_t i = 0; i < naxes; i++ )
+    {
+        parameters.push_back( bin_map_object->minRange(i) );
+        parameters.push_back( bin_map_object->maxRange(i) );
+    }
+
+    if ( m_lod_object == object && m_lod_parameters == parameters ) return;
+    m_lod_object = object;
+    m_lod_parameters = parameters;
+
+    const int x0 = m_left_margin;
+    const int x1 = width - m_right_margin;
+    const int y0 = m_top_margin;
+    const int y1 = height - m_bottom_margin;
+    const float stride = float( x1 - x0 ) / ( naxes - 1 );
+
+    // Merge the bins that have the same footprint on the screen.
+    typedef std::map<std::vector<int>,size_t> FootprintMap;
+    FootprintMap footprints;
+    std::vector<GLfloat> vertices; // vertices of the merged bins
+    std::vector<kvs::Real64> colors; // counter-weighted sum of the colors (RGB)
+    std::vector<size_t> counters; // summed counters
+    std::vector<size_t> nmerged; // number of the merged bins
+
+    std::vector<GLfloat> vertex( naxes * 4 );
+    std::vector<int> footprint( naxes * 2 );
     pcs::MultiBinMapObject::BinList::const_iterator bin = bin_map_object->binList().begin();
     pcs::MultiBinMapObject::BinList::const_iterator last = bin_map_object->binList().end();
     while ( bin != last )
     {
         const kvs::ValueArray<kvs::UInt16>& indices = bin->indices();
-        const kvs::RGBColor color = m_color_map.at( indices[m_active_axis] );
+        if ( !::CalculateBinVertices( bin_map_object, indices, x0, stride, y0, y1, &vertex[0] ) ) { bin++; continue; }
 
-        bool draw = true;
         for ( size_t i = 0; i < naxes; i++ )
         {
-            const size_t nbins = bin_map_object->nbins().at(i);
-            const size_t index = indices[i];
-
-            const kvs::Real64 y_min_value = bin_map_object->minValue(i);
-            const kvs::Real64 y_max_value = bin_map_object->maxValue(i);
-            const kvs::Real64 y_min_range = bin_map_object->minRange(i);
-            const kvs::Real64 y_max_range = bin_map_object->maxRange(i);
-            const kvs::Real64 bin_width = ( y_max_value - y_min_value ) / nbins;
-            if ( y_max_range < y_min_value + bin_width * ( index + 1 ) ||
-                 y_min_range > y_min_value + bin_width * ( index + 0 ) )
-            {
-                draw = false;
-                break;
-            }
-
-            const float x = m_left_margin + stride * i;
-            const float width = float( y1 - y0 ) / nbins;
-            const float ya = y1 - width * indices[i];
-            const float yb = ya - width;
-            vertex[ 4 * i + 0 ] = x;
-            vertex[ 4 * i + 1 ] = ya;
-            vertex[ 4 * i + 2 ] = x;
-            vertex[ 4 * i + 3 ] = yb;
+            footprint[ 2 * i + 0 ] = static_cast<int>( std::floor( vertex[ 4 * i + 1 ] ) );
+            footprint[ 2 * i + 1 ] = static_cast<int>( std::floor( vertex[ 4 * i + 3 ] ) );
         }
 
-        if ( draw )
+        size_t index = counters.size();
+        std::pair<FootprintMap::iterator,bool> result = footprints.insert( std::make_pair( footprint, index ) );
+        if ( result.second )
         {
-            glBegin( GL_QUAD_STRIP );
-            glColor4ub( color.r(), color.g(), color.b(), m_bin_opacity );
-            const size_t naxes = indices.size();
-            for ( size_t i = 0; i < naxes; i++ )
-            {
-                glVertex2fv( vertex + 4 * i );
-                glVertex2fv( vertex + 4 * i + 2 );
-            }
-            glEnd();
+            vertices.insert( vertices.end(), vertex.begin(), vertex.end() );
+            colors.resize( colors.size() + 3, 0.0 );
+            counters.push_back( 0 );
+            nmerged.push_back( 0 );
         }
-
-        if ( draw )
+        else
         {
-            if ( m_bin_edge_width > 0.0f )
+            index = result.first->second;
+            GLfloat* merged = &vertices[ naxes * 4 * index ];
+            for ( size_t i = 0; i < naxes; i++ )
             {
-                glLineWidth( m_bin_edge_width );
-                const size_t naxes = indices.size();
-                for ( size_t i = 0; i < naxes - 1; i++ )
-                {
-                    const GLubyte r = color.r() * 0.8 + 0.5;
-                    const GLubyte g = color.g() * 0.8 + 0.5;
-                    const GLubyte b = color.b() * 0.8 + 0.5;
-                    const GLubyte a = m_bin_opacity;
-                    glBegin( GL_LINE_LOOP );
-                    glColor4ub( r, g, b, a );
-                    glVertex2f( vertex[4*i+0], vertex[4*i+1] );
-                    glVertex2f( vertex[4*i+2], vertex[4*i+3] );
-                    glVertex2f( vertex[4*i+6], vertex[4*i+7] );
-                    glVertex2f( vertex[4*i+4], vertex[4*i+5] );
-                    glEnd();
-                }
+                merged[ 4 * i + 1 ] = kvs::Math::Max( merged[ 4 * i + 1 ], vertex[ 4 * i + 1 ] );
+                merged[ 4 * i + 3 ] = kvs::Math::Min( merged[ 4 * i + 3 ], vertex[ 4 * i + 3 ] );
             }
         }
 
+        const kvs::RGBColor color = m_color_map.at( indices[m_active_axis] );
+        const kvs::Real64 counter = static_cast<kvs::Real64>( bin->counter() );
+        colors[ 3 * index + 0 ] += color.r() * counter;
+        colors[ 3 * index + 1 ] += color.g() * counter;
+        colors[ 3 * index + 2 ] += color.b() * counter;
+        counters[ index ] += bin->counter();
+        nmerged[ index ] += 1;
+
         bin++;
     }
-    delete [] vertex;
 
-    ::EndDraw();
+    // Drop the merged bins whose contribution is below the threshold.
+    m_lod_vertices.clear();
+    m_lod_colors.clear();
+    const kvs::Real64 opacity = m_bin_opacity / 255.0;
+    const size_t nbins = counters.size();
+    for ( size_t i = 0; i < nbins; i++ )
+    {
+        const kvs::Real64 a = 1.0 - std::pow( 1.0 - opacity, static_cast<kvs::Real64>( nmerged[i] ) );
+        if ( a < m_lod_opacity_threshold ) continue;
 
-    glPopAttrib();
+        const kvs::Real64 counter = kvs::Math::Max( counters[i], size_t(1) );
+        m_lod_colors.push_back( static_cast<kvs::UInt8>( colors[ 3 * i + 0 ] / counter + 0.5 ) );
+        m_lod_colors.push_back( static_cast<kvs::UInt8>( colors[ 3 * i + 1 ] / counter + 0.5 ) );
+        m_lod_colors.push_back( static_cast<kvs::UInt8>( colors[ 3 * i + 2 ] / counter + 0.5 ) );
+        m_lod_colors.push_back( static_cast<kvs::UInt8>( a * 255.0 + 0.5 ) );
+
+        const GLfloat* merged = &vertices[ naxes * 4 * i ];
+        m_lod_vertices.insert( m_lod_vertices.end(), merged, merged + naxes * 4 );
+    }
 }
 
 } // end of namespace pcs
@@ -15,6 +15,7 @@
 #ifndef KVSOCEANVIS__PCS__MULTI_BIN_MAPPED_PARALLEL_COORDINATES_RENDERER_H_INCLUDE
 #define KVSOCEANVIS__PCS__MULTI_BIN_MAPPED_PARALLEL_COORDINATES_RENDERER_H_INCLUDE
 
+#include <vector>
 #include <kvs/RendererBase>
 #include <kvs/ClassName>
 #include <kvs/Module>
@@ -57,6 +58,12 @@ protected:
     kvs::UInt8 m_bin_opacity; ///< bin opacity
     kvs::Real32 m_bin_edge_width; ///< bin edge width
     kvs::ColorMap m_color_map; ///< color map
+    bool m_enable_lod; ///< flag for level-of-detail (LOD) rendering
+    kvs::Real32 m_lod_opacity_threshold; ///< opacity threshold for dropping merged bins in LOD
+    const kvs::ObjectBase* m_lod_object; ///< pointer to the object used for the LOD bins
+    std::vector<kvs::Real64> m_lod_parameters; ///< parameters used for the LOD bins
+    std::vector<kvs::Real32> m_lod_vertices; ///< vertices of the LOD bins (4 values per axis)
+    std::vector<kvs::UInt8> m_lod_colors; ///< colors of the LOD bins (RGBA)
 
 public:
 
@@ -74,6 +81,9 @@ public:
     void setBinEdgeWidth( const kvs::Real32 width );
     void setColorMap( const kvs::ColorMap& color_map );
     void selectAxis( const size_t index );
+    void enableLOD( const kvs::Real32 opacity_threshold = 0.0f );
+    void disableLOD();
+    void setLODOpacityThreshold( const kvs::Real32 opacity_threshold );
 
     int topMargin() const;
     int bottomMargin() const;
@@ -82,10 +92,17 @@ public:
     size_t activeAxis() const;
     kvs::UInt8 binOpacity() const;
     kvs::Real32 binEdgeWidth() const;
+    bool isEnabledLOD() const;
+    kvs::Real32 lodOpacityThreshold() const;
+    size_t numberOfLODBins() const;
 
 public:
 
     void exec( kvs::ObjectBase* object, kvs::Camera* camera, kvs::Light* light );
+
+private:
+
+    void update_lod( const kvs::ObjectBase* object, const int width, const int height );
 };
 
 } // end of namespace pcs
@@ -13,67 +13,490 @@
  */
 /*****************************************************************************/
 #include "MultiDimensionalScaling.h"
+#include "ClusteringUtility.h"
+#include "DistanceMatrix.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
 #include <kvs/Matrix>
 #include <kvs/EigenDecomposer>
+#include <kvs/MersenneTwister>
+#include <kvs/Value>
 #include <kvs/Timer>
 
 
 namespace
 {
 
-kvs::Real32 GetEuclideanDistance( const kvs::TableObject* table, const size_t i, const size_t j )
+/*===========================================================================*/
+/**
+ *  @brief  Converts the squared distance matrix to the inner product matrix.
+ *  @param  d [in/out] squared distance matrix (packed symmetric)
+ *  @param  n [in] matrix size
+ *
+ *  The double centering B = -1/2 H D H with the centering matrix H = I - 1/n
+ *  is applied in place as b_ij = -1/2 ( d_ij - r_i - r_j + t ), where r_i is
+ *  the mean of the i-th row and t is the mean of all the elements.
+ */
+/*===========================================================================*/
+void DoubleCenter( kvs::Real32* d, const size_t n )
 {
-    kvs::Real32 distance = 0.0f;
-    const size_t ncolumns = table->numberOfColumns();
-    for ( size_t index = 0; index < ncolumns; index++ )
+    std::vector<kvs::Real64> means( n, 0.0 );
+    const kvs::Int64 nrows = static_cast<kvs::Int64>( n );
+    #pragma omp parallel
     {
-        const kvs::Real32 xi = table->column(index).at<kvs::Real32>(i);
-        const kvs::Real32 xj = table->column(index).at<kvs::Real32>(j);
-        const kvs::Real32 diff = xi - xj;
-        distance += diff * diff;
+        std::vector<kvs::Real64> local_sums( n, 0.0 );
+
+        #pragma omp for schedule(dynamic,16)
+        for ( kvs::Int64 i = 0; i < nrows; i++ )
+        {
+            const kvs::Real32* di = d + kvsoceanvis::pcs::DistanceMatrix::PackedIndex( n, i, i );
+            local_sums[i] += di[0];
+            for ( size_t j = i + 1; j < n; j++ )
+            {
+                local_sums[i] += di[ j - i ];
+                local_sums[j] += di[ j - i ];
+            }
+        }
+
+        #pragma omp critical
+        {
+            for ( size_t i = 0; i < n; i++ ) { means[i] += local_sums[i]; }
+        }
     }
 
-    return distance;
+    kvs::Real64 total = 0.0;
+    for ( size_t i = 0; i < n; i++ ) { means[i] /= n; total += means[i]; }
+    total /= n;
+
+    #pragma omp parallel for schedule(dynamic,16)
+    for ( kvs::Int64 i = 0; i < nrows; i++ )
+    {
+        kvs::Real32* di = d + kvsoceanvis::pcs::DistanceMatrix::PackedIndex( n, i, i );
+        for ( size_t j = i; j < n; j++ )
+        {
+            di[ j - i ] = static_cast<kvs::Real32>( -0.5 * ( di[ j - i ] - means[i] - means[j] + total ) );
+        }
+    }
 }
 
-void ToIdentify( kvs::Matrix<kvs::Real32>& m )
+/*===========================================================================*/
+/**
+ *  @brief  Multiplies the packed symmetric matrix by the vector.
+ *  @param  a [in] packed symmetric matrix
+ *  @param  n [in] matrix size
+ *  @param  x [in] vector
+ *  @param  y [out] product A x
+ */
+/*===========================================================================*/
+void Multiply( const kvs::Real32* a, const size_t n, const kvs::Real64* x, kvs::Real64* y )
 {
-    m.identity();
+    std::fill( y, y + n, 0.0 );
+
+    const kvs::Int64 nrows = static_cast<kvs::Int64>( n );
+    #pragma omp parallel
+    {
+        std::vector<kvs::Real64> local_y( n, 0.0 );
+
+        #pragma omp for schedule(dynamic,16)
+        for ( kvs::Int64 i = 0; i < nrows; i++ )
+        {
+            const kvs::Real32* ai = a + kvsoceanvis::pcs::DistanceMatrix::PackedIndex( n, i, i );
+            const kvs::Real64 xi = x[i];
+            kvs::Real64 yi = ai[0] * xi;
+            for ( size_t j = i + 1; j < n; j++ )
+            {
+                const kvs::Real64 aij = ai[ j - i ];
+                yi += aij * x[j];
+                local_y[j] += aij * xi;
+            }
+            local_y[i] += yi;
+        }
+
+        #pragma omp critical
+        {
+            for ( size_t i = 0; i < n; i++ ) { y[i] += local_y[i]; }
+        }
+    }
 }
 
-void ToOnes( kvs::Matrix<kvs::Real32>& m )
+/*===========================================================================*/
+/**
+ *  @brief  Returns the dot product of the vectors.
+ */
+/*===========================================================================*/
+kvs::Real64 Dot( const kvs::Real64* x, const kvs::Real64* y, const size_t n )
 {
-    const size_t ncolumns = m.columnSize();
-    const size_t nrows = m.rowSize();
-    for ( size_t i = 0; i < ncolumns; i++ ) for ( size_t j = 0; j < nrows; j++ ) m[i][j] = 1.0f;
+    kvs::Real64 sum = 0.0;
+    for ( size_t i = 0; i < n; i++ ) { sum += x[i] * y[i]; }
+    return sum;
 }
 
-void ToSquare( kvs::Matrix<kvs::Real32>& m )
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the largest eigenpairs of the packed symmetric matrix.
+ *  @param  a [in] packed symmetric matrix
+ *  @param  n [in] matrix size
+ *  @param  npairs [in] number of eigenpairs
+ *  @param  values [out] eigenvalues in descending order
+ *  @param  vectors [out] normalized eigenvectors (npairs x n)
+ *
+ *  The eigenpairs are calculated by the Lanczos method with the full
+ *  re-orthogonalization, which is restarted from the sum of the Ritz vectors
+ *  until the residuals are converged. Only the matrix-vector products access
+ *  the matrix, so the matrix is neither copied nor factorized.
+ */
+/*===========================================================================*/
+void LargestEigenPairs(
+    const kvs::Real32* a,
+    const size_t n,
+    const size_t npairs,
+    std::vector<kvs::Real64>& values,
+    std::vector<kvs::Real64>& vectors )
 {
-    const size_t ncolumns = m.columnSize();
-    const size_t nrows = m.rowSize();
-    for ( size_t i = 0; i < ncolumns; i++ ) for ( size_t j = 0; j < nrows; j++ ) m[i][j] = m[i][j] * m[i][j];
+    const size_t max_restarts = 50;
+    const kvs::Real64 tolerance = 1.0e-8;
+    const size_t m = kvs::Math::Min( n, kvs::Math::Max( 4 * npairs, size_t(40) ) );
+
+    values.assign( npairs, 0.0 );
+    vectors.assign( npairs * n, 0.0 );
+
+    // Starting vector.
+    kvs::MersenneTwister random( 0 );
+    std::vector<kvs::Real64> v0( n );
+    for ( size_t i = 0; i < n; i++ ) { v0[i] = random() - 0.5; }
+
+    std::vector<kvs::Real64> V( m * n ); // Lanczos vectors
+    std::vector<kvs::Real64> alpha( m );
+    std::vector<kvs::Real64> beta( m );
+    std::vector<kvs::Real64> w( n );
+    for ( size_t restart = 0; restart < max_restarts; restart++ )
+    {
+        const kvs::Real64 norm0 = std::sqrt( ::Dot( &v0[0], &v0[0], n ) );
+        if ( !( norm0 > 0.0 ) ) break;
+        for ( size_t i = 0; i < n; i++ ) { V[i] = v0[i] / norm0; }
+
+        // Lanczos iteration.
+        size_t k = 0;
+        kvs::Real64 scale = 0.0;
+        while ( k < m )
+        {
+            const kvs::Real64* vk = &V[ k * n ];
+            ::Multiply( a, n, vk, &w[0] );
+            alpha[k] = ::Dot( &w[0], vk, n );
+            scale = kvs::Math::Max( scale, std::fabs( alpha[k] ) );
+
+            // Full re-orthogonalization (twice is enough).
+            for ( size_t pass = 0; pass < 2; pass++ )
+            {
+                for ( size_t j = 0; j <= k; j++ )
+                {
+                    const kvs::Real64* vj = &V[ j * n ];
+                    const kvs::Real64 h = ::Dot( &w[0], vj, n );
+                    for ( size_t i = 0; i < n; i++ ) { w[i] -= h * vj[i]; }
+                }
+            }
+
+            beta[k] = std::sqrt( ::Dot( &w[0], &w[0], n ) );
+            scale = kvs::Math::Max( scale, beta[k] );
+            k++;
+
+            if ( !( beta[ k - 1 ] > tolerance * scale ) ) { beta[ k - 1 ] = 0.0; break; }
+            if ( k < m )
+            {
+                kvs::Real64* vnext = &V[ k * n ];
+                for ( size_t i = 0; i < n; i++ ) { vnext[i] = w[i] / beta[ k - 1 ]; }
+            }
+        }
+
+        // Ritz pairs from the tridiagonal matrix.
+        kvs::Matrix<kvs::Real64> T( k, k );
+        T.zero();
+        for ( size_t i = 0; i < k; i++ )
+        {
+            T[i][i] = alpha[i];
+            if ( i + 1 < k ) { T[i][i+1] = beta[i]; T[i+1][i] = beta[i]; }
+        }
+        kvs::EigenDecomposer<kvs::Real64> eigen( T, kvs::EigenDecomposer<kvs::Real64>::Symmetric );
+        const kvs::Vector<kvs::Real64>& evalues = eigen.eigenValues();
+        const kvs::Matrix<kvs::Real64>& evectors = eigen.eigenVectors();
+
+        std::vector<size_t> order;
+        std::vector<bool> used( k, false );
+        for ( size_t p = 0; p < kvs::Math::Min( npairs, k ); p++ )
+        {
+            size_t index = k;
+            for ( size_t i = 0; i < k; i++ )
+            {
+                if ( used[i] ) continue;
+                if ( index == k || evalues[i] > evalues[ index ] ) index = i;
+            }
+            used[ index ] = true;
+            order.push_back( index );
+        }
+
+        // Ritz vectors and the convergence test by the residuals.
+        bool converged = true;
+        std::fill( v0.begin(), v0.end(), 0.0 );
+        for ( size_t p = 0; p < order.size(); p++ )
+        {
+            const kvs::Vector<kvs::Real64>& s = evectors[ order[p] ];
+            values[p] = evalues[ order[p] ];
+
+            kvs::Real64* u = &vectors[ p * n ];
+            std::fill( u, u + n, 0.0 );
+            for ( size_t j = 0; j < k; j++ )
+            {
+                const kvs::Real64* vj = &V[ j * n ];
+                for ( size_t i = 0; i < n; i++ ) { u[i] += s[j] * vj[i]; }
+            }
+
+            const kvs::Real64 norm = std::sqrt( ::Dot( u, u, n ) );
+            for ( size_t i = 0; i < n; i++ ) { u[i] /= norm; v0[i] += u[i]; }
 
+            const kvs::Real64 residual = std::fabs( beta[ k - 1 ] * s[ k - 1 ] ) / norm;
+            if ( residual > tolerance * scale ) converged = false;
+        }
+
+        if ( converged ) break;
+    }
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Squared Euclidean distance between the table rows.
+ */
+/*===========================================================================*/
+struct TableDistance
+{
+    const kvs::Real32* x; ///< table data packed in row-major order
+    size_t ncolumns; ///< number of columns
+
+    TableDistance( const kvs::Real32* data, const size_t n ): x( data ), ncolumns( n ) {}
+
+    kvs::Real32 operator () ( const size_t i, const size_t j ) const
+    {
+        return kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( x + i * ncolumns, x + j * ncolumns, ncolumns );
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Squared distance given by the distance matrix.
+ */
+/*===========================================================================*/
+struct MatrixDistance
+{
+    const kvs::Matrix<kvs::Real32>& D; ///< distance matrix
+
+    MatrixDistance( const kvs::Matrix<kvs::Real32>& m ): D( m ) {}
+
+    kvs::Real32 operator () ( const size_t i, const size_t j ) const
+    {
+        return D[i][j] * D[i][j];
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Selects the landmarks randomly.
+ *  @param  nrows [in] number of rows
+ *  @param  nlandmarks [in] number of landmarks
+ *  @param  random [in] random number generator
+ *  @return indices of the landmarks
+ */
+/*===========================================================================*/
+kvs::ValueArray<kvs::UInt32> RandomLandmarks(
+    const size_t nrows,
+    const size_t nlandmarks,
+    kvs::MersenneTwister& random )
+{
+    std::vector<kvs::UInt32> indices( nrows );
+    for ( size_t i = 0; i < nrows; i++ ) { indices[i] = static_cast<kvs::UInt32>( i ); }
+
+    kvs::ValueArray<kvs::UInt32> landmarks( nlandmarks );
+    for ( size_t l = 0; l < nlandmarks; l++ )
+    {
+        const size_t j = l + random.randInteger() % ( nrows - l );
+        std::swap( indices[l], indices[j] );
+        landmarks[l] = indices[l];
+    }
+
+    return landmarks;
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Selects the landmarks by the max-min method.
+ *  @param  distance [in] squared distance between the rows
+ *  @param  nrows [in] number of rows
+ *  @param  nlandmarks [in] number of landmarks
+ *  @param  random [in] random number generator
+ *  @return indices of the landmarks
+ *
+ *  The first landmark is selected randomly, and then the row farthest from
+ *  the selected landmarks is selected as the next landmark.
+ */
+/*===========================================================================*/
+template <typename Distance>
+kvs::ValueArray<kvs::UInt32> MaxMinLandmarks(
+    const Distance& distance,
+    const size_t nrows,
+    const size_t nlandmarks,
+    kvs::MersenneTwister& random )
+{
+    kvs::ValueArray<kvs::UInt32> landmarks( nlandmarks );
+    std::vector<kvs::Real32> mins( nrows, kvs::Value<kvs::Real32>::Max() );
+
+    const kvs::Int64 n = static_cast<kvs::Int64>( nrows );
+    size_t next = random.randInteger() % nrows;
+    for ( size_t l = 0; l < nlandmarks; l++ )
+    {
+        landmarks[l] = static_cast<kvs::UInt32>( next );
+
+        kvs::Real32 dmax = -1.0f;
+        size_t farthest = next;
+        #pragma omp parallel
+        {
+            kvs::Real32 local_dmax = -1.0f;
+            size_t local_farthest = next;
+
+            #pragma omp for schedule(static)
+            for ( kvs::Int64 i = 0; i < n; i++ )
+            {
+                const kvs::Real32 d = distance( i, next );
+                if ( d < mins[i] ) { mins[i] = d; }
+                if ( mins[i] > local_dmax ) { local_dmax = mins[i]; local_farthest = i; }
+            }
+
+            #pragma omp critical
+            {
+                if ( local_dmax > dmax || ( local_dmax == dmax && local_farthest < farthest ) )
+                {
+                    dmax = local_dmax;
+                    farthest = local_farthest;
+                }
+            }
+        }
+
+        next = farthest;
+    }
+
+    return landmarks;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the 2D locations by the landmark MDS.
+ *  @param  distance [in] squared distance between the rows
+ *  @param  nrows [in] number of rows
+ *  @param  landmarks [in] indices of the landmarks
+ *  @param  px [out] x coordinates of the rows
+ *  @param  py [out] y coordinates of the rows
+ *
+ *  The landmarks are located by the classical MDS, and then every row is
+ *  located by the distance-based triangulation from the landmarks, i.e.
+ *  x = -1/2 L# ( d - d_mean ), where the rows of L# are the eigenvectors
+ *  divided by the square roots of the eigenvalues, d is the squared
+ *  distances to the landmarks and d_mean is the column means of the
+ *  squared distance matrix of the landmarks.
+ */
+/*===========================================================================*/
+template <typename Distance>
+void LandmarkScaling(
+    const Distance& distance,
+    const size_t nrows,
+    const kvs::ValueArray<kvs::UInt32>& landmarks,
+    kvs::Real32* px,
+    kvs::Real32* py )
+{
+    const size_t m = landmarks.size();
+
+    // Squared distance matrix of the landmarks and its column means.
+    std::vector<kvs::Real32> delta( m * ( m + 1 ) / 2 );
+    const kvs::Int64 nlandmarks = static_cast<kvs::Int64>( m );
+    #pragma omp parallel for schedule(dynamic,16)
+    for ( kvs::Int64 i = 0; i < nlandmarks; i++ )
+    {
+        kvs::Real32* di = &delta[ kvsoceanvis::pcs::DistanceMatrix::PackedIndex( m, i, i ) ];
+        for ( size_t j = i; j < m; j++ ) { di[ j - i ] = distance( landmarks[i], landmarks[j] ); }
+    }
+
+    std::vector<kvs::Real64> means( m, 0.0 );
+    for ( size_t i = 0; i < m; i++ )
+    {
+        for ( size_t j = i; j < m; j++ )
+        {
+            const kvs::Real64 d = delta[ kvsoceanvis::pcs::DistanceMatrix::PackedIndex( m, i, j ) ];
+            means[i] += d;
+            if ( j != i ) means[j] += d;
+        }
+    }
+    for ( size_t j = 0; j < m; j++ ) { means[j] /= m; }
+
+    // Classical MDS of the landmarks.
+    std::vector<kvs::Real64> evalues;
+    std::vector<kvs::Real64> evectors;
+    ::DoubleCenter( &delta[0], m );
+    ::LargestEigenPairs( &delta[0], m, 2, evalues, evectors );
+
+    std::vector<kvs::Real64> h( 2 * m );
+    for ( size_t k = 0; k < 2; k++ )
+    {
+        const kvs::Real64 s = ( evalues[k] > 0.0 ) ? -0.5 / std::sqrt( evalues[k] ) : 0.0;
+        for ( size_t j = 0; j < m; j++ ) { h[ k * m + j ] = s * evectors[ k * m + j ]; }
+    }
+
+    // Triangulation of all the rows in one pass.
+    const kvs::Int64 n = static_cast<kvs::Int64>( nrows );
+    #pragma omp parallel for schedule(static)
+    for ( kvs::Int64 i = 0; i < n; i++ )
+    {
+        kvs::Real64 x = 0.0;
+        kvs::Real64 y = 0.0;
+        for ( size_t j = 0; j < m; j++ )
+        {
+            const kvs::Real64 d = distance( i, landmarks[j] ) - means[j];
+            x += h[j] * d;
+            y += h[ m + j ] * d;
+        }
+        px[i] = static_cast<kvs::Real32>( x );
+        py[i] = static_cast<kvs::Real32>( y );
+    }
+}
+
+} // end of namespace
+
+
 namespace kvsoceanvis
 {
 
 namespace pcs
 {
 
-MultiDimensionalScaling::MultiDimensionalScaling( void )
+MultiDimensionalScaling::MultiDimensionalScaling( void ):
+    m_nlandmarks( 0 ),
+    m_landmark_selection( MaxMinSelection )
+{
+}
+
+MultiDimensionalScaling::MultiDimensionalScaling( const kvs::TableObject* object ):
+    m_nlandmarks( 0 ),
+    m_landmark_selection( MaxMinSelection )
 {
+    this->exec( object );
 }
 
-MultiDimensionalScaling::MultiDimensionalScaling( const kvs::TableObject* object )
+MultiDimensionalScaling::MultiDimensionalScaling( const kvs::TableObject* object, const size_t nlandmarks ):
+    m_nlandmarks( nlandmarks ),
+    m_landmark_selection( MaxMinSelection )
 {
     this->exec( object );
 }
 
-MultiDimensionalScaling::MultiDimensionalScaling( const kvs::Matrix<kvs::Real32>& distance_matrix )
+MultiDimensionalScaling::MultiDimensionalScaling( const kvs::Matrix<kvs::Real32>& distance_matrix ):
+    m_nlandmarks( 0 ),
+    m_landmark_selection( MaxMinSelection )
 {
     this->setDistanceMatrix( distance_matrix );
     this->exec( NULL );
@@ -84,66 +507,166 @@ void MultiDimensionalScaling::setDistanceMatrix( const kvs::Matrix<kvs::Real32>&
     m_distance_matrix = distance_matrix;
 }
 
+void MultiDimensionalScaling::setSeed( const size_t seed )
+{
+    m_random.setSeed( seed );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a number of landmarks.
+ *  @param  nlandmarks [in] number of landmarks (0: classical MDS for all the rows)
+ *
+ *  If the number of landmarks is given, only the landmarks are located by
+ *  the classical MDS and the other rows are located by the triangulation,
+ *  so the cost is O(m^2) for the m landmarks and O(nm) for the n rows.
+ */
+/*===========================================================================*/
+void MultiDimensionalScaling::setNumberOfLandmarks( const size_t nlandmarks )
+{
+    m_nlandmarks = nlandmarks;
+}
+
+void MultiDimensionalScaling::setLandmarkSelection( const LandmarkSelection selection )
+{
+    m_landmark_selection = selection;
+}
+
+size_t MultiDimensionalScaling::numberOfLandmarks( void ) const
+{
+    return m_nlandmarks;
+}
+
+const kvs::ValueArray<kvs::UInt32>& MultiDimensionalScaling::landmarks( void ) const
+{
+    return m_landmarks;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Executes the multidimensional scaling.
+ *  @param  object [in] pointer to the table object (NULL: the given distance matrix is used)
+ *  @return pointer to the table object of the 2D locations
+ *
+ *  The squared distance matrix is stored in the packed symmetric form and
+ *  converted to the inner product matrix in place, and then the two largest
+ *  eigenpairs are calculated by the Lanczos method. Therefore, the memory is
+ *  about n^2 / 2 floats and the cost is O(n^2) for n rows. If the number of
+ *  landmarks is given, the landmark MDS is executed instead.
+ */
+/*===========================================================================*/
 MultiDimensionalScaling::SuperClass* MultiDimensionalScaling::exec( const kvs::ObjectBase* object )
 {
+    // Table data packed in row-major order, or the given distance matrix.
+    kvs::ValueArray<kvs::Real32> data;
+    size_t ncolumns = 0;
+    size_t N = 0;
     if ( object )
     {
         const kvs::TableObject* table = static_cast<const kvs::TableObject*>( object );
-        const size_t N = table->numberOfRows();
+        ncolumns = table->numberOfColumns();
+        N = table->numberOfRows();
+        if ( N == 0 || ncolumns == 0 )
+        {
+            BaseClass::setSuccess( false );
+            kvsMessageError("Input table is empty.");
+            return NULL;
+        }
+
+        data = pcs::ClusteringUtility::PackTable( table );
+    }
+    else
+    {
+        N = m_distance_matrix.rowSize();
+        if ( N == 0 || m_distance_matrix.columnSize() != N )
+        {
+            BaseClass::setSuccess( false );
+            kvsMessageError("Distance matrix is not a square matrix.");
+            return NULL;
+        }
+    }
+
+    kvs::ValueArray<kvs::Real32> x( N );
+    kvs::ValueArray<kvs::Real32> y( N );
+    kvs::Real32* px = x.data();
+    kvs::Real32* py = y.data();
 
-        // Dissimilarity (distance) matrix (D)
-        m_distance_matrix.setSize( N, N );
-        m_distance_matrix.zero();
-        kvs::Matrix<kvs::Real32>& D = m_distance_matrix;
+    // Landmark MDS (at least three landmarks are needed for the 2D plane).
+    const size_t nlandmarks = kvs::Math::Max( m_nlandmarks, size_t(3) );
+    if ( m_nlandmarks > 0 && nlandmarks < N )
+    {
+        const bool maxmin = ( m_landmark_selection == MaxMinSelection );
+        if ( object )
+        {
+            const ::TableDistance distance( data.data(), ncolumns );
+            m_landmarks = maxmin ? ::MaxMinLandmarks( distance, N, nlandmarks, m_random ) : ::RandomLandmarks( N, nlandmarks, m_random );
+            ::LandmarkScaling( distance, N, m_landmarks, px, py );
+        }
+        else
+        {
+            const ::MatrixDistance distance( m_distance_matrix );
+            m_landmarks = maxmin ? ::MaxMinLandmarks( distance, N, nlandmarks, m_random ) : ::RandomLandmarks( N, nlandmarks, m_random );
+            ::LandmarkScaling( distance, N, m_landmarks, px, py );
+        }
+
+        SuperClass::addColumn( kvs::AnyValueArray(x) );
+        SuperClass::addColumn( kvs::AnyValueArray(y) );
+
+        return this;
+    }
+
+    m_landmarks.release();
+
+    // Squared dissimilarity (distance) matrix (D) packed in the upper triangle.
+    pcs::DistanceMatrix D;
+    D.enableSquaredDistance();
+    if ( object )
+    {
+        if ( !D.compute( data.data(), N, ncolumns ) )
+        {
+            BaseClass::setSuccess( false );
+            kvsMessageError("Cannot calculate the distance matrix.");
+            return NULL;
+        }
+        data.release();
+    }
+    else
+    {
+        if ( !D.allocate( N ) )
+        {
+            BaseClass::setSuccess( false );
+            kvsMessageError("Cannot allocate the distance matrix.");
+            return NULL;
+        }
+
+        kvs::Real32* d = D.data();
         for ( size_t i = 0; i < N; i++ )
         {
-            for ( size_t j = i + 1; j < N; j++ )
+            for ( size_t j = i; j < N; j++ )
             {
-                D[i][j] = std::sqrt( ::GetEuclideanDistance( table, i, j ) );
-                D[j][i] = D[i][j];
+                const kvs::Real32 dij = m_distance_matrix[i][j];
+                d[ DistanceMatrix::PackedIndex( N, i, j ) ] = dij * dij;
             }
         }
     }
 
-    kvs::Matrix<kvs::Real32>& D = m_distance_matrix;
-    const size_t N = m_distance_matrix.rowSize();
-
     // Inner product matrix (P) can be solved by Young-Householder transformation.
-    kvs::Matrix<kvs::Real32> I( N, N ); ::ToIdentify( I );
-    kvs::Matrix<kvs::Real32> O( N, N ); ::ToOnes( O );
-    kvs::Matrix<kvs::Real32> DD( D ); ::ToSquare( DD );
-    kvs::Matrix<kvs::Real32> H = I - ( 1.0f / N ) * O; // centering matrix
-    kvs::Matrix<kvs::Real32> P = -0.5f * H * DD * H; // inner product matrix
+    kvs::Real32* P = D.data();
+    ::DoubleCenter( P, N );
 
-    // Eigen value decomposition.
-    kvs::EigenDecomposer<kvs::Real32> eigen( P, kvs::EigenDecomposer<kvs::Real32>::Symmetric );
-    const kvs::Vector<kvs::Real32>& evalues = eigen.eigenValues();
-    const kvs::Matrix<kvs::Real32>& evectors = eigen.eigenVectors();
+    // Eigen value decomposition (two largest eigenpairs).
+    std::vector<kvs::Real64> evalues;
+    std::vector<kvs::Real64> evectors;
+    ::LargestEigenPairs( P, N, 2, evalues, evectors );
+    D.release();
 
     // Location (X) in a 2D plane.
-    kvs::Matrix<kvs::Real32> A( 2, 2 );
-    A[0][0] = std::sqrt( evalues[0] ); A[0][1] = 0.0f;
-    A[1][0] = 0.0f; A[1][1] = std::sqrt( evalues[1] );
-
-    kvs::Matrix<kvs::Real32> Q( 2, evectors.columnSize() );
-    Q[0] = evectors[0].normalized();
-    Q[1] = evectors[1].normalized();
-
-    kvs::Matrix<kvs::Real32> X = A * Q;
-/*
-    kvs::AnyValueArray x;
-    kvs::AnyValueArray y;
-    kvs::Real32* px = static_cast<kvs::Real32*>( x.allocate<kvs::Real32>(N) );
-    kvs::Real32* py = static_cast<kvs::Real32*>( y.allocate<kvs::Real32>(N) );
-*/
-    kvs::ValueArray<kvs::Real32> x( N );
-    kvs::ValueArray<kvs::Real32> y( N );
-    kvs::Real32* px = x.data();
-    kvs::Real32* py = y.data();
+    const kvs::Real64 a0 = std::sqrt( kvs::Math::Max( evalues[0], 0.0 ) );
+    const kvs::Real64 a1 = std::sqrt( kvs::Math::Max( evalues[1], 0.0 ) );
     for ( size_t i = 0; i < N; i++ )
     {
-        px[i] = X[0][i];
-        py[i] = X[1][i];
+        px[i] = static_cast<kvs::Real32>( a0 * evectors[i] );
+        py[i] = static_cast<kvs::Real32>( a1 * evectors[ N + i ] );
     }
 
     SuperClass::addColumn( kvs::AnyValueArray(x) );
@@ -19,6 +19,8 @@
 #include <kvs/FilterBase>
 #include <kvs/TableObject>
 #include <kvs/Matrix>
+#include <kvs/ValueArray>
+#include <kvs/MersenneTwister>
 
 
 namespace kvsoceanvis
@@ -34,17 +36,36 @@ class MultiDimensionalScaling : public kvs::FilterBase, public kvs::TableObject
     kvsModuleBaseClass( kvs::FilterBase );
     kvsModuleSuperClass( kvs::TableObject );
 
+public:
+
+    enum LandmarkSelection
+    {
+        RandomSelection,
+        MaxMinSelection
+    };
+
 private:
 
     kvs::Matrix<kvs::Real32> m_distance_matrix;
+    kvs::MersenneTwister m_random; ///< random number generator
+    size_t m_nlandmarks; ///< number of landmarks (0: classical MDS for all the rows)
+    LandmarkSelection m_landmark_selection; ///< landmark selection method
+    kvs::ValueArray<kvs::UInt32> m_landmarks; ///< indices of the selected landmarks
 
 public:
 
     MultiDimensionalScaling( void );
     MultiDimensionalScaling( const kvs::TableObject* object );
+    MultiDimensionalScaling( const kvs::TableObject* object, const size_t nlandmarks );
     MultiDimensionalScaling( const kvs::Matrix<kvs::Real32>& distance_matrix );
 
     void setDistanceMatrix( const kvs::Matrix<kvs::Real32>& distance_matrix );
+    void setSeed( const size_t seed );
+    void setNumberOfLandmarks( const size_t nlandmarks );
+    void setLandmarkSelection( const LandmarkSelection selection );
+
+    size_t numberOfLandmarks( void ) const;
+    const kvs::ValueArray<kvs::UInt32>& landmarks( void ) const;
 
     SuperClass* exec( const kvs::ObjectBase* object );
 };
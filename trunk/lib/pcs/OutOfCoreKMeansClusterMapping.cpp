@@ -16,79 +16,131 @@
 #include <kvs/MersenneTwister>
 #include <kvs/Value>
 #include <kvs/KVSMLObjectTable>
+#include <vector>
+#include <algorithm>
 #include "OutOfCoreTableObject.h"
+#include "ClusteringUtility.h"
+#include "CoresetSampling.h"
+#include "FastKMeansClustering.h"
 
 
 namespace
 {
 
-kvs::Real64 GetEuclideanDistance(
+/*===========================================================================*/
+/**
+ *  @brief  Samples the rows uniformly in a sequential pass over the table.
+ *  @param  table [in] table object
+ *  @param  block_size [in] number of rows read at once
+ *  @param  nsamples [in] expected number of the sampled rows
+ *  @param  random [in] random number generator
+ *  @param  samples [out] sampled rows packed in row-major order
+ *  @return true if the table is read successfully
+ */
+/*===========================================================================*/
+bool SampleRows(
     const kvsoceanvis::pcs::OutOfCoreTableObject* table,
-    const kvs::UInt16 row_index,
-    const kvs::ValueArray<kvs::Real64>& means )
+    const size_t block_size,
+    const size_t nsamples,
+    kvs::MersenneTwister& random,
+    std::vector<kvs::Real32>& samples )
 {
-    kvs::Real64 distance = 0.0;
-    for ( size_t i = 0; i < table->numberOfColumns(); i++ )
+    const size_t nrows = table->numberOfRows();
+    const size_t ncolumns = table->numberOfColumns();
+    const kvs::Real64 probability = static_cast<kvs::Real64>( nsamples ) / nrows;
+
+    samples.clear();
+    samples.reserve( ( nsamples + nsamples / 10 ) * ncolumns );
+
+    std::vector<kvs::Real32> block( block_size * ncolumns );
+    for ( size_t begin = 0; begin < nrows; begin += block_size )
     {
-        const kvs::Real64 x0 = means[i];
-        const kvs::Real64 x1 = table->readValue( row_index, i );
-        distance += ( x1 - x0 ) * ( x1 - x0 );
+        const size_t n = kvs::Math::Min( block_size, nrows - begin );
+        if ( !table->readRows( begin, n, &block[0] ) ) return false;
+
+        for ( size_t i = 0; i < n; i++ )
+        {
+            if ( random() < probability )
+            {
+                const kvs::Real32* x = &block[ i * ncolumns ];
+                samples.insert( samples.end(), x, x + ncolumns );
+            }
+        }
     }
 
-    return distance;
+    return true;
 }
 
-kvs::Real64 GetEuclideanDistance(
-    const kvsoceanvis::pcs::OutOfCoreTableObject* table,
-    const kvs::ValueArray<kvs::Real64>& mean_old,
-    const kvs::ValueArray<kvs::Real64>& mean_new )
+/*===========================================================================*/
+/**
+ *  @brief  Assigns each row in the block to the nearest center.
+ *  @param  x [in] rows packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  centers [in] centers packed in row-major order
+ *  @param  nclusters [in] number of clusters
+ *  @param  ids [out] index of the nearest center
+ */
+/*===========================================================================*/
+void AssignRows(
+    const kvs::Real32* x,
+    const size_t nrows,
+    const size_t ncolumns,
+    const kvs::Real32* centers,
+    const size_t nclusters,
+    kvs::UInt32* ids )
 {
-    kvs::Real64 distance = 0.0;
-    for ( size_t i = 0; i < table->numberOfColumns(); i++ )
+    const kvs::Int64 n = static_cast<kvs::Int64>( nrows );
+    #pragma omp parallel for schedule(static)
+    for ( kvs::Int64 i = 0; i < n; i++ )
     {
-        const kvs::Real64 x0 = mean_old[i];
-        const kvs::Real64 x1 = mean_new[i];
-        distance += ( x1 - x0 ) * ( x1 - x0 );
+        ids[i] = static_cast<kvs::UInt32>( kvsoceanvis::pcs::ClusteringUtility::NearestCenter( x + i * ncolumns, centers, nclusters, ncolumns, NULL ) );
     }
-
-    return distance;
-}
 }
 
-namespace
-{
 /*===========================================================================*/
 /**
- *  @brief  Calculates the cluster centroids.
- *  @param  table [in] table object
- *  @param  cluster_id [in] target cluster ID
- *  @param  ids [in] cluster ID array
- *  @param  means [out] cluster centroids (means)
+ *  @brief  Assigns each row in the block to the nearest center and accumulates the rows.
+ *  @param  x [in] rows packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  centers [in] centers packed in row-major order
+ *  @param  nclusters [in] number of clusters
+ *  @param  sums [in/out] vector sum of the rows for each cluster
+ *  @param  counts [in/out] number of the rows for each cluster
  */
 /*===========================================================================*/
-void CalculateMeans(
-    const kvsoceanvis::pcs::OutOfCoreTableObject* table,
-    const kvs::UInt16 cluster_id,
-    const kvs::ValueArray<kvs::UInt16>& ids,
-    kvs::ValueArray<kvs::Real64>* means )
+void AssignAndAccumulate(
+    const kvs::Real32* x,
+    const size_t nrows,
+    const size_t ncolumns,
+    const kvs::Real32* centers,
+    const size_t nclusters,
+    kvs::Real64* sums,
+    kvs::UInt64* counts )
 {
-    for ( size_t j = 0; j < table->numberOfColumns(); j++ ) { means->at(j) = 0.0; }
-
-    size_t counter = 0;
-    for ( size_t j = 0; j < table->numberOfRows(); j++ )
+    const kvs::Int64 n = static_cast<kvs::Int64>( nrows );
+    #pragma omp parallel
     {
-        if ( ids[j] == cluster_id )
+        std::vector<kvs::Real64> local_sums( nclusters * ncolumns, 0.0 );
+        std::vector<kvs::UInt64> local_counts( nclusters, 0 );
+
+        #pragma omp for schedule(static)
+        for ( kvs::Int64 i = 0; i < n; i++ )
         {
-            for ( size_t k = 0; k < table->numberOfColumns(); k++ )
-            {
-                means->at(k) += table->readValue( j, k );
-            }
-            counter++;
+            const kvs::Real32* xi = x + i * ncolumns;
+            const size_t id = kvsoceanvis::pcs::ClusteringUtility::NearestCenter( xi, centers, nclusters, ncolumns, NULL );
+
+            kvs::Real64* sum = &local_sums[ id * ncolumns ];
+            for ( size_t k = 0; k < ncolumns; k++ ) { sum[k] += xi[k]; }
+            local_counts[id]++;
+        }
+
+        #pragma omp critical
+        {
+            for ( size_t j = 0; j < nclusters * ncolumns; j++ ) { sums[j] += local_sums[j]; }
+            for ( size_t j = 0; j < nclusters; j++ ) { counts[j] += local_counts[j]; }
         }
-    }
-    if ( counter != 0 )
-    {
-        for ( size_t k = 0; k < table->numberOfColumns(); k++ ) { means->at(k) /= counter; }
     }
 }
 
@@ -101,22 +153,37 @@ namespace kvsoceanvis
 namespace pcs
 {
 
-OutOfCoreKMeansClusterMapping::OutOfCoreKMeansClusterMapping()
+OutOfCoreKMeansClusterMapping::OutOfCoreKMeansClusterMapping():
+    m_method( OutOfCoreKMeansClusterMapping::ExactMethod ),
+    m_nclusters( 1 ),
+    m_max_iterations( 100 ),
+    m_tolerance( 1.e-6 ),
+    m_block_size( 262144 ),
+    m_batch_size( 4096 ),
+    m_coreset_size( 10000 )
 {
 }
 
 OutOfCoreKMeansClusterMapping::OutOfCoreKMeansClusterMapping( const kvs::ObjectBase* object, const size_t nclusters ):
+    m_method( OutOfCoreKMeansClusterMapping::ExactMethod ),
     m_nclusters( nclusters ),
     m_max_iterations( 100 ),
-    m_tolerance( 1.e-6 )
+    m_tolerance( 1.e-6 ),
+    m_block_size( 262144 ),
+    m_batch_size( 4096 ),
+    m_coreset_size( 10000 )
 {
     this->exec( object );
 }
 
 OutOfCoreKMeansClusterMapping::OutOfCoreKMeansClusterMapping( const kvs::ObjectBase* object, const size_t nclusters, const size_t max_iterations, const double tolerance ):
+    m_method( OutOfCoreKMeansClusterMapping::ExactMethod ),
     m_nclusters( nclusters ),
     m_max_iterations( max_iterations ),
-    m_tolerance( tolerance )
+    m_tolerance( tolerance ),
+    m_block_size( 262144 ),
+    m_batch_size( 4096 ),
+    m_coreset_size( 10000 )
 {
     this->exec( object );
 }
@@ -134,75 +201,358 @@ OutOfCoreKMeansClusterMapping::SuperClass* OutOfCoreKMeansClusterMapping::exec(
     const size_t nrows = table->numberOfRows();
     const size_t ncolumns = table->numberOfColumns();
     const size_t nclusters = m_nclusters;
+    if ( nrows == 0 || nclusters == 0 )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input table or number of clusters is empty.");
+        return NULL;
+    }
 
-    // Assign initial cluster IDs to each row of the input table randomly.
-    kvs::MersenneTwister R;
-    kvs::ValueArray<kvs::UInt16> IDs( nrows );
-    for ( size_t i = 0; i < nrows; i++ ) IDs[i] = kvs::UInt16( nclusters * R() );
+    // Clustering.
+    table->openColumnFiles();
+    kvs::ValueArray<kvs::Real32> centers( nclusters * ncolumns );
+    bool success = false;
+    switch ( m_method )
+    {
+    case MiniBatchMethod:
+        success = this->calculate_centers_with_mini_batch( table, centers );
+        break;
+    case CoresetMethod:
+        success = this->calculate_centers_with_coreset( table, centers );
+        break;
+    default:
+        success = this->calculate_centers_exactly( table, centers );
+        break;
+    }
 
-    // Allocate memory for the mean values.
-    kvs::ValueArray<kvs::Real64>* means = new kvs::ValueArray<kvs::Real64> [ nclusters ];
-    for ( size_t i = 0; i < nclusters; i++ ) { means[i].allocate( ncolumns ); }
+    // Cluster mapping.
+    if ( success ) { success = this->map_clusters( table, centers ); }
+    table->closeColumnFiles();
 
-    // Mean value used for convergence test.
-    kvs::ValueArray<kvs::Real64> mean_new( ncolumns );
+    if ( !success )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Cannot cluster the input table.");
+        return NULL;
+    }
 
-   // Clustering.
-    table->openColumnFiles();
-    bool converged = false;
-    size_t iterations = 0;
-    while ( !converged )
+    const size_t naxes = ncolumns;
+
+    // Sorting.
+    SuperClass::m_cluster_list.sort();
+
+    // Number of axes.
+    SuperClass::m_naxes = naxes;
+    SuperClass::setNumberOfColumns( naxes );
+
+    // Number of points.
+    SuperClass::m_npoints = nrows;
+    SuperClass::setNumberOfRows( nrows );
+
+    // Min/Max value.
+    SuperClass::setMinValues( table->minValues() );
+    SuperClass::setMaxValues( table->maxValues() );
+    SuperClass::setLabels( table->labels() );
+
+    // Min/Max range.
+    SuperClass::setMinRanges( table->minValues() );
+    SuperClass::setMaxRanges( table->maxValues() );
+
+    return this;
+}
+
+void OutOfCoreKMeansClusterMapping::setClusteringMethod( const ClusteringMethod method )
+{
+    m_method = method;
+}
+
+void OutOfCoreKMeansClusterMapping::setSeed( const size_t seed )
+{
+    m_random.setSeed( seed );
+}
+
+void OutOfCoreKMeansClusterMapping::setNumberOfClusters( const size_t nclusters )
+{
+    m_nclusters = nclusters;
+}
+
+void OutOfCoreKMeansClusterMapping::setMaxInterations( const size_t max_iterations )
+{
+    m_max_iterations = max_iterations;
+}
+
+void OutOfCoreKMeansClusterMapping::setTolerance( const double tolerance )
+{
+    m_tolerance = tolerance;
+}
+
+void OutOfCoreKMeansClusterMapping::setBlockSize( const size_t block_size )
+{
+    m_block_size = kvs::Math::Max( block_size, size_t(1) );
+}
+
+void OutOfCoreKMeansClusterMapping::setBatchSize( const size_t batch_size )
+{
+    m_batch_size = kvs::Math::Max( batch_size, size_t(1) );
+}
+
+void OutOfCoreKMeansClusterMapping::setCoresetSize( const size_t coreset_size )
+{
+    m_coreset_size = kvs::Math::Max( coreset_size, size_t(1) );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Selects the initial cluster centers.
+ *  @param  object [in] pointer to the out-of-core table object
+ *  @param  centers [out] cluster centers packed in row-major order
+ *  @return true if the process is done successfully
+ *
+ *  The rows are sampled uniformly in one sequential pass over the table,
+ *  and the k-means|| seeding is applied to the sampled rows.
+ */
+/*===========================================================================*/
+bool OutOfCoreKMeansClusterMapping::initialize_centers(
+    const kvs::ObjectBase* object,
+    kvs::ValueArray<kvs::Real32>& centers )
+{
+    const pcs::OutOfCoreTableObject* table = reinterpret_cast<const pcs::OutOfCoreTableObject*>( object );
+    const size_t nrows = table->numberOfRows();
+    const size_t ncolumns = table->numberOfColumns();
+    const size_t nclusters = m_nclusters;
+    const size_t block_size = kvs::Math::Min( m_block_size, nrows );
+    const size_t batch_size = kvs::Math::Min( m_batch_size, block_size );
+
+    std::vector<kvs::Real32> samples;
+    const size_t nsamples = kvs::Math::Min( nrows, kvs::Math::Max( batch_size, nclusters * 64 ) );
+    if ( !::SampleRows( table, block_size, nsamples, m_random, samples ) ) return false;
+    if ( samples.empty() )
+    {
+        samples.resize( nsamples * ncolumns );
+        if ( !table->readRows( 0, nsamples, &samples[0] ) ) return false;
+    }
+
+    pcs::ClusteringUtility::ScalableSeeding( &samples[0], samples.size() / ncolumns, ncolumns, nclusters, m_random, centers.data() );
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the cluster centers with Lloyd's k-means.
+ *  @param  object [in] pointer to the out-of-core table object
+ *  @param  centers [out] cluster centers packed in row-major order
+ *  @return true if the process is done successfully
+ *
+ *  Each iteration reads the table exactly once in sequential blocks. The
+ *  rows are assigned to the nearest centers and accumulated into the sums
+ *  in the same pass, and the new centers and the convergence test are
+ *  computed from the sums. The iterations are stopped when every center
+ *  moves less than the tolerance or none of them moves, so that the cluster
+ *  IDs of the rows do not need to be kept between the iterations.
+ */
+/*===========================================================================*/
+bool OutOfCoreKMeansClusterMapping::calculate_centers_exactly(
+    const kvs::ObjectBase* object,
+    kvs::ValueArray<kvs::Real32>& centers )
+{
+    const pcs::OutOfCoreTableObject* table = reinterpret_cast<const pcs::OutOfCoreTableObject*>( object );
+    const size_t nrows = table->numberOfRows();
+    const size_t ncolumns = table->numberOfColumns();
+    const size_t nclusters = m_nclusters;
+    const size_t block_size = kvs::Math::Min( m_block_size, nrows );
+
+    if ( !this->initialize_centers( table, centers ) ) return false;
+
+    std::vector<kvs::Real32> block( block_size * ncolumns );
+    std::vector<kvs::Real64> sums( nclusters * ncolumns );
+    std::vector<kvs::UInt64> counts( nclusters );
+    for ( size_t iterations = 0; iterations < kvs::Math::Max( m_max_iterations, size_t(1) ); iterations++ )
     {
-        // Calculate the center of cluster.
+        std::fill( sums.begin(), sums.end(), 0.0 );
+        std::fill( counts.begin(), counts.end(), 0 );
+
+        // Assignment and accumulation.
+        for ( size_t begin = 0; begin < nrows; begin += block_size )
+        {
+            const size_t n = kvs::Math::Min( block_size, nrows - begin );
+            if ( !table->readRows( begin, n, &block[0] ) ) return false;
+
+            ::AssignAndAccumulate( &block[0], n, ncolumns, centers.data(), nclusters, &sums[0], &counts[0] );
+        }
+
+        // Update the centers and test the convergence.
+        bool converged = true;
+        bool moved = false;
         for ( size_t i = 0; i < nclusters; i++ )
         {
-            ::CalculateMeans( table, i, IDs, &(means[i]) );
+            // The center of the empty cluster is kept in the current position.
+            if ( counts[i] == 0 ) continue;
+
+            kvs::Real64 distance = 0.0;
+            kvs::Real32* c = centers.data() + i * ncolumns;
+            for ( size_t k = 0; k < ncolumns; k++ )
+            {
+                const kvs::Real32 mean = static_cast<kvs::Real32>( sums[ i * ncolumns + k ] / counts[i] );
+                distance += ( mean - c[k] ) * ( mean - c[k] );
+                c[k] = mean;
+            }
+
+            if ( !( distance < m_tolerance ) ) { converged = false; }
+            if ( distance > 0.0 ) { moved = true; }
         }
 
-        // Calculate euclidean distance between the center of cluster and the point, and update the IDs.
-        for ( size_t i = 0; i < nrows; i++ )
+        if ( converged || !moved ) break;
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the cluster centers with mini-batch k-means.
+ *  @param  object [in] pointer to the out-of-core table object
+ *  @param  centers [out] cluster centers packed in row-major order
+ *  @return true if the process is done successfully
+ *
+ *  The table is streamed in sequential blocks, and each block is split into
+ *  mini-batches. The rows in a mini-batch are assigned to the nearest
+ *  centers, and then each center is moved toward the rows with the learning
+ *  rate given by the inverse of the number of rows assigned to the center
+ *  so far [D. Sculley, Web-Scale K-Means Clustering, WWW 2010]. One epoch
+ *  is one sequential pass over the table, and the epochs are repeated until
+ *  the centers move less than the tolerance.
+ */
+/*===========================================================================*/
+bool OutOfCoreKMeansClusterMapping::calculate_centers_with_mini_batch(
+    const kvs::ObjectBase* object,
+    kvs::ValueArray<kvs::Real32>& centers )
+{
+    const pcs::OutOfCoreTableObject* table = reinterpret_cast<const pcs::OutOfCoreTableObject*>( object );
+    const size_t nrows = table->numberOfRows();
+    const size_t ncolumns = table->numberOfColumns();
+    const size_t nclusters = m_nclusters;
+    const size_t block_size = kvs::Math::Min( m_block_size, nrows );
+    const size_t batch_size = kvs::Math::Min( m_batch_size, block_size );
+
+    if ( !this->initialize_centers( table, centers ) ) return false;
+
+    // Number of rows assigned to each center so far.
+    std::vector<kvs::UInt64> counts( nclusters, 0 );
+
+    std::vector<kvs::Real32> block( block_size * ncolumns );
+    std::vector<kvs::UInt32> ids( block_size );
+    std::vector<kvs::Real32> centers_old( nclusters * ncolumns );
+    for ( size_t epoch = 0; epoch < kvs::Math::Max( m_max_iterations, size_t(1) ); epoch++ )
+    {
+        std::copy( centers.begin(), centers.end(), centers_old.begin() );
+
+        for ( size_t begin = 0; begin < nrows; begin += block_size )
         {
-            size_t id = 0;
-            kvs::Real64 distance = kvs::Value<kvs::Real64>::Max();
-            for ( size_t j = 0; j < nclusters; j++ )
+            const size_t n = kvs::Math::Min( block_size, nrows - begin );
+            if ( !table->readRows( begin, n, &block[0] ) ) return false;
+
+            for ( size_t batch = 0; batch < n; batch += batch_size )
             {
-                const kvs::Real64 d = ::GetEuclideanDistance( table, i, means[j] );
-                if ( d < distance ) { distance = d; id = j; }
+                const size_t m = kvs::Math::Min( batch_size, n - batch );
+                const kvs::Real32* x = &block[ batch * ncolumns ];
+                ::AssignRows( x, m, ncolumns, centers.data(), nclusters, &ids[0] );
+
+                for ( size_t i = 0; i < m; i++ )
+                {
+                    const size_t id = ids[i];
+                    const kvs::Real32 eta = 1.0f / static_cast<kvs::Real32>( ++counts[id] );
+                    const kvs::Real32* xi = x + i * ncolumns;
+                    kvs::Real32* c = centers.data() + id * ncolumns;
+                    for ( size_t k = 0; k < ncolumns; k++ ) { c[k] += eta * ( xi[k] - c[k] ); }
+                }
             }
-            IDs[i] = id;
         }
 
         // Convergence test.
-        converged = true;
+        bool converged = true;
         for ( size_t i = 0; i < nclusters; i++ )
         {
-            ::CalculateMeans( table, i, IDs, &mean_new );
+            const kvs::Real32 d = pcs::ClusteringUtility::SquaredDistance( &centers_old[ i * ncolumns ], centers.data() + i * ncolumns, ncolumns );
+            if ( !( d < m_tolerance ) ) { converged = false; break; }
+        }
 
-            const kvs::Real64 distance = ::GetEuclideanDistance( table, means[i], mean_new );
+        if ( converged ) break;
+    }
 
-            if ( !( distance < m_tolerance ) )
-            {
-                converged = false;
-                break;
-            }
-        }
+    return true;
+}
 
-        if ( iterations++ > m_max_iterations ) break;
-    } // end of while
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the cluster centers with the weighted k-means on the coreset.
+ *  @param  object [in] pointer to the out-of-core table object
+ *  @param  centers [out] cluster centers packed in row-major order
+ *  @return true if the process is done successfully
+ *
+ *  The table is summarized into the coreset in one sequential pass, and the
+ *  coreset is clustered in memory with the weighted Hamerly's k-means.
+ */
+/*===========================================================================*/
+bool OutOfCoreKMeansClusterMapping::calculate_centers_with_coreset(
+    const kvs::ObjectBase* object,
+    kvs::ValueArray<kvs::Real32>& centers )
+{
+    const pcs::OutOfCoreTableObject* table = reinterpret_cast<const pcs::OutOfCoreTableObject*>( object );
+    const size_t ncolumns = table->numberOfColumns();
+    const size_t nclusters = m_nclusters;
 
-    delete [] means;
+    pcs::CoresetSampling coreset;
+    coreset.setSeed( m_random.randInteger() );
+    coreset.setCoresetSize( kvs::Math::Max( m_coreset_size, nclusters ) );
+    coreset.setBlockSize( m_block_size );
+    if ( !coreset.exec( table ) ) return false;
+
+    pcs::FastKMeansClustering clustering;
+    clustering.setSeed( m_random.randInteger() );
+    clustering.setSeedingMethod( pcs::FastKMeansClustering::SmartSeeding );
+    clustering.setNumberOfClusters( nclusters );
+    clustering.setMaxIterations( m_max_iterations );
+    clustering.setTolerance( static_cast<float>( m_tolerance ) );
+    clustering.enableWeight();
+    if ( !clustering.exec( &coreset ) ) return false;
 
+    for ( size_t i = 0; i < nclusters; i++ )
+    {
+        const kvs::ValueArray<kvs::Real32>& center = clustering.center(i);
+        std::copy( center.begin(), center.end(), centers.data() + i * ncolumns );
+    }
 
-    const size_t index = ncolumns;
-    const size_t naxes = index;
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Assigns the rows to the nearest centers and sets the clusters.
+ *  @param  object [in] pointer to the out-of-core table object
+ *  @param  centers [in] cluster centers packed in row-major order
+ *  @return true if the process is done successfully
+ *
+ *  The counters and the min/max envelopes of the clusters are calculated
+ *  in one sequential pass over the table.
+ */
+/*===========================================================================*/
+bool OutOfCoreKMeansClusterMapping::map_clusters(
+    const kvs::ObjectBase* object,
+    const kvs::ValueArray<kvs::Real32>& centers )
+{
+    const pcs::OutOfCoreTableObject* table = reinterpret_cast<const pcs::OutOfCoreTableObject*>( object );
+    const size_t nrows = table->numberOfRows();
+    const size_t naxes = table->numberOfColumns();
+    const size_t nclusters = m_nclusters;
+    const size_t block_size = kvs::Math::Min( m_block_size, nrows );
 
     // Cluster parameters.
-    size_t* counter = new size_t [ nclusters ];
+    std::vector<size_t> counter( nclusters, 0 );
     kvs::ValueArray<kvs::Real64>* min_values = new kvs::ValueArray<kvs::Real64> [ nclusters ];
     kvs::ValueArray<kvs::Real64>* max_values = new kvs::ValueArray<kvs::Real64> [ nclusters ];
 
     // Initialize the parameters.
-    std::memset( counter, 0, sizeof(size_t) * nclusters );
     for ( size_t i = 0; i < nclusters; i++ )
     {
         min_values[i].allocate( naxes );
@@ -215,16 +565,31 @@ OutOfCoreKMeansClusterMapping::SuperClass* OutOfCoreKMeansClusterMapping::exec(
     }
 
     // Cluster mapping.
-    for ( size_t i = 0; i < nrows; i++ )
+    std::vector<kvs::Real32> block( block_size * naxes );
+    std::vector<kvs::UInt32> ids( block_size );
+    for ( size_t begin = 0; begin < nrows; begin += block_size )
     {
-        const size_t id = IDs[i];
-        for ( size_t j = 0; j < naxes; j++ )
+        const size_t n = kvs::Math::Min( block_size, nrows - begin );
+        if ( !table->readRows( begin, n, &block[0] ) )
         {
-            const kvs::Real64 value = table->readValue( i, j );
-            min_values[id][j] = kvs::Math::Min( min_values[id][j], value );
-            max_values[id][j] = kvs::Math::Max( max_values[id][j], value );
+            delete [] min_values;
+            delete [] max_values;
+            return false;
+        }
+
+        ::AssignRows( &block[0], n, naxes, centers.data(), nclusters, &ids[0] );
+        for ( size_t i = 0; i < n; i++ )
+        {
+            const size_t id = ids[i];
+            const kvs::Real32* x = &block[ i * naxes ];
+            for ( size_t j = 0; j < naxes; j++ )
+            {
+                const kvs::Real64 value = x[j];
+                min_values[id][j] = kvs::Math::Min( min_values[id][j], value );
+                max_values[id][j] = kvs::Math::Max( max_values[id][j], value );
+            }
+            counter[id]++;
         }
-        counter[id]++;
     }
 
     // Set the clusters.
@@ -239,57 +604,10 @@ OutOfCoreKMeansClusterMapping::SuperClass* OutOfCoreKMeansClusterMapping::exec(
         SuperClass::m_cluster_list.push_back( cluster );
     }
 
-    delete [] counter;
     delete [] min_values;
     delete [] max_values;
 
-    // Sorting.
-    SuperClass::m_cluster_list.sort();
-
-    // Number of axes.
-    SuperClass::m_naxes = naxes;
-    SuperClass::setNumberOfColumns( naxes );
-
-    // Number of points.
-    SuperClass::m_npoints = nrows;
-    SuperClass::setNumberOfRows( nrows );
-
-    // Min/Max value.
-/*
-    for ( size_t i = 0; i < naxes; i++ )
-    {
-        SuperClass::m_min_values.push_back( table->minValue(i) );
-        SuperClass::m_max_values.push_back( table->maxValue(i) );
-    }
-*/
-    SuperClass::setMinValues( table->minValues() );
-    SuperClass::setMaxValues( table->maxValues() );
-    SuperClass::setLabels( table->labels() );
-
-    // Min/Max range.
-//    SuperClass::m_min_ranges.deepCopy( m_min_values );
-//    SuperClass::m_max_ranges.deepCopy( m_max_values );
-//    SuperClass::m_min_ranges = m_min_values;
-//    SuperClass::m_max_ranges = m_max_values;
-    SuperClass::setMinRanges( table->minValues() );
-    SuperClass::setMaxRanges( table->maxValues() );
-
-    return this;
-}
-
-void OutOfCoreKMeansClusterMapping::setNumberOfClusters( const size_t nclusters )
-{
-    m_nclusters = nclusters;
-}
-
-void OutOfCoreKMeansClusterMapping::setMaxInterations( const size_t max_iterations )
-{
-    m_max_iterations = max_iterations;
-}
-
-void OutOfCoreKMeansClusterMapping::setTolerance( const double tolerance )
-{
-    m_tolerance = tolerance;
+    return true;
 }
 
 } // end of namespace pcs
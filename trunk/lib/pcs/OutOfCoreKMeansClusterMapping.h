@@ -17,6 +17,7 @@
 
 #include <kvs/Module>
 #include <kvs/FilterBase>
+#include <kvs/MersenneTwister>
 #include "ClusterMapObject.h"
 
 
@@ -38,11 +39,25 @@ class OutOfCoreKMeansClusterMapping : public kvs::FilterBase, public pcs::Cluste
     kvsModuleBaseClass( kvs::FilterBase );
     kvsModuleSuperClass( pcs::ClusterMapObject );
 
+public:
+
+    enum ClusteringMethod
+    {
+        ExactMethod, ///< Lloyd's k-means with one sequential pass per iteration
+        MiniBatchMethod, ///< mini-batch k-means over sequential blocks
+        CoresetMethod ///< weighted k-means on the coreset
+    };
+
 protected:
 
+    kvs::MersenneTwister m_random; ///< random number generator
+    ClusteringMethod m_method; ///< clustering method
     size_t m_nclusters; ///< number of clusters
     size_t m_max_iterations; ///< maximum number of interations
     double m_tolerance; ///< tolerance of distance
+    size_t m_block_size; ///< number of rows read from the files at once
+    size_t m_batch_size; ///< number of rows in a mini-batch
+    size_t m_coreset_size; ///< number of rows in the coreset
 
 public:
 
@@ -56,9 +71,22 @@ public:
 
 public:
 
+    void setClusteringMethod( const ClusteringMethod method );
+    void setSeed( const size_t seed );
     void setNumberOfClusters( const size_t nclusters );
     void setMaxInterations( const size_t max_iterations );
     void setTolerance( const double tolerance );
+    void setBlockSize( const size_t block_size );
+    void setBatchSize( const size_t batch_size );
+    void setCoresetSize( const size_t coreset_size );
+
+private:
+
+    bool initialize_centers( const kvs::ObjectBase* object, kvs::ValueArray<kvs::Real32>& centers );
+    bool calculate_centers_exactly( const kvs::ObjectBase* object, kvs::ValueArray<kvs::Real32>& centers );
+    bool calculate_centers_with_mini_batch( const kvs::ObjectBase* object, kvs::ValueArray<kvs::Real32>& centers );
+    bool calculate_centers_with_coreset( const kvs::ObjectBase* object, kvs::ValueArray<kvs::Real32>& centers );
+    bool map_clusters( const kvs::ObjectBase* object, const kvs::ValueArray<kvs::Real32>& centers );
 };
 
 } // end of namespace pcs
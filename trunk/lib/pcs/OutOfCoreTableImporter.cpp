@@ -24,6 +24,7 @@
 #include <utility>
 #include <kvs/Math>
 #include <kvs/Value>
+#include "../util/BrickedVolumeFile.h"
 
 
 namespace
@@ -133,6 +134,27 @@ std::pair<kvs::Real64,kvs::Real64> GetMinMax( const kvs::AnyValueArray& array )
     return std::pair<kvs::Real64,kvs::Real64>( min_value, max_value );
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Returns the <DataArray> element of the compressed column.
+ *  @param  node [in] pointer to the <Column> node
+ *  @return pointer to the element (NULL if the format is not "compressed")
+ *
+ *  The compressed column (see util::BrickedVolumeFile) cannot be read by
+ *  kvs::kvsml::DataArrayTag, so that it is detected in advance.
+ */
+/*===========================================================================*/
+const kvs::XMLElement::SuperClass* CompressedDataArray( const kvs::XMLNode::SuperClass* node )
+{
+    const kvs::XMLNode::SuperClass* data_array_node = kvs::XMLNode::FindChildNode( node, "DataArray" );
+    if ( !data_array_node ) return NULL;
+
+    const kvs::XMLElement::SuperClass* element = kvs::XMLNode::ToElement( data_array_node );
+    if ( !element || kvs::XMLElement::AttributeValue( element, "format" ) != "compressed" ) return NULL;
+
+    return element;
+}
+
 }
 
 namespace kvsoceanvis
@@ -250,6 +272,34 @@ void OutOfCoreTableImporter::import( const kvs::KVSMLObjectTable* kvsml, const s
         column_tag.read( kvs::XMLNode::ToElement( node ) );
 
 //        if ( counter++ < m_ncolumns )
+        const kvs::XMLElement::SuperClass* element = ::CompressedDataArray( node );
+        if ( element )
+        {
+            // The values are not read, and the min/max values are given by
+            // the header of the compressed column file.
+            const std::string path = kvs::File( document.filename() ).pathName( true );
+            const std::string filename = path + kvs::File::Separator() + kvs::XMLElement::AttributeValue( element, "file" );
+            const util::BrickedVolumeFile file( filename );
+            if ( !file.isOpen() || file.resolution().x() != SuperClass::numberOfRows() )
+            {
+                kvsMessageError( "Cannot read the compressed column %s.", filename.c_str() );
+            }
+            else
+            {
+                SuperClass::m_column_types.push_back( "float" );
+                SuperClass::m_column_formats.push_back( "compressed" );
+                SuperClass::m_column_files.push_back( filename );
+                labels.push_back( column_tag.label() );
+
+                const kvs::Real64 min_value = column_tag.hasMinValue() ? column_tag.minValue() : file.minValue();
+                const kvs::Real64 max_value = column_tag.hasMaxValue() ? column_tag.maxValue() : file.maxValue();
+                min_values.push_back( min_value );
+                max_values.push_back( max_value );
+                min_ranges.push_back( min_value );
+                max_ranges.push_back( max_value );
+            }
+        }
+        else
         {
             // Read one element for determing the data type.
             kvs::AnyValueArray data_array;
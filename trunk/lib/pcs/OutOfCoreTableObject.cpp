@@ -17,6 +17,7 @@
 #include <kvs/Vector3>
 #include <kvs/AnyValueArray>
 #include <Core/FileFormat/KVSML/DataArray.h>
+#include "../util/BrickedVolumeFile.h"
 
 
 namespace
@@ -127,6 +128,127 @@ const kvs::AnyValueArray ReadExternalData(
     return kvs::AnyValueArray();
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Reads the values of the column into the row-major matrix.
+ *  @param  index [in] index of the first row
+ *  @param  nvalues [in] number of rows
+ *  @param  column_index [in] column index
+ *  @param  ncolumns [in] number of columns
+ *  @param  format [in] file format
+ *  @param  file_pointer [in] file pointer
+ *  @param  data [out] pointer to the row-major matrix
+ *  @return true if the values are read successfully
+ */
+/*===========================================================================*/
+template <typename T>
+bool ReadExternalData(
+    const size_t index,
+    const size_t nvalues,
+    const size_t column_index,
+    const size_t ncolumns,
+    const std::string& format,
+    FILE* file_pointer,
+    kvs::Real32* data )
+{
+    kvs::Real32* row = data + column_index;
+    if ( format == "binary" )
+    {
+        std::vector<T> values( nvalues );
+        fseek( file_pointer, sizeof(T) * index, SEEK_SET );
+        if ( fread( &values[0], sizeof(T), nvalues, file_pointer ) != nvalues )
+        {
+            kvsMessageError("Cannot read values in the table object.");
+            return false;
+        }
+
+        for ( size_t i = 0; i < nvalues; i++, row += ncolumns ) { *row = kvs::Real32( values[i] ); }
+        return true;
+    }
+
+    const kvs::AnyValueArray values = ::ReadExternalData<T>( index, nvalues, format, file_pointer );
+    if ( values.size() != nvalues ) return false;
+
+    for ( size_t i = 0; i < nvalues; i++, row += ncolumns ) { *row = values.at<kvs::Real32>(i); }
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads the values of the compressed column.
+ *  @param  index [in] index of the first row
+ *  @param  nvalues [in] number of rows
+ *  @param  file [in] pointer to the compressed column file
+ *  @param  values [out] pointer to the values
+ *  @return true if the values are read successfully
+ */
+/*===========================================================================*/
+bool ReadCompressedData(
+    const size_t index,
+    const size_t nvalues,
+    const kvsoceanvis::util::BrickedVolumeFile* file,
+    kvs::Real32* values )
+{
+    if ( !file || !file->isOpen() )
+    {
+        kvsMessageError("Compressed column file is not opened.");
+        return false;
+    }
+
+    if ( nvalues == 0 ) return true;
+
+    const kvs::Vec3ui min_index( static_cast<unsigned int>( index ), 0, 0 );
+    const kvs::Vec3ui max_index( static_cast<unsigned int>( index + nvalues - 1 ), 0, 0 );
+    return file->readRegion( min_index, max_index, values );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads a value of the compressed column through the decompressed block.
+ *  @param  index [in] row index
+ *  @param  file [in] pointer to the compressed column file
+ *  @param  brick_index [in/out] index of the decompressed block
+ *  @param  brick [in/out] values of the decompressed block
+ *  @param  value [out] pointer to the value
+ *  @return true if the value is read successfully
+ *
+ *  The block including the row is decompressed only if it is not the given
+ *  decompressed block, and then it is kept in the given block.
+ */
+/*===========================================================================*/
+bool ReadCompressedValue(
+    const size_t index,
+    const kvsoceanvis::util::BrickedVolumeFile* file,
+    size_t& brick_index,
+    kvs::ValueArray<kvs::Real32>& brick,
+    kvs::Real32* value )
+{
+    if ( !file || !file->isOpen() )
+    {
+        kvsMessageError("Compressed column file is not opened.");
+        return false;
+    }
+
+    if ( index >= file->resolution().x() ) return false;
+
+    const size_t bindex = index / file->brickSize();
+    if ( bindex != brick_index )
+    {
+        kvs::Vec3ui min_index, max_index;
+        file->brickRange( bindex, &min_index, &max_index );
+        brick.allocate( max_index.x() - min_index.x() + 1 );
+        if ( !file->readBrick( bindex, brick.data() ) )
+        {
+            brick_index = size_t(-1);
+            return false;
+        }
+        brick_index = bindex;
+    }
+
+    *value = brick[ index - bindex * file->brickSize() ];
+    return true;
+}
+
 const size_t GetByteSizePerRow( const kvsoceanvis::pcs::OutOfCoreTableObject* table )
 {
     const size_t ncolumns = table->numberOfColumns();
@@ -198,7 +320,20 @@ void OutOfCoreTableObject::fetch() const
         FILE* file_pointer = m_column_file_pointers[i];
         const std::string type = this->columnType( i );
         const std::string format = this->columnFormat( i );
-        if( type == "char" )
+        if ( format == "compressed" )
+        {
+            // The rows beyond the end of the table are filled with zero.
+            const size_t nrows = BaseClass::numberOfRows();
+            const size_t nvalues = m_cache_index < nrows ? kvs::Math::Min( m_cache_nrows, nrows - m_cache_index ) : 0;
+            kvs::ValueArray<kvs::Real32> values( m_cache_nrows );
+            values.fill( 0 );
+            if ( !::ReadCompressedData( m_cache_index, nvalues, m_column_compressed_files[i], values.data() ) )
+            {
+                kvsMessageError( "Cannot read %s.", m_column_files[i].c_str() );
+            }
+            m_cache_columns.push_back( kvs::AnyValueArray( values ) );
+        }
+        else if( type == "char" )
         {
             m_cache_columns.push_back( ::ReadExternalData<kvs::Int8>( m_cache_index, m_cache_nrows, format, file_pointer ) );
         }
@@ -238,12 +373,26 @@ void OutOfCoreTableObject::openColumnFiles() const
     const size_t nfiles = m_column_files.size();
     for ( size_t i = 0; i < nfiles; i++ )
     {
+        if ( m_column_formats[i] == "compressed" )
+        {
+            util::BrickedVolumeFile* file = new util::BrickedVolumeFile( m_column_files[i] );
+            if ( !file->isOpen() ) kvsMessageError( "Cannot open %s.", m_column_files[i].c_str() );
+            m_column_file_pointers.push_back( NULL );
+            m_column_compressed_files.push_back( file );
+            m_column_brick_indices.push_back( size_t(-1) );
+            m_column_bricks.push_back( kvs::ValueArray<kvs::Real32>() );
+            continue;
+        }
+
         FILE* fp = NULL;
         if ( m_column_formats[i] == "binary" ) fp = fopen( m_column_files[i].c_str(), "rb" );
         else fp = fopen( m_column_files[i].c_str(), "r" );
 
         if ( !fp ) kvsMessageError( "Cannot open %s.", m_column_files[i].c_str() );
         m_column_file_pointers.push_back( fp );
+        m_column_compressed_files.push_back( NULL );
+        m_column_brick_indices.push_back( size_t(-1) );
+        m_column_bricks.push_back( kvs::ValueArray<kvs::Real32>() );
     }
 }
 
@@ -252,10 +401,19 @@ void OutOfCoreTableObject::closeColumnFiles() const
     const size_t nfiles = m_column_file_pointers.size();
     for ( size_t i = 0; i < nfiles; i++ )
     {
-        fclose( m_column_file_pointers[i] );
+        if ( m_column_file_pointers[i] ) fclose( m_column_file_pointers[i] );
+        delete m_column_compressed_files[i];
     }
 
     m_column_file_pointers.clear();
+    m_column_compressed_files.clear();
+    m_column_brick_indices.clear();
+    m_column_bricks.clear();
+}
+
+bool OutOfCoreTableObject::hasOpenedColumnFiles() const
+{
+    return !m_column_file_pointers.empty();
 }
 
 const std::string& OutOfCoreTableObject::columnType( const size_t index ) const
@@ -281,7 +439,20 @@ kvs::AnyValueArray OutOfCoreTableObject::column( const size_t index ) const
     const size_t nelements = this->numberOfRows();
 
     kvs::AnyValueArray values;
-    if( type == "char" )
+    if ( format == "compressed" )
+    {
+        const util::BrickedVolumeFile file( filename );
+        kvs::ValueArray<kvs::Real32> data( nelements );
+        if ( !::ReadCompressedData( 0, nelements, &file, data.data() ) )
+        {
+            kvsMessageError( "Cannot read %s.", filename.c_str() );
+        }
+        else
+        {
+            values = kvs::AnyValueArray( data );
+        }
+    }
+    else if( type == "char" )
     {
         if ( !kvs::kvsml::DataArray::ReadExternalData<kvs::Int8>( &values, nelements, filename, format ) )
         {
@@ -370,7 +541,21 @@ kvs::Real64 OutOfCoreTableObject::readValue( const size_t row_index, const size_
         FILE* file_pointer = m_column_file_pointers[column_index];
         const std::string type = this->columnType( column_index );
         const std::string format = this->columnFormat( column_index );
-        if( type == "char" )
+        if ( format == "compressed" )
+        {
+            kvs::Real32 value = 0.0f;
+            if ( !::ReadCompressedValue(
+                     row_index,
+                     m_column_compressed_files[column_index],
+                     m_column_brick_indices[column_index],
+                     m_column_bricks[column_index],
+                     &value ) )
+            {
+                kvsMessageError("Cannot read a value in the table object.");
+            }
+            return kvs::Real64( value );
+        }
+        else if( type == "char" )
         {
             return ::ReadExternalData<kvs::Int8>( row_index, format, file_pointer );
         }
@@ -408,6 +593,86 @@ kvs::Real64 OutOfCoreTableObject::readValue( const size_t row_index, const size_
     }
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Reads the consecutive rows into the row-major matrix.
+ *  @param  row_index [in] index of the first row
+ *  @param  nrows [in] number of rows
+ *  @param  data [out] pointer to the matrix of nrows x ncolumns values
+ *  @return true if the rows are read successfully
+ *
+ *  Each column file is read sequentially with a single request, so that the
+ *  whole table can be streamed in large blocks. The blocks of the compressed
+ *  columns are decompressed in parallel. The column files have to be opened
+ *  with openColumnFiles() in advance.
+ */
+/*===========================================================================*/
+bool OutOfCoreTableObject::readRows( const size_t row_index, const size_t nrows, kvs::Real32* data ) const
+{
+    const size_t ncolumns = BaseClass::numberOfColumns();
+    if ( m_column_file_pointers.size() < ncolumns )
+    {
+        kvsMessageError("Column files are not opened.");
+        return false;
+    }
+
+    for ( size_t i = 0; i < ncolumns; i++ )
+    {
+        FILE* file_pointer = m_column_file_pointers[i];
+        const std::string type = this->columnType( i );
+        const std::string format = this->columnFormat( i );
+
+        bool success = false;
+        if ( format == "compressed" )
+        {
+            std::vector<kvs::Real32> values( nrows );
+            success = nrows == 0 || ::ReadCompressedData( row_index, nrows, m_column_compressed_files[i], &values[0] );
+            kvs::Real32* row = data + i;
+            for ( size_t j = 0; success && j < nrows; j++, row += ncolumns ) { *row = values[j]; }
+        }
+        else if( type == "char" )
+        {
+            success = ::ReadExternalData<kvs::Int8>( row_index, nrows, i, ncolumns, format, file_pointer, data );
+        }
+        else if( type == "unsigned char" || type == "uchar" )
+        {
+            success = ::ReadExternalData<kvs::UInt8>( row_index, nrows, i, ncolumns, format, file_pointer, data );
+        }
+        else if ( type == "short" )
+        {
+            success = ::ReadExternalData<kvs::Int16>( row_index, nrows, i, ncolumns, format, file_pointer, data );
+        }
+        else if ( type == "unsigned short" || type == "ushort" )
+        {
+            success = ::ReadExternalData<kvs::UInt16>( row_index, nrows, i, ncolumns, format, file_pointer, data );
+        }
+        else if ( type == "int" )
+        {
+            success = ::ReadExternalData<kvs::Int32>( row_index, nrows, i, ncolumns, format, file_pointer, data );
+        }
+        else if ( type == "unsigned int" || type == "uint" )
+        {
+            success = ::ReadExternalData<kvs::UInt32>( row_index, nrows, i, ncolumns, format, file_pointer, data );
+        }
+        else if ( type == "float" )
+        {
+            success = ::ReadExternalData<kvs::Real32>( row_index, nrows, i, ncolumns, format, file_pointer, data );
+        }
+        else if ( type == "double" )
+        {
+            success = ::ReadExternalData<kvs::Real64>( row_index, nrows, i, ncolumns, format, file_pointer, data );
+        }
+        else
+        {
+            kvsMessageError( "'type' is not specified or unknown data type '%s'.", type.c_str() );
+        }
+
+        if ( !success ) return false;
+    }
+
+    return true;
+}
+
 } // end of namespace pcs
 
 } // end of namespace kvsoceanvis
@@ -20,17 +20,31 @@
 #include <cstdio>
 #include <kvs/Module>
 #include <kvs/TableObject>
+#include <kvs/ValueArray>
 
 
 namespace kvsoceanvis
 {
 
+namespace util
+{
+class BrickedVolumeFile;
+}
+
 namespace pcs
 {
 
 /*===========================================================================*/
 /**
  *  @brief  Out-of-core table class.
+ *
+ *  The columns are read from the external files in the format of "binary",
+ *  "ascii" or "compressed". The compressed column is the bricked volume file
+ *  of nrows x 1 x 1 float values (see util::BrickedVolumeFile), whose blocks
+ *  of the rows are decompressed in parallel when they are read. The last
+ *  block decompressed by readValue() is kept for each compressed column, so
+ *  that the rows can be read one by one without decompressing the block for
+ *  every value.
  */
 /*===========================================================================*/
 class OutOfCoreTableObject : public kvs::TableObject
@@ -45,6 +59,9 @@ protected:
     std::vector<std::string> m_column_formats; ///< column formats
     std::vector<std::string> m_column_files; ///< column files
     mutable std::vector<FILE*> m_column_file_pointers; // column file pointers
+    mutable std::vector<util::BrickedVolumeFile*> m_column_compressed_files; ///< compressed column files (NULL for the other formats)
+    mutable std::vector<size_t> m_column_brick_indices; ///< indices of the last decompressed blocks of the compressed columns
+    mutable std::vector< kvs::ValueArray<kvs::Real32> > m_column_bricks; ///< last decompressed blocks of the compressed columns
     bool m_cache_enabled; ///< enable chache machanism
     kvs::UInt64 m_cache_size; ///< cache size [byte]
     mutable size_t m_cache_index; ///< start index of cached data
@@ -64,6 +81,7 @@ public:
     void fetch() const;
     void openColumnFiles() const;
     void closeColumnFiles() const;
+    bool hasOpenedColumnFiles() const;
 
     const std::string& columnType( const size_t index ) const;
     const std::string& columnFormat( const size_t index ) const;
@@ -72,6 +90,7 @@ public:
     ObjectType objectType() const;
 
     kvs::Real64 readValue( const size_t row_index, const size_t column_index ) const;
+    bool readRows( const size_t row_index, const size_t nrows, kvs::Real32* data ) const;
 };
 
 } // end of namespace pcs
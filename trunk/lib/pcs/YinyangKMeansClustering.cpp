@@ -0,0 +1,718 @@
+/*****************************************************************************/
+/**
+ *  @file   YinyangKMeansClustering.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "YinyangKMeansClustering.h"
+#include "ClusteringUtility.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <kvs/Value>
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Groups of the cluster centers.
+ */
+/*===========================================================================*/
+struct Groups
+{
+    size_t ngroups; ///< number of groups
+    std::vector<kvs::UInt32> group; ///< group index of each center
+    std::vector<size_t> offsets; ///< offset of each group in the members (ngroups + 1)
+    std::vector<kvs::UInt32> members; ///< center indices sorted by the group
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Initializes the centers with rows selected randomly.
+ *  @param  x [in] pointer to the table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  nclusters [in] number of clusters
+ *  @param  random [in] random number generator
+ *  @param  c [out] pointer to the centers packed in row-major order
+ */
+/*===========================================================================*/
+void InitializeCenterWithRandomSeeding(
+    const kvs::Real32* x,
+    const size_t nrows,
+    const size_t ncolumns,
+    const size_t nclusters,
+    kvs::MersenneTwister& random,
+    kvs::Real32* c )
+{
+    for ( size_t i = 0; i < nclusters; i++ )
+    {
+        const size_t index = kvs::Math::Min( size_t( nrows * random.rand() ), nrows - 1 );
+        std::copy( x + index * ncolumns, x + ( index + 1 ) * ncolumns, c + i * ncolumns );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Groups the initial centers by k-means clustering of the centers.
+ *  @param  c [in] pointer to the centers packed in row-major order
+ *  @param  nclusters [in] number of clusters
+ *  @param  ncolumns [in] number of columns
+ *  @param  ngroups [in] number of groups
+ *  @param  groups [out] groups of the centers
+ *
+ *  The grouping is fixed through the iterations, so a few iterations of the
+ *  k-means over the centers are enough.
+ */
+/*===========================================================================*/
+void GroupCenters(
+    const kvs::Real32* c,
+    const size_t nclusters,
+    const size_t ncolumns,
+    const size_t ngroups,
+    Groups& groups )
+{
+    const size_t max_iterations = 5;
+
+    std::vector<kvs::Real32> g( ngroups * ncolumns );
+    for ( size_t t = 0; t < ngroups; t++ )
+    {
+        const size_t j = t * nclusters / ngroups;
+        std::copy( c + j * ncolumns, c + ( j + 1 ) * ncolumns, g.begin() + t * ncolumns );
+    }
+
+    groups.ngroups = ngroups;
+    groups.group.resize( nclusters );
+    std::vector<kvs::Real64> sums( ngroups * ncolumns );
+    std::vector<size_t> counts( ngroups );
+    for ( size_t iteration = 0; iteration <= max_iterations; iteration++ )
+    {
+        for ( size_t j = 0; j < nclusters; j++ )
+        {
+            const size_t t = kvsoceanvis::pcs::ClusteringUtility::NearestCenter( c + j * ncolumns, &g[0], ngroups, ncolumns, NULL );
+            groups.group[j] = static_cast<kvs::UInt32>( t );
+        }
+
+        if ( iteration == max_iterations ) break;
+
+        std::fill( sums.begin(), sums.end(), 0.0 );
+        std::fill( counts.begin(), counts.end(), size_t(0) );
+        for ( size_t j = 0; j < nclusters; j++ )
+        {
+            const size_t t = groups.group[j];
+            for ( size_t k = 0; k < ncolumns; k++ ) { sums[ t * ncolumns + k ] += c[ j * ncolumns + k ]; }
+            counts[t]++;
+        }
+
+        for ( size_t t = 0; t < ngroups; t++ )
+        {
+            if ( counts[t] == 0 ) continue;
+            for ( size_t k = 0; k < ncolumns; k++ )
+            {
+                g[ t * ncolumns + k ] = static_cast<kvs::Real32>( sums[ t * ncolumns + k ] / counts[t] );
+            }
+        }
+    }
+
+    // Sort the center indices by the group (the empty groups have no members).
+    groups.offsets.assign( ngroups + 1, 0 );
+    for ( size_t j = 0; j < nclusters; j++ ) { groups.offsets[ groups.group[j] + 1 ]++; }
+    for ( size_t t = 0; t < ngroups; t++ ) { groups.offsets[ t + 1 ] += groups.offsets[t]; }
+
+    groups.members.resize( nclusters );
+    std::vector<size_t> position( groups.offsets.begin(), groups.offsets.end() - 1 );
+    for ( size_t j = 0; j < nclusters; j++ )
+    {
+        groups.members[ position[ groups.group[j] ]++ ] = static_cast<kvs::UInt32>( j );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Initializes the bounds and the assignments.
+ *  @param  groups [in] groups of the centers
+ *  @param  x [in] pointer to the table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  c [in] pointer to the centers packed in row-major order
+ *  @param  nclusters [in] number of clusters
+ *  @param  q [out] number of points
+ *  @param  cp [out] vector sum of all points
+ *  @param  u [out] upper bound
+ *  @param  l [out] lower bound for each group
+ *  @param  a [out] index of the center
+ */
+/*===========================================================================*/
+void Initialize(
+    const Groups& groups,
+    const kvs::Real32* x,
+    const size_t nrows,
+    const size_t ncolumns,
+    const kvs::Real32* c,
+    const size_t nclusters,
+    kvs::ValueArray<kvs::Real64>& q,
+    kvs::ValueArray<kvs::Real64>& cp,
+    kvs::ValueArray<kvs::Real32>& u,
+    kvs::ValueArray<kvs::Real32>& l,
+    kvs::ValueArray<kvs::UInt32>& a )
+{
+    q.fill( 0x00 );
+    cp.fill( 0x00 );
+
+    const size_t ngroups = groups.ngroups;
+    const kvs::Real32 max_value = kvs::Value<kvs::Real32>::Max();
+    const kvs::Int64 n = static_cast<kvs::Int64>( nrows );
+    #pragma omp parallel
+    {
+        std::vector<kvs::Real64> local_cp( nclusters * ncolumns, 0.0 );
+        std::vector<kvs::Real64> local_q( nclusters, 0.0 );
+
+        #pragma omp for schedule(static)
+        for ( kvs::Int64 i = 0; i < n; i++ )
+        {
+            const kvs::Real32* xi = x + i * ncolumns;
+            kvs::Real32* li = l.data() + i * ngroups;
+            std::fill( li, li + ngroups, max_value );
+
+            // The squared distances are compared here, and the bounds are
+            // converted to the distances at the end.
+            kvs::UInt32 best = 0;
+            kvs::Real32 dbest = max_value;
+            for ( size_t t = 0; t < ngroups; t++ )
+            {
+                for ( size_t m = groups.offsets[t]; m < groups.offsets[ t + 1 ]; m++ )
+                {
+                    const kvs::UInt32 j = groups.members[m];
+                    const kvs::Real32 d = kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( xi, c + j * ncolumns, ncolumns );
+                    if ( d < dbest )
+                    {
+                        if ( dbest < max_value )
+                        {
+                            kvs::Real32& lb = li[ groups.group[ best ] ];
+                            lb = kvs::Math::Min( lb, dbest );
+                        }
+                        best = j;
+                        dbest = d;
+                    }
+                    else
+                    {
+                        li[t] = kvs::Math::Min( li[t], d );
+                    }
+                }
+            }
+
+            a[i] = best;
+            u[i] = std::sqrt( dbest );
+            for ( size_t t = 0; t < ngroups; t++ )
+            {
+                if ( li[t] < max_value ) { li[t] = std::sqrt( li[t] ); }
+            }
+
+            kvs::Real64* cpi = &local_cp[ best * ncolumns ];
+            for ( size_t k = 0; k < ncolumns; k++ ) { cpi[k] += xi[k]; }
+            local_q[ best ] += 1.0;
+        }
+
+        #pragma omp critical
+        {
+            for ( size_t j = 0; j < nclusters * ncolumns; j++ ) { cp[j] += local_cp[j]; }
+            for ( size_t j = 0; j < nclusters; j++ ) { q[j] += local_q[j]; }
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Updates the center locations.
+ *  @param  cp [in] set of the vector sum of all points
+ *  @param  q [in] array of the number of points
+ *  @param  ncolumns [in] number of columns
+ *  @param  c [out] updated cluster centers
+ *  @param  p [out] array of the distance that the cluster center moved
+ */
+/*===========================================================================*/
+void MoveCenters(
+    const kvs::ValueArray<kvs::Real64>& cp,
+    const kvs::ValueArray<kvs::Real64>& q,
+    const size_t ncolumns,
+    kvs::ValueArray<kvs::Real32>& c,
+    kvs::ValueArray<kvs::Real32>& p )
+{
+    std::vector<kvs::Real32> cs( ncolumns );
+    const size_t nclusters = q.size();
+    for ( size_t j = 0; j < nclusters; j++ )
+    {
+        // The center of the empty cluster is kept in the current position.
+        if ( !( q[j] > 0.0 ) ) { p[j] = 0.0f; continue; }
+
+        kvs::Real32* cj = c.data() + j * ncolumns;
+        std::copy( cj, cj + ncolumns, cs.begin() );
+
+        const kvs::Real64 qj = q[j];
+        for ( size_t k = 0; k < ncolumns; k++ )
+        {
+            cj[k] = static_cast<kvs::Real32>( cp[ j * ncolumns + k ] / qj );
+        }
+        p[j] = std::sqrt( kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( &cs[0], cj, ncolumns ) );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the half of the distance from each center to its closest other center.
+ *  @param  c [in] pointer to the centers packed in row-major order
+ *  @param  nclusters [in] number of clusters
+ *  @param  ncolumns [in] number of columns
+ *  @param  s [out] half of the distance to the closest other center
+ *
+ *  The centers are split across the threads, since the number of the pairs
+ *  is large for a large number of clusters.
+ */
+/*===========================================================================*/
+void UpdateHalfDistances(
+    const kvs::Real32* c,
+    const size_t nclusters,
+    const size_t ncolumns,
+    kvs::ValueArray<kvs::Real32>& s )
+{
+    const kvs::Int64 n = static_cast<kvs::Int64>( nclusters );
+    #pragma omp parallel for schedule(dynamic, 16)
+    for ( kvs::Int64 j = 0; j < n; j++ )
+    {
+        kvs::Real32 dmin = kvs::Value<kvs::Real32>::Max();
+        for ( size_t jp = 0; jp < nclusters; jp++ )
+        {
+            if ( jp == size_t(j) ) continue;
+            const kvs::Real32 d = kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( c + j * ncolumns, c + jp * ncolumns, ncolumns );
+            dmin = kvs::Math::Min( dmin, d );
+        }
+
+        s[j] = ( dmin < kvs::Value<kvs::Real32>::Max() ) ? 0.5f * std::sqrt( dmin ) : dmin;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reassigns the points whose bounds do not hold.
+ *  @param  groups [in] groups of the centers
+ *  @param  x [in] pointer to the table data packed in row-major order
+ *  @param  nrows [in] number of rows
+ *  @param  ncolumns [in] number of columns
+ *  @param  c [in] pointer to the centers packed in row-major order
+ *  @param  nclusters [in] number of clusters
+ *  @param  p [in] array of the distance that the cluster center moved
+ *  @param  s [in] half of the distance to the closest other center
+ *  @param  q [in/out] number of points
+ *  @param  cp [in/out] vector sum of all points
+ *  @param  u [in/out] upper bound
+ *  @param  l [in/out] lower bound for each group
+ *  @param  a [in/out] index of the center
+ *
+ *  The bounds are first updated with the drifts of the centers. The point is
+ *  skipped when the upper bound is not greater than the smallest lower bound
+ *  of the groups (global filtering). Otherwise, only the groups whose lower
+ *  bound is less than the distance to the current best center are examined
+ *  (group filtering). The changes of the sums are merged as in Hamerly's
+ *  algorithm.
+ */
+/*===========================================================================*/
+void AssignPoints(
+    const Groups& groups,
+    const kvs::Real32* x,
+    const size_t nrows,
+    const size_t ncolumns,
+    const kvs::Real32* c,
+    const size_t nclusters,
+    const kvs::ValueArray<kvs::Real32>& p,
+    const kvs::ValueArray<kvs::Real32>& s,
+    kvs::ValueArray<kvs::Real64>& q,
+    kvs::ValueArray<kvs::Real64>& cp,
+    kvs::ValueArray<kvs::Real32>& u,
+    kvs::ValueArray<kvs::Real32>& l,
+    kvs::ValueArray<kvs::UInt32>& a )
+{
+    // Maximum drift of the centers in each group.
+    const size_t ngroups = groups.ngroups;
+    std::vector<kvs::Real32> drifts( ngroups, 0.0f );
+    for ( size_t j = 0; j < nclusters; j++ )
+    {
+        kvs::Real32& drift = drifts[ groups.group[j] ];
+        drift = kvs::Math::Max( drift, p[j] );
+    }
+
+    const kvs::Real32 max_value = kvs::Value<kvs::Real32>::Max();
+    const kvs::Int64 n = static_cast<kvs::Int64>( nrows );
+    #pragma omp parallel
+    {
+        std::vector<kvs::Real64> dcp( nclusters * ncolumns, 0.0 );
+        std::vector<kvs::Real64> dq( nclusters, 0.0 );
+        bool changed = false;
+
+        #pragma omp for schedule(static)
+        for ( kvs::Int64 i = 0; i < n; i++ )
+        {
+            kvs::Real32* li = l.data() + i * ngroups;
+            kvs::Real32 lmin = max_value;
+            for ( size_t t = 0; t < ngroups; t++ )
+            {
+                if ( li[t] < max_value ) { li[t] -= drifts[t]; }
+                lmin = kvs::Math::Min( lmin, li[t] );
+            }
+            u[i] += p[ a[i] ];
+
+            // Global filtering.
+            const kvs::Real32 m = kvs::Math::Max( s[ a[i] ], lmin );
+            if ( !( u[i] > m ) ) continue;
+
+            // Tighten upper bound.
+            const kvs::Real32* xi = x + i * ncolumns;
+            u[i] = std::sqrt( kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( xi, c + a[i] * ncolumns, ncolumns ) );
+            if ( !( u[i] > m ) ) continue;
+
+            // Group filtering.
+            const kvs::UInt32 ap = a[i];
+            kvs::UInt32 best = ap;
+            kvs::Real32 dbest = u[i];
+            for ( size_t t = 0; t < ngroups; t++ )
+            {
+                if ( !( li[t] < dbest ) ) continue;
+
+                kvs::UInt32 index = 0;
+                kvs::Real32 dmin1 = max_value;
+                kvs::Real32 dmin2 = max_value;
+                for ( size_t k = groups.offsets[t]; k < groups.offsets[ t + 1 ]; k++ )
+                {
+                    const kvs::UInt32 j = groups.members[k];
+                    if ( j == best ) continue;
+
+                    const kvs::Real32 d = std::sqrt( kvsoceanvis::pcs::ClusteringUtility::SquaredDistance( xi, c + j * ncolumns, ncolumns ) );
+                    if ( d < dmin1 ) { dmin2 = dmin1; dmin1 = d; index = j; }
+                    else if ( d < dmin2 ) { dmin2 = d; }
+                }
+
+                if ( dmin1 < dbest )
+                {
+                    // The previous best center becomes a candidate of its group.
+                    li[t] = dmin2;
+                    kvs::Real32& lb = li[ groups.group[ best ] ];
+                    lb = kvs::Math::Min( lb, dbest );
+                    best = index;
+                    dbest = dmin1;
+                }
+                else
+                {
+                    li[t] = dmin1;
+                }
+            }
+
+            a[i] = best;
+            u[i] = dbest;
+            if ( ap != best )
+            {
+                kvs::Real64* dcp_old = &dcp[ ap * ncolumns ];
+                kvs::Real64* dcp_new = &dcp[ best * ncolumns ];
+                for ( size_t k = 0; k < ncolumns; k++ )
+                {
+                    dcp_old[k] -= xi[k];
+                    dcp_new[k] += xi[k];
+                }
+                dq[ap] -= 1.0;
+                dq[best] += 1.0;
+                changed = true;
+            }
+        }
+
+        if ( changed )
+        {
+            #pragma omp critical
+            {
+                for ( size_t j = 0; j < nclusters * ncolumns; j++ ) { cp[j] += dcp[j]; }
+                for ( size_t j = 0; j < nclusters; j++ ) { q[j] += dq[j]; }
+            }
+        }
+    }
+}
+
+}
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new YinyangKMeansClustering class.
+ */
+/*===========================================================================*/
+YinyangKMeansClustering::YinyangKMeansClustering():
+    m_seeding_method( YinyangKMeansClustering::RandomSeeding ),
+    m_nclusters( 10 ),
+    m_max_iterations( 100 ),
+    m_tolerance( 1.e-6 ),
+    m_ngroups( 0 ),
+    m_centers( NULL )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new YinyangKMeansClustering class.
+ *  @param  object [in] pointer to the table object
+ *  @param  nclusters [in] number of clusters
+ */
+/*===========================================================================*/
+YinyangKMeansClustering::YinyangKMeansClustering( const kvs::ObjectBase* object, const size_t nclusters ):
+    m_seeding_method( YinyangKMeansClustering::RandomSeeding ),
+    m_nclusters( nclusters ),
+    m_max_iterations( 100 ),
+    m_tolerance( 1.e-6 ),
+    m_ngroups( 0 ),
+    m_centers( NULL )
+{
+    this->exec( object );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new YinyangKMeansClustering class.
+ *  @param  object [in] pointer to the table object
+ *  @param  nclusters [in] number of clusters
+ *  @param  max_iterations [in] maximum number of iterations
+ *  @param  tolerance [in] tolerance for the convergence test
+ */
+/*===========================================================================*/
+YinyangKMeansClustering::YinyangKMeansClustering( const kvs::ObjectBase* object, const size_t nclusters, const size_t max_iterations, const float tolerance ):
+    m_seeding_method( YinyangKMeansClustering::RandomSeeding ),
+    m_nclusters( nclusters ),
+    m_max_iterations( max_iterations ),
+    m_tolerance( tolerance ),
+    m_ngroups( 0 ),
+    m_centers( NULL )
+{
+    this->exec( object );
+}
+
+YinyangKMeansClustering::~YinyangKMeansClustering()
+{
+    if ( m_centers ) delete [] m_centers;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Executes Yinyang k-means clustering.
+ *  @param  object [in] pointer to the table object
+ *  @return pointer to the clustered table object
+ */
+/*===========================================================================*/
+YinyangKMeansClustering::SuperClass* YinyangKMeansClustering::exec( const kvs::ObjectBase* object )
+{
+    if ( !object )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input object is NULL.");
+        return NULL;
+    }
+
+    // Input table object.
+    const kvs::TableObject* table = static_cast<const kvs::TableObject*>( object );
+    const size_t nrows = table->numberOfRows();
+    const size_t ncolumns = table->numberOfColumns();
+    const size_t nclusters = m_nclusters;
+    if ( nrows == 0 || nclusters == 0 || ncolumns == 0 )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input table or number of clusters is empty.");
+        return NULL;
+    }
+
+    // Table data packed in row-major order.
+    const kvs::ValueArray<kvs::Real32> x = pcs::ClusteringUtility::PackTable( table );
+    if ( x.size() != nrows * ncolumns )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Cannot pack the input table.");
+        return NULL;
+    }
+
+    // Number of groups. The automatic number is about a tenth of the number
+    // of clusters, and is limited so that the lower bounds of all the rows
+    // (nrows x ngroups) fit within 64M values.
+    size_t ngroups = m_ngroups;
+    if ( ngroups == 0 )
+    {
+        const size_t max_bounds = size_t(1) << 26;
+        ngroups = ( nclusters + 9 ) / 10;
+        ngroups = kvs::Math::Min( ngroups, kvs::Math::Max( max_bounds / nrows, size_t(1) ) );
+    }
+    ngroups = kvs::Math::Max( kvs::Math::Min( ngroups, nclusters ), size_t(1) );
+
+    // Parameters that relate to cluster centers.
+    /*   c:  cluster center (packed in row-major order)
+     *   cp: vector sum of all points in the cluster
+     *   q:  number of points assigned to the cluster
+     *   p:  distance that c last moved
+     *   s:  half of the distance from c to its closest other center
+     */
+    kvs::ValueArray<kvs::Real32> c( nclusters * ncolumns );
+    kvs::ValueArray<kvs::Real64> cp( nclusters * ncolumns );
+    kvs::ValueArray<kvs::Real64> q( nclusters );
+    kvs::ValueArray<kvs::Real32> p( nclusters );
+    kvs::ValueArray<kvs::Real32> s( nclusters );
+
+    // Parameters that relate to data points.
+    /*   a:  index of the center to which the data point x is assigned
+     *   u:  upper bound on the distance between the data point x and
+     *       its assigned center c(a)
+     *   l:  lower bounds on the distance between the data point x and
+     *       the centers other than c(a) in each group (ngroups per row)
+     */
+    kvs::ValueArray<kvs::UInt32> a( nrows );
+    kvs::ValueArray<kvs::Real32> u( nrows );
+    kvs::ValueArray<kvs::Real32> l( nrows * ngroups );
+
+    // Assign initial centers.
+    switch ( m_seeding_method )
+    {
+    case RandomSeeding:
+        ::InitializeCenterWithRandomSeeding( x.data(), nrows, ncolumns, nclusters, m_random, c.data() );
+        break;
+    case SmartSeeding:
+        pcs::ClusteringUtility::ScalableSeeding( x.data(), nrows, ncolumns, nclusters, m_random, c.data() );
+        break;
+    default:
+        ::InitializeCenterWithRandomSeeding( x.data(), nrows, ncolumns, nclusters, m_random, c.data() );
+        break;
+    }
+
+    // Group the centers and initialize.
+    ::Groups groups;
+    ::GroupCenters( c.data(), nclusters, ncolumns, ngroups, groups );
+    ::Initialize( groups, x.data(), nrows, ncolumns, c.data(), nclusters, q, cp, u, l, a );
+
+    // Clustering.
+    bool converged = false;
+    size_t counter = 0;
+    while ( !converged )
+    {
+        ::MoveCenters( cp, q, ncolumns, c, p );
+
+        // Convergence test (the tolerance is given for the squared distance).
+        converged = true;
+        for ( size_t j = 0; j < nclusters; j++ )
+        {
+            if ( !( p[j] * p[j] < m_tolerance ) ) { converged = false; break; }
+        }
+        if ( converged ) break;
+
+        ::UpdateHalfDistances( c.data(), nclusters, ncolumns, s );
+        ::AssignPoints( groups, x.data(), nrows, ncolumns, c.data(), nclusters, p, s, q, cp, u, l, a );
+
+        if ( counter++ > m_max_iterations ) break;
+    }
+
+    if ( m_centers ) delete [] m_centers;
+    m_centers = new kvs::ValueArray<kvs::Real32> [ nclusters ];
+    for ( size_t j = 0; j < nclusters; j++ )
+    {
+        m_centers[j].allocate( ncolumns );
+        std::copy( c.data() + j * ncolumns, c.data() + ( j + 1 ) * ncolumns, m_centers[j].begin() );
+    }
+
+    // Cluster IDs.
+    const kvs::ValueArray<kvs::UInt32>& IDs = a;
+
+    // Set the results to the output table object.
+    for ( size_t i = 0; i < ncolumns; i++ )
+    {
+        const std::string label = table->label(i);
+        const kvs::AnyValueArray& column = table->column(i);
+        SuperClass::addColumn( column, label );
+    }
+    SuperClass::addColumn( kvs::AnyValueArray( IDs ), "Cluster ID" );
+
+    return this;
+}
+
+void YinyangKMeansClustering::setSeedingMethod( SeedingMethod seeding_method )
+{
+    m_seeding_method = seeding_method;
+}
+
+void YinyangKMeansClustering::setSeed( const size_t seed )
+{
+    m_random.setSeed( seed );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a number of clusters.
+ *  @param  nclusters [in] number of clusters
+ */
+/*===========================================================================*/
+void YinyangKMeansClustering::setNumberOfClusters( const size_t nclusters )
+{
+    m_nclusters = nclusters;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a maximum number of interations.
+ *  @param  max_iterations [in] maximum number of iterations
+ */
+/*===========================================================================*/
+void YinyangKMeansClustering::setMaxIterations( const size_t max_iterations )
+{
+    m_max_iterations = max_iterations;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a tolerance for the convergence test.
+ *  @param  tolerance [in] tolerance which can be assumed zero
+ */
+/*===========================================================================*/
+void YinyangKMeansClustering::setTolerance( const float tolerance )
+{
+    m_tolerance = tolerance;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a number of groups of the centers.
+ *  @param  ngroups [in] number of groups (0: automatic)
+ *
+ *  Each row has a lower bound for each group, so the memory for the bounds
+ *  is nrows x ngroups values.
+ */
+/*===========================================================================*/
+void YinyangKMeansClustering::setNumberOfGroups( const size_t ngroups )
+{
+    m_ngroups = ngroups;
+}
+
+size_t YinyangKMeansClustering::numberOfClusters() const
+{
+    return m_nclusters;
+}
+
+const kvs::ValueArray<kvs::Real32>& YinyangKMeansClustering::center( const size_t index ) const
+{
+    return m_centers[ index ];
+}
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
@@ -0,0 +1,101 @@
+/*****************************************************************************/
+/**
+ *  @file   YinyangKMeansClustering.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*----------------------------------------------------------------------------
+ *
+ * References:
+ * [1] Y. Ding, Y. Zhao, X. Shen, M. Musuvathi and T. Mytkowicz, Yinyang
+ *     K-Means: A Drop-In Replacement of the Classic K-Means with Consistent
+ *     Speedup, In Proceedings of the 32nd International Conference on Machine
+ *     Learning (ICML 2015), pp. 579-587, 2015.
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__PCS__YINYANG_K_MEANS_CLUSTERING_H_INCLUDE
+#define KVSOCEANVIS__PCS__YINYANG_K_MEANS_CLUSTERING_H_INCLUDE
+
+#include <kvs/Module>
+#include <kvs/FilterBase>
+#include <kvs/TableObject>
+#include <kvs/MersenneTwister>
+
+
+namespace kvsoceanvis
+{
+
+namespace pcs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  K-means clustering class with the Yinyang algorithm.
+ *
+ *  The centers are grouped, and each row has a lower bound for each group
+ *  of the centers in addition to the upper bound. This keeps the distance
+ *  computations small for a large number of clusters (hundreds or more),
+ *  where the single lower bound of Hamerly's algorithm becomes loose.
+ */
+/*===========================================================================*/
+class YinyangKMeansClustering : public kvs::FilterBase, public kvs::TableObject
+{
+    kvsModuleName( kvsoceanvis::pcs::YinyangKMeansClustering );
+    kvsModuleCategory( Filter );
+    kvsModuleBaseClass( kvs::FilterBase );
+    kvsModuleSuperClass( kvs::TableObject );
+
+public:
+
+    enum SeedingMethod
+    {
+        RandomSeeding,
+        SmartSeeding
+    };
+
+protected:
+
+    kvs::MersenneTwister m_random; ///< random number generator
+    SeedingMethod m_seeding_method; ///< seeding method
+    size_t m_nclusters; ///< number of clusters
+    size_t m_max_iterations; ///< maximum number of interations
+    float m_tolerance; ///< tolerance of distance
+    size_t m_ngroups; ///< number of groups of the centers (0: automatic)
+    kvs::ValueArray<kvs::Real32>* m_centers; ///< cluster centers
+
+public:
+
+    YinyangKMeansClustering();
+    YinyangKMeansClustering( const kvs::ObjectBase* object, const size_t nclusters );
+    YinyangKMeansClustering( const kvs::ObjectBase* object, const size_t nclusters, const size_t max_iterations, const float torelance );
+    virtual ~YinyangKMeansClustering();
+
+public:
+
+    SuperClass* exec( const kvs::ObjectBase* object );
+
+public:
+
+    void setSeedingMethod( SeedingMethod seeding_method );
+    void setSeed( const size_t seed );
+    void setNumberOfClusters( const size_t nclusters );
+    void setMaxIterations( const size_t max_iterations );
+    void setTolerance( const float tolerance );
+    void setNumberOfGroups( const size_t ngroups );
+
+    size_t numberOfClusters() const;
+    const kvs::ValueArray<kvs::Real32>& center( const size_t index ) const;
+};
+
+} // end of namespace pcs
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__PCS__YINYANG_K_MEANS_CLUSTERING_H_INCLUDE
@@ -0,0 +1,694 @@
+/*****************************************************************************/
+/**
+ *  @file   BrickedVolumeFile.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "BrickedVolumeFile.h"
+#include "LosslessCodec.h"
+#include "ErrorBoundedCodec.h"
+#include "MaskedStatistics.h"
+#include <fstream>
+#include <cstring>
+#include <kvs/Message>
+#include <kvs/Math>
+#if defined( _OPENMP )
+#include <omp.h>
+#endif
+
+
+namespace
+{
+
+const char Magic[8] = { 'K', 'O', 'V', 'B', 'R', 'I', 'C', 'K' };
+const kvs::UInt32 Version = 2;
+const kvs::UInt32 HasCoords = 1; // flag of the coordinates in the header (version 2)
+const size_t BrickEntrySize = 24; // offset (8), size (4), undef count (4), min/max (4+4)
+
+void Put32( std::vector<kvs::UInt8>* buffer, const kvs::UInt32 value )
+{
+    for ( size_t i = 0; i < 4; i++ ) buffer->push_back( static_cast<kvs::UInt8>( value >> ( 8 * i ) ) );
+}
+
+void Put64( std::vector<kvs::UInt8>* buffer, const kvs::UInt64 value )
+{
+    for ( size_t i = 0; i < 8; i++ ) buffer->push_back( static_cast<kvs::UInt8>( value >> ( 8 * i ) ) );
+}
+
+void PutReal32( std::vector<kvs::UInt8>* buffer, const kvs::Real32 value )
+{
+    kvs::UInt32 bits;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    ::Put32( buffer, bits );
+}
+
+kvs::UInt32 Get32( const kvs::UInt8* p )
+{
+    return kvs::UInt32( p[0] ) | ( kvs::UInt32( p[1] ) << 8 ) | ( kvs::UInt32( p[2] ) << 16 ) | ( kvs::UInt32( p[3] ) << 24 );
+}
+
+kvs::UInt64 Get64( const kvs::UInt8* p )
+{
+    return kvs::UInt64( ::Get32( p ) ) | ( kvs::UInt64( ::Get32( p + 4 ) ) << 32 );
+}
+
+kvs::Real32 GetReal32( const kvs::UInt8* p )
+{
+    const kvs::UInt32 bits = ::Get32( p );
+    kvs::Real32 value;
+    std::memcpy( &value, &bits, sizeof( value ) );
+    return value;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the coordinates of the volume.
+ *  @param  volume [in] pointer to the volume object
+ *  @return coordinates {x0,...,xi,y0,...,yj,z0,...,zk}
+ */
+/*===========================================================================*/
+kvs::ValueArray<kvs::Real32> Coords( const kvs::StructuredVolumeObject* volume )
+{
+    const kvs::Vec3ui resolution = volume->resolution();
+    const size_t ncoords = resolution.x() + resolution.y() + resolution.z();
+    if ( volume->gridType() == kvs::StructuredVolumeObject::Rectilinear && volume->coords().size() == ncoords )
+    {
+        return volume->coords();
+    }
+
+    // Node indices for the uniform grid.
+    kvs::ValueArray<kvs::Real32> coords( ncoords );
+    kvs::Real32* dst = coords.data();
+    for ( size_t axis = 0; axis < 3; axis++ )
+    {
+        for ( size_t i = 0; i < resolution[axis]; i++ ) *(dst++) = static_cast<kvs::Real32>( i );
+    }
+    return coords;
+}
+
+} // end of namespace
+
+
+namespace kvsoceanvis
+{
+
+namespace util
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes the scalar volume to the bricked volume file.
+ *  @param  filename [in] filename
+ *  @param  volume [in] pointer to the scalar volume object (float values)
+ *  @param  undef_value [in] undefined value
+ *  @param  brick_size [in] number of the nodes along an edge of the brick
+ *  @param  tolerance [in] absolute error tolerance (0: lossless)
+ *  @return true if the file is written successfully
+ *
+ *  The bricks are compressed by util::ErrorBoundedCodec if the tolerance is
+ *  positive, where the undefined values are stored exactly.
+ */
+/*===========================================================================*/
+bool BrickedVolumeFile::Write(
+    const std::string& filename,
+    const kvs::StructuredVolumeObject* volume,
+    const kvs::Real32 undef_value,
+    const size_t brick_size,
+    const kvs::Real32 tolerance )
+{
+    if ( !volume || volume->veclen() != 1 )
+    {
+        kvsMessageError("Scalar volume is required.");
+        return false;
+    }
+
+    const kvs::ValueArray<kvs::Real32> values = volume->values().asValueArray<kvs::Real32>();
+    const kvs::ValueArray<kvs::Real32> coords = ::Coords( volume );
+    return BrickedVolumeFile::write( filename, values, volume->resolution(), coords, undef_value, brick_size, tolerance );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes the values to the bricked volume file without coordinates.
+ *  @param  filename [in] filename
+ *  @param  values [in] values (in the order of x, y and z)
+ *  @param  resolution [in] resolution of the values
+ *  @param  undef_value [in] undefined value
+ *  @param  brick_size [in] number of the values along an edge of the brick
+ *  @param  tolerance [in] absolute error tolerance (0: lossless)
+ *  @return true if the file is written successfully
+ *
+ *  This is used for storing the values other than the volumes, such as the
+ *  columns of the table as the (nrows x 1 x 1) values, where the coordinates
+ *  are not stored in the file.
+ */
+/*===========================================================================*/
+bool BrickedVolumeFile::Write(
+    const std::string& filename,
+    const kvs::ValueArray<kvs::Real32>& values,
+    const kvs::Vec3ui& resolution,
+    const kvs::Real32 undef_value,
+    const size_t brick_size,
+    const kvs::Real32 tolerance )
+{
+    return BrickedVolumeFile::write( filename, values, resolution, kvs::ValueArray<kvs::Real32>(), undef_value, brick_size, tolerance );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes the values and coordinates to the bricked volume file.
+ *  @param  filename [in] filename
+ *  @param  values [in] values (in the order of x, y and z)
+ *  @param  resolution [in] resolution of the values
+ *  @param  coords [in] coordinates (empty: not stored)
+ *  @param  undef_value [in] undefined value
+ *  @param  brick_size [in] number of the values along an edge of the brick
+ *  @param  tolerance [in] absolute error tolerance (0: lossless)
+ *  @return true if the file is written successfully
+ */
+/*===========================================================================*/
+bool BrickedVolumeFile::write(
+    const std::string& filename,
+    const kvs::ValueArray<kvs::Real32>& values,
+    const kvs::Vec3ui& resolution,
+    const kvs::ValueArray<kvs::Real32>& coords,
+    const kvs::Real32 undef_value,
+    const size_t brick_size,
+    const kvs::Real32 tolerance )
+{
+    if ( brick_size == 0 || !( tolerance >= 0.0f ) )
+    {
+        kvsMessageError("Non-zero brick size and non-negative tolerance are required.");
+        return false;
+    }
+
+    const size_t dimx = resolution.x();
+    const size_t dimy = resolution.y();
+    const size_t dimz = resolution.z();
+    if ( values.size() != dimx * dimy * dimz )
+    {
+        kvsMessageError("Number of the values does not match the resolution.");
+        return false;
+    }
+
+    const size_t nbx = ( dimx + brick_size - 1 ) / brick_size;
+    const size_t nby = ( dimy + brick_size - 1 ) / brick_size;
+    const size_t nbz = ( dimz + brick_size - 1 ) / brick_size;
+    const size_t nbricks = nbx * nby * nbz;
+
+    // Compress the bricks in parallel.
+    const Codec codec = tolerance > 0.0f ? ErrorBounded : Lossless;
+    std::vector< std::vector<kvs::UInt8> > streams( nbricks );
+    std::vector<util::MaskedStatistics> statistics( nbricks, util::MaskedStatistics( undef_value ) );
+    std::vector<kvs::UInt32> undef_counts( nbricks, 0 );
+    const kvs::Int64 end = static_cast<kvs::Int64>( nbricks );
+    #pragma omp parallel for schedule(dynamic)
+    for ( kvs::Int64 index = 0; index < end; index++ )
+    {
+        const size_t bi = size_t( index ) % nbx;
+        const size_t bj = size_t( index ) / nbx % nby;
+        const size_t bk = size_t( index ) / ( nbx * nby );
+        const size_t imin = bi * brick_size;
+        const size_t jmin = bj * brick_size;
+        const size_t kmin = bk * brick_size;
+        const size_t imax = kvs::Math::Min( imin + brick_size, dimx );
+        const size_t jmax = kvs::Math::Min( jmin + brick_size, dimy );
+        const size_t kmax = kvs::Math::Min( kmin + brick_size, dimz );
+
+        std::vector<kvs::Real32> brick;
+        brick.reserve( ( imax - imin ) * ( jmax - jmin ) * ( kmax - kmin ) );
+        for ( size_t k = kmin; k < kmax; k++ )
+        {
+            for ( size_t j = jmin; j < jmax; j++ )
+            {
+                const kvs::Real32* line = values.data() + ( k * dimy + j ) * dimx;
+                brick.insert( brick.end(), line + imin, line + imax );
+            }
+        }
+
+        kvs::UInt32 undef_count = 0;
+        for ( size_t i = 0; i < brick.size(); i++ ) { if ( brick[i] == undef_value ) undef_count++; }
+
+        statistics[ index ].update( &brick[0], brick.size() );
+        undef_counts[ index ] = undef_count;
+        if ( codec == ErrorBounded )
+        {
+            const kvs::Vec3ui brick_resolution( imax - imin, jmax - jmin, kmax - kmin );
+            util::ErrorBoundedCodec::Encode( &brick[0], brick_resolution, tolerance, undef_value, &streams[ index ] );
+        }
+        else
+        {
+            util::LosslessCodec::Encode( &brick[0], brick.size(), &streams[ index ] );
+        }
+    }
+
+    // Header and the table of the bricks.
+    util::MaskedStatistics total( undef_value );
+    for ( size_t i = 0; i < nbricks; i++ ) total.merge( statistics[i] );
+
+    std::vector<kvs::UInt8> header( ::Magic, ::Magic + sizeof( ::Magic ) );
+    ::Put32( &header, ::Version );
+    ::Put32( &header, static_cast<kvs::UInt32>( dimx ) );
+    ::Put32( &header, static_cast<kvs::UInt32>( dimy ) );
+    ::Put32( &header, static_cast<kvs::UInt32>( dimz ) );
+    ::Put32( &header, static_cast<kvs::UInt32>( brick_size ) );
+    ::Put32( &header, static_cast<kvs::UInt32>( codec ) );
+    ::PutReal32( &header, codec == ErrorBounded ? tolerance : 0.0f );
+    ::Put32( &header, coords.size() > 0 ? ::HasCoords : 0 );
+    ::PutReal32( &header, undef_value );
+    ::PutReal32( &header, total.minValue() );
+    ::PutReal32( &header, total.maxValue() );
+    for ( size_t i = 0; i < coords.size(); i++ ) ::PutReal32( &header, coords[i] );
+
+    kvs::UInt64 offset = header.size() + nbricks * ::BrickEntrySize;
+    for ( size_t i = 0; i < nbricks; i++ )
+    {
+        ::Put64( &header, offset );
+        ::Put32( &header, static_cast<kvs::UInt32>( streams[i].size() ) );
+        ::Put32( &header, undef_counts[i] );
+        ::PutReal32( &header, statistics[i].minValue() );
+        ::PutReal32( &header, statistics[i].maxValue() );
+        offset += streams[i].size();
+    }
+
+    std::ofstream ofs( filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+    if ( !ofs.is_open() )
+    {
+        kvsMessageError( "Cannot open %s.", filename.c_str() );
+        return false;
+    }
+
+    ofs.write( reinterpret_cast<const char*>( &header[0] ), header.size() );
+    for ( size_t i = 0; i < nbricks; i++ )
+    {
+        ofs.write( reinterpret_cast<const char*>( &streams[i][0] ), streams[i].size() );
+    }
+
+    if ( !ofs.good() )
+    {
+        kvsMessageError( "Cannot write %s.", filename.c_str() );
+        return false;
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new BrickedVolumeFile class.
+ */
+/*===========================================================================*/
+BrickedVolumeFile::BrickedVolumeFile():
+    m_resolution( 0, 0, 0 ),
+    m_brick_size( 0 ),
+    m_brick_resolution( 0, 0, 0 ),
+    m_codec( Lossless ),
+    m_tolerance( 0.0f ),
+    m_undef_value( 0.0f ),
+    m_min_value( 0.0f ),
+    m_max_value( 0.0f )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new BrickedVolumeFile class and opens the file.
+ *  @param  filename [in] filename
+ */
+/*===========================================================================*/
+BrickedVolumeFile::BrickedVolumeFile( const std::string& filename ):
+    m_resolution( 0, 0, 0 ),
+    m_brick_size( 0 ),
+    m_brick_resolution( 0, 0, 0 ),
+    m_codec( Lossless ),
+    m_tolerance( 0.0f ),
+    m_undef_value( 0.0f ),
+    m_min_value( 0.0f ),
+    m_max_value( 0.0f )
+{
+    this->open( filename );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Opens the bricked volume file.
+ *  @param  filename [in] filename
+ *  @return true if the file is opened successfully
+ *
+ *  The file is memory-mapped, and the header and the table of the bricks are
+ *  read. The bricks are decompressed when they are read.
+ */
+/*===========================================================================*/
+bool BrickedVolumeFile::open( const std::string& filename )
+{
+    this->close();
+    if ( !m_file.open( filename ) ) return false;
+
+    const kvs::UInt8* data = static_cast<const kvs::UInt8*>( m_file.data() );
+    const size_t size = m_file.size();
+    const size_t fixed_size_v1 = sizeof( ::Magic ) + 4 * 9;
+    if ( size < fixed_size_v1 || std::memcmp( data, ::Magic, sizeof( ::Magic ) ) != 0 )
+    {
+        kvsMessageError( "%s is not a bricked volume file.", filename.c_str() );
+        this->close();
+        return false;
+    }
+
+    const kvs::UInt8* p = data + sizeof( ::Magic );
+    const kvs::UInt32 version = ::Get32( p ); p += 4;
+    const size_t dimx = ::Get32( p ); p += 4;
+    const size_t dimy = ::Get32( p ); p += 4;
+    const size_t dimz = ::Get32( p ); p += 4;
+    const size_t brick_size = ::Get32( p ); p += 4;
+    const kvs::UInt32 codec = ::Get32( p ); p += 4;
+    if ( version < 1 || version > ::Version || codec > ErrorBounded || brick_size == 0 )
+    {
+        kvsMessageError( "Unsupported version or codec of %s.", filename.c_str() );
+        this->close();
+        return false;
+    }
+
+    // Version 1 has neither the tolerance nor the flags, and always has the coordinates.
+    const size_t fixed_size = version == 1 ? fixed_size_v1 : fixed_size_v1 + 4 * 2;
+    if ( size < fixed_size )
+    {
+        kvsMessageError( "%s is truncated.", filename.c_str() );
+        this->close();
+        return false;
+    }
+
+    kvs::Real32 tolerance = 0.0f;
+    kvs::UInt32 flags = ::HasCoords;
+    if ( version >= 2 )
+    {
+        tolerance = ::GetReal32( p ); p += 4;
+        flags = ::Get32( p ); p += 4;
+    }
+
+    const size_t nbx = ( dimx + brick_size - 1 ) / brick_size;
+    const size_t nby = ( dimy + brick_size - 1 ) / brick_size;
+    const size_t nbz = ( dimz + brick_size - 1 ) / brick_size;
+    const size_t nbricks = nbx * nby * nbz;
+    const size_t ncoords = ( flags & ::HasCoords ) ? dimx + dimy + dimz : 0;
+    const size_t header_size = fixed_size + ncoords * 4 + nbricks * ::BrickEntrySize;
+    if ( size < header_size )
+    {
+        kvsMessageError( "%s is truncated.", filename.c_str() );
+        this->close();
+        return false;
+    }
+
+    m_undef_value = ::GetReal32( p ); p += 4;
+    m_min_value = ::GetReal32( p ); p += 4;
+    m_max_value = ::GetReal32( p ); p += 4;
+
+    if ( ncoords > 0 ) m_coords.allocate( ncoords );
+    for ( size_t i = 0; i < ncoords; i++, p += 4 ) m_coords[i] = ::GetReal32( p );
+
+    m_bricks.resize( nbricks );
+    for ( size_t i = 0; i < nbricks; i++ )
+    {
+        Brick& brick = m_bricks[i];
+        brick.offset = ::Get64( p ); p += 8;
+        brick.size = ::Get32( p ); p += 4;
+        brick.undef_count = ::Get32( p ); p += 4;
+        brick.min_value = ::GetReal32( p ); p += 4;
+        brick.max_value = ::GetReal32( p ); p += 4;
+        if ( brick.offset < header_size || brick.offset > size || brick.size > size - brick.offset )
+        {
+            kvsMessageError( "%s has an invalid brick table.", filename.c_str() );
+            this->close();
+            return false;
+        }
+    }
+
+    m_resolution = kvs::Vec3ui( dimx, dimy, dimz );
+    m_brick_size = brick_size;
+    m_brick_resolution = kvs::Vec3ui( nbx, nby, nbz );
+    m_codec = static_cast<Codec>( codec );
+    m_tolerance = tolerance;
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Closes the file.
+ */
+/*===========================================================================*/
+void BrickedVolumeFile::close()
+{
+    m_file.close();
+    m_resolution = kvs::Vec3ui( 0, 0, 0 );
+    m_brick_size = 0;
+    m_brick_resolution = kvs::Vec3ui( 0, 0, 0 );
+    m_codec = Lossless;
+    m_tolerance = 0.0f;
+    m_coords.release();
+    m_bricks.clear();
+}
+
+bool BrickedVolumeFile::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+const kvs::Vec3ui& BrickedVolumeFile::resolution() const
+{
+    return m_resolution;
+}
+
+size_t BrickedVolumeFile::brickSize() const
+{
+    return m_brick_size;
+}
+
+const kvs::Vec3ui& BrickedVolumeFile::brickResolution() const
+{
+    return m_brick_resolution;
+}
+
+size_t BrickedVolumeFile::numberOfBricks() const
+{
+    return m_bricks.size();
+}
+
+BrickedVolumeFile::Codec BrickedVolumeFile::codec() const
+{
+    return m_codec;
+}
+
+kvs::Real32 BrickedVolumeFile::tolerance() const
+{
+    return m_tolerance;
+}
+
+kvs::Real32 BrickedVolumeFile::undefValue() const
+{
+    return m_undef_value;
+}
+
+kvs::Real32 BrickedVolumeFile::minValue() const
+{
+    return m_min_value;
+}
+
+kvs::Real32 BrickedVolumeFile::maxValue() const
+{
+    return m_max_value;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the coordinates.
+ *  @return coordinates {x0,...,xi,y0,...,yj,z0,...,zk} (empty if not stored)
+ */
+/*===========================================================================*/
+const kvs::ValueArray<kvs::Real32>& BrickedVolumeFile::coords() const
+{
+    return m_coords;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the index of the brick.
+ *  @param  bi [in] brick index along the x-axis
+ *  @param  bj [in] brick index along the y-axis
+ *  @param  bk [in] brick index along the z-axis
+ *  @return index of the brick
+ */
+/*===========================================================================*/
+size_t BrickedVolumeFile::brickIndex( const size_t bi, const size_t bj, const size_t bk ) const
+{
+    return ( bk * m_brick_resolution.y() + bj ) * m_brick_resolution.x() + bi;
+}
+
+const BrickedVolumeFile::Brick& BrickedVolumeFile::brick( const size_t index ) const
+{
+    return m_bricks[ index ];
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the node index range of the brick.
+ *  @param  index [in] index of the brick
+ *  @param  min_index [out] min. node index (inclusive)
+ *  @param  max_index [out] max. node index (inclusive)
+ */
+/*===========================================================================*/
+void BrickedVolumeFile::brickRange( const size_t index, kvs::Vec3ui* min_index, kvs::Vec3ui* max_index ) const
+{
+    const size_t nbx = m_brick_resolution.x();
+    const size_t nby = m_brick_resolution.y();
+    const size_t b[3] = { index % nbx, index / nbx % nby, index / ( nbx * nby ) };
+    for ( size_t axis = 0; axis < 3; axis++ )
+    {
+        const size_t min = b[axis] * m_brick_size;
+        const size_t max = kvs::Math::Min( min + m_brick_size, size_t( m_resolution[axis] ) ) - 1;
+        (*min_index)[axis] = static_cast<unsigned int>( min );
+        (*max_index)[axis] = static_cast<unsigned int>( max );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the bricks whose value range contains the value.
+ *  @param  value [in] value (e.g. isovalue)
+ *  @return indices of the bricks
+ *
+ *  The cells on the faces between the bricks are shared with the neighboring
+ *  bricks, so the bricks next to the returned ones should be read as well for
+ *  extracting the isosurfaces in the cells across the faces.
+ */
+/*===========================================================================*/
+std::vector<size_t> BrickedVolumeFile::activeBricks( const kvs::Real32 value ) const
+{
+    std::vector<size_t> indices;
+    for ( size_t i = 0; i < m_bricks.size(); i++ )
+    {
+        const Brick& brick = m_bricks[i];
+        if ( brick.min_value <= value && value <= brick.max_value ) indices.push_back( i );
+    }
+    return indices;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads and decompresses the values of the brick.
+ *  @param  index [in] index of the brick
+ *  @param  values [out] pointer to the values (in the order of x, y and z in the brick)
+ *  @return true if the brick is read successfully
+ */
+/*===========================================================================*/
+bool BrickedVolumeFile::readBrick( const size_t index, kvs::Real32* values ) const
+{
+    if ( index >= m_bricks.size() ) return false;
+
+    kvs::Vec3ui min_index, max_index;
+    this->brickRange( index, &min_index, &max_index );
+    const kvs::Vec3ui resolution(
+        max_index.x() - min_index.x() + 1,
+        max_index.y() - min_index.y() + 1,
+        max_index.z() - min_index.z() + 1 );
+    const size_t nvalues = size_t( resolution.x() ) * resolution.y() * resolution.z();
+
+    const Brick& brick = m_bricks[ index ];
+    const kvs::UInt8* stream = static_cast<const kvs::UInt8*>( m_file.data() ) + brick.offset;
+    if ( m_codec == ErrorBounded )
+    {
+        return util::ErrorBoundedCodec::Decode( stream, brick.size, values, resolution );
+    }
+    return util::LosslessCodec::Decode( stream, brick.size, values, nvalues );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads the values in the region.
+ *  @param  min_index [in] min. node index of the region (inclusive)
+ *  @param  max_index [in] max. node index of the region (inclusive)
+ *  @param  values [out] pointer to the values (in the order of x, y and z in the region)
+ *  @return true if the region is read successfully
+ *
+ *  Only the bricks overlapping with the region are decompressed in parallel.
+ */
+/*===========================================================================*/
+bool BrickedVolumeFile::readRegion( const kvs::Vec3ui& min_index, const kvs::Vec3ui& max_index, kvs::Real32* values ) const
+{
+    for ( size_t axis = 0; axis < 3; axis++ )
+    {
+        if ( min_index[axis] > max_index[axis] || max_index[axis] >= m_resolution[axis] )
+        {
+            kvsMessageError("Invalid region.");
+            return false;
+        }
+    }
+
+    const size_t region_dimx = max_index.x() - min_index.x() + 1;
+    const size_t region_dimy = max_index.y() - min_index.y() + 1;
+
+    std::vector<size_t> indices;
+    for ( size_t bk = min_index.z() / m_brick_size; bk <= max_index.z() / m_brick_size; bk++ )
+    {
+        for ( size_t bj = min_index.y() / m_brick_size; bj <= max_index.y() / m_brick_size; bj++ )
+        {
+            for ( size_t bi = min_index.x() / m_brick_size; bi <= max_index.x() / m_brick_size; bi++ )
+            {
+                indices.push_back( this->brickIndex( bi, bj, bk ) );
+            }
+        }
+    }
+
+    bool succeeded = true;
+    const kvs::Int64 end = static_cast<kvs::Int64>( indices.size() );
+    #pragma omp parallel for schedule(dynamic)
+    for ( kvs::Int64 n = 0; n < end; n++ )
+    {
+        kvs::Vec3ui bmin, bmax;
+        this->brickRange( indices[n], &bmin, &bmax );
+        const size_t bdimx = bmax.x() - bmin.x() + 1;
+        const size_t bdimy = bmax.y() - bmin.y() + 1;
+        const size_t bdimz = bmax.z() - bmin.z() + 1;
+
+        std::vector<kvs::Real32> brick( bdimx * bdimy * bdimz );
+        if ( !this->readBrick( indices[n], &brick[0] ) )
+        {
+            #pragma omp critical
+            {
+                succeeded = false;
+            }
+            continue;
+        }
+
+        // Copy the intersection of the brick and the region.
+        const size_t imin = kvs::Math::Max( bmin.x(), min_index.x() );
+        const size_t jmin = kvs::Math::Max( bmin.y(), min_index.y() );
+        const size_t kmin = kvs::Math::Max( bmin.z(), min_index.z() );
+        const size_t imax = kvs::Math::Min( bmax.x(), max_index.x() );
+        const size_t jmax = kvs::Math::Min( bmax.y(), max_index.y() );
+        const size_t kmax = kvs::Math::Min( bmax.z(), max_index.z() );
+        for ( size_t k = kmin; k <= kmax; k++ )
+        {
+            for ( size_t j = jmin; j <= jmax; j++ )
+            {
+                const kvs::Real32* src = &brick[0] + ( ( k - bmin.z() ) * bdimy + ( j - bmin.y() ) ) * bdimx + ( imin - bmin.x() );
+                kvs::Real32* dst = values + ( ( k - min_index.z() ) * region_dimy + ( j - min_index.y() ) ) * region_dimx + ( imin - min_index.x() );
+                std::memcpy( dst, src, ( imax - imin + 1 ) * sizeof( kvs::Real32 ) );
+            }
+        }
+    }
+
+    if ( !succeeded ) kvsMessageError("Cannot decompress the bricks.");
+    return succeeded;
+}
+
+} // end of namespace util
+
+} // end of namespace kvsoceanvis
@@ -0,0 +1,150 @@
+/*****************************************************************************/
+/**
+ *  @file   BrickedVolumeFile.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__UTIL__BRICKED_VOLUME_FILE_H_INCLUDE
+#define KVSOCEANVIS__UTIL__BRICKED_VOLUME_FILE_H_INCLUDE
+
+#include <string>
+#include <vector>
+#include <kvs/Type>
+#include <kvs/Vector3>
+#include <kvs/ValueArray>
+#include <kvs/StructuredVolumeObject>
+#include "MappedFile.h"
+
+
+namespace kvsoceanvis
+{
+
+namespace util
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Bricked and compressed scalar volume file.
+ *
+ *  The values of the scalar volume are divided into the cubic bricks (32^3
+ *  by default), and each brick is compressed by util::LosslessCodec, or by
+ *  util::ErrorBoundedCodec within the absolute error tolerance for archiving
+ *  the time series. The file has the resolution, codec, tolerance, undefined
+ *  value, min/max values, coordinates of the rectilinear grid (optional) and
+ *  the table of the bricks (offset, size, number of the undefined values and
+ *  min/max values of each brick) in the header, so that the bricks are read
+ *  from the memory-mapped file and decompressed independently. The numbers
+ *  are stored in little endian.
+ *
+ *  The values of the brick are stored in the order of x, y and z within the
+ *  brick, and the bricks on the boundary have the remaining resolution.
+ */
+/*===========================================================================*/
+class BrickedVolumeFile
+{
+public:
+
+    enum Codec
+    {
+        Lossless = 0, ///< util::LosslessCodec
+        ErrorBounded = 1 ///< util::ErrorBoundedCodec
+    };
+
+    struct Brick
+    {
+        kvs::UInt64 offset; ///< offset of the compressed values in the file
+        kvs::UInt32 size; ///< size of the compressed values in bytes
+        kvs::UInt32 undef_count; ///< number of the undefined values
+        kvs::Real32 min_value; ///< min. value in disregard for the undefined values
+        kvs::Real32 max_value; ///< max. value in disregard for the undefined values
+    };
+
+private:
+
+    util::MappedFile m_file; ///< memory-mapped file
+    kvs::Vec3ui m_resolution; ///< resolution of the volume
+    size_t m_brick_size; ///< number of the nodes along an edge of the brick
+    kvs::Vec3ui m_brick_resolution; ///< number of the bricks along the axes
+    Codec m_codec; ///< codec of the bricks
+    kvs::Real32 m_tolerance; ///< absolute error tolerance (ErrorBounded only)
+    kvs::Real32 m_undef_value; ///< undefined value
+    kvs::Real32 m_min_value; ///< min. value in disregard for the undefined values
+    kvs::Real32 m_max_value; ///< max. value in disregard for the undefined values
+    kvs::ValueArray<kvs::Real32> m_coords; ///< coordinates {x0,...,xi,y0,...,yj,z0,...,zk}
+    std::vector<Brick> m_bricks; ///< table of the bricks
+
+public:
+
+    static bool Write(
+        const std::string& filename,
+        const kvs::StructuredVolumeObject* volume,
+        const kvs::Real32 undef_value,
+        const size_t brick_size = 32,
+        const kvs::Real32 tolerance = 0.0f );
+
+    static bool Write(
+        const std::string& filename,
+        const kvs::ValueArray<kvs::Real32>& values,
+        const kvs::Vec3ui& resolution,
+        const kvs::Real32 undef_value,
+        const size_t brick_size,
+        const kvs::Real32 tolerance = 0.0f );
+
+public:
+
+    BrickedVolumeFile();
+    explicit BrickedVolumeFile( const std::string& filename );
+
+public:
+
+    bool open( const std::string& filename );
+    void close();
+    bool isOpen() const;
+
+    const kvs::Vec3ui& resolution() const;
+    size_t brickSize() const;
+    const kvs::Vec3ui& brickResolution() const;
+    size_t numberOfBricks() const;
+    Codec codec() const;
+    kvs::Real32 tolerance() const;
+    kvs::Real32 undefValue() const;
+    kvs::Real32 minValue() const;
+    kvs::Real32 maxValue() const;
+    const kvs::ValueArray<kvs::Real32>& coords() const;
+
+    size_t brickIndex( const size_t bi, const size_t bj, const size_t bk ) const;
+    const Brick& brick( const size_t index ) const;
+    void brickRange( const size_t index, kvs::Vec3ui* min_index, kvs::Vec3ui* max_index ) const;
+    std::vector<size_t> activeBricks( const kvs::Real32 value ) const;
+
+    bool readBrick( const size_t index, kvs::Real32* values ) const;
+    bool readRegion( const kvs::Vec3ui& min_index, const kvs::Vec3ui& max_index, kvs::Real32* values ) const;
+
+private:
+
+    static bool write(
+        const std::string& filename,
+        const kvs::ValueArray<kvs::Real32>& values,
+        const kvs::Vec3ui& resolution,
+        const kvs::ValueArray<kvs::Real32>& coords,
+        const kvs::Real32 undef_value,
+        const size_t brick_size,
+        const kvs::Real32 tolerance );
+
+    BrickedVolumeFile( const BrickedVolumeFile& );
+    BrickedVolumeFile& operator =( const BrickedVolumeFile& );
+};
+
+} // end of namespace util
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__UTIL__BRICKED_VOLUME_FILE_H_INCLUDE
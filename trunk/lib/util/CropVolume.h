@@ -18,6 +18,7 @@
 #include <kvs/StructuredVolumeObject>
 #include <kvs/FilterBase>
 #include <kvs/Module>
+#include "VolumeView.h"
 
 
 namespace kvsoceanvis
@@ -45,6 +46,11 @@ public:
         const kvs::Vector3f min_range,
         const kvs::Vector3f max_range );
 
+    CropVolume(
+        const util::VolumeView& view,
+        const kvs::Vector3f min_range,
+        const kvs::Vector3f max_range );
+
     SuperClass* exec( const kvs::ObjectBase* object );
 };
 
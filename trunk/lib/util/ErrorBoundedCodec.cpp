@@ -0,0 +1,559 @@
+/*****************************************************************************/
+/**
+ *  @file   ErrorBoundedCodec.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "ErrorBoundedCodec.h"
+#include <cmath>
+#include <cstring>
+
+
+namespace
+{
+
+const kvs::UInt8 Version = 1; // version of the encoded stream
+const size_t HeaderSize = 17; // version, tolerance, undef, number of literals, coded size
+const double MaxQuantum = 1073741824.0; // max. magnitude of the quantized residual (2^30)
+
+// Quantization codes.
+const kvs::UInt32 UndefCode = 0; // undefined value
+const kvs::UInt32 LiteralCode = 1; // value stored exactly
+const kvs::UInt32 QuantumCode = 2; // zigzag-encoded residual + 2
+
+// Adaptive bit models of the range coder.
+const int ProbabilityBits = 11; // precision of the probability
+const int MoveBits = 5; // adaptation speed of the probability
+const size_t MaxExponent = 31; // max. exponent of the Exp-Golomb binarization
+const size_t NumberOfContexts = 16; // contexts given by the exponent of the previous code
+
+inline void Put32( const kvs::UInt32 value, std::vector<kvs::UInt8>* stream )
+{
+    stream->push_back( static_cast<kvs::UInt8>( value ) );
+    stream->push_back( static_cast<kvs::UInt8>( value >> 8 ) );
+    stream->push_back( static_cast<kvs::UInt8>( value >> 16 ) );
+    stream->push_back( static_cast<kvs::UInt8>( value >> 24 ) );
+}
+
+inline kvs::UInt32 Get32( const kvs::UInt8* p )
+{
+    return kvs::UInt32( p[0] ) | ( kvs::UInt32( p[1] ) << 8 ) | ( kvs::UInt32( p[2] ) << 16 ) | ( kvs::UInt32( p[3] ) << 24 );
+}
+
+inline void PutReal32( const kvs::Real32 value, std::vector<kvs::UInt8>* stream )
+{
+    kvs::UInt32 bits;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    ::Put32( bits, stream );
+}
+
+inline kvs::Real32 GetReal32( const kvs::UInt8* p )
+{
+    const kvs::UInt32 bits = ::Get32( p );
+    kvs::Real32 value;
+    std::memcpy( &value, &bits, sizeof( value ) );
+    return value;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the value is defined (finite and not undefined).
+ *  @param  value [in] value
+ *  @param  undef_value [in] undefined value
+ *  @return true if the value can be used for the prediction
+ */
+/*===========================================================================*/
+inline bool Defined( const kvs::Real32 value, const kvs::Real32 undef_value )
+{
+    return value != undef_value && value - value == 0.0f;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Predicts the value from the decoded neighbors.
+ *  @param  r [in] pointer to the decoded values
+ *  @param  i [in] index along the x-axis
+ *  @param  j [in] index along the y-axis
+ *  @param  k [in] index along the z-axis
+ *  @param  nx [in] number of the values along the x-axis
+ *  @param  nxy [in] number of the values on the xy-plane
+ *  @param  undef_value [in] undefined value
+ *  @param  last [in] last defined value (used without the neighbors)
+ *  @return predicted value
+ */
+/*===========================================================================*/
+inline double Predict(
+    const kvs::Real32* r,
+    const size_t i,
+    const size_t j,
+    const size_t k,
+    const size_t nx,
+    const size_t nxy,
+    const kvs::Real32 undef_value,
+    const kvs::Real32 last )
+{
+    const size_t index = i + j * nx + k * nxy;
+    const bool x = i > 0 && ::Defined( r[ index - 1 ], undef_value );
+    const bool y = j > 0 && ::Defined( r[ index - nx ], undef_value );
+    const bool z = k > 0 && ::Defined( r[ index - nxy ], undef_value );
+    const bool xy = x && y && ::Defined( r[ index - 1 - nx ], undef_value );
+    if ( xy && z &&
+         ::Defined( r[ index - 1 - nxy ], undef_value ) &&
+         ::Defined( r[ index - nx - nxy ], undef_value ) &&
+         ::Defined( r[ index - 1 - nx - nxy ], undef_value ) )
+    {
+        // 3D Lorenzo predictor.
+        return double( r[ index - 1 ] ) + double( r[ index - nx ] ) + double( r[ index - nxy ] )
+            - double( r[ index - 1 - nx ] ) - double( r[ index - 1 - nxy ] ) - double( r[ index - nx - nxy ] )
+            + double( r[ index - 1 - nx - nxy ] );
+    }
+    if ( xy )
+    {
+        // 2D Lorenzo predictor on the xy-plane.
+        return double( r[ index - 1 ] ) + double( r[ index - nx ] ) - double( r[ index - 1 - nx ] );
+    }
+    if ( x ) return r[ index - 1 ];
+    if ( y ) return r[ index - nx ];
+    if ( z ) return r[ index - nxy ];
+    return last;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Adaptive bit models of the quantization codes.
+ */
+/*===========================================================================*/
+struct Model
+{
+    kvs::UInt16 unary[ NumberOfContexts ][ MaxExponent + 1 ]; ///< models of the exponent
+    kvs::UInt16 mantissa[ MaxExponent + 1 ][ MaxExponent ]; ///< models of the mantissa bits
+
+    Model()
+    {
+        const kvs::UInt16 half = kvs::UInt16( 1 << ( ProbabilityBits - 1 ) );
+        for ( size_t i = 0; i < NumberOfContexts; i++ )
+            for ( size_t j = 0; j <= MaxExponent; j++ ) unary[i][j] = half;
+        for ( size_t i = 0; i <= MaxExponent; i++ )
+            for ( size_t j = 0; j < MaxExponent; j++ ) mantissa[i][j] = half;
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Binary range encoder with the adaptive probabilities.
+ */
+/*===========================================================================*/
+class RangeEncoder
+{
+private:
+
+    kvs::UInt64 m_low; ///< lower bound of the range
+    kvs::UInt32 m_range; ///< width of the range
+    kvs::UInt8 m_cache; ///< byte pending for the carry
+    kvs::UInt64 m_cache_size; ///< number of the pending bytes
+    std::vector<kvs::UInt8>* m_stream; ///< output stream
+
+public:
+
+    RangeEncoder( std::vector<kvs::UInt8>* stream ):
+        m_low( 0 ),
+        m_range( 0xFFFFFFFF ),
+        m_cache( 0 ),
+        m_cache_size( 1 ),
+        m_stream( stream ) {}
+
+    void encode( kvs::UInt16& probability, const kvs::UInt32 bit )
+    {
+        const kvs::UInt32 bound = ( m_range >> ProbabilityBits ) * probability;
+        if ( bit == 0 )
+        {
+            m_range = bound;
+            probability = kvs::UInt16( probability + ( ( ( 1 << ProbabilityBits ) - probability ) >> MoveBits ) );
+        }
+        else
+        {
+            m_low += bound;
+            m_range -= bound;
+            probability = kvs::UInt16( probability - ( probability >> MoveBits ) );
+        }
+        while ( m_range < ( 1u << 24 ) )
+        {
+            m_range <<= 8;
+            this->shift_low();
+        }
+    }
+
+    void flush()
+    {
+        for ( int i = 0; i < 5; i++ ) this->shift_low();
+    }
+
+private:
+
+    void shift_low()
+    {
+        if ( kvs::UInt32( m_low ) < 0xFF000000u || ( m_low >> 32 ) != 0 )
+        {
+            const kvs::UInt8 carry = kvs::UInt8( m_low >> 32 );
+            kvs::UInt8 byte = m_cache;
+            do
+            {
+                m_stream->push_back( kvs::UInt8( byte + carry ) );
+                byte = 0xFF;
+            }
+            while ( --m_cache_size != 0 );
+            m_cache = kvs::UInt8( kvs::UInt32( m_low ) >> 24 );
+        }
+        m_cache_size++;
+        m_low = ( m_low & 0x00FFFFFF ) << 8;
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Binary range decoder with the adaptive probabilities.
+ */
+/*===========================================================================*/
+class RangeDecoder
+{
+private:
+
+    const kvs::UInt8* m_p; ///< current position of the input stream
+    const kvs::UInt8* m_end; ///< end of the input stream
+    kvs::UInt32 m_range; ///< width of the range
+    kvs::UInt32 m_code; ///< code value within the range
+    bool m_overrun; ///< true if the decoder has read beyond the end
+
+public:
+
+    RangeDecoder( const kvs::UInt8* p, const kvs::UInt8* end ):
+        m_p( p ),
+        m_end( end ),
+        m_range( 0xFFFFFFFF ),
+        m_code( 0 ),
+        m_overrun( false )
+    {
+        for ( int i = 0; i < 5; i++ ) m_code = ( m_code << 8 ) | this->next();
+    }
+
+    bool isValid() const
+    {
+        return !m_overrun;
+    }
+
+    kvs::UInt32 decode( kvs::UInt16& probability )
+    {
+        kvs::UInt32 bit = 0;
+        const kvs::UInt32 bound = ( m_range >> ProbabilityBits ) * probability;
+        if ( m_code < bound )
+        {
+            m_range = bound;
+            probability = kvs::UInt16( probability + ( ( ( 1 << ProbabilityBits ) - probability ) >> MoveBits ) );
+        }
+        else
+        {
+            m_code -= bound;
+            m_range -= bound;
+            probability = kvs::UInt16( probability - ( probability >> MoveBits ) );
+            bit = 1;
+        }
+        while ( m_range < ( 1u << 24 ) )
+        {
+            m_range <<= 8;
+            m_code = ( m_code << 8 ) | this->next();
+        }
+        return bit;
+    }
+
+private:
+
+    kvs::UInt8 next()
+    {
+        if ( m_p < m_end ) return *(m_p++);
+        m_overrun = true;
+        return 0;
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Encodes the quantization code (Exp-Golomb binarization of code + 1).
+ *  @param  encoder [in/out] range encoder
+ *  @param  model [in/out] bit models
+ *  @param  context [in/out] exponent of the previous code
+ *  @param  code [in] quantization code
+ */
+/*===========================================================================*/
+void EncodeCode( RangeEncoder& encoder, Model& model, size_t& context, const kvs::UInt32 code )
+{
+    const kvs::UInt64 value = kvs::UInt64( code ) + 1;
+    size_t exponent = 0;
+    while ( ( value >> ( exponent + 1 ) ) != 0 ) exponent++;
+
+    for ( size_t i = 0; i < exponent; i++ ) encoder.encode( model.unary[ context ][ i ], 1 );
+    encoder.encode( model.unary[ context ][ exponent ], 0 );
+    for ( size_t i = exponent; i > 0; i-- )
+    {
+        encoder.encode( model.mantissa[ exponent ][ i - 1 ], kvs::UInt32( value >> ( i - 1 ) ) & 1 );
+    }
+
+    context = exponent < NumberOfContexts ? exponent : NumberOfContexts - 1;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Decodes the quantization code.
+ *  @param  decoder [in/out] range decoder
+ *  @param  model [in/out] bit models
+ *  @param  context [in/out] exponent of the previous code
+ *  @param  code [out] quantization code
+ *  @return true if the code is decoded successfully
+ */
+/*===========================================================================*/
+bool DecodeCode( RangeDecoder& decoder, Model& model, size_t& context, kvs::UInt32* code )
+{
+    size_t exponent = 0;
+    while ( decoder.decode( model.unary[ context ][ exponent ] ) )
+    {
+        if ( ++exponent > MaxExponent ) return false;
+    }
+
+    kvs::UInt64 value = 1;
+    for ( size_t i = exponent; i > 0; i-- )
+    {
+        value = ( value << 1 ) | decoder.decode( model.mantissa[ exponent ][ i - 1 ] );
+    }
+
+    *code = kvs::UInt32( value - 1 );
+    context = exponent < NumberOfContexts ? exponent : NumberOfContexts - 1;
+    return true;
+}
+
+} // end of namespace
+
+
+namespace kvsoceanvis
+{
+
+namespace util
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Encodes the values of the block.
+ *  @param  values [in] pointer to the values (x-fastest order)
+ *  @param  resolution [in] resolution of the block
+ *  @param  tolerance [in] absolute error tolerance (0: all values are stored exactly)
+ *  @param  undef_value [in] undefined value (stored exactly)
+ *  @param  stream [out] encoded stream (appended)
+ */
+/*===========================================================================*/
+void ErrorBoundedCodec::Encode(
+    const kvs::Real32* values,
+    const kvs::Vec3ui& resolution,
+    const kvs::Real32 tolerance,
+    const kvs::Real32 undef_value,
+    std::vector<kvs::UInt8>* stream )
+{
+    const size_t nx = resolution.x();
+    const size_t ny = resolution.y();
+    const size_t nz = resolution.z();
+    const size_t nxy = nx * ny;
+    const double step = 2.0 * tolerance;
+
+    std::vector<kvs::Real32> decoded( nxy * nz ); // values reconstructed by the decoder
+    std::vector<kvs::UInt8> literals;
+    std::vector<kvs::UInt8> coded;
+    ::RangeEncoder encoder( &coded );
+    ::Model model;
+    size_t context = 0;
+    kvs::Real32 last = 0.0f;
+    kvs::UInt32 nliterals = 0;
+
+    size_t index = 0;
+    for ( size_t k = 0; k < nz; k++ )
+    {
+        for ( size_t j = 0; j < ny; j++ )
+        {
+            for ( size_t i = 0; i < nx; i++, index++ )
+            {
+                const kvs::Real32 value = values[ index ];
+                if ( value == undef_value )
+                {
+                    decoded[ index ] = value;
+                    ::EncodeCode( encoder, model, context, ::UndefCode );
+                    continue;
+                }
+
+                if ( step > 0.0 && ::Defined( value, undef_value ) )
+                {
+                    const double predicted = ::Predict( &decoded[0], i, j, k, nx, nxy, undef_value, last );
+                    const double quantum = std::floor( ( value - predicted ) / step + 0.5 );
+                    if ( std::fabs( quantum ) <= ::MaxQuantum )
+                    {
+                        // The decoded value is checked against the tolerance
+                        // since it is rounded to the float.
+                        const kvs::Real32 result = kvs::Real32( predicted + quantum * step );
+                        if ( ::Defined( result, undef_value ) &&
+                             std::fabs( double( result ) - double( value ) ) <= double( tolerance ) )
+                        {
+                            const kvs::Int64 q = kvs::Int64( quantum );
+                            const kvs::UInt32 zigzag = kvs::UInt32( q >= 0 ? 2 * q : -2 * q - 1 );
+                            decoded[ index ] = result;
+                            last = result;
+                            ::EncodeCode( encoder, model, context, zigzag + ::QuantumCode );
+                            continue;
+                        }
+                    }
+                }
+
+                // Unpredictable values are stored exactly.
+                decoded[ index ] = value;
+                if ( ::Defined( value, undef_value ) ) last = value;
+                ::PutReal32( value, &literals );
+                nliterals++;
+                ::EncodeCode( encoder, model, context, ::LiteralCode );
+            }
+        }
+    }
+    encoder.flush();
+
+    stream->push_back( ::Version );
+    ::PutReal32( tolerance, stream );
+    ::PutReal32( undef_value, stream );
+    ::Put32( nliterals, stream );
+    ::Put32( static_cast<kvs::UInt32>( coded.size() ), stream );
+    stream->insert( stream->end(), coded.begin(), coded.end() );
+    stream->insert( stream->end(), literals.begin(), literals.end() );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Encodes the values of the one-dimensional block (e.g. table column).
+ *  @param  values [in] pointer to the values
+ *  @param  nvalues [in] number of the values
+ *  @param  tolerance [in] absolute error tolerance (0: all values are stored exactly)
+ *  @param  undef_value [in] undefined value (stored exactly)
+ *  @param  stream [out] encoded stream (appended)
+ */
+/*===========================================================================*/
+void ErrorBoundedCodec::Encode(
+    const kvs::Real32* values,
+    const size_t nvalues,
+    const kvs::Real32 tolerance,
+    const kvs::Real32 undef_value,
+    std::vector<kvs::UInt8>* stream )
+{
+    const kvs::Vec3ui resolution( static_cast<unsigned int>( nvalues ), 1, 1 );
+    ErrorBoundedCodec::Encode( values, resolution, tolerance, undef_value, stream );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Decodes the values of the block.
+ *  @param  stream [in] pointer to the encoded stream
+ *  @param  size [in] size of the encoded stream in bytes
+ *  @param  values [out] pointer to the decoded values
+ *  @param  resolution [in] resolution of the block
+ *  @return true if the stream is decoded successfully
+ */
+/*===========================================================================*/
+bool ErrorBoundedCodec::Decode(
+    const kvs::UInt8* stream,
+    const size_t size,
+    kvs::Real32* values,
+    const kvs::Vec3ui& resolution )
+{
+    if ( size < ::HeaderSize || stream[0] != ::Version ) return false;
+
+    const kvs::Real32 tolerance = ::GetReal32( stream + 1 );
+    const kvs::Real32 undef_value = ::GetReal32( stream + 5 );
+    const size_t nliterals = ::Get32( stream + 9 );
+    const size_t coded_size = ::Get32( stream + 13 );
+    if ( coded_size > size - ::HeaderSize ) return false;
+    if ( nliterals > ( size - ::HeaderSize - coded_size ) / 4 ) return false;
+    if ( ::HeaderSize + coded_size + nliterals * 4 != size ) return false;
+
+    const size_t nx = resolution.x();
+    const size_t ny = resolution.y();
+    const size_t nz = resolution.z();
+    const size_t nxy = nx * ny;
+    const double step = 2.0 * tolerance;
+
+    const kvs::UInt8* coded = stream + ::HeaderSize;
+    const kvs::UInt8* literals = coded + coded_size;
+    ::RangeDecoder decoder( coded, coded + coded_size );
+    ::Model model;
+    size_t context = 0;
+    kvs::Real32 last = 0.0f;
+    size_t literal_index = 0;
+
+    size_t index = 0;
+    for ( size_t k = 0; k < nz; k++ )
+    {
+        for ( size_t j = 0; j < ny; j++ )
+        {
+            for ( size_t i = 0; i < nx; i++, index++ )
+            {
+                kvs::UInt32 code = 0;
+                if ( !::DecodeCode( decoder, model, context, &code ) ) return false;
+
+                if ( code == ::UndefCode )
+                {
+                    values[ index ] = undef_value;
+                }
+                else if ( code == ::LiteralCode )
+                {
+                    if ( literal_index >= nliterals ) return false;
+                    const kvs::Real32 value = ::GetReal32( literals + literal_index * 4 );
+                    literal_index++;
+                    values[ index ] = value;
+                    if ( ::Defined( value, undef_value ) ) last = value;
+                }
+                else
+                {
+                    const kvs::UInt32 zigzag = code - ::QuantumCode;
+                    const kvs::Int64 q = ( zigzag & 1 ) ? -kvs::Int64( zigzag >> 1 ) - 1 : kvs::Int64( zigzag >> 1 );
+                    const double predicted = ::Predict( values, i, j, k, nx, nxy, undef_value, last );
+                    const kvs::Real32 result = kvs::Real32( predicted + double( q ) * step );
+                    values[ index ] = result;
+                    last = result;
+                }
+            }
+        }
+    }
+
+    return decoder.isValid() && literal_index == nliterals;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Decodes the values of the one-dimensional block.
+ *  @param  stream [in] pointer to the encoded stream
+ *  @param  size [in] size of the encoded stream in bytes
+ *  @param  values [out] pointer to the decoded values
+ *  @param  nvalues [in] number of the values
+ *  @return true if the stream is decoded successfully
+ */
+/*===========================================================================*/
+bool ErrorBoundedCodec::Decode(
+    const kvs::UInt8* stream,
+    const size_t size,
+    kvs::Real32* values,
+    const size_t nvalues )
+{
+    const kvs::Vec3ui resolution( static_cast<unsigned int>( nvalues ), 1, 1 );
+    return ErrorBoundedCodec::Decode( stream, size, values, resolution );
+}
+
+} // end of namespace util
+
+} // end of namespace kvsoceanvis
@@ -0,0 +1,83 @@
+/*****************************************************************************/
+/**
+ *  @file   ErrorBoundedCodec.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__UTIL__ERROR_BOUNDED_CODEC_H_INCLUDE
+#define KVSOCEANVIS__UTIL__ERROR_BOUNDED_CODEC_H_INCLUDE
+
+#include <vector>
+#include <cstddef>
+#include <kvs/Type>
+#include <kvs/Vector3>
+
+
+namespace kvsoceanvis
+{
+
+namespace util
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Error-bounded lossy codec for the float values.
+ *
+ *  Each value of the block (x-fastest order) is predicted from the decoded
+ *  neighbors by the Lorenzo predictor (3D, 2D or the previous value where
+ *  the neighbors are defined), and the residual is quantized with the bin
+ *  width of 2 * tolerance, so that the absolute error of the decoded value
+ *  is not greater than the tolerance. The undefined values (e.g. the land
+ *  cells) and the values that cannot be quantized within the tolerance are
+ *  stored exactly. The quantization codes are compressed by the adaptive
+ *  binary range coder (Exp-Golomb binarization with adaptive bit models).
+ *
+ *  The encoded stream has the tolerance and the undefined value, and the
+ *  blocks are encoded and decoded independently, so that they can be
+ *  processed in parallel by the caller.
+ */
+/*===========================================================================*/
+class ErrorBoundedCodec
+{
+public:
+
+    static void Encode(
+        const kvs::Real32* values,
+        const kvs::Vec3ui& resolution,
+        const kvs::Real32 tolerance,
+        const kvs::Real32 undef_value,
+        std::vector<kvs::UInt8>* stream );
+
+    static void Encode(
+        const kvs::Real32* values,
+        const size_t nvalues,
+        const kvs::Real32 tolerance,
+        const kvs::Real32 undef_value,
+        std::vector<kvs::UInt8>* stream );
+
+    static bool Decode(
+        const kvs::UInt8* stream,
+        const size_t size,
+        kvs::Real32* values,
+        const kvs::Vec3ui& resolution );
+
+    static bool Decode(
+        const kvs::UInt8* stream,
+        const size_t size,
+        kvs::Real32* values,
+        const size_t nvalues );
+};
+
+} // end of namespace util
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__UTIL__ERROR_BOUNDED_CODEC_H_INCLUDE
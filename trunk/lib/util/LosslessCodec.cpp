@@ -0,0 +1,317 @@
+/*****************************************************************************/
+/**
+ *  @file   LosslessCodec.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "LosslessCodec.h"
+#include <cstring>
+
+
+namespace
+{
+
+const size_t MinMatch = 4; // min. length of the match
+const size_t MaxOffset = 65535; // max. offset of the match (window size)
+const size_t HashBits = 14; // number of bits of the hash table index
+
+// Modes of the encoded stream.
+const kvs::UInt8 Stored = 0; // shuffled planes are stored
+const kvs::UInt8 Compressed = 1; // shuffled planes are compressed
+
+inline kvs::UInt32 Read32( const kvs::UInt8* p )
+{
+    return kvs::UInt32( p[0] ) | ( kvs::UInt32( p[1] ) << 8 ) | ( kvs::UInt32( p[2] ) << 16 ) | ( kvs::UInt32( p[3] ) << 24 );
+}
+
+inline kvs::UInt32 Hash( const kvs::UInt32 sequence )
+{
+    return ( sequence * 2654435761u ) >> ( 32 - HashBits );
+}
+
+inline kvs::UInt32 Bits( const kvs::Real32 value )
+{
+    kvs::UInt32 bits;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    return bits;
+}
+
+inline kvs::Real32 Value( const kvs::UInt32 bits )
+{
+    kvs::Real32 value;
+    std::memcpy( &value, &bits, sizeof( value ) );
+    return value;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes the length exceeding the nibble as the 255-terminated bytes.
+ *  @param  length [in] length (15 or more)
+ *  @param  dst [out] pointer to the stream
+ */
+/*===========================================================================*/
+void WriteLength( size_t length, std::vector<kvs::UInt8>* dst )
+{
+    length -= 15;
+    while ( length >= 255 ) { dst->push_back( 255 ); length -= 255; }
+    dst->push_back( static_cast<kvs::UInt8>( length ) );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads the length exceeding the nibble.
+ *  @param  p [in/out] pointer to the stream
+ *  @param  end [in] end of the stream
+ *  @param  length [in/out] length (15 given by the nibble)
+ *  @return true if the length is read successfully
+ */
+/*===========================================================================*/
+bool ReadLength( const kvs::UInt8*& p, const kvs::UInt8* end, size_t& length )
+{
+    kvs::UInt8 byte = 255;
+    while ( byte == 255 )
+    {
+        if ( p >= end ) return false;
+        byte = *(p++);
+        length += byte;
+    }
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes a sequence of the literals followed by the match.
+ *  @param  literals [in] pointer to the literals
+ *  @param  nliterals [in] number of the literals
+ *  @param  offset [in] offset of the match (0: no match)
+ *  @param  length [in] length of the match
+ *  @param  dst [out] pointer to the stream
+ */
+/*===========================================================================*/
+void WriteSequence(
+    const kvs::UInt8* literals,
+    const size_t nliterals,
+    const size_t offset,
+    const size_t length,
+    std::vector<kvs::UInt8>* dst )
+{
+    const size_t match = offset > 0 ? length - MinMatch : 0;
+    const kvs::UInt8 token = static_cast<kvs::UInt8>(
+        ( ( nliterals < 15 ? nliterals : 15 ) << 4 ) | ( match < 15 ? match : 15 ) );
+    dst->push_back( token );
+    if ( nliterals >= 15 ) ::WriteLength( nliterals, dst );
+    dst->insert( dst->end(), literals, literals + nliterals );
+
+    if ( offset > 0 )
+    {
+        dst->push_back( static_cast<kvs::UInt8>( offset & 0xff ) );
+        dst->push_back( static_cast<kvs::UInt8>( offset >> 8 ) );
+        if ( match >= 15 ) ::WriteLength( match, dst );
+    }
+}
+
+} // end of namespace
+
+
+namespace kvsoceanvis
+{
+
+namespace util
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Encodes the values.
+ *  @param  values [in] pointer to the values
+ *  @param  nvalues [in] number of the values
+ *  @param  stream [out] encoded stream (appended)
+ */
+/*===========================================================================*/
+void LosslessCodec::Encode( const kvs::Real32* values, const size_t nvalues, std::vector<kvs::UInt8>* stream )
+{
+    // XORed values shuffled into the byte planes.
+    std::vector<kvs::UInt8> planes( nvalues * 4 );
+    kvs::UInt32 previous = 0;
+    for ( size_t i = 0; i < nvalues; i++ )
+    {
+        const kvs::UInt32 bits = ::Bits( values[i] );
+        const kvs::UInt32 x = bits ^ previous;
+        planes[ i ] = static_cast<kvs::UInt8>( x );
+        planes[ i + nvalues ] = static_cast<kvs::UInt8>( x >> 8 );
+        planes[ i + nvalues * 2 ] = static_cast<kvs::UInt8>( x >> 16 );
+        planes[ i + nvalues * 3 ] = static_cast<kvs::UInt8>( x >> 24 );
+        previous = bits;
+    }
+
+    std::vector<kvs::UInt8> compressed;
+    if ( !planes.empty() ) LosslessCodec::CompressBytes( &planes[0], planes.size(), &compressed );
+    if ( !planes.empty() && compressed.size() < planes.size() )
+    {
+        stream->push_back( ::Compressed );
+        stream->insert( stream->end(), compressed.begin(), compressed.end() );
+    }
+    else
+    {
+        stream->push_back( ::Stored );
+        stream->insert( stream->end(), planes.begin(), planes.end() );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Decodes the values.
+ *  @param  stream [in] pointer to the encoded stream
+ *  @param  size [in] size of the encoded stream in bytes
+ *  @param  values [out] pointer to the decoded values
+ *  @param  nvalues [in] number of the values
+ *  @return true if the stream is decoded successfully
+ */
+/*===========================================================================*/
+bool LosslessCodec::Decode( const kvs::UInt8* stream, const size_t size, kvs::Real32* values, const size_t nvalues )
+{
+    if ( size < 1 ) return false;
+
+    std::vector<kvs::UInt8> planes( nvalues * 4 );
+    const kvs::UInt8 mode = stream[0];
+    if ( mode == ::Stored )
+    {
+        if ( size - 1 != planes.size() ) return false;
+        if ( !planes.empty() ) std::memcpy( &planes[0], stream + 1, planes.size() );
+    }
+    else if ( mode == ::Compressed )
+    {
+        if ( planes.empty() ) return false;
+        if ( !LosslessCodec::DecompressBytes( stream + 1, size - 1, &planes[0], planes.size() ) ) return false;
+    }
+    else
+    {
+        return false;
+    }
+
+    kvs::UInt32 previous = 0;
+    for ( size_t i = 0; i < nvalues; i++ )
+    {
+        const kvs::UInt32 x =
+            kvs::UInt32( planes[ i ] ) |
+            ( kvs::UInt32( planes[ i + nvalues ] ) << 8 ) |
+            ( kvs::UInt32( planes[ i + nvalues * 2 ] ) << 16 ) |
+            ( kvs::UInt32( planes[ i + nvalues * 3 ] ) << 24 );
+        previous ^= x;
+        values[i] = ::Value( previous );
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Compresses the bytes with the LZ77 byte coder.
+ *  @param  src [in] pointer to the bytes
+ *  @param  size [in] number of the bytes
+ *  @param  dst [out] compressed bytes (appended)
+ *
+ *  The stream is a series of the sequences, each of which consists of a token
+ *  (numbers of the literals and the matched bytes - 4 in the upper and lower
+ *  nibbles), the extra bytes of the number of the literals, the literals, the
+ *  offset of the match (2 bytes) and the extra bytes of the match length. The
+ *  last sequence has no match.
+ */
+/*===========================================================================*/
+void LosslessCodec::CompressBytes( const kvs::UInt8* src, const size_t size, std::vector<kvs::UInt8>* dst )
+{
+    std::vector<kvs::UInt32> table( size_t(1) << ::HashBits, 0 ); // position + 1
+    size_t anchor = 0;
+    size_t position = 0;
+    while ( position + ::MinMatch <= size )
+    {
+        const kvs::UInt32 sequence = ::Read32( src + position );
+        const kvs::UInt32 hash = ::Hash( sequence );
+        const size_t candidate = table[ hash ];
+        table[ hash ] = static_cast<kvs::UInt32>( position + 1 );
+
+        if ( candidate > 0 &&
+             position - ( candidate - 1 ) <= ::MaxOffset &&
+             ::Read32( src + candidate - 1 ) == sequence )
+        {
+            const size_t match = candidate - 1;
+            size_t length = ::MinMatch;
+            while ( position + length < size && src[ match + length ] == src[ position + length ] ) length++;
+
+            ::WriteSequence( src + anchor, position - anchor, position - match, length, dst );
+            position += length;
+            anchor = position;
+
+            // The hash of the last position in the match is registered for
+            // the following runs.
+            if ( position >= 2 && position - 2 + ::MinMatch <= size )
+            {
+                table[ ::Hash( ::Read32( src + position - 2 ) ) ] = static_cast<kvs::UInt32>( position - 1 );
+            }
+            continue;
+        }
+
+        // The search is accelerated in the incompressible bytes.
+        position += 1 + ( ( position - anchor ) >> 6 );
+    }
+
+    ::WriteSequence( src + anchor, size - anchor, 0, 0, dst );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Decompresses the bytes compressed by CompressBytes().
+ *  @param  src [in] pointer to the compressed bytes
+ *  @param  size [in] number of the compressed bytes
+ *  @param  dst [out] pointer to the decompressed bytes
+ *  @param  dst_size [in] number of the decompressed bytes
+ *  @return true if the bytes are decompressed successfully
+ */
+/*===========================================================================*/
+bool LosslessCodec::DecompressBytes( const kvs::UInt8* src, const size_t size, kvs::UInt8* dst, const size_t dst_size )
+{
+    const kvs::UInt8* p = src;
+    const kvs::UInt8* end = src + size;
+    size_t position = 0;
+    while ( p < end )
+    {
+        const kvs::UInt8 token = *(p++);
+
+        size_t nliterals = token >> 4;
+        if ( nliterals == 15 && !::ReadLength( p, end, nliterals ) ) return false;
+        if ( nliterals > size_t( end - p ) || nliterals > dst_size - position ) return false;
+        std::memcpy( dst + position, p, nliterals );
+        p += nliterals;
+        position += nliterals;
+
+        // The last sequence has no match.
+        if ( p == end ) break;
+
+        if ( end - p < 2 ) return false;
+        const size_t offset = size_t( p[0] ) | ( size_t( p[1] ) << 8 );
+        p += 2;
+        size_t length = token & 0x0f;
+        if ( length == 15 && !::ReadLength( p, end, length ) ) return false;
+        length += ::MinMatch;
+        if ( offset == 0 || offset > position || length > dst_size - position ) return false;
+
+        // The match can overlap the output (runs), so that it is copied byte by byte.
+        const kvs::UInt8* from = dst + position - offset;
+        kvs::UInt8* to = dst + position;
+        for ( size_t i = 0; i < length; i++ ) to[i] = from[i];
+        position += length;
+    }
+
+    return position == dst_size;
+}
+
+} // end of namespace util
+
+} // end of namespace kvsoceanvis
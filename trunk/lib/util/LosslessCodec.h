@@ -0,0 +1,58 @@
+/*****************************************************************************/
+/**
+ *  @file   LosslessCodec.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__UTIL__LOSSLESS_CODEC_H_INCLUDE
+#define KVSOCEANVIS__UTIL__LOSSLESS_CODEC_H_INCLUDE
+
+#include <vector>
+#include <cstddef>
+#include <kvs/Type>
+
+
+namespace kvsoceanvis
+{
+
+namespace util
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Lossless codec for the float values.
+ *
+ *  The bit pattern of each value is XORed with the previous one, and the
+ *  bytes of the XORed values are shuffled into four planes (lowest bytes
+ *  first), so that the sign/exponent bytes of the smooth fields and the runs
+ *  of the undefined values become the runs of the zero bytes. The planes are
+ *  compressed by the LZ77 byte coder (LZ4-like sequences of the literals and
+ *  the matches in the 64KB window), or stored as they are if they cannot be
+ *  compressed. The encoded stream does not depend on the byte order of the
+ *  machine.
+ */
+/*===========================================================================*/
+class LosslessCodec
+{
+public:
+
+    static void Encode( const kvs::Real32* values, const size_t nvalues, std::vector<kvs::UInt8>* stream );
+    static bool Decode( const kvs::UInt8* stream, const size_t size, kvs::Real32* values, const size_t nvalues );
+
+    static void CompressBytes( const kvs::UInt8* src, const size_t size, std::vector<kvs::UInt8>* dst );
+    static bool DecompressBytes( const kvs::UInt8* src, const size_t size, kvs::UInt8* dst, const size_t dst_size );
+};
+
+} // end of namespace util
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__UTIL__LOSSLESS_CODEC_H_INCLUDE
@@ -0,0 +1,274 @@
+/*****************************************************************************/
+/**
+ *  @file   MappedFile.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "MappedFile.h"
+#include <vector>
+#include <cstdlib>
+#include <kvs/Message>
+#if defined( _WIN32 )
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace kvsoceanvis
+{
+
+namespace util
+{
+
+MappedFile::MappedFile():
+    m_data( NULL ),
+    m_size( 0 ),
+    m_mode( MappedFile::ReadOnly ),
+#if defined( _WIN32 )
+    m_file( INVALID_HANDLE_VALUE ),
+    m_mapping( NULL )
+#else
+    m_descriptor( -1 )
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    this->close();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Maps the whole of the existing file.
+ *  @param  filename [in] filename
+ *  @param  mode [in] access mode
+ *  @return true if the file is mapped successfully
+ */
+/*===========================================================================*/
+bool MappedFile::open( const std::string& filename, const AccessMode mode )
+{
+    this->close();
+    m_mode = mode;
+
+#if defined( _WIN32 )
+    const DWORD access = ( mode == ReadWrite ) ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+    m_file = ::CreateFileA( filename.c_str(), access, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if ( m_file == INVALID_HANDLE_VALUE )
+    {
+        kvsMessageError( "Cannot open %s.", filename.c_str() );
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    ::GetFileSizeEx( m_file, &size );
+    return this->map( static_cast<size_t>( size.QuadPart ) );
+#else
+    m_descriptor = ::open( filename.c_str(), ( mode == ReadWrite ) ? O_RDWR : O_RDONLY );
+    if ( m_descriptor < 0 )
+    {
+        kvsMessageError( "Cannot open %s.", filename.c_str() );
+        return false;
+    }
+
+    struct stat status;
+    ::fstat( m_descriptor, &status );
+    return this->map( static_cast<size_t>( status.st_size ) );
+#endif
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Creates (or truncates) the file of the given size and maps it.
+ *  @param  filename [in] filename
+ *  @param  size [in] file size [byte]
+ *  @return true if the file is mapped successfully
+ */
+/*===========================================================================*/
+bool MappedFile::create( const std::string& filename, const size_t size )
+{
+    this->close();
+    m_mode = ReadWrite;
+
+#if defined( _WIN32 )
+    m_file = ::CreateFileA( filename.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+    if ( m_file == INVALID_HANDLE_VALUE )
+    {
+        kvsMessageError( "Cannot create %s.", filename.c_str() );
+        return false;
+    }
+#else
+    m_descriptor = ::open( filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+    if ( m_descriptor < 0 )
+    {
+        kvsMessageError( "Cannot create %s.", filename.c_str() );
+        return false;
+    }
+
+    if ( ::ftruncate( m_descriptor, static_cast<off_t>( size ) ) != 0 )
+    {
+        kvsMessageError( "Cannot resize %s.", filename.c_str() );
+        this->close();
+        return false;
+    }
+#endif
+
+    return this->map( size );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Creates a temporary file of the given size and maps it.
+ *  @param  size [in] file size [byte]
+ *  @return true if the file is mapped successfully
+ *
+ *  The temporary file is created in the directory given by TMPDIR (TEMP on
+ *  Windows) and is removed automatically when it is closed.
+ */
+/*===========================================================================*/
+bool MappedFile::createTemporary( const size_t size )
+{
+    this->close();
+    m_mode = ReadWrite;
+
+#if defined( _WIN32 )
+    char path[ MAX_PATH ];
+    char filename[ MAX_PATH ];
+    if ( ::GetTempPathA( MAX_PATH, path ) == 0 || ::GetTempFileNameA( path, "kvs", 0, filename ) == 0 )
+    {
+        kvsMessageError("Cannot create a temporary file.");
+        return false;
+    }
+
+    m_file = ::CreateFileA( filename, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                            FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL );
+    if ( m_file == INVALID_HANDLE_VALUE )
+    {
+        kvsMessageError("Cannot create a temporary file.");
+        return false;
+    }
+#else
+    const char* directory = std::getenv( "TMPDIR" );
+    std::string pattern = std::string( directory ? directory : "/tmp" ) + "/kvsoceanvisXXXXXX";
+    std::vector<char> filename( pattern.begin(), pattern.end() );
+    filename.push_back( '\0' );
+
+    m_descriptor = ::mkstemp( &filename[0] );
+    if ( m_descriptor < 0 )
+    {
+        kvsMessageError( "Cannot create a temporary file %s.", &filename[0] );
+        return false;
+    }
+
+    // The file is removed when the descriptor is closed.
+    ::unlink( &filename[0] );
+
+    if ( ::ftruncate( m_descriptor, static_cast<off_t>( size ) ) != 0 )
+    {
+        kvsMessageError("Cannot resize the temporary file.");
+        this->close();
+        return false;
+    }
+#endif
+
+    return this->map( size );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Unmaps and closes the file.
+ */
+/*===========================================================================*/
+void MappedFile::close()
+{
+#if defined( _WIN32 )
+    if ( m_data ) ::UnmapViewOfFile( m_data );
+    if ( m_mapping ) ::CloseHandle( m_mapping );
+    if ( m_file != INVALID_HANDLE_VALUE ) ::CloseHandle( m_file );
+    m_mapping = NULL;
+    m_file = INVALID_HANDLE_VALUE;
+#else
+    if ( m_data ) ::munmap( m_data, m_size );
+    if ( m_descriptor >= 0 ) ::close( m_descriptor );
+    m_descriptor = -1;
+#endif
+
+    m_data = NULL;
+    m_size = 0;
+}
+
+bool MappedFile::isOpen() const
+{
+#if defined( _WIN32 )
+    return m_file != INVALID_HANDLE_VALUE;
+#else
+    return m_descriptor >= 0;
+#endif
+}
+
+size_t MappedFile::size() const
+{
+    return m_size;
+}
+
+void* MappedFile::data()
+{
+    return m_data;
+}
+
+const void* MappedFile::data() const
+{
+    return m_data;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Maps the opened file.
+ *  @param  size [in] size of the region [byte]
+ *  @return true if the file is mapped successfully
+ */
+/*===========================================================================*/
+bool MappedFile::map( const size_t size )
+{
+    // An empty file is opened without the mapping.
+    m_size = size;
+    if ( size == 0 ) return true;
+
+#if defined( _WIN32 )
+    const DWORD protect = ( m_mode == ReadWrite ) ? PAGE_READWRITE : PAGE_READONLY;
+    const DWORD access = ( m_mode == ReadWrite ) ? FILE_MAP_WRITE : FILE_MAP_READ;
+    const unsigned long long length = size;
+    m_mapping = ::CreateFileMappingA( m_file, NULL, protect, DWORD( length >> 32 ), DWORD( length & 0xffffffff ), NULL );
+    m_data = m_mapping ? ::MapViewOfFile( m_mapping, access, 0, 0, size ) : NULL;
+    if ( !m_data )
+#else
+    const int protect = ( m_mode == ReadWrite ) ? PROT_READ | PROT_WRITE : PROT_READ;
+    m_data = ::mmap( NULL, size, protect, MAP_SHARED, m_descriptor, 0 );
+    if ( m_data == MAP_FAILED )
+#endif
+    {
+        m_data = NULL;
+        kvsMessageError("Cannot map the file.");
+        this->close();
+        return false;
+    }
+
+    return true;
+}
+
+} // end of namespace util
+
+} // end of namespace kvsoceanvis
@@ -0,0 +1,84 @@
+/*****************************************************************************/
+/**
+ *  @file   MappedFile.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__UTIL__MAPPED_FILE_H_INCLUDE
+#define KVSOCEANVIS__UTIL__MAPPED_FILE_H_INCLUDE
+
+#include <string>
+#include <cstddef>
+
+
+namespace kvsoceanvis
+{
+
+namespace util
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Memory-mapped file class.
+ */
+/*===========================================================================*/
+class MappedFile
+{
+public:
+
+    enum AccessMode
+    {
+        ReadOnly,
+        ReadWrite
+    };
+
+private:
+
+    void* m_data; ///< pointer to the mapped region
+    size_t m_size; ///< size of the mapped region [byte]
+    AccessMode m_mode; ///< access mode
+#if defined( _WIN32 )
+    void* m_file; ///< file handle
+    void* m_mapping; ///< file mapping handle
+#else
+    int m_descriptor; ///< file descriptor
+#endif
+
+public:
+
+    MappedFile();
+    ~MappedFile();
+
+public:
+
+    bool open( const std::string& filename, const AccessMode mode = ReadOnly );
+    bool create( const std::string& filename, const size_t size );
+    bool createTemporary( const size_t size );
+    void close();
+
+    bool isOpen() const;
+    size_t size() const;
+    void* data();
+    const void* data() const;
+
+private:
+
+    MappedFile( const MappedFile& );
+    MappedFile& operator =( const MappedFile& );
+
+    bool map( const size_t size );
+};
+
+} // end of namespace util
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__UTIL__MAPPED_FILE_H_INCLUDE
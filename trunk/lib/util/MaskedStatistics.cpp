@@ -0,0 +1,385 @@
+/*****************************************************************************/
+/**
+ *  @file   MaskedStatistics.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "MaskedStatistics.h"
+#include <kvs/Math>
+#include <kvs/Value>
+#if defined( __AVX__ )
+#include <immintrin.h>
+#define KVSOCEANVIS__UTIL__MASKED_STATISTICS_ENABLE_AVX
+#elif defined( __SSE2__ ) || defined( _M_X64 )
+#include <emmintrin.h>
+#define KVSOCEANVIS__UTIL__MASKED_STATISTICS_ENABLE_SSE
+#endif
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Number of values in a chunk processed by a thread.
+ *
+ *  The per-lane counters and partial sums are reduced chunk by chunk, so the
+ *  float counters of the AVX kernel are kept exact.
+ */
+/*===========================================================================*/
+const size_t ChunkSize = 65536;
+
+} // end of namespace
+
+
+namespace kvsoceanvis
+{
+
+namespace util
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new MaskedStatistics class.
+ *  @param  ignore_value [in] undefined value
+ *  @param  lower_bound [in] values not greater than the bound are disregarded
+ */
+/*===========================================================================*/
+MaskedStatistics::MaskedStatistics( const kvs::Real32 ignore_value, const kvs::Real32 lower_bound ):
+    m_ignore_value( ignore_value ),
+    m_lower_bound( lower_bound )
+{
+    this->reset();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets an undefined value.
+ *  @param  ignore_value [in] undefined value
+ */
+/*===========================================================================*/
+void MaskedStatistics::setIgnoreValue( const kvs::Real32 ignore_value )
+{
+    m_ignore_value = ignore_value;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a lower bound of the defined values.
+ *  @param  lower_bound [in] values not greater than the bound are disregarded
+ */
+/*===========================================================================*/
+void MaskedStatistics::setLowerBound( const kvs::Real32 lower_bound )
+{
+    m_lower_bound = lower_bound;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Disables the lower bound, so only the undefined value is disregarded.
+ */
+/*===========================================================================*/
+void MaskedStatistics::disableLowerBound()
+{
+    m_lower_bound = -kvs::Value<kvs::Real32>::Max();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Resets the statistics.
+ */
+/*===========================================================================*/
+void MaskedStatistics::reset()
+{
+    m_count = 0;
+    m_min_value = kvs::Value<kvs::Real32>::Max();
+    m_max_value = kvs::Value<kvs::Real32>::Min();
+    m_sum = 0.0;
+    m_sum_of_squares = 0.0;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Updates the statistics with the given values.
+ *  @param  values [in] pointer to the values
+ *  @param  nvalues [in] number of the values
+ */
+/*===========================================================================*/
+void MaskedStatistics::update( const kvs::Real32* values, const size_t nvalues )
+{
+    this->update_values( values, nvalues, NULL );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Updates the statistics with the given values.
+ *  @param  values [in] value array
+ */
+/*===========================================================================*/
+void MaskedStatistics::update( const kvs::ValueArray<kvs::Real32>& values )
+{
+    this->update( values.data(), values.size() );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Copies the values and updates the statistics with them in one pass.
+ *  @param  values [in] pointer to the values
+ *  @param  nvalues [in] number of the values
+ *  @param  destination [out] pointer to the copied values (not overlapped)
+ */
+/*===========================================================================*/
+void MaskedStatistics::copy( const kvs::Real32* values, const size_t nvalues, kvs::Real32* destination )
+{
+    this->update_values( values, nvalues, destination );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Merges the statistics of the other values.
+ *  @param  other [in] statistics of the other values
+ */
+/*===========================================================================*/
+void MaskedStatistics::merge( const MaskedStatistics& other )
+{
+    m_count += other.m_count;
+    m_min_value = kvs::Math::Min( m_min_value, other.m_min_value );
+    m_max_value = kvs::Math::Max( m_max_value, other.m_max_value );
+    m_sum += other.m_sum;
+    m_sum_of_squares += other.m_sum_of_squares;
+}
+
+size_t MaskedStatistics::count() const
+{
+    return m_count;
+}
+
+kvs::Real32 MaskedStatistics::minValue() const
+{
+    return m_min_value;
+}
+
+kvs::Real32 MaskedStatistics::maxValue() const
+{
+    return m_max_value;
+}
+
+kvs::Real64 MaskedStatistics::sum() const
+{
+    return m_sum;
+}
+
+kvs::Real64 MaskedStatistics::sumOfSquares() const
+{
+    return m_sum_of_squares;
+}
+
+kvs::Real64 MaskedStatistics::mean() const
+{
+    return m_count > 0 ? m_sum / m_count : 0.0;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the population variance of the defined values.
+ *  @return variance (0 if no value is defined)
+ */
+/*===========================================================================*/
+kvs::Real64 MaskedStatistics::variance() const
+{
+    if ( m_count == 0 ) return 0.0;
+
+    const kvs::Real64 mean = m_sum / m_count;
+    return kvs::Math::Max( m_sum_of_squares / m_count - mean * mean, 0.0 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Updates the statistics with the values processed chunk by chunk.
+ *  @param  values [in] pointer to the values
+ *  @param  nvalues [in] number of the values
+ *  @param  destination [out] pointer to the copied values (NULL: not copied)
+ */
+/*===========================================================================*/
+void MaskedStatistics::update_values( const kvs::Real32* values, const size_t nvalues, kvs::Real32* destination )
+{
+    if ( nvalues <= 2 * ::ChunkSize )
+    {
+        this->update_chunk( values, nvalues, destination );
+        return;
+    }
+
+    const kvs::Int64 nchunks = static_cast<kvs::Int64>( ( nvalues + ::ChunkSize - 1 ) / ::ChunkSize );
+    #pragma omp parallel
+    {
+        MaskedStatistics local( m_ignore_value, m_lower_bound );
+
+        #pragma omp for schedule(static)
+        for ( kvs::Int64 c = 0; c < nchunks; c++ )
+        {
+            const size_t begin = static_cast<size_t>( c ) * ::ChunkSize;
+            const size_t end = kvs::Math::Min( begin + ::ChunkSize, nvalues );
+            local.update_chunk( values + begin, end - begin, destination ? destination + begin : NULL );
+        }
+
+        #pragma omp critical
+        {
+            this->merge( local );
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Updates the statistics with the values in a chunk.
+ *  @param  values [in] pointer to the values
+ *  @param  nvalues [in] number of the values
+ *  @param  destination [out] pointer to the copied values (NULL: not copied)
+ *
+ *  The undefined value is compared with the absolute tolerance as same as
+ *  kvs::Math::Equal, and the disregarded lanes are replaced with the neutral
+ *  elements (max/min of float for min/max, zero for the sums).
+ */
+/*===========================================================================*/
+void MaskedStatistics::update_chunk( const kvs::Real32* values, const size_t nvalues, kvs::Real32* destination )
+{
+    const kvs::Real32 ignore_value = m_ignore_value;
+    const kvs::Real32 lower_bound = m_lower_bound;
+    const kvs::Real32 epsilon = kvs::Value<kvs::Real32>::Epsilon();
+    const kvs::Real32 neutral_min = kvs::Value<kvs::Real32>::Max();
+    const kvs::Real32 neutral_max = kvs::Value<kvs::Real32>::Min();
+
+    size_t i = 0;
+    size_t count = 0;
+    kvs::Real32 min_value = m_min_value;
+    kvs::Real32 max_value = m_max_value;
+    kvs::Real64 sum = 0.0;
+    kvs::Real64 sum_of_squares = 0.0;
+
+#if defined( KVSOCEANVIS__UTIL__MASKED_STATISTICS_ENABLE_AVX )
+    if ( nvalues >= 8 )
+    {
+        const __m256 sign = _mm256_set1_ps( -0.0f );
+        const __m256 ignore = _mm256_set1_ps( ignore_value );
+        const __m256 bound = _mm256_set1_ps( lower_bound );
+        const __m256 eps = _mm256_set1_ps( epsilon );
+        const __m256 fmin = _mm256_set1_ps( neutral_min );
+        const __m256 fmax = _mm256_set1_ps( neutral_max );
+        const __m256 one = _mm256_set1_ps( 1.0f );
+        __m256 vmin = fmin;
+        __m256 vmax = fmax;
+        __m256 vcount = _mm256_setzero_ps();
+        __m256d vsum = _mm256_setzero_pd();
+        __m256d vsum2 = _mm256_setzero_pd();
+        for ( ; i + 8 <= nvalues; i += 8 )
+        {
+            const __m256 v = _mm256_loadu_ps( values + i );
+            if ( destination ) { _mm256_storeu_ps( destination + i, v ); }
+            const __m256 diff = _mm256_andnot_ps( sign, _mm256_sub_ps( v, ignore ) );
+            const __m256 undefined = _mm256_cmp_ps( diff, eps, _CMP_LE_OQ );
+            const __m256 mask = _mm256_andnot_ps( undefined, _mm256_cmp_ps( v, bound, _CMP_GT_OQ ) );
+
+            vmin = _mm256_min_ps( vmin, _mm256_blendv_ps( fmin, v, mask ) );
+            vmax = _mm256_max_ps( vmax, _mm256_blendv_ps( fmax, v, mask ) );
+            vcount = _mm256_add_ps( vcount, _mm256_and_ps( mask, one ) );
+
+            const __m256 mv = _mm256_and_ps( mask, v );
+            const __m256d lo = _mm256_cvtps_pd( _mm256_castps256_ps128( mv ) );
+            const __m256d hi = _mm256_cvtps_pd( _mm256_extractf128_ps( mv, 1 ) );
+            vsum = _mm256_add_pd( vsum, _mm256_add_pd( lo, hi ) );
+            vsum2 = _mm256_add_pd( vsum2, _mm256_add_pd( _mm256_mul_pd( lo, lo ), _mm256_mul_pd( hi, hi ) ) );
+        }
+
+        float mins[8]; _mm256_storeu_ps( mins, vmin );
+        float maxs[8]; _mm256_storeu_ps( maxs, vmax );
+        float counts[8]; _mm256_storeu_ps( counts, vcount );
+        double sums[4]; _mm256_storeu_pd( sums, vsum );
+        double sums2[4]; _mm256_storeu_pd( sums2, vsum2 );
+        for ( size_t k = 0; k < 8; k++ )
+        {
+            min_value = kvs::Math::Min( min_value, mins[k] );
+            max_value = kvs::Math::Max( max_value, maxs[k] );
+            count += static_cast<size_t>( counts[k] );
+        }
+        for ( size_t k = 0; k < 4; k++ ) { sum += sums[k]; sum_of_squares += sums2[k]; }
+    }
+#elif defined( KVSOCEANVIS__UTIL__MASKED_STATISTICS_ENABLE_SSE )
+    if ( nvalues >= 4 )
+    {
+        const __m128 sign = _mm_set1_ps( -0.0f );
+        const __m128 ignore = _mm_set1_ps( ignore_value );
+        const __m128 bound = _mm_set1_ps( lower_bound );
+        const __m128 eps = _mm_set1_ps( epsilon );
+        const __m128 fmin = _mm_set1_ps( neutral_min );
+        const __m128 fmax = _mm_set1_ps( neutral_max );
+        __m128 vmin = fmin;
+        __m128 vmax = fmax;
+        __m128i vcount = _mm_setzero_si128();
+        __m128d vsum = _mm_setzero_pd();
+        __m128d vsum2 = _mm_setzero_pd();
+        for ( ; i + 4 <= nvalues; i += 4 )
+        {
+            const __m128 v = _mm_loadu_ps( values + i );
+            if ( destination ) { _mm_storeu_ps( destination + i, v ); }
+            const __m128 diff = _mm_andnot_ps( sign, _mm_sub_ps( v, ignore ) );
+            const __m128 undefined = _mm_cmple_ps( diff, eps );
+            const __m128 mask = _mm_andnot_ps( undefined, _mm_cmpgt_ps( v, bound ) );
+
+            vmin = _mm_min_ps( vmin, _mm_or_ps( _mm_and_ps( mask, v ), _mm_andnot_ps( mask, fmin ) ) );
+            vmax = _mm_max_ps( vmax, _mm_or_ps( _mm_and_ps( mask, v ), _mm_andnot_ps( mask, fmax ) ) );
+            vcount = _mm_sub_epi32( vcount, _mm_castps_si128( mask ) );
+
+            const __m128 mv = _mm_and_ps( mask, v );
+            const __m128d lo = _mm_cvtps_pd( mv );
+            const __m128d hi = _mm_cvtps_pd( _mm_movehl_ps( mv, mv ) );
+            vsum = _mm_add_pd( vsum, _mm_add_pd( lo, hi ) );
+            vsum2 = _mm_add_pd( vsum2, _mm_add_pd( _mm_mul_pd( lo, lo ), _mm_mul_pd( hi, hi ) ) );
+        }
+
+        float mins[4]; _mm_storeu_ps( mins, vmin );
+        float maxs[4]; _mm_storeu_ps( maxs, vmax );
+        kvs::Int32 counts[4]; _mm_storeu_si128( reinterpret_cast<__m128i*>( counts ), vcount );
+        double sums[2]; _mm_storeu_pd( sums, vsum );
+        double sums2[2]; _mm_storeu_pd( sums2, vsum2 );
+        for ( size_t k = 0; k < 4; k++ )
+        {
+            min_value = kvs::Math::Min( min_value, mins[k] );
+            max_value = kvs::Math::Max( max_value, maxs[k] );
+            count += static_cast<size_t>( counts[k] );
+        }
+        for ( size_t k = 0; k < 2; k++ ) { sum += sums[k]; sum_of_squares += sums2[k]; }
+    }
+#endif
+
+    for ( ; i < nvalues; i++ )
+    {
+        const kvs::Real32 value = values[i];
+        if ( destination ) { destination[i] = value; }
+        if ( !kvs::Math::Equal( value, ignore_value ) && value > lower_bound )
+        {
+            min_value = kvs::Math::Min( value, min_value );
+            max_value = kvs::Math::Max( value, max_value );
+            sum += value;
+            sum_of_squares += static_cast<kvs::Real64>( value ) * value;
+            count++;
+        }
+    }
+
+    m_count += count;
+    m_min_value = min_value;
+    m_max_value = max_value;
+    m_sum += sum;
+    m_sum_of_squares += sum_of_squares;
+}
+
+} // end of namespace util
+
+} // end of namespace kvsoceanvis
@@ -0,0 +1,88 @@
+/*****************************************************************************/
+/**
+ *  @file   MaskedStatistics.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__UTIL__MASKED_STATISTICS_H_INCLUDE
+#define KVSOCEANVIS__UTIL__MASKED_STATISTICS_H_INCLUDE
+
+#include <cstddef>
+#include <kvs/Type>
+#include <kvs/ValueArray>
+
+
+namespace kvsoceanvis
+{
+
+namespace util
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Statistics of the values except the undefined values.
+ *
+ *  The min/max values, sum, sum of squares and number of the defined values
+ *  are calculated in one pass with the SIMD operations (AVX or SSE2 if
+ *  available), where a value is disregarded if it is equal to the undefined
+ *  value or it is not greater than the lower bound (-999 by default for the
+ *  'w' values of the ocean data). Large arrays are divided into the chunks
+ *  and processed in parallel. The values can be copied to the other array in
+ *  the same pass by copy(), so the imported values are not read twice.
+ */
+/*===========================================================================*/
+class MaskedStatistics
+{
+private:
+
+    kvs::Real32 m_ignore_value; ///< undefined value
+    kvs::Real32 m_lower_bound; ///< values not greater than the bound are disregarded
+    size_t m_count; ///< number of the defined values
+    kvs::Real32 m_min_value; ///< min. value
+    kvs::Real32 m_max_value; ///< max. value
+    kvs::Real64 m_sum; ///< sum of the values
+    kvs::Real64 m_sum_of_squares; ///< sum of the squared values
+
+public:
+
+    MaskedStatistics( const kvs::Real32 ignore_value, const kvs::Real32 lower_bound = -999.0f );
+
+public:
+
+    void setIgnoreValue( const kvs::Real32 ignore_value );
+    void setLowerBound( const kvs::Real32 lower_bound );
+    void disableLowerBound();
+
+    void reset();
+    void update( const kvs::Real32* values, const size_t nvalues );
+    void update( const kvs::ValueArray<kvs::Real32>& values );
+    void copy( const kvs::Real32* values, const size_t nvalues, kvs::Real32* destination );
+    void merge( const MaskedStatistics& other );
+
+    size_t count() const;
+    kvs::Real32 minValue() const;
+    kvs::Real32 maxValue() const;
+    kvs::Real64 sum() const;
+    kvs::Real64 sumOfSquares() const;
+    kvs::Real64 mean() const;
+    kvs::Real64 variance() const;
+
+private:
+
+    void update_values( const kvs::Real32* values, const size_t nvalues, kvs::Real32* destination );
+    void update_chunk( const kvs::Real32* values, const size_t nvalues, kvs::Real32* destination );
+};
+
+} // end of namespace util
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__UTIL__MASKED_STATISTICS_H_INCLUDE
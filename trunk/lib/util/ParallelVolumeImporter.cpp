@@ -0,0 +1,274 @@
+/*****************************************************************************/
+/**
+ *  @file   ParallelVolumeImporter.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "ParallelVolumeImporter.h"
+#include "StructuredVolumeImporter.h"
+#include <kvs/Type>
+#include <kvs/Message>
+#if defined( _OPENMP )
+#include <omp.h>
+#endif
+#if defined( _WIN32 )
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the number of bytes of a variable in the GrADS data.
+ *  @param  file [in] pointer to the GrADS data
+ *  @return number of bytes
+ */
+/*===========================================================================*/
+size_t VariableBytes( const kvs::GrADS* file )
+{
+    const size_t dimx = file->dataDescriptor().xdef().num;
+    const size_t dimy = file->dataDescriptor().ydef().num;
+    const size_t dimz = file->dataDescriptor().zdef().num;
+    return dimx * dimy * dimz * sizeof( float );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the size of the physical memory.
+ *  @return size in bytes (0: unknown)
+ */
+/*===========================================================================*/
+size_t PhysicalMemorySize()
+{
+#if defined( _WIN32 )
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof( status );
+    if ( !GlobalMemoryStatusEx( &status ) ) return 0;
+    return static_cast<size_t>( status.ullTotalPhys );
+#else
+    const long npages = sysconf( _SC_PHYS_PAGES );
+    const long page_size = sysconf( _SC_PAGESIZE );
+    if ( npages <= 0 || page_size <= 0 ) return 0;
+    return static_cast<size_t>( npages ) * static_cast<size_t>( page_size );
+#endif
+}
+
+} // end of namespace
+
+
+namespace kvsoceanvis
+{
+
+namespace util
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new ParallelVolumeImporter class.
+ *
+ *  The memory budget is set to the half of the physical memory by default.
+ */
+/*===========================================================================*/
+ParallelVolumeImporter::ParallelVolumeImporter():
+    m_memory_budget( ::PhysicalMemorySize() / 2 ),
+    m_nthreads( 0 )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Appends a variable to be imported.
+ *  @param  file [in] pointer to the GrADS data
+ *  @param  vindex [in] value index
+ *  @param  tindex [in] time index
+ *  @param  zflip [in] flip data along the z-axis if true
+ *  @param  grid_type [in] grid type
+ *  @return index of the task
+ */
+/*===========================================================================*/
+size_t ParallelVolumeImporter::append(
+    const kvs::GrADS* file,
+    const size_t vindex,
+    const size_t tindex,
+    const bool zflip,
+    const GridType grid_type )
+{
+    Task task;
+    task.file = file;
+    task.vindex = vindex;
+    task.tindex = tindex;
+    task.zflip = zflip;
+    task.grid_type = grid_type;
+    task.volume = NULL;
+    m_tasks.push_back( task );
+
+    return m_tasks.size() - 1;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Clears the tasks (the imported volume objects are not deleted).
+ */
+/*===========================================================================*/
+void ParallelVolumeImporter::clear()
+{
+    m_tasks.clear();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a memory budget for the data files loaded concurrently.
+ *  @param  memory_budget [in] memory budget in bytes (0: unlimited)
+ */
+/*===========================================================================*/
+void ParallelVolumeImporter::setMemoryBudget( const size_t memory_budget )
+{
+    m_memory_budget = memory_budget;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets a number of threads.
+ *  @param  nthreads [in] number of threads (0: OpenMP default)
+ */
+/*===========================================================================*/
+void ParallelVolumeImporter::setNumberOfThreads( const size_t nthreads )
+{
+    m_nthreads = nthreads;
+}
+
+size_t ParallelVolumeImporter::numberOfTasks() const
+{
+    return m_tasks.size();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the imported volume object.
+ *  @param  index [in] index of the task
+ *  @return pointer to the volume object (NULL if not imported)
+ */
+/*===========================================================================*/
+kvs::StructuredVolumeObject* ParallelVolumeImporter::volume( const size_t index ) const
+{
+    return m_tasks[ index ].volume;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Imports the variables.
+ *  @return true if all the variables are imported successfully
+ */
+/*===========================================================================*/
+bool ParallelVolumeImporter::import()
+{
+    for ( size_t i = 0; i < m_tasks.size(); i++ )
+    {
+        const Task& task = m_tasks[i];
+        if ( !task.file )
+        {
+            kvsMessageError("GrADS data of the task %d is NULL.", int(i));
+            return false;
+        }
+        if ( task.tindex >= task.file->dataList().size() ||
+             task.vindex >= task.file->dataDescriptor().vars().values.size() )
+        {
+            kvsMessageError("Time or value index of the task %d is out of range.", int(i));
+            return false;
+        }
+    }
+
+    // Groups of the tasks that read the same data file.
+    std::vector< std::vector<size_t> > groups;
+    std::vector<size_t> group_bytes;
+    for ( size_t i = 0; i < m_tasks.size(); i++ )
+    {
+        const Task& task = m_tasks[i];
+        const size_t variable_bytes = ::VariableBytes( task.file );
+
+        size_t g = 0;
+        for ( ; g < groups.size(); g++ )
+        {
+            const Task& front = m_tasks[ groups[g].front() ];
+            if ( front.file == task.file && front.tindex == task.tindex ) break;
+        }
+        if ( g == groups.size() )
+        {
+            // The whole data file (all the variables) is loaded once for the group.
+            const size_t nvariables = task.file->dataDescriptor().vars().values.size();
+            groups.push_back( std::vector<size_t>() );
+            group_bytes.push_back( variable_bytes * nvariables );
+        }
+        groups[g].push_back( i );
+        group_bytes[g] += variable_bytes;
+    }
+
+    // Waves of the groups imported concurrently within the memory budget.
+    std::vector<size_t> waves( 1, 0 );
+    size_t wave_bytes = 0;
+    for ( size_t g = 0; g < groups.size(); g++ )
+    {
+        if ( m_memory_budget > 0 && g > waves.back() && wave_bytes + group_bytes[g] > m_memory_budget )
+        {
+            waves.push_back( g );
+            wave_bytes = 0;
+        }
+        wave_bytes += group_bytes[g];
+    }
+    waves.push_back( groups.size() );
+
+#if defined( _OPENMP )
+    const int nthreads = m_nthreads > 0 ? static_cast<int>( m_nthreads ) : omp_get_max_threads();
+#endif
+    bool success = true;
+    for ( size_t w = 0; w + 1 < waves.size(); w++ )
+    {
+        const kvs::Int64 begin = static_cast<kvs::Int64>( waves[w] );
+        const kvs::Int64 end = static_cast<kvs::Int64>( waves[w+1] );
+        #pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+        for ( kvs::Int64 g = begin; g < end; g++ )
+        {
+            // The data file is loaded once, and all the variables of the
+            // group are copied from it.
+            const std::vector<size_t>& group = groups[g];
+            const Task& front = m_tasks[ group.front() ];
+            const kvs::grads::GriddedBinaryDataFile& data = front.file->dataList().at( front.tindex );
+            if ( !data.load() )
+            {
+                #pragma omp critical
+                {
+                    kvsMessageError("Cannot load %s.", data.filename().c_str());
+                    success = false;
+                }
+                continue;
+            }
+
+            for ( size_t i = 0; i < group.size(); i++ )
+            {
+                Task& task = m_tasks[ group[i] ];
+                task.volume = new util::StructuredVolumeImporter(
+                    task.file, data, task.vindex, task.zflip, task.grid_type );
+            }
+
+            data.free();
+        }
+    }
+
+    return success;
+}
+
+} // end of namespace util
+
+} // end of namespace kvsoceanvis
@@ -0,0 +1,91 @@
+/*****************************************************************************/
+/**
+ *  @file   ParallelVolumeImporter.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__UTIL__PARALLEL_VOLUME_IMPORTER_H_INCLUDE
+#define KVSOCEANVIS__UTIL__PARALLEL_VOLUME_IMPORTER_H_INCLUDE
+
+#include <vector>
+#include <kvs/StructuredVolumeObject>
+#include <kvs/GrADS>
+
+
+namespace kvsoceanvis
+{
+
+namespace util
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Concurrent importer of the variables in the GrADS datasets.
+ *
+ *  The appended variables are imported with util::StructuredVolumeImporter
+ *  in parallel. The data file of each dataset and time step is loaded once
+ *  by a thread, and all the variables appended for it are copied from the
+ *  loaded data before it is freed. The data files are imported concurrently
+ *  in the groups whose estimated memory usage is within the memory budget.
+ *
+ *  The imported volume objects are not deleted by this class.
+ */
+/*===========================================================================*/
+class ParallelVolumeImporter
+{
+public:
+
+    typedef kvs::StructuredVolumeObject::GridType GridType;
+
+private:
+
+    struct Task
+    {
+        const kvs::GrADS* file; ///< pointer to the GrADS data
+        size_t vindex; ///< value index
+        size_t tindex; ///< time index
+        bool zflip; ///< flip data along the z-axis if true
+        GridType grid_type; ///< grid type
+        kvs::StructuredVolumeObject* volume; ///< imported volume object
+    };
+
+    std::vector<Task> m_tasks; ///< import tasks
+    size_t m_memory_budget; ///< memory budget in bytes (0: unlimited, default: half of the physical memory)
+    size_t m_nthreads; ///< number of threads (0: OpenMP default)
+
+public:
+
+    ParallelVolumeImporter();
+
+public:
+
+    size_t append(
+        const kvs::GrADS* file,
+        const size_t vindex = 0,
+        const size_t tindex = 0,
+        const bool zflip = false,
+        const GridType grid_type = kvs::StructuredVolumeObject::Uniform );
+    void clear();
+
+    void setMemoryBudget( const size_t memory_budget );
+    void setNumberOfThreads( const size_t nthreads );
+
+    size_t numberOfTasks() const;
+    kvs::StructuredVolumeObject* volume( const size_t index ) const;
+
+    bool import();
+};
+
+} // end of namespace util
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__UTIL__PARALLEL_VOLUME_IMPORTER_H_INCLUDE
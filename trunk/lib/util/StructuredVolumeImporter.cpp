@@ -13,8 +13,194 @@
  */
 /*****************************************************************************/
 #include "StructuredVolumeImporter.h"
+#include "MappedFile.h"
+#include "MaskedStatistics.h"
+#include "BrickedVolumeFile.h"
 #include <kvs/Vector3>
+#include <kvs/Message>
 #include <cstring>
+#include <algorithm>
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the coordinate array of the GrADS data.
+ *  @param  file [in] pointer to the GrADS data
+ *  @param  zflip [in] flip the z coordinates if true
+ *  @return coordinate array {x0,x1,...,xi,y0,y1,...,yj,z0,z1,...,zk}
+ */
+/*===========================================================================*/
+kvs::ValueArray<float> Coords( const kvs::GrADS* file, const bool zflip )
+{
+    const size_t dimx = file->dataDescriptor().xdef().num;
+    const size_t dimy = file->dataDescriptor().ydef().num;
+    const size_t dimz = file->dataDescriptor().zdef().num;
+
+    // Coordinate array of the structured volume object (rectilinear grid).
+    // NOTE: The coordinate values are stored in the array 'coords' as follows:
+    //       coords = {x0,x1,...,xi,y0,y1,...,yj,z0,z1,...,zk}
+    kvs::ValueArray<float> coords( dimx + dimy + dimz );
+
+    float* xcoords = coords.pointer();
+    switch ( file->dataDescriptor().xdef().mapping )
+    {
+    case kvs::grads::XDef::Levels:
+    {
+        const float* values = file->dataDescriptor().xdef().values.pointer();
+        memcpy( xcoords, values, sizeof( float ) * dimx );
+        break;
+    }
+    case kvs::grads::XDef::Linear:
+    {
+        kvs::Real32 value = file->dataDescriptor().xdef().values[0];
+        const kvs::Real32 increment = file->dataDescriptor().xdef().values[1];
+        for ( size_t i = 0; i < dimx; i++, value += increment ) xcoords[i] = value;
+        break;
+    }
+    default: break;
+    }
+
+    float* ycoords = coords.pointer() + dimx;
+    switch ( file->dataDescriptor().ydef().mapping )
+    {
+    case kvs::grads::YDef::Levels:
+    {
+        const float* values = file->dataDescriptor().ydef().values.pointer();
+        memcpy( ycoords, values, sizeof( float ) * dimy );
+        break;
+    }
+    case kvs::grads::YDef::Linear:
+    {
+        kvs::Real32 value = file->dataDescriptor().ydef().values[0];
+        const kvs::Real32 increment = file->dataDescriptor().ydef().values[1];
+        for ( size_t i = 0; i < dimy; i++, value += increment ) ycoords[i] = value;
+        break;
+    }
+    default: break;
+    }
+
+    float* zcoords = coords.pointer() + dimx + dimy;
+    switch ( file->dataDescriptor().zdef().mapping )
+    {
+    case kvs::grads::ZDef::Levels:
+    {
+        const float* values = file->dataDescriptor().zdef().values.pointer();
+        memcpy( zcoords, values, sizeof( float ) * dimz );
+        break;
+    }
+    case kvs::grads::ZDef::Linear:
+    {
+        kvs::Real32 value = file->dataDescriptor().zdef().values[0];
+        const kvs::Real32 increment = file->dataDescriptor().zdef().values[1];
+        for ( size_t i = 0; i < dimz; i++, value += increment ) zcoords[i] = value;
+        break;
+    }
+    default: break;
+    }
+
+    if ( zflip )
+    {
+        const size_t end = dimz / 2;
+        kvs::Real32* src = zcoords;
+        kvs::Real32* dst = zcoords + dimz - 1;
+        for ( size_t i = 0; i < end; i++ )
+        {
+            kvs::Real32 temp = *dst;
+            *dst = *src;
+            *src = temp;
+            src++;
+            dst--;
+        }
+
+        for ( size_t i = 0; i < dimz; i++ ) zcoords[i] *= -1;
+    }
+
+    return coords;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the coordinate array of the bricked volume file.
+ *  @param  file [in] pointer to the bricked volume file
+ *  @param  zflip [in] flip the z coordinates if true
+ *  @return coordinate array {x0,x1,...,xi,y0,y1,...,yj,z0,z1,...,zk}
+ */
+/*===========================================================================*/
+kvs::ValueArray<float> Coords( const kvsoceanvis::util::BrickedVolumeFile* file, const bool zflip )
+{
+    const kvs::Vec3ui resolution = file->resolution();
+    kvs::ValueArray<float> coords = file->coords().clone();
+    if ( coords.size() == 0 )
+    {
+        // Node indices for the file without the coordinates.
+        coords.allocate( resolution.x() + resolution.y() + resolution.z() );
+        float* dst = coords.data();
+        for ( size_t axis = 0; axis < 3; axis++ )
+        {
+            for ( size_t i = 0; i < resolution[axis]; i++ ) *(dst++) = static_cast<float>( i );
+        }
+    }
+
+    if ( zflip )
+    {
+        const size_t dimz = file->resolution().z();
+        float* zcoords = coords.data() + file->resolution().x() + file->resolution().y();
+        std::reverse( zcoords, zcoords + dimz );
+        for ( size_t i = 0; i < dimz; i++ ) zcoords[i] *= -1;
+    }
+
+    return coords;
+}
+
+size_t MinIndexOf( const float coord, const float* coords, const size_t coords_size )
+{
+    if ( coord < coords[0] ) { return 0; }
+    if ( coords[ coords_size - 1 ] <= coord ) { return coords_size - 1; }
+
+    for ( size_t i = 0; i < coords_size - 1; i++ )
+    {
+        if ( coords[i] <= coord && coord < coords[i+1] ) { return i; }
+    }
+
+    return coords_size - 1;
+}
+
+size_t MaxIndexOf( const float coord, const float* coords, const size_t coords_size )
+{
+    size_t index = MinIndexOf( coord, coords, coords_size ) + 1;
+    return kvs::Math::Clamp( index, size_t(0), coords_size - 1 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the byte order of the machine is big endian.
+ */
+/*===========================================================================*/
+bool IsBigEndianMachine()
+{
+    const kvs::UInt32 value = 1;
+    return *reinterpret_cast<const kvs::UInt8*>( &value ) == 0;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Swaps the byte order of the value.
+ */
+/*===========================================================================*/
+inline float Swap( const float value )
+{
+    float swapped = value;
+    kvs::UInt8* p = reinterpret_cast<kvs::UInt8*>( &swapped );
+    std::swap( p[0], p[3] );
+    std::swap( p[1], p[2] );
+    return swapped;
+}
+
+} // end of namespace
+
 
 
 namespace kvsoceanvis
@@ -65,6 +251,114 @@ StructuredVolumeImporter::StructuredVolumeImporter(
     this->import( file, vindex, tindex, zflip, grid_type );
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new StructuredVolumeImporter class from the loaded time step.
+ *  @param  file [in] pointer to the GrADS data
+ *  @param  data [in] data file of the time step loaded by the caller
+ *  @param  vindex [in] value index
+ *  @param  zflip [in] flip data along the z-axis if true
+ *  @param  grid_type [in] grid type
+ *
+ *  The data file is neither loaded nor freed, so that the variables in the
+ *  same time step can be imported from a single load of the data file.
+ */
+/*===========================================================================*/
+StructuredVolumeImporter::StructuredVolumeImporter(
+    const kvs::GrADS* file,
+    const kvs::grads::GriddedBinaryDataFile& data,
+    const size_t vindex,
+    const bool zflip,
+    const kvs::StructuredVolumeObject::GridType grid_type )
+{
+    this->import_loaded( file, data, vindex, zflip, grid_type );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new StructuredVolumeImporter class for the sub-region.
+ *  @param  file [in] pointer to the GrADS data
+ *  @param  min_range [in] min. coordinates of the region
+ *  @param  max_range [in] max. coordinates of the region
+ *  @param  vindex [in] value index
+ *  @param  tindex [in] time index
+ *  @param  zflip [in] flip data along the z-axis if true
+ *  @param  grid_type [in] grid type
+ *
+ *  The region is given in the coordinates of the GrADS data (e.g. longitude,
+ *  latitude and depth, where the depth is negative if zflip is true), and it
+ *  is expanded to the nearest grid points as well as util::CropVolume.
+ */
+/*===========================================================================*/
+StructuredVolumeImporter::StructuredVolumeImporter(
+    const kvs::GrADS* file,
+    const kvs::Vec3& min_range,
+    const kvs::Vec3& max_range,
+    const size_t vindex,
+    const size_t tindex,
+    const bool zflip,
+    const kvs::StructuredVolumeObject::GridType grid_type )
+{
+    this->import_region( file, min_range, max_range, vindex, tindex, zflip, grid_type );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new StructuredVolumeImporter class for the bricked volume file.
+ *  @param  file [in] pointer to the bricked volume file
+ *  @param  zflip [in] flip data along the z-axis if true
+ *  @param  grid_type [in] grid type
+ */
+/*===========================================================================*/
+StructuredVolumeImporter::StructuredVolumeImporter(
+    const util::BrickedVolumeFile* file,
+    const bool zflip,
+    const kvs::StructuredVolumeObject::GridType grid_type )
+{
+    const kvs::Vec3ui min_index( 0, 0, 0 );
+    const kvs::Vec3ui max_index = file->resolution() - kvs::Vec3ui( 1, 1, 1 );
+    this->import_bricks( file, min_index, max_index, zflip, grid_type );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new StructuredVolumeImporter class for the sub-region of the bricked volume file.
+ *  @param  file [in] pointer to the bricked volume file
+ *  @param  min_range [in] min. coordinates of the region
+ *  @param  max_range [in] max. coordinates of the region
+ *  @param  zflip [in] flip data along the z-axis if true
+ *  @param  grid_type [in] grid type
+ *
+ *  The region is given and expanded as well as the region of the GrADS data.
+ */
+/*===========================================================================*/
+StructuredVolumeImporter::StructuredVolumeImporter(
+    const util::BrickedVolumeFile* file,
+    const kvs::Vec3& min_range,
+    const kvs::Vec3& max_range,
+    const bool zflip,
+    const kvs::StructuredVolumeObject::GridType grid_type )
+{
+    const size_t dimx = file->resolution().x();
+    const size_t dimy = file->resolution().y();
+    const size_t dimz = file->resolution().z();
+
+    const kvs::ValueArray<float> coords = ::Coords( file, zflip );
+    const float* xcoords = coords.data();
+    const float* ycoords = xcoords + dimx;
+    const float* zcoords = ycoords + dimy;
+    const size_t imin = ::MinIndexOf( min_range.x(), xcoords, dimx );
+    const size_t jmin = ::MinIndexOf( min_range.y(), ycoords, dimy );
+    const size_t kmin = ::MinIndexOf( min_range.z(), zcoords, dimz );
+    const size_t imax = kvs::Math::Max( ::MaxIndexOf( max_range.x(), xcoords, dimx ), imin );
+    const size_t jmax = kvs::Math::Max( ::MaxIndexOf( max_range.y(), ycoords, dimy ), jmin );
+    const size_t kmax = kvs::Math::Max( ::MaxIndexOf( max_range.z(), zcoords, dimz ), kmin );
+
+    const kvs::Vec3ui min_index( imin, jmin, kmin );
+    const kvs::Vec3ui max_index( imax, jmax, kmax );
+    this->import_bricks( file, min_index, max_index, zflip, grid_type );
+}
+
 /*===========================================================================*/
 /**
  *  @brief  Main method.
@@ -98,6 +392,28 @@ void StructuredVolumeImporter::import(
     const size_t tindex,
     const bool zflip,
     const kvs::StructuredVolumeObject::GridType grid_type )
+{
+    file->dataList().at( tindex ).load();
+    this->import_loaded( file, file->dataList().at( tindex ), vindex, zflip, grid_type );
+    file->dataList().at( tindex ).free();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Imports a variable from the loaded time step of the GrADS data.
+ *  @param  file [in] pointer to the GrADS data
+ *  @param  data [in] loaded data file of the time step
+ *  @param  vindex [in] value index
+ *  @param  zflip [in] flip data along the z-axis if true
+ *  @param  grid_type [in] grid type
+ */
+/*===========================================================================*/
+void StructuredVolumeImporter::import_loaded(
+    const kvs::GrADS* file,
+    const kvs::grads::GriddedBinaryDataFile& data,
+    const size_t vindex,
+    const bool zflip,
+    const kvs::StructuredVolumeObject::GridType grid_type )
 {
     const size_t dimx = file->dataDescriptor().xdef().num;
     const size_t dimy = file->dataDescriptor().ydef().num;
@@ -110,32 +426,19 @@ void StructuredVolumeImporter::import(
     kvs::ValueArray<float> values( size );
     float* pvalues = values.data();
 
-    // Copy (deep copy) scalar values to the value array from the GrADS datasets.
-    float min_value = kvs::Value<float>::Max();
-    float max_value = kvs::Value<float>::Min();
+    // Copy (deep copy) scalar values to the value array from the GrADS datasets
+    // and calculate the min/max values in the same pass.
+    // NOTE: The min/max values are calculated in disregard for the undefined
+    // value and the values not greater than -999, which is a condition for the
+    // 'w' values. "!kvs::Math::Equal( src[i], ignore_value )" is valid
+    // condition, but this condition dosen't work well for the w values.
     const float ignore_value = file->dataDescriptor().undef().value;
-    file->dataList().at( tindex ).load();
+    util::MaskedStatistics statistics( ignore_value );
     {
         // src: head pointer to the scalar values specified by the sindex.
-        const float* src = file->dataList().at(tindex).values().pointer() + size * vindex;
-        for ( size_t i = 0; i < size; i++ )
-        {
-            pvalues[i] = src[i];
-
-            // Calculate the min/max values in disregard for the undefined value.
-            // NOTE: "src[i] > -999" is a condition for the 'w' values.
-            // "!kvs::Math::Equal( src[i], ignore_value )" is valid condition,
-            // but this condition dosen't work well for the w values. I don't
-            // why it is like that.
-            // if ( !kvs::Math::Equal( src[i], ignore_value ) )
-            if ( !kvs::Math::Equal( src[i], ignore_value ) && src[i] > -999 )
-            {
-                min_value = kvs::Math::Min( src[i], min_value );
-                max_value = kvs::Math::Max( src[i], max_value );
-            }
-        }
+        const float* src = data.values().pointer() + size * vindex;
+        statistics.copy( src, size, pvalues );
     }
-    file->dataList().at( tindex ).free();
 
     // Flip the slices along the z-axis.
     if ( zflip )
@@ -161,90 +464,206 @@ void StructuredVolumeImporter::import(
     setResolution( kvs::Vector3ui( dimx, dimy, dimz ) );
     setVeclen( 1 );
     setValues( kvs::AnyValueArray( values ) );
-    setMinMaxValues( min_value, max_value );
+    setMinMaxValues( statistics.minValue(), statistics.maxValue() );
 
     if ( grid_type == kvs::StructuredVolumeObject::Rectilinear )
     {
-        // Coordinate array of the structured volume object (rectilinear grid).
-        // NOTE: The coordinate values are stored in the array 'coords' as follows:
-        //       coords = {x0,x1,...,xi,y0,y1,...,yj,z0,z1,...,zk}
-        kvs::ValueArray<float> coords( dimx + dimy + dimz );
+        setCoords( ::Coords( file, zflip ) );
+    }
+    updateMinMaxCoords();
+}
 
-        float* xcoords = coords.pointer();
-        switch ( file->dataDescriptor().xdef().mapping )
-        {
-        case kvs::grads::XDef::Levels:
-        {
-            const float* values = file->dataDescriptor().xdef().values.pointer();
-            memcpy( xcoords, values, sizeof( float ) * dimx );
-            break;
-        }
-        case kvs::grads::XDef::Linear:
-        {
-            kvs::Real32 value = file->dataDescriptor().xdef().values[0];
-            const kvs::Real32 increment = file->dataDescriptor().xdef().values[1];
-            for ( size_t i = 0; i < dimx; i++, value += increment ) xcoords[i] = value;
-            break;
-        }
-        default: break;
-        }
+/*===========================================================================*/
+/**
+ *  @brief  Imports the sub-region of a GrADS data.
+ *  @param  file [in] pointer to the GrADS data
+ *  @param  min_range [in] min. coordinates of the region
+ *  @param  max_range [in] max. coordinates of the region
+ *  @param  vindex [in] value index
+ *  @param  tindex [in] time index
+ *  @param  zflip [in] flip data along the z-axis if true
+ *  @param  grid_type [in] grid type
+ *
+ *  The binary data file of the time step is memory-mapped, and the values in
+ *  the region are read line by line at the byte offsets given by the data
+ *  descriptor, so only the pages of the region are read from the file. The
+ *  sequential (Fortran unformatted) file is loaded as well as import().
+ */
+/*===========================================================================*/
+void StructuredVolumeImporter::import_region(
+    const kvs::GrADS* file,
+    const kvs::Vec3& min_range,
+    const kvs::Vec3& max_range,
+    const size_t vindex,
+    const size_t tindex,
+    const bool zflip,
+    const kvs::StructuredVolumeObject::GridType grid_type )
+{
+    const size_t dimx = file->dataDescriptor().xdef().num;
+    const size_t dimy = file->dataDescriptor().ydef().num;
+    const size_t dimz = file->dataDescriptor().zdef().num;
+    const size_t size = dimx * dimy * dimz;
 
-        float* ycoords = coords.pointer() + dimx;
-        switch ( file->dataDescriptor().ydef().mapping )
-        {
-        case kvs::grads::YDef::Levels:
-        {
-            const float* values = file->dataDescriptor().ydef().values.pointer();
-            memcpy( ycoords, values, sizeof( float ) * dimy );
-            break;
-        }
-        case kvs::grads::YDef::Linear:
-        {
-            kvs::Real32 value = file->dataDescriptor().ydef().values[0];
-            const kvs::Real32 increment = file->dataDescriptor().ydef().values[1];
-            for ( size_t i = 0; i < dimy; i++, value += increment ) ycoords[i] = value;
-            break;
-        }
-        default: break;
-        }
+    // Index range of the region.
+    const kvs::ValueArray<float> coords = ::Coords( file, zflip );
+    const float* xcoords = coords.data();
+    const float* ycoords = xcoords + dimx;
+    const float* zcoords = ycoords + dimy;
+    const size_t imin = ::MinIndexOf( min_range.x(), xcoords, dimx );
+    const size_t jmin = ::MinIndexOf( min_range.y(), ycoords, dimy );
+    const size_t kmin = ::MinIndexOf( min_range.z(), zcoords, dimz );
+    const size_t imax = kvs::Math::Max( ::MaxIndexOf( max_range.x(), xcoords, dimx ), imin );
+    const size_t jmax = kvs::Math::Max( ::MaxIndexOf( max_range.y(), ycoords, dimy ), jmin );
+    const size_t kmax = kvs::Math::Max( ::MaxIndexOf( max_range.z(), zcoords, dimz ), kmin );
+    const size_t region_dimx = imax - imin + 1;
+    const size_t region_dimy = jmax - jmin + 1;
+    const size_t region_dimz = kmax - kmin + 1;
 
-        float* zcoords = coords.pointer() + dimx + dimy;
-        switch ( file->dataDescriptor().zdef().mapping )
-        {
-        case kvs::grads::ZDef::Levels:
-        {
-            const float* values = file->dataDescriptor().zdef().values.pointer();
-            memcpy( zcoords, values, sizeof( float ) * dimz );
-            break;
-        }
-        case kvs::grads::ZDef::Linear:
-        {
-            kvs::Real32 value = file->dataDescriptor().zdef().values[0];
-            const kvs::Real32 increment = file->dataDescriptor().zdef().values[1];
-            for ( size_t i = 0; i < dimz; i++, value += increment ) zcoords[i] = value;
-            break;
-        }
-        default: break;
-        }
+    // Head pointer to the values of the variable in the mapped file, or in
+    // the loaded data for the sequential file.
+    /* NOTE: The variables are assumed to have the same number of levels as
+     * import(), so that the values of the variable start at size * vindex.
+     */
+    util::MappedFile mapped_file;
+    const float* src = NULL;
+    bool swap = false;
+    bool loaded = false;
+    if ( !file->dataList().at( tindex ).isSequential() &&
+         mapped_file.open( file->dataList().at( tindex ).filename() ) &&
+         mapped_file.size() >= ( vindex + 1 ) * size * sizeof( float ) )
+    {
+        src = static_cast<const float*>( mapped_file.data() ) + size * vindex;
+        swap = ( file->dataList().at( tindex ).isBigEndian() != ::IsBigEndianMachine() );
+    }
+    else
+    {
+        mapped_file.close();
+        file->dataList().at( tindex ).load();
+        src = file->dataList().at( tindex ).values().data() + size * vindex;
+        loaded = true;
+    }
 
-        if ( zflip )
+    // Copy the values in the region line by line, and calculate the min/max
+    // values in disregard for the undefined values (see import()) while the
+    // line is in the cache.
+    util::MaskedStatistics statistics( file->dataDescriptor().undef().value );
+    kvs::ValueArray<float> values( region_dimx * region_dimy * region_dimz );
+    float* pvalues = values.data();
+    for ( size_t k = kmin; k <= kmax; k++ )
+    {
+        // Level in the file for the flipped slices along the z-axis.
+        const size_t level = zflip ? dimz - k - 1 : k;
+        for ( size_t j = jmin; j <= jmax; j++ )
         {
-            const size_t end = dimz / 2;
-            kvs::Real32* src = zcoords;
-            kvs::Real32* dst = zcoords + dimz - 1;
-            for ( size_t i = 0; i < end; i++ )
+            const float* line = src + ( level * dimy + j ) * dimx + imin;
+            if ( swap )
             {
-                kvs::Real32 temp = *dst;
-                *dst = *src;
-                *src = temp;
-                src++;
-                dst--;
+                for ( size_t i = 0; i < region_dimx; i++ ) { pvalues[i] = ::Swap( line[i] ); }
+                statistics.update( pvalues, region_dimx );
+            }
+            else
+            {
+                statistics.copy( line, region_dimx, pvalues );
             }
+            pvalues += region_dimx;
+        }
+    }
+
+    if ( loaded ) file->dataList().at( tindex ).free();
+
+    setGridType( grid_type );
+    setResolution( kvs::Vector3ui( region_dimx, region_dimy, region_dimz ) );
+    setVeclen( 1 );
+    setValues( kvs::AnyValueArray( values ) );
+    setMinMaxValues( statistics.minValue(), statistics.maxValue() );
+
+    if ( grid_type == kvs::StructuredVolumeObject::Rectilinear )
+    {
+        kvs::ValueArray<float> region_coords( region_dimx + region_dimy + region_dimz );
+        float* dst = region_coords.data();
+        for ( size_t i = imin; i <= imax; i++ ) { *(dst++) = xcoords[i]; }
+        for ( size_t j = jmin; j <= jmax; j++ ) { *(dst++) = ycoords[j]; }
+        for ( size_t k = kmin; k <= kmax; k++ ) { *(dst++) = zcoords[k]; }
+        setCoords( region_coords );
+    }
+    updateMinMaxCoords();
+}
 
-            for ( size_t i = 0; i < dimz; i++ ) zcoords[i] *= -1;
+/*===========================================================================*/
+/**
+ *  @brief  Imports the region of the bricked volume file.
+ *  @param  file [in] pointer to the bricked volume file
+ *  @param  min_index [in] min. node index of the region (inclusive, after flipping)
+ *  @param  max_index [in] max. node index of the region (inclusive, after flipping)
+ *  @param  zflip [in] flip data along the z-axis if true
+ *  @param  grid_type [in] grid type
+ */
+/*===========================================================================*/
+void StructuredVolumeImporter::import_bricks(
+    const util::BrickedVolumeFile* file,
+    const kvs::Vec3ui& min_index,
+    const kvs::Vec3ui& max_index,
+    const bool zflip,
+    const kvs::StructuredVolumeObject::GridType grid_type )
+{
+    const size_t dimx = file->resolution().x();
+    const size_t dimy = file->resolution().y();
+    const size_t dimz = file->resolution().z();
+    const size_t region_dimx = max_index.x() - min_index.x() + 1;
+    const size_t region_dimy = max_index.y() - min_index.y() + 1;
+    const size_t region_dimz = max_index.z() - min_index.z() + 1;
+
+    // Levels of the region in the file for the flipped slices along the z-axis.
+    kvs::Vec3ui min_level( min_index );
+    kvs::Vec3ui max_level( max_index );
+    if ( zflip )
+    {
+        min_level[2] = static_cast<unsigned int>( dimz - 1 - max_index.z() );
+        max_level[2] = static_cast<unsigned int>( dimz - 1 - min_index.z() );
+    }
+
+    kvs::ValueArray<float> values( region_dimx * region_dimy * region_dimz );
+    if ( !file->readRegion( min_level, max_level, values.data() ) )
+    {
+        kvs::ImporterBase::setSuccess( false );
+        kvsMessageError("Cannot read the region from the bricked volume file.");
+        return;
+    }
+
+    // Flip the slices along the z-axis.
+    if ( zflip )
+    {
+        const size_t stride = region_dimx * region_dimy;
+        for ( size_t k = 0; k < region_dimz / 2; k++ )
+        {
+            float* src = values.data() + k * stride;
+            float* dst = values.data() + ( region_dimz - k - 1 ) * stride;
+            std::swap_ranges( src, src + stride, dst );
         }
+    }
+
+    // Min/max values in disregard for the undefined values (see import()).
+    util::MaskedStatistics statistics( file->undefValue() );
+    statistics.update( values );
+
+    setGridType( grid_type );
+    setResolution( kvs::Vector3ui( region_dimx, region_dimy, region_dimz ) );
+    setVeclen( 1 );
+    setValues( kvs::AnyValueArray( values ) );
+    setMinMaxValues( statistics.minValue(), statistics.maxValue() );
 
-        setCoords( coords );
+    if ( grid_type == kvs::StructuredVolumeObject::Rectilinear )
+    {
+        const kvs::ValueArray<float> coords = ::Coords( file, zflip );
+        const float* xcoords = coords.data();
+        const float* ycoords = xcoords + dimx;
+        const float* zcoords = ycoords + dimy;
+        kvs::ValueArray<float> region_coords( region_dimx + region_dimy + region_dimz );
+        float* dst = region_coords.data();
+        for ( size_t i = min_index.x(); i <= max_index.x(); i++ ) { *(dst++) = xcoords[i]; }
+        for ( size_t j = min_index.y(); j <= max_index.y(); j++ ) { *(dst++) = ycoords[j]; }
+        for ( size_t k = min_index.z(); k <= max_index.z(); k++ ) { *(dst++) = zcoords[k]; }
+        setCoords( region_coords );
     }
     updateMinMaxCoords();
 }
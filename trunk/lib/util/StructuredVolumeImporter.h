@@ -19,6 +19,7 @@
 #include <kvs/PolygonObject>
 #include <kvs/StructuredVolumeObject>
 #include <kvs/GrADS>
+#include <kvs/Vector3>
 
 
 namespace kvsoceanvis
@@ -27,9 +28,15 @@ namespace kvsoceanvis
 namespace util
 {
 
+class BrickedVolumeFile;
+
 /*===========================================================================*/
 /**
  *  @brief  Structured volume importer for GrADS datasets.
+ *
+ *  The volume can be also imported from the bricked volume file converted
+ *  from the GrADS dataset (see util::BrickedVolumeFile), where only the
+ *  bricks overlapping with the region are decompressed.
  */
 /*===========================================================================*/
 class StructuredVolumeImporter : public kvs::ImporterBase, public kvs::StructuredVolumeObject
@@ -50,6 +57,34 @@ public:
         const bool zflip = false,
         const kvs::StructuredVolumeObject::GridType grid_type = kvs::StructuredVolumeObject::Uniform );
 
+    StructuredVolumeImporter(
+        const kvs::GrADS* file,
+        const kvs::grads::GriddedBinaryDataFile& data,
+        const size_t vindex = 0,
+        const bool zflip = false,
+        const kvs::StructuredVolumeObject::GridType grid_type = kvs::StructuredVolumeObject::Uniform );
+
+    StructuredVolumeImporter(
+        const kvs::GrADS* file,
+        const kvs::Vec3& min_range,
+        const kvs::Vec3& max_range,
+        const size_t vindex = 0,
+        const size_t tindex = 0,
+        const bool zflip = false,
+        const kvs::StructuredVolumeObject::GridType grid_type = kvs::StructuredVolumeObject::Uniform );
+
+    StructuredVolumeImporter(
+        const util::BrickedVolumeFile* file,
+        const bool zflip = false,
+        const kvs::StructuredVolumeObject::GridType grid_type = kvs::StructuredVolumeObject::Uniform );
+
+    StructuredVolumeImporter(
+        const util::BrickedVolumeFile* file,
+        const kvs::Vec3& min_range,
+        const kvs::Vec3& max_range,
+        const bool zflip = false,
+        const kvs::StructuredVolumeObject::GridType grid_type = kvs::StructuredVolumeObject::Uniform );
+
 public:
 
     kvs::StructuredVolumeObject* exec( const kvs::FileFormatBase* file );
@@ -62,6 +97,29 @@ private:
         const size_t tindex,
         const bool zflip,
         const kvs::StructuredVolumeObject::GridType grid_type = kvs::StructuredVolumeObject::Uniform );
+
+    void import_loaded(
+        const kvs::GrADS* file,
+        const kvs::grads::GriddedBinaryDataFile& data,
+        const size_t vindex,
+        const bool zflip,
+        const kvs::StructuredVolumeObject::GridType grid_type );
+
+    void import_region(
+        const kvs::GrADS* file,
+        const kvs::Vec3& min_range,
+        const kvs::Vec3& max_range,
+        const size_t vindex,
+        const size_t tindex,
+        const bool zflip,
+        const kvs::StructuredVolumeObject::GridType grid_type );
+
+    void import_bricks(
+        const util::BrickedVolumeFile* file,
+        const kvs::Vec3ui& min_index,
+        const kvs::Vec3ui& max_index,
+        const bool zflip,
+        const kvs::StructuredVolumeObject::GridType grid_type );
 };
 
 } // end of namespace util
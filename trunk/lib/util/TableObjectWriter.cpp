@@ -13,7 +13,20 @@
  */
 /*****************************************************************************/
 #include "TableObjectWriter.h"
+#include "BrickedVolumeFile.h"
+#include <typeinfo>
 #include <kvs/File>
+#include <kvs/Vector3>
+#include <kvs/ValueArray>
+#include <kvs/Message>
+
+
+namespace
+{
+
+const size_t ColumnBlockSize = 65536; // number of the rows compressed together
+
+} // end of namespace
 
 
 namespace kvsoceanvis
@@ -23,10 +36,36 @@ namespace util
 {
 
 TableObjectWriter::TableObjectWriter( const kvs::TableObject* object ):
-    m_object( object )
+    m_object( object ),
+    m_compression( false ),
+    m_tolerance( 0.0f ),
+    m_undef_value( 0.0f )
 {
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Enables the compression of the float columns.
+ *  @param  tolerance [in] absolute error tolerance (0: lossless)
+ *  @param  undef_value [in] undefined value (stored exactly)
+ *
+ *  The float columns are written as the bricked volume files of nrows x 1 x 1
+ *  values (see util::BrickedVolumeFile) with the format "compressed", which
+ *  can be read by pcs::OutOfCoreTableImporter.
+ */
+/*===========================================================================*/
+void TableObjectWriter::enableCompression( const kvs::Real32 tolerance, const kvs::Real32 undef_value )
+{
+    m_compression = true;
+    m_tolerance = tolerance;
+    m_undef_value = undef_value;
+}
+
+void TableObjectWriter::disableCompression()
+{
+    m_compression = false;
+}
+
 void TableObjectWriter::write( const std::string filename )
 {
     std::ofstream kvsml( filename.c_str() );
@@ -46,7 +85,9 @@ void TableObjectWriter::write( const std::string filename )
         const std::string type = m_object->column(i).typeInfo()->typeName();
         const float min_value = m_object->minValue(i);
         const float max_value = m_object->maxValue(i);
-        const std::string file = basename + "_" + label + ".dat";
+        const bool compressed = m_compression && m_object->column(i).typeInfo()->type() == typeid( kvs::Real32 );
+        const std::string file = basename + "_" + label + ( compressed ? ".kbv" : ".dat" );
+        const std::string format = compressed ? "compressed" : "binary";
 
         kvsml.setf( std::ios::fixed );
         kvsml << "\t\t\t<Column "
@@ -57,9 +98,20 @@ void TableObjectWriter::write( const std::string filename )
         kvsml << "\t\t\t\t<DataArray "
               << "type=\"" << type << "\" "
               << "file=\"" << file << "\" "
-              << "format=\"binary\"/>" << std::endl;
+              << "format=\"" << format << "\"/>" << std::endl;
         kvsml << "\t\t\t</Column>" << std::endl;
 
+        if ( compressed )
+        {
+            const kvs::ValueArray<kvs::Real32> values = m_object->column(i).asValueArray<kvs::Real32>();
+            const kvs::Vec3ui resolution( static_cast<unsigned int>( nrows ), 1, 1 );
+            if ( !util::BrickedVolumeFile::Write( file, values, resolution, m_undef_value, ::ColumnBlockSize, m_tolerance ) )
+            {
+                kvsMessageError( "Cannot write %s.", file.c_str() );
+            }
+            continue;
+        }
+
         std::ofstream ofs( file.c_str() );
         ofs.write( (char*)m_object->column(i).data(), m_object->column(i).byteSize() );
         ofs.close();
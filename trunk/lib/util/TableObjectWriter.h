@@ -17,6 +17,7 @@
 
 #include <string>
 #include <fstream>
+#include <kvs/Type>
 #include <kvs/TableObject>
 
 
@@ -31,11 +32,17 @@ class TableObjectWriter
 protected:
 
     const kvs::TableObject* m_object;
+    bool m_compression; ///< true if the float columns are compressed
+    kvs::Real32 m_tolerance; ///< absolute error tolerance of the compressed columns
+    kvs::Real32 m_undef_value; ///< undefined value of the compressed columns
 
 public:
 
     TableObjectWriter( const kvs::TableObject* object );
 
+    void enableCompression( const kvs::Real32 tolerance, const kvs::Real32 undef_value );
+    void disableCompression();
+
     void write( const std::string filename );
 };
 
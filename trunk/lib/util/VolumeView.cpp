@@ -0,0 +1,520 @@
+/*****************************************************************************/
+/**
+ *  @file   VolumeView.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "VolumeView.h"
+#include "MaskedStatistics.h"
+#include <cmath>
+#include <cstring>
+#include <kvs/Math>
+#include <kvs/Value>
+#include <kvs/AnyValueArray>
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the index of the node just before the coordinate.
+ *  @param  coord [in] coordinate
+ *  @param  view [in] volume view
+ *  @param  axis [in] axis
+ *  @return node index along the axis
+ */
+/*===========================================================================*/
+size_t MinIndexOf( const float coord, const kvsoceanvis::util::VolumeView& view, const size_t axis )
+{
+    const size_t size = view.resolution()[axis];
+    if ( coord < view.coord( axis, 0 ) ) { return 0; }
+    if ( view.coord( axis, size - 1 ) <= coord ) { return size - 1; }
+
+    for ( size_t i = 0; i < size - 1; i++ )
+    {
+        if ( view.coord( axis, i ) <= coord && coord < view.coord( axis, i + 1 ) ) { return i; }
+    }
+
+    return size - 1;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the index of the node just after the coordinate.
+ *  @param  coord [in] coordinate
+ *  @param  view [in] volume view
+ *  @param  axis [in] axis
+ *  @return node index along the axis
+ */
+/*===========================================================================*/
+size_t MaxIndexOf( const float coord, const kvsoceanvis::util::VolumeView& view, const size_t axis )
+{
+    size_t index = MinIndexOf( coord, view, axis ) + 1;
+    return kvs::Math::Clamp( index, size_t(0), size_t( view.resolution()[axis] - 1 ) );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if all the components of the scale are one.
+ *  @param  scale [in] scale
+ */
+/*===========================================================================*/
+bool IsOne( const kvs::Vec3& scale )
+{
+    return scale.x() == 1.0f && scale.y() == 1.0f && scale.z() == 1.0f;
+}
+
+} // end of namespace
+
+
+namespace kvsoceanvis
+{
+
+namespace util
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new empty VolumeView class.
+ */
+/*===========================================================================*/
+VolumeView::VolumeView():
+    m_grid_type( kvs::StructuredVolumeObject::Uniform ),
+    m_veclen( 0 ),
+    m_source_resolution( 0, 0, 0 ),
+    m_resolution( 0, 0, 0 ),
+    m_offset( 0 ),
+    m_coord_scale( 1, 1, 1 ),
+    m_coord_translation( 0, 0, 0 ),
+    m_value_scale( 1, 1, 1 ),
+    m_has_min_max_values( false ),
+    m_min_value( 0.0 ),
+    m_max_value( 0.0 )
+{
+    for ( size_t a = 0; a < 3; a++ )
+    {
+        m_steps[a] = 0;
+        m_coord_offsets[a] = 0;
+        m_coord_steps[a] = 0;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new VolumeView class for the whole volume.
+ *  @param  volume [in] pointer to the structured volume object (float values)
+ *
+ *  The value and coordinate arrays are shared with the volume object, so the
+ *  volume object can be deleted while the view is used.
+ */
+/*===========================================================================*/
+VolumeView::VolumeView( const kvs::StructuredVolumeObject* volume ):
+    m_values( volume->values().asValueArray<kvs::Real32>() ),
+    m_coords( volume->coords() ),
+    m_grid_type( volume->gridType() ),
+    m_veclen( volume->veclen() ),
+    m_source_resolution( volume->resolution() ),
+    m_resolution( volume->resolution() ),
+    m_offset( 0 ),
+    m_coord_scale( 1, 1, 1 ),
+    m_coord_translation( 0, 0, 0 ),
+    m_value_scale( 1, 1, 1 ),
+    m_has_min_max_values( true ),
+    m_min_value( volume->minValue() ),
+    m_max_value( volume->maxValue() )
+{
+    const std::ptrdiff_t dimx = static_cast<std::ptrdiff_t>( m_resolution.x() );
+    const std::ptrdiff_t dimy = static_cast<std::ptrdiff_t>( m_resolution.y() );
+    m_steps[0] = 1;
+    m_steps[1] = dimx;
+    m_steps[2] = dimx * dimy;
+    m_coord_offsets[0] = 0;
+    m_coord_offsets[1] = dimx;
+    m_coord_offsets[2] = dimx + dimy;
+    m_coord_steps[0] = 1;
+    m_coord_steps[1] = 1;
+    m_coord_steps[2] = 1;
+}
+
+size_t VolumeView::numberOfNodes() const
+{
+    return size_t( m_resolution.x() ) * m_resolution.y() * m_resolution.z();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the min. coordinates of the view.
+ *  @return coordinates of the first node
+ */
+/*===========================================================================*/
+kvs::Vec3 VolumeView::minCoord() const
+{
+    return kvs::Vec3( this->coord( 0, 0 ), this->coord( 1, 0 ), this->coord( 2, 0 ) );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the max. coordinates of the view.
+ *  @return coordinates of the last node
+ */
+/*===========================================================================*/
+kvs::Vec3 VolumeView::maxCoord() const
+{
+    return kvs::Vec3(
+        this->coord( 0, m_resolution.x() - 1 ),
+        this->coord( 1, m_resolution.y() - 1 ),
+        this->coord( 2, m_resolution.z() - 1 ) );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the view of the sub-volume.
+ *  @param  min_range [in] min. range
+ *  @param  max_range [in] max. range
+ *  @return view of the sub-volume
+ *
+ *  The range is given by the node indices for the uniform grid and by the
+ *  coordinates for the rectilinear grid, where the range is expanded to the
+ *  nearest nodes as well as util::CropVolume.
+ */
+/*===========================================================================*/
+VolumeView VolumeView::crop( const kvs::Vec3& min_range, const kvs::Vec3& max_range ) const
+{
+    size_t min_index[3];
+    size_t max_index[3];
+    if ( m_grid_type == kvs::StructuredVolumeObject::Rectilinear )
+    {
+        const kvs::Vec3 min_coord = this->minCoord();
+        const kvs::Vec3 max_coord = this->maxCoord();
+        for ( size_t a = 0; a < 3; a++ )
+        {
+            const float min_value = kvs::Math::Max( min_range[a], min_coord[a] );
+            const float max_value = kvs::Math::Min( max_range[a], max_coord[a] );
+            min_index[a] = ::MinIndexOf( min_value, *this, a );
+            max_index[a] = ::MaxIndexOf( max_value, *this, a );
+        }
+    }
+    else
+    {
+        for ( size_t a = 0; a < 3; a++ )
+        {
+            min_index[a] = static_cast<size_t>( kvs::Math::Max( min_range[a], 0.0f ) );
+            max_index[a] = static_cast<size_t>( kvs::Math::Min( max_range[a], m_resolution[a] - 1.0f ) );
+        }
+    }
+
+    VolumeView view( *this );
+    for ( size_t a = 0; a < 3; a++ )
+    {
+        max_index[a] = kvs::Math::Max( max_index[a], min_index[a] );
+        view.m_resolution[a] = static_cast<kvs::UInt32>( max_index[a] - min_index[a] + 1 );
+        view.m_offset += static_cast<std::ptrdiff_t>( min_index[a] ) * m_steps[a];
+        view.m_coord_offsets[a] += static_cast<std::ptrdiff_t>( min_index[a] ) * m_coord_steps[a];
+    }
+    view.m_has_min_max_values = false;
+
+    return view;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the view of the nodes sampled with the stride.
+ *  @param  stride [in] stride along the axes
+ *  @return view of the sampled nodes
+ *
+ *  The min/max values are kept as well as ISFV2014::Downsize.
+ */
+/*===========================================================================*/
+VolumeView VolumeView::downsize( const kvs::Vec3ui& stride ) const
+{
+    VolumeView view( *this );
+    for ( size_t a = 0; a < 3; a++ )
+    {
+        const std::ptrdiff_t s = static_cast<std::ptrdiff_t>( kvs::Math::Max( stride[a], kvs::UInt32(1) ) );
+        view.m_resolution[a] = static_cast<kvs::UInt32>( ( m_resolution[a] - 1 ) / s + 1 );
+        view.m_steps[a] *= s;
+        view.m_coord_steps[a] *= s;
+    }
+
+    return view;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the view mirrored along the axes.
+ *  @param  x [in] mirror along the x-axis if true
+ *  @param  y [in] mirror along the y-axis if true
+ *  @param  z [in] mirror along the z-axis if true
+ *  @return mirrored view
+ *
+ *  The order of the nodes is reversed, and the coordinates of the rectilinear
+ *  grid are negated so that they are kept in ascending order (e.g. depth to
+ *  height as the zflip of util::StructuredVolumeImporter).
+ */
+/*===========================================================================*/
+VolumeView VolumeView::flip( const bool x, const bool y, const bool z ) const
+{
+    const bool flips[3] = { x, y, z };
+
+    VolumeView view( *this );
+    for ( size_t a = 0; a < 3; a++ )
+    {
+        if ( !flips[a] ) continue;
+
+        const std::ptrdiff_t last = static_cast<std::ptrdiff_t>( m_resolution[a] ) - 1;
+        view.m_offset += last * m_steps[a];
+        view.m_steps[a] = -m_steps[a];
+        if ( m_grid_type == kvs::StructuredVolumeObject::Rectilinear )
+        {
+            view.m_coord_offsets[a] += last * m_coord_steps[a];
+            view.m_coord_steps[a] = -m_coord_steps[a];
+            view.m_coord_scale[a] = -m_coord_scale[a];
+            view.m_coord_translation[a] = -m_coord_translation[a];
+        }
+    }
+
+    return view;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the view whose coordinates are multiplied by the scale.
+ *  @param  scale [in] scale along the axes (e.g. degree to distance)
+ *  @return scaled view
+ */
+/*===========================================================================*/
+VolumeView VolumeView::scaleCoords( const kvs::Vec3& scale ) const
+{
+    VolumeView view( *this );
+    for ( size_t a = 0; a < 3; a++ )
+    {
+        view.m_coord_scale[a] = m_coord_scale[a] * scale[a];
+        view.m_coord_translation[a] = m_coord_translation[a] * scale[a];
+    }
+
+    return view;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the view whose coordinates are scaled from the first node.
+ *  @param  scale [in] scale along the axes
+ *  @return scaled view
+ *
+ *  The coordinates x are replaced with (x - x0) * scale + x0 as well as
+ *  ISFV2014::Rescale::Coords, where x0 is the coordinate of the first node.
+ */
+/*===========================================================================*/
+VolumeView VolumeView::rescaleCoords( const kvs::Vec3& scale ) const
+{
+    VolumeView view( *this );
+    for ( size_t a = 0; a < 3; a++ )
+    {
+        const kvs::Real32 x0 = this->coord( a, 0 );
+        view.m_coord_scale[a] = m_coord_scale[a] * scale[a];
+        view.m_coord_translation[a] = ( m_coord_translation[a] - x0 ) * scale[a] + x0;
+    }
+
+    return view;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the view whose values are multiplied by the scale.
+ *  @param  scale [in] scale of the vector components (x for the scalar values)
+ *  @return scaled view
+ */
+/*===========================================================================*/
+VolumeView VolumeView::scaleValues( const kvs::Vec3& scale ) const
+{
+    VolumeView view( *this );
+    for ( size_t a = 0; a < 3; a++ ) { view.m_value_scale[a] = m_value_scale[a] * scale[a]; }
+    view.m_has_min_max_values = false;
+
+    return view;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets min/max values.
+ *  @param  min_value [in] min. value
+ *  @param  max_value [in] max. value
+ */
+/*===========================================================================*/
+void VolumeView::setMinMaxValues( const kvs::Real64 min_value, const kvs::Real64 max_value )
+{
+    m_has_min_max_values = true;
+    m_min_value = min_value;
+    m_max_value = max_value;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Updates the min/max values of the nodes in the view.
+ *  @param  horizontal [in] use the magnitude of the horizontal components if true
+ *
+ *  The magnitudes of the vectors are used for the vector volume as well as
+ *  kvs::VolumeObjectBase::updateMinMaxValues (or ISFV2014::Rescale::Values
+ *  for the horizontal components).
+ */
+/*===========================================================================*/
+void VolumeView::updateMinMaxValues( const bool horizontal )
+{
+    const size_t ncomponents = ( m_veclen > 1 && horizontal ) ? 2 : m_veclen;
+
+    kvs::Real64 min_value = kvs::Value<kvs::Real64>::Max();
+    kvs::Real64 max_value = kvs::Value<kvs::Real64>::Min();
+    for ( size_t k = 0; k < m_resolution.z(); k++ )
+    {
+        for ( size_t j = 0; j < m_resolution.y(); j++ )
+        {
+            for ( size_t i = 0; i < m_resolution.x(); i++ )
+            {
+                kvs::Real64 value = 0.0;
+                if ( m_veclen == 1 )
+                {
+                    value = this->value( i, j, k );
+                }
+                else
+                {
+                    for ( size_t c = 0; c < ncomponents; c++ )
+                    {
+                        const kvs::Real64 v = this->value( i, j, k, c );
+                        value += v * v;
+                    }
+                }
+
+                min_value = kvs::Math::Min( value, min_value );
+                max_value = kvs::Math::Max( value, max_value );
+            }
+        }
+    }
+
+    if ( m_veclen > 1 )
+    {
+        min_value = std::sqrt( min_value );
+        max_value = std::sqrt( max_value );
+    }
+
+    this->setMinMaxValues( min_value, max_value );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the view is the whole volume without scaling.
+ *  @return true if the value array can be shared with the materialized volume
+ */
+/*===========================================================================*/
+bool VolumeView::isContiguous() const
+{
+    return m_resolution.x() == m_source_resolution.x() &&
+        m_resolution.y() == m_source_resolution.y() &&
+        m_resolution.z() == m_source_resolution.z() &&
+        m_offset == 0 &&
+        m_steps[0] == 1 &&
+        m_steps[1] == static_cast<std::ptrdiff_t>( m_source_resolution.x() ) &&
+        m_steps[2] == static_cast<std::ptrdiff_t>( m_source_resolution.x() ) * m_source_resolution.y() &&
+        ::IsOne( m_value_scale );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Copies the nodes in the view to the structured volume object.
+ *  @param  object [out] pointer to the structured volume object
+ *  @param  statistics [in/out] statistics updated with the copied values (optional)
+ *
+ *  The value array is shared without copying if the view is contiguous.
+ *  If the statistics is given, it is updated in the same pass as the copy,
+ *  and its min/max values are set to the scalar volume object.
+ */
+/*===========================================================================*/
+void VolumeView::copyTo( kvs::StructuredVolumeObject* object, util::MaskedStatistics* statistics ) const
+{
+    const size_t dimx = m_resolution.x();
+    const size_t dimy = m_resolution.y();
+    const size_t dimz = m_resolution.z();
+
+    kvs::ValueArray<kvs::Real32> values;
+    if ( this->isContiguous() )
+    {
+        values = m_values;
+        if ( statistics ) { statistics->update( values ); }
+    }
+    else
+    {
+        values.allocate( dimx * dimy * dimz * m_veclen );
+        kvs::Real32* dst = values.data();
+        const kvs::Real32* src = m_values.data();
+        const std::ptrdiff_t step = m_steps[0] * static_cast<std::ptrdiff_t>( m_veclen );
+        const bool scaled = !::IsOne( m_value_scale );
+        for ( size_t k = 0; k < dimz; k++ )
+        {
+            for ( size_t j = 0; j < dimy; j++ )
+            {
+                const kvs::Real32* line = src + this->nodeIndex( 0, j, k ) * m_veclen;
+                if ( m_steps[0] == 1 && !scaled )
+                {
+                    if ( statistics ) { statistics->copy( line, dimx * m_veclen, dst ); }
+                    else { std::memcpy( dst, line, dimx * m_veclen * sizeof( kvs::Real32 ) ); }
+                    dst += dimx * m_veclen;
+                    continue;
+                }
+
+                for ( size_t i = 0; i < dimx; i++, line += step )
+                {
+                    for ( size_t c = 0; c < m_veclen; c++ )
+                    {
+                        *(dst++) = line[c] * this->component_scale( c );
+                    }
+                }
+                if ( statistics ) { statistics->update( dst - dimx * m_veclen, dimx * m_veclen ); }
+            }
+        }
+    }
+
+    object->setGridType( m_grid_type );
+    object->setResolution( m_resolution );
+    object->setVeclen( m_veclen );
+    object->setValues( kvs::AnyValueArray( values ) );
+
+    if ( m_grid_type == kvs::StructuredVolumeObject::Rectilinear )
+    {
+        kvs::ValueArray<kvs::Real32> coords( dimx + dimy + dimz );
+        kvs::Real32* dst = coords.data();
+        for ( size_t i = 0; i < dimx; i++ ) { *(dst++) = this->coord( 0, i ); }
+        for ( size_t j = 0; j < dimy; j++ ) { *(dst++) = this->coord( 1, j ); }
+        for ( size_t k = 0; k < dimz; k++ ) { *(dst++) = this->coord( 2, k ); }
+        object->setCoords( coords );
+    }
+
+    if ( statistics && m_veclen == 1 ) { object->setMinMaxValues( statistics->minValue(), statistics->maxValue() ); }
+    else if ( m_has_min_max_values ) { object->setMinMaxValues( m_min_value, m_max_value ); }
+    else { object->updateMinMaxValues(); }
+    object->updateMinMaxCoords();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the structured volume object of the nodes in the view.
+ *  @return pointer to the new structured volume object
+ */
+/*===========================================================================*/
+kvs::StructuredVolumeObject* VolumeView::materialize() const
+{
+    kvs::StructuredVolumeObject* object = new kvs::StructuredVolumeObject();
+    this->copyTo( object );
+    return object;
+}
+
+} // end of namespace util
+
+} // end of namespace kvsoceanvis
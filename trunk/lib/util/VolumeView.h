@@ -0,0 +1,172 @@
+/*****************************************************************************/
+/**
+ *  @file   VolumeView.h
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVSOCEANVIS__UTIL__VOLUME_VIEW_H_INCLUDE
+#define KVSOCEANVIS__UTIL__VOLUME_VIEW_H_INCLUDE
+
+#include <cstddef>
+#include <kvs/Type>
+#include <kvs/Vector3>
+#include <kvs/ValueArray>
+#include <kvs/StructuredVolumeObject>
+
+
+namespace kvsoceanvis
+{
+
+namespace util
+{
+
+class MaskedStatistics;
+
+/*===========================================================================*/
+/**
+ *  @brief  Strided view of the structured volume.
+ *
+ *  The view shares the value and coordinate arrays of the volume object, and
+ *  the sub-volumes (crop), the sampled volumes (downsize), the mirrored axes
+ *  (flip) and the scaled coordinates/values (rescale) are represented by the
+ *  node offset, the signed node steps along the axes and the scale factors
+ *  without copying the values. The view is materialized as the structured
+ *  volume object by copyTo() or materialize() when it is needed.
+ *
+ *  The coordinates of the rectilinear grid are given by scale * coord +
+ *  translation for the coordinates in the shared array, and the coordinates
+ *  of the uniform grid are given by the node indices of the view.
+ */
+/*===========================================================================*/
+class VolumeView
+{
+public:
+
+    typedef kvs::StructuredVolumeObject::GridType GridType;
+
+private:
+
+    kvs::ValueArray<kvs::Real32> m_values; ///< shared value array
+    kvs::ValueArray<kvs::Real32> m_coords; ///< shared coordinate array (rectilinear grid)
+    GridType m_grid_type; ///< grid type
+    size_t m_veclen; ///< vector length
+    kvs::Vec3ui m_source_resolution; ///< resolution of the shared arrays
+    kvs::Vec3ui m_resolution; ///< resolution of the view
+    std::ptrdiff_t m_offset; ///< node offset of the first node
+    std::ptrdiff_t m_steps[3]; ///< node steps along the axes
+    std::ptrdiff_t m_coord_offsets[3]; ///< offsets of the first coordinates along the axes
+    std::ptrdiff_t m_coord_steps[3]; ///< coordinate steps along the axes
+    kvs::Vec3 m_coord_scale; ///< scale of the coordinates
+    kvs::Vec3 m_coord_translation; ///< translation of the coordinates
+    kvs::Vec3 m_value_scale; ///< scale of the vector components (or the scalar)
+    bool m_has_min_max_values; ///< true if the min/max values are given
+    kvs::Real64 m_min_value; ///< min. value
+    kvs::Real64 m_max_value; ///< max. value
+
+public:
+
+    VolumeView();
+    explicit VolumeView( const kvs::StructuredVolumeObject* volume );
+
+public:
+
+    GridType gridType() const { return m_grid_type; }
+    size_t veclen() const { return m_veclen; }
+    const kvs::Vec3ui& resolution() const { return m_resolution; }
+    size_t numberOfNodes() const;
+    bool hasMinMaxValues() const { return m_has_min_max_values; }
+    kvs::Real64 minValue() const { return m_min_value; }
+    kvs::Real64 maxValue() const { return m_max_value; }
+
+    size_t nodeIndex( const size_t i, const size_t j, const size_t k ) const;
+    kvs::Real32 value( const size_t i, const size_t j, const size_t k, const size_t c = 0 ) const;
+    kvs::Real32 coord( const size_t axis, const size_t index ) const;
+    kvs::Vec3 minCoord() const;
+    kvs::Vec3 maxCoord() const;
+
+    VolumeView crop( const kvs::Vec3& min_range, const kvs::Vec3& max_range ) const;
+    VolumeView downsize( const kvs::Vec3ui& stride ) const;
+    VolumeView flip( const bool x, const bool y, const bool z ) const;
+    VolumeView scaleCoords( const kvs::Vec3& scale ) const;
+    VolumeView rescaleCoords( const kvs::Vec3& scale ) const;
+    VolumeView scaleValues( const kvs::Vec3& scale ) const;
+
+    void setMinMaxValues( const kvs::Real64 min_value, const kvs::Real64 max_value );
+    void updateMinMaxValues( const bool horizontal = false );
+
+    bool isContiguous() const;
+    void copyTo( kvs::StructuredVolumeObject* object, util::MaskedStatistics* statistics = NULL ) const;
+    kvs::StructuredVolumeObject* materialize() const;
+
+private:
+
+    kvs::Real32 component_scale( const size_t c ) const;
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the index of the node in the shared value array.
+ *  @param  i [in] node index along the x-axis of the view
+ *  @param  j [in] node index along the y-axis of the view
+ *  @param  k [in] node index along the z-axis of the view
+ *  @return node index in the shared array
+ */
+/*===========================================================================*/
+inline size_t VolumeView::nodeIndex( const size_t i, const size_t j, const size_t k ) const
+{
+    return static_cast<size_t>(
+        m_offset +
+        static_cast<std::ptrdiff_t>( i ) * m_steps[0] +
+        static_cast<std::ptrdiff_t>( j ) * m_steps[1] +
+        static_cast<std::ptrdiff_t>( k ) * m_steps[2] );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the scaled value at the node.
+ *  @param  i [in] node index along the x-axis of the view
+ *  @param  j [in] node index along the y-axis of the view
+ *  @param  k [in] node index along the z-axis of the view
+ *  @param  c [in] component index
+ *  @return value
+ */
+/*===========================================================================*/
+inline kvs::Real32 VolumeView::value( const size_t i, const size_t j, const size_t k, const size_t c ) const
+{
+    return m_values.data()[ this->nodeIndex( i, j, k ) * m_veclen + c ] * this->component_scale( c );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the coordinate of the node along the axis.
+ *  @param  axis [in] axis (0: x, 1: y, 2: z)
+ *  @param  index [in] node index along the axis of the view
+ *  @return coordinate
+ */
+/*===========================================================================*/
+inline kvs::Real32 VolumeView::coord( const size_t axis, const size_t index ) const
+{
+    const std::ptrdiff_t n = m_coord_offsets[axis] + static_cast<std::ptrdiff_t>( index ) * m_coord_steps[axis];
+    const kvs::Real32 x = m_grid_type == kvs::StructuredVolumeObject::Rectilinear ?
+        m_coords.data()[n] : static_cast<kvs::Real32>( index );
+    return m_coord_scale[axis] * x + m_coord_translation[axis];
+}
+
+inline kvs::Real32 VolumeView::component_scale( const size_t c ) const
+{
+    return m_value_scale[ c < 3 ? c : 0 ];
+}
+
+} // end of namespace util
+
+} // end of namespace kvsoceanvis
+
+#endif // KVSOCEANVIS__UTIL__VOLUME_VIEW_H_INCLUDE
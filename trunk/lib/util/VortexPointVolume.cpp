@@ -229,6 +229,19 @@ VortexPointVolume::VortexPointVolume( const kvs::StructuredVolumeObject* volume,
     this->exec( volume );
 }
 
+VortexPointVolume::VortexPointVolume( const util::VolumeView& view ):
+    m_has_ignore_value( false ),
+    m_ignore_value( 0.0f )
+{
+    this->compute( view );
+}
+
+VortexPointVolume::VortexPointVolume( const util::VolumeView& view, const float ignore_value )
+{
+    this->setIgnoreValue( ignore_value );
+    this->compute( view );
+}
+
 void VortexPointVolume::setIgnoreValue( const float ignore_value )
 {
     m_has_ignore_value = true;
@@ -239,146 +252,77 @@ VortexPointVolume::SuperClass* VortexPointVolume::exec( const kvs::ObjectBase* o
 {
     const kvs::StructuredVolumeObject* volume = kvs::StructuredVolumeObject::DownCast( object );
 
-    const size_t dimx = volume->resolution().x();
-    const size_t dimy = volume->resolution().y();
-    const size_t dimz = volume->resolution().z();
+    this->compute( util::VolumeView( volume ) );
+    SuperClass::setMinMaxObjectCoords( volume->minObjectCoord(), volume->maxObjectCoord() );
+    SuperClass::setMinMaxExternalCoords( volume->minExternalCoord(), volume->maxExternalCoord() );
+
+    return this;
+}
+
+VortexPointVolume::SuperClass* VortexPointVolume::compute( const util::VolumeView& view )
+{
+    const size_t dimx = view.resolution().x();
+    const size_t dimy = view.resolution().y();
+    const size_t dimz = view.resolution().z();
 
     std::vector<float> coords;
     std::vector<float> values;
 
-    const size_t veclen = volume->veclen();
-    const float* pvalues = static_cast<const float*>( volume->values().data() );
-    if ( volume->gridType() == kvs::StructuredVolumeObject::Uniform )
+    // The node coordinates are given by the indices for the uniform grid and
+    // by the coordinates of the view for the rectilinear grid.
+    for ( size_t k = 0; k < dimz - 1; k++ )
     {
-        for ( size_t k = 0; k < dimz - 1; k++ )
+        const float z0 = view.coord( 2, k );
+        const float zdiff = view.coord( 2, k + 1 ) - z0;
+        for ( size_t j = 0; j < dimy - 1; j++ )
         {
-            const float z0 = k;
-
-            for ( size_t j = 0; j < dimy - 1; j++ )
+            const float y0 = view.coord( 1, j );
+            const float ydiff = view.coord( 1, j + 1 ) - y0;
+            for ( size_t i = 0; i < dimx - 1; i++ )
             {
-                const float y0 = j;
-                for ( size_t i = 0; i < dimx - 1; i++ )
+                const float x0 = view.coord( 0, i );
+                const float xdiff = view.coord( 0, i + 1 ) - x0;
+
+                /*  p2 ------- p3
+                 *   |         |    p0: (x0, y0)
+                 *   |         |    p1: (x1, y1)
+                 *   |         |    p2: (x2, y2)
+                 *  p0 ------- p1   p3: (x3, y3)
+                 */
+
+                float data[24];
+                float* u = data + 0;
+                float* v = data + 8;
+                float* w = data + 16;
+                for ( size_t a = 0; a < 8; ++a )
                 {
-                    const float x0 = i;
-
-                    /*  p2 ------- p3
-                     *   |         |    p0: (x0, y0)
-                     *   |         |    p1: (x1, y1)
-                     *   |         |    p2: (x2, y2)
-                     *  p0 ------- p1   p3: (x3, y3)
-                     */
-
-                    size_t index[8];
-                    index[0] = i + dimx * j + dimx * dimy * k;  // index of (x0, y0) dimx * j + i
-                    index[1] = index[0] + 1;    // index of (x1, y0)
-                    index[2] = index[0] + dimx; // index of (x0, y1)
-                    index[3] = index[2] + 1;    // index of (x1, y1)
-                    index[4] = index[0] + dimx * dimy; // index of (x1, y1)
-                    index[5] = index[4] + 1;    // index of (x1, y1)
-                    index[6] = index[4] + dimx; // index of (x1, y1)
-                    index[7] = index[6] + 1;    // index of (x1, y1)
-
-                    float data[24];
-                    float* u = data + 0;
-                    float* v = data + 8;
-                    float* w = data + 16;
-                    for (size_t a = 0; a < 8; ++a)
-                    {
-                        u[a] = pvalues[ index[a] * veclen + 0 ];
-                        v[a] = pvalues[ index[a] * veclen + 1 ];
-                        w[a] = pvalues[ index[a] * veclen + 2 ];
-                    }
-                    if ( this->include_ignore_value( data ) ) continue;
-
-                    kvs::Vector3f local;
-                    kvs::Matrix33f tensor;
-                    if ( ::FindVortexPoint( data, &local, &tensor ) )
-                    {
-                        kvs::Vector3f global = kvs::Vector3f(x0,y0,z0) + local;
-                        coords.push_back( global[0] );
-                        coords.push_back( global[1] );
-                        coords.push_back( global[2] );
-                        values.push_back( tensor[0][0] );
-                        values.push_back( tensor[0][1] );
-                        values.push_back( tensor[0][2] );
-                        values.push_back( tensor[1][0] );
-                        values.push_back( tensor[1][1] );
-                        values.push_back( tensor[1][2] );
-                        values.push_back( tensor[2][0] );
-                        values.push_back( tensor[2][1] );
-                        values.push_back( tensor[2][2] );
-                    }
+                    const size_t ii = i + ( a & 1 );
+                    const size_t jj = j + ( ( a >> 1 ) & 1 );
+                    const size_t kk = k + ( ( a >> 2 ) & 1 );
+                    u[a] = view.value( ii, jj, kk, 0 );
+                    v[a] = view.value( ii, jj, kk, 1 );
+                    w[a] = view.value( ii, jj, kk, 2 );
                 }
-            }
-        }
-    }
-    else if ( kvs::StructuredVolumeObject::Rectilinear )
-    {
-        const kvs::Real32* xcoords = volume->coords().pointer();
-        const kvs::Real32* ycoords = xcoords + volume->resolution().x();
-        const kvs::Real32* zcoords = ycoords + volume->resolution().y();
+                if ( this->include_ignore_value( data ) ) continue;
 
-        for ( size_t k = 0; k < dimz - 1; k++ )
-        {
-            const float z0 = zcoords[ k ];
-            const float zdiff = zcoords[ k + 1 ] - zcoords[ k ];
-            for ( size_t j = 0; j < dimy - 1; j++ )
-            {
-                const float y0 = ycoords[ j ];
-                const float ydiff = ycoords[ j + 1 ] - ycoords[ j ];
-                for ( size_t i = 0; i < dimx - 1; i++ )
+                kvs::Vector3f local;
+                kvs::Matrix33f tensor;
+                if ( ::FindVortexPoint( data, &local, &tensor ) )
                 {
-                    const float x0 = xcoords[ i ];
-                    const float xdiff = xcoords[ i + 1 ] - xcoords[ i ];
-
-                    /*  p2 ------- p3
-                     *   |         |    p0: (x0, y0)
-                     *   |         |    p1: (x1, y1)
-                     *   |         |    p2: (x2, y2)
-                     *  p0 ------- p1   p3: (x3, y3)
-                     */
-
-                    size_t index[8];
-                    index[0] = i + dimx * j + dimx * dimy * k;  // index of (x0, y0) dimx * j + i
-                    index[1] = index[0] + 1;    // index of (x1, y0)
-                    index[2] = index[0] + dimx; // index of (x0, y1)
-                    index[3] = index[2] + 1;    // index of (x1, y1)
-                    index[4] = index[0] + dimx * dimy; // index of (x1, y1)
-                    index[5] = index[4] + 1;    // index of (x1, y1)
-                    index[6] = index[4] + dimx; // index of (x1, y1)
-                    index[7] = index[6] + 1;    // index of (x1, y1)
-
-                    float data[24];
-                    float* u = data + 0;
-                    float* v = data + 8;
-                    float* w = data + 16;
-                    for (size_t a = 0; a < 8; ++a)
-                    {
-                        u[a] = pvalues[ index[a] * veclen + 0 ];
-                        v[a] = pvalues[ index[a] * veclen + 1 ];
-                        w[a] = pvalues[ index[a] * veclen + 2 ];
-                    }
-                    if ( this->include_ignore_value( data ) ) continue;
-
-                    kvs::Vector3f local;
-                    kvs::Matrix33f tensor;
-                    if ( ::FindVortexPoint( data, &local, &tensor ) )
-                    {
-                        kvs::Vector3f d = kvs::Vector3f( local.x() * xdiff, local.y() * ydiff, local.z() * zdiff );
-                        kvs::Vector3f global = kvs::Vector3f(x0,y0,z0) + d;
-                        coords.push_back( global[0] );
-                        coords.push_back( global[1] );
-                        coords.push_back( global[2] );
-                        values.push_back( tensor[0][0] );
-                        values.push_back( tensor[0][1] );
-                        values.push_back( tensor[0][2] );
-                        values.push_back( tensor[1][0] );
-                        values.push_back( tensor[1][1] );
-                        values.push_back( tensor[1][2] );
-                        values.push_back( tensor[2][0] );
-                        values.push_back( tensor[2][1] );
-                        values.push_back( tensor[2][2] );
-                    }
+                    kvs::Vector3f d = kvs::Vector3f( local.x() * xdiff, local.y() * ydiff, local.z() * zdiff );
+                    kvs::Vector3f global = kvs::Vector3f(x0,y0,z0) + d;
+                    coords.push_back( global[0] );
+                    coords.push_back( global[1] );
+                    coords.push_back( global[2] );
+                    values.push_back( tensor[0][0] );
+                    values.push_back( tensor[0][1] );
+                    values.push_back( tensor[0][2] );
+                    values.push_back( tensor[1][0] );
+                    values.push_back( tensor[1][1] );
+                    values.push_back( tensor[1][2] );
+                    values.push_back( tensor[2][0] );
+                    values.push_back( tensor[2][1] );
+                    values.push_back( tensor[2][2] );
                 }
             }
         }
@@ -390,8 +334,8 @@ VortexPointVolume::SuperClass* VortexPointVolume::exec( const kvs::ObjectBase* o
     SuperClass::setNumberOfCells( coords.size() / 3 );
     SuperClass::setCoords( kvs::ValueArray<float>( coords ) );
     SuperClass::setValues( kvs::AnyValueArray( kvs::ValueArray<float>( values ) ) );
-    SuperClass::setMinMaxObjectCoords( volume->minObjectCoord(), volume->maxObjectCoord() );
-    SuperClass::setMinMaxExternalCoords( volume->minExternalCoord(), volume->maxExternalCoord() );
+    SuperClass::setMinMaxObjectCoords( view.minCoord(), view.maxCoord() );
+    SuperClass::setMinMaxExternalCoords( view.minCoord(), view.maxCoord() );
 
     return this;
 }
@@ -21,6 +21,7 @@
 #include <kvs/FilterBase>
 #include <kvs/ClassName>
 #include <kvs/Module>
+#include "VolumeView.h"
 
 
 namespace kvsoceanvis
@@ -48,6 +49,8 @@ public:
 
     VortexPointVolume( const kvs::StructuredVolumeObject* volume );
     VortexPointVolume( const kvs::StructuredVolumeObject* volume, const float ignore_value );
+    VortexPointVolume( const util::VolumeView& view );
+    VortexPointVolume( const util::VolumeView& view, const float ignore_value );
 
     void setIgnoreValue( const float ignore_value );
 
@@ -55,6 +58,7 @@ public:
 
 private:
 
+    SuperClass* compute( const util::VolumeView& view );
     bool include_ignore_value( const float* values ) const;
 };
 
@@ -26,71 +26,62 @@ Vorticity::Vorticity( const kvs::StructuredVolumeObject* volume )
     this->exec( volume );
 }
 
+Vorticity::Vorticity( const util::VolumeView& view )
+{
+    this->compute( view );
+}
+
 Vorticity::SuperClass* Vorticity::exec( const kvs::ObjectBase* object )
 {
     const kvs::StructuredVolumeObject* volume = kvs::StructuredVolumeObject::DownCast( object );
+    return this->compute( util::VolumeView( volume ) );
+}
 
-    if ( volume->veclen() != 3 )
+Vorticity::SuperClass* Vorticity::compute( const util::VolumeView& view )
+{
+    if ( view.veclen() != 3 )
     {
         kvsMessageError( "Input volume is not vector volume." );
         return NULL;
     }
 
-    if ( volume->gridType() != kvs::StructuredVolumeObject::Uniform )
+    if ( view.gridType() != kvs::StructuredVolumeObject::Uniform )
     {
         kvsMessageError( "Input volume is not uniform grid." );
         return NULL;
     }
 
-    const kvs::Real32* src_values = static_cast<const kvs::Real32*>( volume->values().data() );
-    const kvs::Vector3ui resolution = volume->resolution();
-    const kvs::UInt32 line_size = volume->numberOfNodesPerLine();
-    const kvs::UInt32 slice_size = volume->numberOfNodesPerSlice();
-    const size_t veclen = volume->veclen();
-
-//    kvs::AnyValueArray values;
-//    kvs::Real32* pvalues = static_cast<kvs::Real32*>( values.allocate<kvs::Real32>( volume->values().size() ) );
-    kvs::ValueArray<kvs::Real32> values( volume->values().size() );
+    // The values are read through the view, so the sub-volume or the flipped
+    // volume can be given without copying.
+    // NOTE: The derivatives along the z-axis are evaluated at the first node
+    // of the slice and the ones along the y-axis at the first node of the line
+    // as well as the previous implementation.
+    const kvs::Vector3ui resolution = view.resolution();
+    kvs::ValueArray<kvs::Real32> values( view.numberOfNodes() * 3 );
     kvs::Real32* pvalues = values.data();
-    size_t index = 0;
     for ( size_t k = 0; k < resolution.z(); k++ )
     {
-        const int k0 = ( k == 0 ) ? 0 : -slice_size;
-        const int k1 = ( k == resolution.z() - 1 ) ? 0 : +slice_size;
-
-        const float u0z = src_values[ ( index + k0 ) * veclen + 0 ];
-        const float u1z = src_values[ ( index + k1 ) * veclen + 0 ];
-        const float dudz = ( u1z - u0z ) / 2.0f;
+        const size_t k0 = ( k == 0 ) ? k : k - 1;
+        const size_t k1 = ( k == resolution.z() - 1 ) ? k : k + 1;
 
-        const float v0z = src_values[ ( index + k0 ) * veclen + 1 ];
-        const float v1z = src_values[ ( index + k1 ) * veclen + 1 ];
-        const float dvdz = ( v1z - v0z ) / 2.0f;
+        const float dudz = ( view.value( 0, 0, k1, 0 ) - view.value( 0, 0, k0, 0 ) ) / 2.0f;
+        const float dvdz = ( view.value( 0, 0, k1, 1 ) - view.value( 0, 0, k0, 1 ) ) / 2.0f;
 
         for ( size_t j = 0; j < resolution.y(); j++ )
         {
-            const int j0 = ( j == 0 ) ? 0 : -line_size;
-            const int j1 = ( j == resolution.y() - 1 ) ? 0 : +line_size;
+            const size_t j0 = ( j == 0 ) ? j : j - 1;
+            const size_t j1 = ( j == resolution.y() - 1 ) ? j : j + 1;
 
-            const float u0y = src_values[ ( index + j0 ) * veclen + 0 ];
-            const float u1y = src_values[ ( index + j1 ) * veclen + 0 ];
-            const float dudy = ( u1y - u0y ) / 2.0f;
+            const float dudy = ( view.value( 0, j1, k, 0 ) - view.value( 0, j0, k, 0 ) ) / 2.0f;
+            const float dwdy = ( view.value( 0, j1, k, 2 ) - view.value( 0, j0, k, 2 ) ) / 2.0f;
 
-            const float w0y = src_values[ ( index + j0 ) * veclen + 2 ];
-            const float w1y = src_values[ ( index + j1 ) * veclen + 2 ];
-            const float dwdy = ( w1y - w0y ) / 2.0f;
-
-            for ( size_t i = 0; i < resolution.x(); i++, index++ )
+            for ( size_t i = 0; i < resolution.x(); i++ )
             {
-                const int i0 = ( i == 0 ) ? 0 : -1;
-                const int i1 = ( i == resolution.x() - 1 ) ? 0 : +1;
-
-                const float v0x = src_values[ ( index + i0 ) * veclen + 1 ];
-                const float v1x = src_values[ ( index + i1 ) * veclen + 1 ];
-                const float dvdx = ( v1x - v0x ) / 2.0f;
+                const size_t i0 = ( i == 0 ) ? i : i - 1;
+                const size_t i1 = ( i == resolution.x() - 1 ) ? i : i + 1;
 
-                const float w0x = src_values[ ( index + i0 ) * veclen + 2 ];
-                const float w1x = src_values[ ( index + i1 ) * veclen + 2 ];
-                const float dwdx = ( w1x - w0x ) / 2.0f;
+                const float dvdx = ( view.value( i1, j, k, 1 ) - view.value( i0, j, k, 1 ) ) / 2.0f;
+                const float dwdx = ( view.value( i1, j, k, 2 ) - view.value( i0, j, k, 2 ) ) / 2.0f;
 
                 *(pvalues++) = dwdy - dvdz;
                 *(pvalues++) = dudz - dwdx;
@@ -99,9 +90,9 @@ Vorticity::SuperClass* Vorticity::exec( const kvs::ObjectBase* object )
         }
     }
 
-    SuperClass::setGridType( volume->gridType() );
-    SuperClass::setResolution( volume->resolution() );
-    SuperClass::setVeclen( volume->veclen() );
+    SuperClass::setGridType( view.gridType() );
+    SuperClass::setResolution( resolution );
+    SuperClass::setVeclen( 3 );
     SuperClass::setValues( kvs::AnyValueArray( values ) );
     SuperClass::updateMinMaxValues();
     SuperClass::updateMinMaxCoords();
@@ -19,6 +19,7 @@
 #include <kvs/FilterBase>
 #include <kvs/ClassName>
 #include <kvs/Module>
+#include "VolumeView.h"
 
 
 namespace kvsoceanvis
@@ -40,8 +41,13 @@ class Vorticity : public kvs::FilterBase, public kvs::StructuredVolumeObject
 public:
 
     Vorticity( const kvs::StructuredVolumeObject* volume );
+    Vorticity( const util::VolumeView& view );
 
     SuperClass* exec( const kvs::ObjectBase* object );
+
+private:
+
+    SuperClass* compute( const util::VolumeView& view );
 };
 
 } // end of namespace util
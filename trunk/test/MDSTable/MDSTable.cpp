@@ -14,6 +14,7 @@ extern"C"
 }
 
 
+#include <pcs/DistanceMatrix.h>
 #include "MDSTable.h"
 
 namespace mds
@@ -48,38 +49,20 @@ namespace mds
         return output;
     }
 
-    kvs::ValueArray<kvs::Real32> MDSTable::GetRowArray(const kvs::TableObject* table, const size_t i)
-    {
-        kvs::ValueArray<kvs::Real32> row( table->ncolumns() );
-        const size_t ncolumns = table->ncolumns();
-        for ( size_t j = 0; j < ncolumns; j++ )
-        {
-            row[j] = table->column(j).to<kvs::Real32>(i);
-        }
-        return row;
-    }
-
-    kvs::Real32 MDSTable::GetEuclideanDistance(const kvs::ValueArray<kvs::Real32>& x0, const kvs::ValueArray<kvs::Real32>& x1)
-    {
-        kvs::Real32 distance = 0.0f;
-        const size_t nrows = x0.size();
-        for ( size_t i = 0; i < nrows; i++ )
-        {
-            const kvs::Real32 diff = x1[i] - x0[i];
-            distance += diff * diff;
-        }
-        return distance;
-    }
-
     void MDSTable::DSMatrix(const kvs::TableObject& input, double output[])
     {
         size_t n = m_nrows;
-        memset(output, 0, n*n*sizeof(double));
-        for (size_t i=1; i<n; i++)
+        kvsoceanvis::pcs::DistanceMatrix distance;
+        if (!distance.compute(&input))
+        {
+            std::cerr << "Error: Cannot compute the distance matrix." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i=0; i<n; i++)
         {
-            for (size_t j=0; j<i; j++)
+            for (size_t j=i; j<n; j++)
             {
-                output[i*n+j] = sqrt(MDSTable::GetEuclideanDistance(MDSTable::GetRowArray(&input, i), MDSTable::GetRowArray(&input, j)));
+                output[i*n+j] = distance.at(i, j);
                 output[j*n+i] = output[i*n+j];
             }
         }
@@ -15,8 +15,6 @@ private:
 
     size_t m_nrows; // number of input rows
 
-    kvs::ValueArray<kvs::Real32> GetRowArray(const kvs::TableObject* table, const size_t i);
-    kvs::Real32 GetEuclideanDistance(const kvs::ValueArray<kvs::Real32>& x0, const kvs::ValueArray<kvs::Real32>& x1);
     void DSMatrix(const kvs::TableObject& input, double output[]);
     void IPMatrix(const double input[], double output[]);
     kvs::TableObject OutputTable(double input[]);
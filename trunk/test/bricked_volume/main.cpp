@@ -0,0 +1,149 @@
+/*****************************************************************************/
+/**
+ *  @file   main.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+/**
+ *  Converts a variable of the GrADS data into the bricked volume file, and
+ *  compares the bricked file with the GrADS data in the imported values and
+ *  the import times of the whole volume and the sub-region.
+ *
+ *  Usage:
+ *    ./bricked_volume <ctl file> [-o output] [-v vindex] [-t tindex]
+ *                     [-brick N]
+ */
+/*****************************************************************************/
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <kvs/GrADS>
+#include <kvs/Timer>
+#include <kvs/File>
+#include <kvs/StructuredVolumeObject>
+#include <util/StructuredVolumeImporter.h>
+#include <util/BrickedVolumeFile.h>
+
+using namespace kvsoceanvis;
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the values of the volumes are identical.
+ *  @param  volume0 [in] pointer to the volume object
+ *  @param  volume1 [in] pointer to the volume object
+ *  @return true if the values are identical bit by bit
+ */
+/*===========================================================================*/
+bool Identical( const kvs::StructuredVolumeObject* volume0, const kvs::StructuredVolumeObject* volume1 )
+{
+    const kvs::ValueArray<kvs::Real32> values0 = volume0->values().asValueArray<kvs::Real32>();
+    const kvs::ValueArray<kvs::Real32> values1 = volume1->values().asValueArray<kvs::Real32>();
+    return values0.size() == values1.size() &&
+        std::memcmp( values0.data(), values1.data(), values0.size() * sizeof( kvs::Real32 ) ) == 0;
+}
+
+} // end of namespace
+
+
+int main( int argc, char** argv )
+{
+    if ( argc < 2 )
+    {
+        std::cerr << "Usage: " << argv[0] << " <ctl file> [-o output] [-v vindex] [-t tindex] [-brick N]" << std::endl;
+        return 1;
+    }
+
+    std::string output( kvs::File( argv[1] ).baseName() + ".kbv" );
+    size_t vindex = 0;
+    size_t tindex = 0;
+    size_t brick_size = 32;
+    for ( int i = 2; i + 1 < argc; i += 2 )
+    {
+        const std::string option( argv[i] );
+        const std::string value( argv[i+1] );
+        if ( option == "-o" ) { output = value; }
+        else if ( option == "-v" ) { vindex = std::atoi( value.c_str() ); }
+        else if ( option == "-t" ) { tindex = std::atoi( value.c_str() ); }
+        else if ( option == "-brick" ) { brick_size = std::atoi( value.c_str() ); }
+        else { std::cerr << "Unknown option " << option << "." << std::endl; return 1; }
+    }
+
+    kvs::GrADS data( argv[1] );
+    const kvs::Real32 undef_value = data.dataDescriptor().undef().value;
+
+    // Conversion (the values and coordinates are stored without flipping).
+    kvs::Timer timer;
+    timer.start();
+    const kvs::StructuredVolumeObject::GridType grid_type = kvs::StructuredVolumeObject::Rectilinear;
+    kvs::StructuredVolumeObject* volume = new util::StructuredVolumeImporter( &data, vindex, tindex, false, grid_type );
+    timer.stop();
+    std::cout << "Import GrADS data:    " << timer.msec() << " [msec]" << std::endl;
+
+    timer.start();
+    if ( !util::BrickedVolumeFile::Write( output, volume, undef_value, brick_size ) ) return 1;
+    timer.stop();
+    std::cout << "Write bricked volume: " << timer.msec() << " [msec]" << std::endl;
+
+    util::BrickedVolumeFile file( output );
+    if ( !file.isOpen() ) return 1;
+
+    const size_t raw_size = volume->numberOfNodes() * sizeof( kvs::Real32 );
+    const size_t file_size = kvs::File( output ).byteSize();
+    std::cout << "Bricks:               " << file.numberOfBricks() << " (" << brick_size << "^3)" << std::endl;
+    std::cout << "Size:                 " << file_size << " / " << raw_size << " [bytes]"
+              << " (ratio " << double( raw_size ) / file_size << ")" << std::endl;
+
+    // Whole volume (flipped along the z-axis as the ISFV2014 applications).
+    const bool zflip = true;
+    timer.start();
+    kvs::StructuredVolumeObject* grads_volume = new util::StructuredVolumeImporter( &data, vindex, tindex, zflip, grid_type );
+    timer.stop();
+    std::cout << "Whole (GrADS):        " << timer.msec() << " [msec]" << std::endl;
+
+    timer.start();
+    kvs::StructuredVolumeObject* bricked_volume = new util::StructuredVolumeImporter( &file, zflip, grid_type );
+    timer.stop();
+    std::cout << "Whole (bricked):      " << timer.msec() << " [msec] "
+              << ( ::Identical( grads_volume, bricked_volume ) ? "identical" : "DIFFERENT" ) << std::endl;
+
+    // Sub-region around the Kuroshio current.
+    const kvs::Vec3 min_range( 141, 33, -1000 ); // in (deg, deg, meter)
+    const kvs::Vec3 max_range( 147, 43, 0 ); // in (deg, deg, meter)
+    timer.start();
+    kvs::StructuredVolumeObject* grads_region = new util::StructuredVolumeImporter( &data, min_range, max_range, vindex, tindex, zflip, grid_type );
+    timer.stop();
+    std::cout << "Region (GrADS):       " << timer.msec() << " [msec]" << std::endl;
+
+    timer.start();
+    kvs::StructuredVolumeObject* bricked_region = new util::StructuredVolumeImporter( &file, min_range, max_range, zflip, grid_type );
+    timer.stop();
+    std::cout << "Region (bricked):     " << timer.msec() << " [msec] "
+              << ( ::Identical( grads_region, bricked_region ) ? "identical" : "DIFFERENT" ) << std::endl;
+
+    // Bricks culled for an isosurface of the middle value.
+    const kvs::Real32 isovalue = ( file.minValue() + file.maxValue() ) * 0.5f;
+    std::cout << "Active bricks:        " << file.activeBricks( isovalue ).size() << " / " << file.numberOfBricks()
+              << " (isovalue " << isovalue << ")" << std::endl;
+
+    const bool identical = ::Identical( grads_volume, bricked_volume ) && ::Identical( grads_region, bricked_region );
+    delete volume;
+    delete grads_volume;
+    delete bricked_volume;
+    delete grads_region;
+    delete bricked_region;
+
+    return identical ? 0 : 1;
+}
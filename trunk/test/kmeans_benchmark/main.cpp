@@ -0,0 +1,232 @@
+/*****************************************************************************/
+/**
+ *  @file   main.cpp
+ *  @brief  Benchmark of the k-means clustering with the kd-tree filtering
+ *          algorithm, Hamerly's algorithm and the Yinyang algorithm.
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  FilteringKMeansClustering, FastKMeansClustering and YinyangKMeansClustering
+ *  are executed for the same table with the same initial centers for each
+ *  combination of the number of clusters and the number of columns. The
+ *  results are written to stdout as one JSON object per line, e.g.
+ *
+ *  {"method":"filtering","rows":100000,"columns":4,"clusters":16,"runs":3,
+ *   "min_msec":12.3,"median_msec":12.5,"sse":1.23e+08}
+ *
+ *  The sum of squared errors (sse) is written to check that the methods
+ *  converge to the same clustering.
+ *
+ *  Usage:
+ *    ./kmeans_benchmark [-method all|filtering|hamerly|yinyang] [-rows N]
+ *                       [-columns N]... [-clusters N]... [-runs N]
+ *                       [-seeding random|smart] [-leaf N] [-groups N]
+ */
+/*****************************************************************************/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <kvs/Timer>
+#include <kvs/TableObject>
+#include <pcs/FastKMeansClustering.h>
+#include <pcs/FilteringKMeansClustering.h>
+#include <pcs/YinyangKMeansClustering.h>
+#include <util/CreateRandomTable.h>
+
+using namespace kvsoceanvis;
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Benchmark parameters given by the command line.
+ */
+/*===========================================================================*/
+struct Parameters
+{
+    std::string target; ///< benchmark method ("all" for every method)
+    size_t nrows; ///< number of rows of the synthetic table
+    std::vector<size_t> ncolumns; ///< numbers of columns of the synthetic table
+    std::vector<size_t> nclusters; ///< numbers of clusters
+    size_t nruns; ///< number of measured runs
+    bool smart_seeding; ///< use the smart seeding instead of the random seeding
+    size_t leaf_size; ///< maximum number of rows in a leaf node of the kd-tree
+    size_t ngroups; ///< number of groups of the centers for Yinyang (0: automatic)
+
+    Parameters():
+        target( "all" ),
+        nrows( 100000 ),
+        nruns( 3 ),
+        smart_seeding( false ),
+        leaf_size( 16 ),
+        ngroups( 0 ) {}
+
+    bool parse( int argc, char** argv )
+    {
+        for ( int i = 1; i < argc; i++ )
+        {
+            const std::string option( argv[i] );
+            if ( i + 1 >= argc ) { std::cerr << "Missing value for " << option << std::endl; return false; }
+
+            const std::string value( argv[++i] );
+            if ( option == "-method" ) { target = value; }
+            else if ( option == "-rows" ) { nrows = std::atoi( value.c_str() ); }
+            else if ( option == "-columns" ) { ncolumns.push_back( std::atoi( value.c_str() ) ); }
+            else if ( option == "-clusters" ) { nclusters.push_back( std::atoi( value.c_str() ) ); }
+            else if ( option == "-runs" ) { nruns = std::atoi( value.c_str() ); }
+            else if ( option == "-seeding" ) { smart_seeding = ( value == "smart" ); }
+            else if ( option == "-leaf" ) { leaf_size = std::atoi( value.c_str() ); }
+            else if ( option == "-groups" ) { ngroups = std::atoi( value.c_str() ); }
+            else
+            {
+                std::cerr << "Unknown option " << option << "." << std::endl;
+                return false;
+            }
+        }
+
+        if ( ncolumns.empty() )
+        {
+            const size_t n[] = { 2, 3, 4, 6, 8 };
+            ncolumns.assign( n, n + sizeof(n) / sizeof(n[0]) );
+        }
+
+        if ( nclusters.empty() )
+        {
+            const size_t n[] = { 4, 16, 64, 256 };
+            nclusters.assign( n, n + sizeof(n) / sizeof(n[0]) );
+        }
+
+        return nrows > 0 && nruns > 0;
+    }
+
+    bool run( const std::string& name ) const
+    {
+        return target == "all" || target == name;
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the sum of squared errors of the clustering.
+ *  @param  object [in] clustered table (the last column is the cluster IDs)
+ *  @param  centers [in] cluster centers
+ *  @return sum of squared errors
+ */
+/*===========================================================================*/
+double SumOfSquaredErrors( const kvs::TableObject* object, const std::vector< kvs::ValueArray<kvs::Real32> >& centers )
+{
+    const size_t nrows = object->numberOfRows();
+    const size_t ncolumns = object->numberOfColumns() - 1;
+    const kvs::AnyValueArray& ids = object->column( ncolumns );
+
+    double sse = 0.0;
+    for ( size_t i = 0; i < nrows; i++ )
+    {
+        const kvs::ValueArray<kvs::Real32>& center = centers[ ids.at<kvs::UInt32>(i) ];
+        for ( size_t k = 0; k < ncolumns; k++ )
+        {
+            const double d = object->column(k).at<double>(i) - center[k];
+            sse += d * d;
+        }
+    }
+
+    return sse;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets the method specific parameters.
+ *  @param  clustering [in] pointer to the clustering
+ *  @param  params [in] benchmark parameters
+ */
+/*===========================================================================*/
+void Setup( pcs::FilteringKMeansClustering* clustering, const ::Parameters& params )
+{
+    clustering->setLeafSize( params.leaf_size );
+}
+
+void Setup( pcs::FastKMeansClustering*, const ::Parameters& )
+{
+}
+
+void Setup( pcs::YinyangKMeansClustering* clustering, const ::Parameters& params )
+{
+    clustering->setNumberOfGroups( params.ngroups );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Runs the benchmark for the clustering method.
+ *  @param  name [in] method name
+ *  @param  params [in] benchmark parameters
+ *  @param  table [in] pointer to the input table
+ *  @param  nclusters [in] number of clusters
+ */
+/*===========================================================================*/
+template <typename Clustering>
+void Run( const std::string& name, const ::Parameters& params, const kvs::TableObject* table, const size_t nclusters )
+{
+    std::vector<double> msecs;
+    double sse = 0.0;
+    for ( size_t i = 0; i < params.nruns; i++ )
+    {
+        Clustering* clustering = new Clustering();
+        clustering->setSeedingMethod( params.smart_seeding ? Clustering::SmartSeeding : Clustering::RandomSeeding );
+        clustering->setNumberOfClusters( nclusters );
+        clustering->setSeed( 0 );
+        ::Setup( clustering, params );
+
+        kvs::Timer timer;
+        timer.start();
+        clustering->exec( table );
+        timer.stop();
+        msecs.push_back( timer.msec() );
+
+        std::vector< kvs::ValueArray<kvs::Real32> > centers;
+        for ( size_t j = 0; j < nclusters; j++ ) { centers.push_back( clustering->center(j) ); }
+        sse = ::SumOfSquaredErrors( clustering, centers );
+
+        delete clustering;
+    }
+
+    std::sort( msecs.begin(), msecs.end() );
+    const size_t n = msecs.size();
+    const double min_msec = msecs[0];
+    const double median_msec = ( n % 2 ) ? msecs[n/2] : 0.5 * ( msecs[n/2-1] + msecs[n/2] );
+
+    std::cout << "{\"method\":\"" << name << "\""
+              << ",\"rows\":" << table->numberOfRows()
+              << ",\"columns\":" << table->numberOfColumns()
+              << ",\"clusters\":" << nclusters
+              << ",\"runs\":" << n
+              << ",\"min_msec\":" << min_msec
+              << ",\"median_msec\":" << median_msec
+              << ",\"sse\":" << sse
+              << "}" << std::endl;
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    ::Parameters params;
+    if ( !params.parse( argc, argv ) ) return 1;
+
+    for ( size_t c = 0; c < params.ncolumns.size(); c++ )
+    {
+        const kvs::TableObject table = util::CreateRandomTable( params.nrows, params.ncolumns[c], 0 );
+        for ( size_t k = 0; k < params.nclusters.size(); k++ )
+        {
+            const size_t nclusters = params.nclusters[k];
+            if ( params.run( "filtering" ) ) ::Run<pcs::FilteringKMeansClustering>( "filtering", params, &table, nclusters );
+            if ( params.run( "hamerly" ) ) ::Run<pcs::FastKMeansClustering>( "hamerly", params, &table, nclusters );
+            if ( params.run( "yinyang" ) ) ::Run<pcs::YinyangKMeansClustering>( "yinyang", params, &table, nclusters );
+        }
+    }
+
+    return 0;
+}
@@ -4,13 +4,23 @@ import sys
 import os
 
 
+#=============================================================================
+#  Directories which are not built by default since they require optional
+#  libraries (render_benchmark: OSMesa). Build them with 'kvsmake' in each
+#  directory, or give 'all' as the second argument.
+#=============================================================================
+OPTIONAL_DIRECTORIES = [ 'render_benchmark' ]
+
 #=============================================================================
 #  Returns a list of target directories.
 #=============================================================================
-def GetDirectoryList( find_path ):
+def GetDirectoryList( find_path, with_optional = False ):
     list = []
     for root, dirs, files in os.walk( find_path ):
 
+        if not with_optional:
+            dirs[:] = [ d for d in dirs if not d in OPTIONAL_DIRECTORIES ]
+
         for filename in files:
 
             file_path = os.path.join( root, filename )
@@ -36,7 +46,7 @@ def KVSMake( dir_list, option ):
     elif option == 'rebuild': make_option = "kvsmake rebuild" + s
     else:
         print( "Error: Unknown option '" + option +"'" )
-        print( "Usage: python kvsmake.py [clean | distclean | rebuild]" )
+        print( "Usage: python kvsmake.py [build | clean | distclean | rebuild] [all]" )
         sys.exit()
 
     curdir = os.getcwd()
@@ -52,9 +62,11 @@ def KVSMake( dir_list, option ):
 #  Main process.
 #=============================================================================
 if __name__=='__main__':
-    dir_list = GetDirectoryList( '.' )
-
     argc = len( sys.argv )
     argv = sys.argv
+    with_optional = argc == 3 and argv[2] == 'all'
+    dir_list = GetDirectoryList( '.', with_optional )
+
     if   argc == 1: KVSMake( dir_list, 'build' )
     elif argc == 2: KVSMake( dir_list, argv[1] )
+    elif with_optional: KVSMake( dir_list, argv[1] )
@@ -0,0 +1,566 @@
+/*****************************************************************************/
+/**
+ *  @file   main.cpp
+ *  @author Naohisa Sakamoto
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+/**
+ *  Verifies the error bound of util::ErrorBoundedCodec on the synthetic ocean
+ *  fields (temperature, salinity and current velocity with the land mask),
+ *  and measures the compression ratio and the throughputs of the encoding and
+ *  decoding of the blocks in parallel. The bricked volume file and the table
+ *  column compressed within the tolerance are verified as well, and the table
+ *  written with the compressed columns is read back by the out-of-core table.
+ *
+ *  Usage:
+ *    ./lossy_codec [-r nx ny nz] [-block N]
+ */
+/*****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <kvs/Type>
+#include <kvs/Vector3>
+#include <kvs/ValueArray>
+#include <kvs/Timer>
+#include <kvs/Math>
+#include <kvs/AnyValueArray>
+#include <kvs/TableObject>
+#include <util/ErrorBoundedCodec.h>
+#include <util/LosslessCodec.h>
+#include <util/BrickedVolumeFile.h>
+#include <util/MaskedStatistics.h>
+#include <util/TableObjectWriter.h>
+#include <pcs/OutOfCoreTableImporter.h>
+
+using namespace kvsoceanvis;
+
+
+namespace
+{
+
+const kvs::Real32 UndefValue = -9.99e33f; // undefined value of the land cells
+const kvs::Real32 MaxDepth = 5000.0f; // depth of the deepest level in meter
+
+/*===========================================================================*/
+/**
+ *  @brief  Block of the volume.
+ */
+/*===========================================================================*/
+struct Block
+{
+    kvs::Vec3ui min_index; ///< min. node index of the block
+    kvs::Vec3ui resolution; ///< resolution of the block
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns a uniform random number in [-1,1) (deterministic LCG).
+ *  @param  seed [in/out] seed
+ *  @return random number
+ */
+/*===========================================================================*/
+inline kvs::Real32 Noise( kvs::UInt32& seed )
+{
+    seed = seed * 1664525u + 1013904223u;
+    return kvs::Real32( seed >> 8 ) / kvs::Real32( 1 << 23 ) - 1.0f;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the depth of the sea floor.
+ *  @param  x [in] normalized longitude in [0,1]
+ *  @param  y [in] normalized latitude in [0,1]
+ *  @return depth in meter (negative on the land)
+ */
+/*===========================================================================*/
+inline kvs::Real32 FloorDepth( const kvs::Real32 x, const kvs::Real32 y )
+{
+    // Continent along the western boundary with a wavy coast, an island and
+    // the continental slope.
+    const kvs::Real32 coast = 0.15f + 0.05f * std::sin( 12.0f * y );
+    const kvs::Real32 dx = x - 0.6f;
+    const kvs::Real32 dy = y - 0.4f;
+    const kvs::Real32 island = 0.08f - std::sqrt( dx * dx + 2.0f * dy * dy );
+    const kvs::Real32 shelf = ( x - coast ) * 6.0f;
+    const kvs::Real32 depth = MaxDepth * kvs::Math::Min( shelf, 1.0f ) - MaxDepth * 4.0f * kvs::Math::Max( island, 0.0f );
+    return island > 0.02f ? -1.0f : depth;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Generates the synthetic ocean field.
+ *  @param  name [in] field name ("temperature", "salinity" or "velocity")
+ *  @param  resolution [in] resolution of the field
+ *  @return values (x-fastest order, the land cells are undefined)
+ */
+/*===========================================================================*/
+std::vector<kvs::Real32> Field( const std::string& name, const kvs::Vec3ui& resolution )
+{
+    const size_t nx = resolution.x();
+    const size_t ny = resolution.y();
+    const size_t nz = resolution.z();
+    std::vector<kvs::Real32> values( nx * ny * nz );
+
+    kvs::UInt32 seed = 12345;
+    size_t index = 0;
+    for ( size_t k = 0; k < nz; k++ )
+    {
+        // The levels are dense near the surface.
+        const kvs::Real32 t = nz > 1 ? kvs::Real32( k ) / ( nz - 1 ) : 0.0f;
+        const kvs::Real32 depth = MaxDepth * t * t;
+        for ( size_t j = 0; j < ny; j++ )
+        {
+            const kvs::Real32 y = ny > 1 ? kvs::Real32( j ) / ( ny - 1 ) : 0.0f;
+            for ( size_t i = 0; i < nx; i++, index++ )
+            {
+                const kvs::Real32 x = nx > 1 ? kvs::Real32( i ) / ( nx - 1 ) : 0.0f;
+                if ( depth >= ::FloorDepth( x, y ) )
+                {
+                    values[ index ] = ::UndefValue;
+                    continue;
+                }
+
+                // Mesoscale eddies decaying with the depth.
+                const kvs::Real32 eddy = std::sin( 20.0f * x + 3.0f * y ) * std::cos( 15.0f * y - 2.0f * x );
+                if ( name == "temperature" )
+                {
+                    values[ index ] = 2.0f + 26.0f * ( 1.0f - 0.6f * y ) * std::exp( -depth / 500.0f )
+                        + 1.5f * eddy * std::exp( -depth / 800.0f ) + 0.005f * ::Noise( seed );
+                }
+                else if ( name == "salinity" )
+                {
+                    values[ index ] = 34.7f + 0.6f * ( 0.5f - y ) * std::exp( -depth / 300.0f )
+                        + 0.1f * eddy * std::exp( -depth / 800.0f ) + 0.0005f * ::Noise( seed );
+                }
+                else
+                {
+                    values[ index ] = 0.8f * eddy * std::exp( -depth / 1000.0f ) + 0.002f * ::Noise( seed );
+                }
+            }
+        }
+    }
+
+    return values;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the blocks dividing the volume.
+ *  @param  resolution [in] resolution of the volume
+ *  @param  block_size [in] number of the nodes along an edge of the block
+ *  @return blocks
+ */
+/*===========================================================================*/
+std::vector<Block> Blocks( const kvs::Vec3ui& resolution, const size_t block_size )
+{
+    std::vector<Block> blocks;
+    for ( size_t k = 0; k < resolution.z(); k += block_size )
+    {
+        for ( size_t j = 0; j < resolution.y(); j += block_size )
+        {
+            for ( size_t i = 0; i < resolution.x(); i += block_size )
+            {
+                Block block;
+                block.min_index = kvs::Vec3ui( i, j, k );
+                block.resolution = kvs::Vec3ui(
+                    kvs::Math::Min( block_size, size_t( resolution.x() - i ) ),
+                    kvs::Math::Min( block_size, size_t( resolution.y() - j ) ),
+                    kvs::Math::Min( block_size, size_t( resolution.z() - k ) ) );
+                blocks.push_back( block );
+            }
+        }
+    }
+    return blocks;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Copies the values between the volume and the block.
+ *  @param  volume [in/out] pointer to the values of the volume
+ *  @param  resolution [in] resolution of the volume
+ *  @param  block [in] block
+ *  @param  values [in/out] pointer to the values of the block
+ *  @param  to_block [in] true: volume to block, false: block to volume
+ */
+/*===========================================================================*/
+void Copy(
+    kvs::Real32* volume,
+    const kvs::Vec3ui& resolution,
+    const Block& block,
+    kvs::Real32* values,
+    const bool to_block )
+{
+    const size_t bx = block.resolution.x();
+    for ( size_t k = 0; k < block.resolution.z(); k++ )
+    {
+        for ( size_t j = 0; j < block.resolution.y(); j++ )
+        {
+            const size_t offset =
+                ( ( block.min_index.z() + k ) * resolution.y() + block.min_index.y() + j ) * resolution.x() + block.min_index.x();
+            kvs::Real32* line = values + ( k * block.resolution.y() + j ) * bx;
+            if ( to_block ) std::memcpy( line, volume + offset, bx * sizeof( kvs::Real32 ) );
+            else std::memcpy( volume + offset, line, bx * sizeof( kvs::Real32 ) );
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the max. error, or -1 if the error bound is violated.
+ *  @param  values [in] original values
+ *  @param  decoded [in] decoded values
+ *  @param  nvalues [in] number of the values
+ *  @param  tolerance [in] absolute error tolerance
+ *  @return max. error of the defined values (-1: the bound is violated)
+ *
+ *  The undefined values have to be decoded exactly.
+ */
+/*===========================================================================*/
+double MaxError( const kvs::Real32* values, const kvs::Real32* decoded, const size_t nvalues, const kvs::Real32 tolerance )
+{
+    double max_error = 0.0;
+    for ( size_t i = 0; i < nvalues; i++ )
+    {
+        if ( values[i] == ::UndefValue )
+        {
+            if ( std::memcmp( values + i, decoded + i, sizeof( kvs::Real32 ) ) != 0 ) return -1.0;
+            continue;
+        }
+
+        const double error = std::fabs( double( decoded[i] ) - double( values[i] ) );
+        if ( !( error <= tolerance ) ) return -1.0;
+        max_error = kvs::Math::Max( max_error, error );
+    }
+    return max_error;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the number of the bytes of the blocks compressed losslessly.
+ *  @param  values [in] values of the volume
+ *  @param  resolution [in] resolution of the volume
+ *  @param  blocks [in] blocks
+ *  @return number of the bytes
+ */
+/*===========================================================================*/
+size_t LosslessSize( std::vector<kvs::Real32>& values, const kvs::Vec3ui& resolution, const std::vector<Block>& blocks )
+{
+    size_t size = 0;
+    const kvs::Int64 end = static_cast<kvs::Int64>( blocks.size() );
+    #pragma omp parallel for schedule(dynamic) reduction(+:size)
+    for ( kvs::Int64 b = 0; b < end; b++ )
+    {
+        const Block& block = blocks[b];
+        std::vector<kvs::Real32> buffer( size_t( block.resolution.x() ) * block.resolution.y() * block.resolution.z() );
+        ::Copy( &values[0], resolution, block, &buffer[0], true );
+
+        std::vector<kvs::UInt8> stream;
+        util::LosslessCodec::Encode( &buffer[0], buffer.size(), &stream );
+        size += stream.size();
+    }
+    return size;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Tests the codec on the field with the tolerance.
+ *  @param  name [in] field name
+ *  @param  values [in] values of the field
+ *  @param  resolution [in] resolution of the field
+ *  @param  blocks [in] blocks
+ *  @param  tolerance [in] absolute error tolerance
+ *  @return true if the error bound is satisfied
+ */
+/*===========================================================================*/
+bool Test(
+    const std::string& name,
+    std::vector<kvs::Real32>& values,
+    const kvs::Vec3ui& resolution,
+    const std::vector<Block>& blocks,
+    const kvs::Real32 tolerance )
+{
+    const kvs::Int64 end = static_cast<kvs::Int64>( blocks.size() );
+    std::vector< std::vector<kvs::UInt8> > streams( blocks.size() );
+
+    // Encode the blocks in parallel.
+    kvs::Timer timer;
+    timer.start();
+    #pragma omp parallel for schedule(dynamic)
+    for ( kvs::Int64 b = 0; b < end; b++ )
+    {
+        const Block& block = blocks[b];
+        std::vector<kvs::Real32> buffer( size_t( block.resolution.x() ) * block.resolution.y() * block.resolution.z() );
+        ::Copy( &values[0], resolution, block, &buffer[0], true );
+        util::ErrorBoundedCodec::Encode( &buffer[0], block.resolution, tolerance, ::UndefValue, &streams[b] );
+    }
+    timer.stop();
+    const double encode_msec = timer.msec();
+
+    // Decode the blocks in parallel.
+    std::vector<kvs::Real32> decoded( values.size() );
+    bool succeeded = true;
+    timer.start();
+    #pragma omp parallel for schedule(dynamic)
+    for ( kvs::Int64 b = 0; b < end; b++ )
+    {
+        const Block& block = blocks[b];
+        std::vector<kvs::Real32> buffer( size_t( block.resolution.x() ) * block.resolution.y() * block.resolution.z() );
+        if ( !util::ErrorBoundedCodec::Decode( &streams[b][0], streams[b].size(), &buffer[0], block.resolution ) )
+        {
+            #pragma omp critical
+            {
+                succeeded = false;
+            }
+            continue;
+        }
+        ::Copy( &decoded[0], resolution, block, &buffer[0], false );
+    }
+    timer.stop();
+    const double decode_msec = timer.msec();
+
+    size_t size = 0;
+    for ( size_t b = 0; b < streams.size(); b++ ) size += streams[b].size();
+
+    const double max_error = succeeded ? ::MaxError( &values[0], &decoded[0], values.size(), tolerance ) : -1.0;
+    const double megabytes = values.size() * sizeof( kvs::Real32 ) / ( 1024.0 * 1024.0 );
+    std::cout << std::setw( 12 ) << name
+              << std::setw( 12 ) << tolerance
+              << std::setw( 10 ) << std::setprecision( 4 ) << double( values.size() * sizeof( kvs::Real32 ) ) / size
+              << std::setw( 14 ) << max_error
+              << std::setw( 12 ) << megabytes / ( encode_msec * 0.001 )
+              << std::setw( 12 ) << megabytes / ( decode_msec * 0.001 )
+              << "  " << ( max_error >= 0.0 ? "ok" : "VIOLATED" ) << std::endl;
+
+    return max_error >= 0.0;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Tests the bricked volume file and the table column within the tolerance.
+ *  @param  values [in] values of the field
+ *  @param  resolution [in] resolution of the field
+ *  @param  block_size [in] number of the nodes along an edge of the brick
+ *  @param  tolerance [in] absolute error tolerance
+ *  @return true if the error bound is satisfied
+ */
+/*===========================================================================*/
+bool TestFiles(
+    std::vector<kvs::Real32>& values,
+    const kvs::Vec3ui& resolution,
+    const size_t block_size,
+    const kvs::Real32 tolerance )
+{
+    kvs::ValueArray<kvs::Real32> array( values.size() );
+    std::copy( values.begin(), values.end(), array.begin() );
+
+    // Volume (e.g. archived time step of the volume cache).
+    const std::string volume_file( "lossy_codec_volume.kbv" );
+    bool passed = util::BrickedVolumeFile::Write( volume_file, array, resolution, ::UndefValue, block_size, tolerance );
+    if ( passed )
+    {
+        util::BrickedVolumeFile file( volume_file );
+        std::vector<kvs::Real32> decoded( values.size() );
+        const kvs::Vec3ui max_index( resolution.x() - 1, resolution.y() - 1, resolution.z() - 1 );
+        passed = file.isOpen() &&
+            file.codec() == util::BrickedVolumeFile::ErrorBounded &&
+            file.readRegion( kvs::Vec3ui( 0, 0, 0 ), max_index, &decoded[0] ) &&
+            ::MaxError( &values[0], &decoded[0], values.size(), tolerance ) >= 0.0;
+    }
+    std::cout << "Bricked volume file:  " << ( passed ? "ok" : "VIOLATED" ) << std::endl;
+    std::remove( volume_file.c_str() );
+
+    // Column of the out-of-core table (nrows x 1 x 1 values).
+    const std::string column_file( "lossy_codec_column.kbv" );
+    const kvs::Vec3ui column_resolution( static_cast<unsigned int>( values.size() ), 1, 1 );
+    bool column_passed = util::BrickedVolumeFile::Write( column_file, array, column_resolution, ::UndefValue, 65536, tolerance );
+    if ( column_passed )
+    {
+        util::BrickedVolumeFile file( column_file );
+        const size_t nrows = kvs::Math::Min( values.size(), size_t( 100000 ) );
+        const size_t first = values.size() - nrows;
+        std::vector<kvs::Real32> decoded( nrows );
+        const kvs::Vec3ui min_index( static_cast<unsigned int>( first ), 0, 0 );
+        const kvs::Vec3ui max_index( static_cast<unsigned int>( values.size() - 1 ), 0, 0 );
+        column_passed = file.isOpen() &&
+            file.coords().size() == 0 &&
+            file.readRegion( min_index, max_index, &decoded[0] ) &&
+            ::MaxError( &values[ first ], &decoded[0], nrows, tolerance ) >= 0.0;
+    }
+    std::cout << "Compressed column:    " << ( column_passed ? "ok" : "VIOLATED" ) << std::endl;
+    std::remove( column_file.c_str() );
+
+    return passed && column_passed;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Tests the table written with the compressed columns.
+ *  @param  values [in] values of the field
+ *  @param  tolerance [in] absolute error tolerance
+ *  @return true if the values are read back within the tolerance
+ *
+ *  The float column is compressed by util::TableObjectWriter, and the table
+ *  is imported by pcs::OutOfCoreTableImporter and read by column(), readRows()
+ *  and readValue(). The int column is written in the binary format and has
+ *  to be read back exactly.
+ */
+/*===========================================================================*/
+bool TestTable( const std::vector<kvs::Real32>& values, const kvs::Real32 tolerance )
+{
+    const size_t nrows = kvs::Math::Min( values.size(), size_t( 300000 ) );
+    kvs::ValueArray<kvs::Real32> field( nrows );
+    kvs::ValueArray<kvs::Int32> index( nrows );
+    for ( size_t i = 0; i < nrows; i++ )
+    {
+        field[i] = values[i];
+        index[i] = static_cast<kvs::Int32>( i );
+    }
+
+    kvs::TableObject table;
+    table.addColumn( kvs::AnyValueArray( field ), "field" );
+    table.addColumn( kvs::AnyValueArray( index ), "index" );
+
+    const std::string filename( "lossy_codec_table.kvsml" );
+    util::TableObjectWriter writer( &table );
+    writer.enableCompression( tolerance, ::UndefValue );
+    writer.write( filename );
+
+    pcs::OutOfCoreTableImporter* imported = new pcs::OutOfCoreTableImporter( filename );
+    bool passed =
+        imported->numberOfRows() == nrows &&
+        imported->numberOfColumns() == 2 &&
+        imported->columnFormat(0) == "compressed" &&
+        imported->columnFormat(1) == "binary";
+
+    // Whole column.
+    if ( passed )
+    {
+        const kvs::AnyValueArray column = imported->column(0);
+        passed = column.size() == nrows &&
+            ::MaxError( &values[0], static_cast<const kvs::Real32*>( column.data() ), nrows, tolerance ) >= 0.0;
+    }
+
+    imported->openColumnFiles();
+
+    // Rows read in the blocks across the compressed blocks of the column.
+    const size_t block_size = 50000;
+    std::vector<kvs::Real32> rows( block_size * 2 );
+    std::vector<kvs::Real32> decoded( nrows );
+    for ( size_t begin = 0; passed && begin < nrows; begin += block_size )
+    {
+        const size_t n = kvs::Math::Min( block_size, nrows - begin );
+        passed = imported->readRows( begin, n, &rows[0] );
+        for ( size_t i = 0; passed && i < n; i++ )
+        {
+            decoded[ begin + i ] = rows[ i * 2 ];
+            passed = rows[ i * 2 + 1 ] == static_cast<kvs::Real32>( begin + i );
+        }
+    }
+    passed = passed && ::MaxError( &values[0], &decoded[0], nrows, tolerance ) >= 0.0;
+
+    // Values read one by one.
+    for ( size_t i = 0; passed && i < nrows; i++ )
+    {
+        decoded[i] = static_cast<kvs::Real32>( imported->readValue( i, 0 ) );
+        passed = imported->readValue( i, 1 ) == static_cast<kvs::Real64>( i );
+    }
+    passed = passed && ::MaxError( &values[0], &decoded[0], nrows, tolerance ) >= 0.0;
+
+    imported->closeColumnFiles();
+    delete imported;
+
+    std::cout << "Compressed table:     " << ( passed ? "ok" : "VIOLATED" ) << std::endl;
+    std::remove( filename.c_str() );
+    std::remove( "lossy_codec_table_field.kbv" );
+    std::remove( "lossy_codec_table_index.dat" );
+
+    return passed;
+}
+
+} // end of namespace
+
+
+int main( int argc, char** argv )
+{
+    kvs::Vec3ui resolution( 256, 192, 40 );
+    size_t block_size = 32;
+    for ( int i = 1; i < argc; i++ )
+    {
+        const std::string option( argv[i] );
+        if ( option == "-r" && i + 3 < argc )
+        {
+            resolution = kvs::Vec3ui( std::atoi( argv[i+1] ), std::atoi( argv[i+2] ), std::atoi( argv[i+3] ) );
+            i += 3;
+        }
+        else if ( option == "-block" && i + 1 < argc )
+        {
+            block_size = std::atoi( argv[++i] );
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [-r nx ny nz] [-block N]" << std::endl;
+            return 1;
+        }
+    }
+
+    if ( resolution.x() * resolution.y() * resolution.z() == 0 || block_size == 0 )
+    {
+        std::cerr << "Non-zero resolution and block size are required." << std::endl;
+        return 1;
+    }
+
+    const std::vector< ::Block > blocks = ::Blocks( resolution, block_size );
+    std::cout << "Resolution: " << resolution.x() << " x " << resolution.y() << " x " << resolution.z()
+              << ", blocks: " << blocks.size() << " (" << block_size << "^3)" << std::endl;
+    std::cout << std::setw( 12 ) << "field"
+              << std::setw( 12 ) << "tolerance"
+              << std::setw( 10 ) << "ratio"
+              << std::setw( 14 ) << "max error"
+              << std::setw( 12 ) << "enc [MB/s]"
+              << std::setw( 12 ) << "dec [MB/s]" << std::endl;
+
+    // The tolerances are relative to the value ranges of the fields.
+    const char* names[] = { "temperature", "salinity", "velocity" };
+    const kvs::Real32 relative_tolerances[] = { 1.0e-2f, 1.0e-3f, 1.0e-4f };
+    bool passed = true;
+    for ( size_t i = 0; i < 3; i++ )
+    {
+        std::vector<kvs::Real32> values = ::Field( names[i], resolution );
+        util::MaskedStatistics statistics( ::UndefValue );
+        statistics.update( &values[0], values.size() );
+        const kvs::Real32 difference = statistics.maxValue() - statistics.minValue();
+        const kvs::Real32 range = difference > 0.0f ? difference : 1.0f; // e.g. all land cells
+
+        const size_t lossless_size = ::LosslessSize( values, resolution, blocks );
+        std::cout << std::setw( 12 ) << names[i]
+                  << std::setw( 12 ) << "lossless"
+                  << std::setw( 10 ) << std::setprecision( 4 ) << double( values.size() * sizeof( kvs::Real32 ) ) / lossless_size
+                  << std::endl;
+
+        for ( size_t j = 0; j < 3; j++ )
+        {
+            const kvs::Real32 tolerance = relative_tolerances[j] * range;
+            if ( !::Test( names[i], values, resolution, blocks, tolerance ) ) passed = false;
+        }
+
+        if ( i == 0 && !::TestFiles( values, resolution, block_size, relative_tolerances[1] * range ) ) passed = false;
+        if ( i == 0 && !::TestTable( values, relative_tolerances[1] * range ) ) passed = false;
+    }
+
+    std::cout << ( passed ? "All error bounds are satisfied." : "Error bound is VIOLATED." ) << std::endl;
+    return passed ? 0 : 1;
+}
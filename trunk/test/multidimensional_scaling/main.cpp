@@ -1,6 +1,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <cstdlib>
 #include <kvs/Timer>
 #include <kvs/TableImporter>
 #include <kvs/ScatterPlotRenderer>
@@ -45,8 +46,11 @@ int main( int argc, char** argv )
         kvs::TableObject* table = new kvs::TableImporter( argv[1] );
         timer.stop();
 
+        // Number of landmarks (0: classical MDS for all the rows).
+        const size_t nlandmarks = argc > 2 ? std::atoi( argv[2] ) : 0;
+
         timer.start("Multidimensional scaling");
-        object = new pcs::MultiDimensionalScaling( table );
+        object = new pcs::MultiDimensionalScaling( table, nlandmarks );
         delete table;
         timer.stop();
     }
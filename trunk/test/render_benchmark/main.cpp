@@ -0,0 +1,477 @@
+/*****************************************************************************/
+/**
+ *  @file   main.cpp
+ *  @brief  Offscreen rendering benchmark for the PCP renderers and the
+ *          ISFV2014 glyph/line pipelines.
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  The benchmark renders into an OSMesa context, so it does not require a
+ *  window system and can be run in CI with Mesa's software rasterizer.
+ *  The results are written to stdout as one JSON object per line, e.g.
+ *
+ *  {"case":"multibin","width":512,"height":512,"frames":100,
+ *   "primitives":12345,"min_msec":1.2,"median_msec":1.3,"p99_msec":1.8,
+ *   "primitives_per_sec":9.4e+06}
+ *
+ *  The primitives are counted as the quads for the bin/cluster PCP cases,
+ *  the glyphs for the arrow case and the line vertices for the streamline
+ *  case.
+ *
+ *  Since OSMesa is optional, the benchmark is not built by test/kvsmake.py
+ *  by default. Build it with 'kvsmake' in this directory, or with
+ *  'python kvsmake.py build all' in the test directory.
+ *
+ *  Usage:
+ *    ./render_benchmark [-case all|multibin|cluster|arrow|streamline]
+ *                       [-frames N] [-warmup N] [-size WxH]...
+ *                       [-table file] [-rows N] [-columns N] [-clusters N]
+ *                       [-grid N] [-lod threshold]
+ */
+/*****************************************************************************/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <GL/osmesa.h>
+#include <kvs/OpenGL>
+#include <kvs/Timer>
+#include <kvs/Camera>
+#include <kvs/Light>
+#include <kvs/TableObject>
+#include <kvs/TableImporter>
+#include <kvs/StructuredVolumeObject>
+#include <kvs/PointObject>
+#include <kvs/LineObject>
+#include <kvs/LineRenderer>
+#include <kvs/TransferFunction>
+#include <kvs/RGBFormulae>
+#include <pcs/MultiBinMapping.h>
+#include <pcs/MultiBinMappedParallelCoordinatesRenderer.h>
+#include <pcs/FastKMeansClustering.h>
+#include <pcs/ClusterMapping.h>
+#include <pcs/ClusterMappedParallelCoordinatesRenderer.h>
+#include <util/CreateRandomTable.h>
+#include <ISFV2014/Util/Arrow.h>
+#include <ISFV2014/Util/Streamline.h>
+
+using namespace kvsoceanvis;
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Benchmark parameters given by the command line.
+ */
+/*===========================================================================*/
+struct Parameters
+{
+    std::string target; ///< benchmark case ("all" for every case)
+    size_t nframes; ///< number of measured frames
+    size_t nwarmups; ///< number of warm-up frames (not measured)
+    std::vector<size_t> widths; ///< window widths
+    std::vector<size_t> heights; ///< window heights
+    std::string table_file; ///< table file for the PCP cases
+    size_t nrows; ///< number of rows of the synthetic table
+    size_t ncolumns; ///< number of columns of the synthetic table
+    size_t nclusters; ///< number of clusters for the cluster mapped PCP
+    size_t grid; ///< horizontal grid resolution of the synthetic volume
+    float lod_threshold; ///< LOD opacity threshold for the bin mapped PCP (disabled if negative)
+
+    Parameters():
+        target( "all" ),
+        nframes( 100 ),
+        nwarmups( 5 ),
+        nrows( 100000 ),
+        ncolumns( 6 ),
+        nclusters( 10 ),
+        grid( 64 ),
+        lod_threshold( -1.0f ) {}
+
+    bool parse( int argc, char** argv )
+    {
+        for ( int i = 1; i < argc; i++ )
+        {
+            const std::string option( argv[i] );
+            if ( i + 1 >= argc ) { std::cerr << "Missing value for " << option << std::endl; return false; }
+
+            const std::string value( argv[++i] );
+            if ( option == "-case" ) { target = value; }
+            else if ( option == "-frames" ) { nframes = std::atoi( value.c_str() ); }
+            else if ( option == "-warmup" ) { nwarmups = std::atoi( value.c_str() ); }
+            else if ( option == "-table" ) { table_file = value; }
+            else if ( option == "-rows" ) { nrows = std::atoi( value.c_str() ); }
+            else if ( option == "-columns" ) { ncolumns = std::atoi( value.c_str() ); }
+            else if ( option == "-clusters" ) { nclusters = std::atoi( value.c_str() ); }
+            else if ( option == "-grid" ) { grid = std::atoi( value.c_str() ); }
+            else if ( option == "-lod" ) { lod_threshold = static_cast<float>( std::atof( value.c_str() ) ); }
+            else if ( option == "-size" )
+            {
+                unsigned int width = 0;
+                unsigned int height = 0;
+                if ( std::sscanf( value.c_str(), "%ux%u", &width, &height ) != 2 )
+                {
+                    std::cerr << "Invalid size '" << value << "'." << std::endl;
+                    return false;
+                }
+                widths.push_back( width );
+                heights.push_back( height );
+            }
+            else
+            {
+                std::cerr << "Unknown option " << option << "." << std::endl;
+                return false;
+            }
+        }
+
+        if ( widths.empty() )
+        {
+            widths.push_back( 512 ); heights.push_back( 512 );
+            widths.push_back( 1024 ); heights.push_back( 1024 );
+        }
+
+        return nframes > 0;
+    }
+
+    bool run( const std::string& name ) const
+    {
+        return target == "all" || target == name;
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Offscreen rendering context with OSMesa.
+ */
+/*===========================================================================*/
+class OffscreenContext
+{
+    OSMesaContext m_context; ///< OSMesa context
+    std::vector<GLubyte> m_buffer; ///< color buffer (RGBA)
+
+public:
+
+    OffscreenContext()
+    {
+        m_context = OSMesaCreateContextExt( OSMESA_RGBA, 24, 8, 0, NULL );
+    }
+
+    ~OffscreenContext()
+    {
+        if ( m_context ) OSMesaDestroyContext( m_context );
+    }
+
+    bool isValid() const
+    {
+        return m_context != NULL;
+    }
+
+    bool resize( const size_t width, const size_t height )
+    {
+        m_buffer.resize( width * height * 4 );
+        if ( !OSMesaMakeCurrent( m_context, &m_buffer[0], GL_UNSIGNED_BYTE, width, height ) ) return false;
+
+        glViewport( 0, 0, width, height );
+        return true;
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets the projection for the 3D objects so that the bounding box
+ *          of the object fits into the viewport.
+ *  @param  object [in] pointer to the object
+ */
+/*===========================================================================*/
+void SetupView3D( const kvs::ObjectBase* object )
+{
+    const kvs::Vec3 min_coord = object->minExternalCoord();
+    const kvs::Vec3 max_coord = object->maxExternalCoord();
+    const kvs::Vec3 center = ( min_coord + max_coord ) * 0.5f;
+    const float radius = static_cast<float>( ( max_coord - min_coord ).length() * 0.5 );
+
+    glMatrixMode( GL_PROJECTION );
+    glLoadIdentity();
+    glOrtho( -radius, radius, -radius, radius, -2 * radius, 2 * radius );
+
+    glMatrixMode( GL_MODELVIEW );
+    glLoadIdentity();
+    glRotatef( -60.0f, 1.0f, 0.0f, 0.0f );
+    glTranslatef( -center.x(), -center.y(), -center.z() );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Renders the frames and writes the statistics.
+ *  @param  name [in] case name
+ *  @param  params [in] benchmark parameters
+ *  @param  context [in] offscreen context
+ *  @param  object [in] pointer to the object
+ *  @param  renderer [in] pointer to the renderer
+ *  @param  primitives [in] number of primitives per frame (per LOD bin if lod_renderer is given)
+ *  @param  view3d [in] if true, 3D projection is applied for each frame
+ *  @param  lod_renderer [in] multi-bin renderer whose merged LOD bins are counted
+ */
+/*===========================================================================*/
+void Run(
+    const std::string& name,
+    const Parameters& params,
+    OffscreenContext& context,
+    kvs::ObjectBase* object,
+    kvs::RendererBase* renderer,
+    const size_t primitives,
+    const bool view3d,
+    const pcs::MultiBinMappedParallelCoordinatesRenderer* lod_renderer = NULL )
+{
+    kvs::Light light;
+    for ( size_t s = 0; s < params.widths.size(); s++ )
+    {
+        const size_t width = params.widths[s];
+        const size_t height = params.heights[s];
+        if ( !context.resize( width, height ) )
+        {
+            std::cerr << "Cannot resize the offscreen buffer to " << width << "x" << height << "." << std::endl;
+            continue;
+        }
+
+        kvs::Camera camera;
+        camera.setWindowSize( width, height );
+
+        std::vector<double> msecs;
+        msecs.reserve( params.nframes );
+        for ( size_t i = 0; i < params.nwarmups + params.nframes; i++ )
+        {
+            kvs::Timer timer;
+            timer.start();
+
+            glClearColor( 1.0f, 1.0f, 1.0f, 1.0f );
+            glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+            if ( view3d ) ::SetupView3D( object );
+            renderer->exec( object, &camera, &light );
+            glFinish();
+
+            timer.stop();
+            if ( i >= params.nwarmups ) msecs.push_back( timer.msec() );
+        }
+
+        // The LOD bins are merged at drawing time according to the window size.
+        const size_t nprimitives = lod_renderer ? lod_renderer->numberOfLODBins() * primitives : primitives;
+
+        std::sort( msecs.begin(), msecs.end() );
+        const size_t n = msecs.size();
+        const double min_msec = msecs[0];
+        const double median_msec = ( n % 2 ) ? msecs[n/2] : 0.5 * ( msecs[n/2-1] + msecs[n/2] );
+        const double p99_msec = msecs[ std::min( n - 1, static_cast<size_t>( 0.99 * n ) ) ];
+        const double primitives_per_sec = median_msec > 0.0 ? nprimitives / ( median_msec * 1.0e-3 ) : 0.0;
+
+        std::cout << "{\"case\":\"" << name << "\""
+                  << ",\"width\":" << width
+                  << ",\"height\":" << height
+                  << ",\"frames\":" << n
+                  << ",\"primitives\":" << nprimitives
+                  << ",\"min_msec\":" << min_msec
+                  << ",\"median_msec\":" << median_msec
+                  << ",\"p99_msec\":" << p99_msec
+                  << ",\"primitives_per_sec\":" << primitives_per_sec
+                  << "}" << std::endl;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Creates a synthetic vortex field on a rectilinear grid.
+ *  @param  grid [in] horizontal grid resolution
+ *  @return pointer to the vector volume object
+ */
+/*===========================================================================*/
+kvs::StructuredVolumeObject* CreateVortexVolume( const size_t grid )
+{
+    const size_t dimx = grid;
+    const size_t dimy = grid;
+    const size_t dimz = kvs::Math::Max( grid / 4, size_t(2) );
+
+    kvs::ValueArray<kvs::Real32> coords( dimx + dimy + dimz );
+    for ( size_t i = 0; i < dimx; i++ ) coords[i] = static_cast<kvs::Real32>( i );
+    for ( size_t j = 0; j < dimy; j++ ) coords[dimx+j] = static_cast<kvs::Real32>( j );
+    for ( size_t k = 0; k < dimz; k++ ) coords[dimx+dimy+k] = static_cast<kvs::Real32>( k );
+
+    const float cx = 0.5f * ( dimx - 1 );
+    const float cy = 0.5f * ( dimy - 1 );
+    kvs::ValueArray<kvs::Real32> values( dimx * dimy * dimz * 3 );
+    kvs::Real32* pvalues = values.data();
+    for ( size_t k = 0; k < dimz; k++ )
+    {
+        for ( size_t j = 0; j < dimy; j++ )
+        {
+            for ( size_t i = 0; i < dimx; i++ )
+            {
+                const float x = ( i - cx ) / cx;
+                const float y = ( j - cy ) / cy;
+                *(pvalues++) = -y;
+                *(pvalues++) = x;
+                *(pvalues++) = 0.05f * ( 1.0f - x * x - y * y );
+            }
+        }
+    }
+
+    kvs::StructuredVolumeObject* volume = new kvs::StructuredVolumeObject();
+    volume->setGridTypeToRectilinear();
+    volume->setVeclen( 3 );
+    volume->setResolution( kvs::Vec3ui( dimx, dimy, dimz ) );
+    volume->setValues( kvs::AnyValueArray( values ) );
+    volume->setCoords( coords );
+    volume->updateMinMaxCoords();
+    volume->updateMinMaxValues();
+
+    return volume;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Creates seed points along the diagonal of the volume.
+ *  @param  volume [in] pointer to the volume object
+ *  @return pointer to the point object
+ */
+/*===========================================================================*/
+kvs::PointObject* CreateSeedPoints( const kvs::StructuredVolumeObject* volume )
+{
+    const size_t nseeds = 64;
+    const kvs::Vec3 min_coord = volume->minObjectCoord();
+    const kvs::Vec3 max_coord = volume->maxObjectCoord();
+
+    kvs::ValueArray<kvs::Real32> coords( nseeds * 3 );
+    for ( size_t i = 0; i < nseeds; i++ )
+    {
+        const float t = ( i + 0.5f ) / nseeds;
+        coords[ 3 * i + 0 ] = min_coord.x() + ( max_coord.x() - min_coord.x() ) * t;
+        coords[ 3 * i + 1 ] = min_coord.y() + ( max_coord.y() - min_coord.y() ) * 0.5f;
+        coords[ 3 * i + 2 ] = min_coord.z() + ( max_coord.z() - min_coord.z() ) * 0.5f;
+    }
+
+    kvs::PointObject* point = new kvs::PointObject();
+    point->setCoords( coords );
+    return point;
+}
+
+} // end of namespace
+
+
+int main( int argc, char** argv )
+{
+    ::Parameters params;
+    if ( !params.parse( argc, argv ) ) return 1;
+
+    ::OffscreenContext context;
+    if ( !context.isValid() || !context.resize( params.widths[0], params.heights[0] ) )
+    {
+        std::cerr << "Cannot create an OSMesa context." << std::endl;
+        return 1;
+    }
+
+    // Table for the parallel coordinates.
+    kvs::TableObject* table = NULL;
+    if ( params.run( "multibin" ) || params.run( "cluster" ) )
+    {
+        if ( params.table_file.empty() )
+        {
+            table = new kvs::TableObject( util::CreateRandomTable( params.nrows, params.ncolumns, 0 ) );
+        }
+        else
+        {
+            table = new kvs::TableImporter( params.table_file );
+        }
+    }
+
+    if ( params.run( "multibin" ) )
+    {
+        pcs::MultiBinMapping* object = new pcs::MultiBinMapping( table );
+        pcs::MultiBinMappedParallelCoordinatesRenderer* renderer = new pcs::MultiBinMappedParallelCoordinatesRenderer();
+        renderer->setBinOpacity( 64 );
+        if ( params.lod_threshold >= 0.0f ) renderer->enableLOD( params.lod_threshold );
+
+        if ( params.lod_threshold >= 0.0f )
+        {
+            const size_t primitives = object->naxes() - 1;
+            ::Run( "multibin_lod", params, context, object, renderer, primitives, false, renderer );
+        }
+        else
+        {
+            const size_t primitives = object->binList().size() * ( object->naxes() - 1 );
+            ::Run( "multibin", params, context, object, renderer, primitives, false );
+        }
+
+        delete renderer;
+        delete object;
+    }
+
+    if ( params.run( "cluster" ) )
+    {
+        pcs::FastKMeansClustering* clustering = new pcs::FastKMeansClustering();
+        clustering->setSeedingMethod( pcs::FastKMeansClustering::SmartSeeding );
+        clustering->setNumberOfClusters( params.nclusters );
+        clustering->setSeed( 0 );
+        clustering->exec( table );
+
+        pcs::ClusterMapping* object = new pcs::ClusterMapping( clustering );
+        pcs::ClusterMappedParallelCoordinatesRenderer* renderer = new pcs::ClusterMappedParallelCoordinatesRenderer();
+        renderer->setClusterOpacity( 64 );
+        delete clustering;
+
+        const size_t primitives = object->nclusters() * ( object->naxes() - 1 );
+        ::Run( "cluster", params, context, object, renderer, primitives, false );
+
+        delete renderer;
+        delete object;
+    }
+
+    if ( table ) delete table;
+
+    // Vector volume for the ISFV2014 pipelines.
+    kvs::StructuredVolumeObject* volume = NULL;
+    if ( params.run( "arrow" ) || params.run( "streamline" ) )
+    {
+        volume = ::CreateVortexVolume( params.grid );
+    }
+
+    const kvs::TransferFunction transfer_function( kvs::RGBFormulae::Jet( 256 ) );
+    if ( params.run( "arrow" ) )
+    {
+        ISFV2014::ArrowGlyph* renderer = new ISFV2014::ArrowGlyph();
+        renderer->setTransferFunction( transfer_function );
+        renderer->setType( ISFV2014::ArrowGlyph::LineArrow );
+
+        const size_t primitives = volume->numberOfNodes();
+        ::Run( "arrow", params, context, volume, renderer, primitives, true );
+
+        delete renderer;
+    }
+
+    if ( params.run( "streamline" ) )
+    {
+        kvs::PointObject* seed_points = ::CreateSeedPoints( volume );
+        ISFV2014::Streamline* object = new ISFV2014::Streamline();
+        object->setSeedPoints( seed_points );
+        object->setIntegrationInterval( 0.1f );
+        object->setTransferFunction( transfer_function );
+        object->setIntegrationTimesThreshold( 2000 );
+        object->setEnableIntegrationTimesCondition( true );
+        object->exec( volume );
+        delete seed_points;
+
+        kvs::LineRenderer* renderer = new kvs::LineRenderer();
+
+        const size_t primitives = object->numberOfVertices();
+        ::Run( "streamline", params, context, object, renderer, primitives, true );
+
+        delete renderer;
+        delete object;
+    }
+
+    if ( volume ) delete volume;
+
+    return 0;
+}